@@ -0,0 +1,993 @@
+/*
+ * file-io-benchmark.cpp - Local drive benchmark through the file I/O hooks
+ *
+ * Generates a temporary tree (many small files, a few large files and one
+ * deep directory chain), mounts it on a harness that makes the same host
+ * calls as drive_local.cpp and drive_cache.cpp, and runs DOS-level
+ * workloads twice:
+ *
+ *   direct    - no delegate: the host calls stock DOSBox makes itself
+ *   delegate  - every call routed through the 18 file I/O hooks
+ *               (INT-039 - INT-056) to a pass-through delegate
+ *
+ * The difference is the cost of the hook layer alone. A second pass
+ * measures each hook in isolation against the host call it replaces.
+ *
+ * Results are printed as a table and written as JSON (--json PATH, or
+ * "--json -" for stdout only).
+ *
+ * Usage: ./file-io-benchmark [--dir PATH] [--files N] [--large-mb N]
+ *                            [--depth N] [--rounds N] [--json PATH]
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// ============================================================================
+// Standalone Hook Layer
+// ============================================================================
+// The file I/O subset of IBoxerDelegate and the BOXER_HOOK_* macros from
+// include/boxer/boxer_hooks.h (phase-1-dosbox-changes.patch), so the
+// benchmark builds without the DOSBox tree.
+
+class DOS_Drive;
+typedef void* DIR_Handle;
+typedef uint8_t Bit8u;
+
+class IBoxerDelegate {
+public:
+    virtual ~IBoxerDelegate() = default;
+    virtual bool shouldMountPath(const char* path) = 0;                                              // INT-039
+    virtual bool shouldShowFileWithName(const char* name) = 0;                                       // INT-040
+    virtual bool shouldAllowWriteAccessToPath(const char* path, DOS_Drive* drive) = 0;               // INT-041
+    virtual void driveDidMount(Bit8u driveIndex) = 0;                                                // INT-042
+    virtual void driveDidUnmount(Bit8u driveIndex) = 0;                                              // INT-043
+    virtual void didCreateLocalFile(const char* path, DOS_Drive* drive) = 0;                         // INT-044
+    virtual void didRemoveLocalFile(const char* path, DOS_Drive* drive) = 0;                         // INT-045
+    virtual FILE* openLocalFile(const char* path, DOS_Drive* drive, const char* mode) = 0;           // INT-046
+    virtual bool removeLocalFile(const char* path, DOS_Drive* drive) = 0;                            // INT-047
+    virtual bool moveLocalFile(const char* fromPath, const char* toPath, DOS_Drive* drive) = 0;      // INT-048
+    virtual bool createLocalDir(const char* path, DOS_Drive* drive) = 0;                             // INT-049
+    virtual bool removeLocalDir(const char* path, DOS_Drive* drive) = 0;                             // INT-050
+    virtual bool getLocalPathStats(const char* path, DOS_Drive* drive, struct stat* outStatus) = 0;  // INT-051
+    virtual bool localDirectoryExists(const char* path, DOS_Drive* drive) = 0;                       // INT-052
+    virtual bool localFileExists(const char* path, DOS_Drive* drive) = 0;                            // INT-053
+    virtual DIR_Handle openLocalDirectory(const char* path, DOS_Drive* drive) = 0;                   // INT-054
+    virtual void closeLocalDirectory(DIR_Handle handle) = 0;                                         // INT-055
+    virtual bool getNextDirectoryEntry(DIR_Handle handle, char* outName, bool& isDirectory) = 0;     // INT-056
+};
+
+IBoxerDelegate* g_boxer_delegate = nullptr;
+
+#define BOXER_HOOK_BOOL(name, ...) \
+    (g_boxer_delegate ? g_boxer_delegate->name(__VA_ARGS__) : true)
+#define BOXER_HOOK_VOID(name, ...) \
+    do { if (g_boxer_delegate) g_boxer_delegate->name(__VA_ARGS__); } while(0)
+#define BOXER_HOOK_VALUE(name, default_val, ...) \
+    (g_boxer_delegate ? g_boxer_delegate->name(__VA_ARGS__) : (default_val))
+#define BOXER_HOOK_PTR(name, ...) \
+    (g_boxer_delegate ? g_boxer_delegate->name(__VA_ARGS__) : nullptr)
+
+namespace {
+
+enum Hook : size_t {
+    kShouldMountPath,
+    kShouldShowFileWithName,
+    kShouldAllowWriteAccessToPath,
+    kDriveDidMount,
+    kDriveDidUnmount,
+    kDidCreateLocalFile,
+    kDidRemoveLocalFile,
+    kOpenLocalFile,
+    kRemoveLocalFile,
+    kMoveLocalFile,
+    kCreateLocalDir,
+    kRemoveLocalDir,
+    kGetLocalPathStats,
+    kLocalDirectoryExists,
+    kLocalFileExists,
+    kOpenLocalDirectory,
+    kCloseLocalDirectory,
+    kGetNextDirectoryEntry,
+    kHookCount,
+};
+
+constexpr const char* kHookNames[kHookCount] = {
+    "shouldMountPath", "shouldShowFileWithName", "shouldAllowWriteAccessToPath",
+    "driveDidMount", "driveDidUnmount", "didCreateLocalFile", "didRemoveLocalFile",
+    "openLocalFile", "removeLocalFile", "moveLocalFile", "createLocalDir", "removeLocalDir",
+    "getLocalPathStats", "localDirectoryExists", "localFileExists",
+    "openLocalDirectory", "closeLocalDirectory", "getNextDirectoryEntry",
+};
+
+std::string hookId(size_t hook) {
+    std::ostringstream id;
+    id << "INT-0" << 39 + hook;
+    return id.str();
+}
+
+// ============================================================================
+// Pass-Through Delegate
+// ============================================================================
+// Does exactly what stock DOSBox does in each hook's place and counts calls.
+
+class PassThroughDelegate : public IBoxerDelegate {
+public:
+    std::array<uint64_t, kHookCount> calls{};
+
+    bool shouldMountPath(const char*) override { ++calls[kShouldMountPath]; return true; }
+    bool shouldShowFileWithName(const char*) override { ++calls[kShouldShowFileWithName]; return true; }
+    bool shouldAllowWriteAccessToPath(const char*, DOS_Drive*) override {
+        ++calls[kShouldAllowWriteAccessToPath];
+        return true;
+    }
+    void driveDidMount(Bit8u) override { ++calls[kDriveDidMount]; }
+    void driveDidUnmount(Bit8u) override { ++calls[kDriveDidUnmount]; }
+    void didCreateLocalFile(const char*, DOS_Drive*) override { ++calls[kDidCreateLocalFile]; }
+    void didRemoveLocalFile(const char*, DOS_Drive*) override { ++calls[kDidRemoveLocalFile]; }
+
+    FILE* openLocalFile(const char* path, DOS_Drive*, const char* mode) override {
+        ++calls[kOpenLocalFile];
+        return std::fopen(path, mode);
+    }
+    bool removeLocalFile(const char* path, DOS_Drive*) override {
+        ++calls[kRemoveLocalFile];
+        return unlink(path) == 0;
+    }
+    bool moveLocalFile(const char* fromPath, const char* toPath, DOS_Drive*) override {
+        ++calls[kMoveLocalFile];
+        return std::rename(fromPath, toPath) == 0;
+    }
+    bool createLocalDir(const char* path, DOS_Drive*) override {
+        ++calls[kCreateLocalDir];
+        return mkdir(path, 0775) == 0;
+    }
+    bool removeLocalDir(const char* path, DOS_Drive*) override {
+        ++calls[kRemoveLocalDir];
+        return rmdir(path) == 0;
+    }
+    bool getLocalPathStats(const char* path, DOS_Drive*, struct stat* outStatus) override {
+        ++calls[kGetLocalPathStats];
+        return stat(path, outStatus) == 0;
+    }
+    bool localDirectoryExists(const char* path, DOS_Drive*) override {
+        ++calls[kLocalDirectoryExists];
+        struct stat status;
+        return stat(path, &status) == 0 && S_ISDIR(status.st_mode);
+    }
+    bool localFileExists(const char* path, DOS_Drive*) override {
+        ++calls[kLocalFileExists];
+        struct stat status;
+        return stat(path, &status) == 0 && S_ISREG(status.st_mode);
+    }
+    DIR_Handle openLocalDirectory(const char* path, DOS_Drive*) override {
+        ++calls[kOpenLocalDirectory];
+        return opendir(path);
+    }
+    void closeLocalDirectory(DIR_Handle handle) override {
+        ++calls[kCloseLocalDirectory];
+        closedir(static_cast<DIR*>(handle));
+    }
+    bool getNextDirectoryEntry(DIR_Handle handle, char* outName, bool& isDirectory) override {
+        ++calls[kGetNextDirectoryEntry];
+        const dirent* entry = readdir(static_cast<DIR*>(handle));
+        if (!entry) {
+            return false;
+        }
+        std::snprintf(outName, 256, "%s", entry->d_name);
+        isDirectory = entry->d_type == DT_DIR;
+        return true;
+    }
+};
+
+// ============================================================================
+// Local Drive Harness
+// ============================================================================
+// The host calls localDrive and DOS_Drive_Cache make for each DOS request,
+// with the hook at each point where BOXER_INTEGRATED inserts one.
+
+DOS_Drive* const kDrive = reinterpret_cast<DOS_Drive*>(0x1000);
+
+class LocalDriveHarness {
+public:
+    explicit LocalDriveHarness(std::string root) : m_root(std::move(root)) {}
+
+    std::string hostPath(const std::string& dosPath) const { return m_root + "/" + dosPath; }
+
+    // MOUNT C: the host directory is checked, then the delegate is asked
+    bool mount() {
+        struct stat status;
+        if (::stat(m_root.c_str(), &status) != 0 || !S_ISDIR(status.st_mode)) {
+            return false;
+        }
+        if (g_boxer_delegate && !BOXER_HOOK_BOOL(shouldMountPath, m_root.c_str())) {
+            return false;
+        }
+        BOXER_HOOK_VOID(driveDidMount, 2);
+        return true;
+    }
+
+    void unmount() { BOXER_HOOK_VOID(driveDidUnmount, 2); }
+
+    // FindFirst/FindNext: drive_cache reads the directory, then FillDTA
+    // stats each match for size, date and attributes
+    template <typename Visitor>
+    size_t find(const std::string& dosDirectory, const char* pattern, Visitor&& visit) {
+        const std::string directory = hostPath(dosDirectory);
+        std::vector<std::pair<std::string, bool>> entries;
+        if (g_boxer_delegate) {
+            DIR_Handle handle = BOXER_HOOK_PTR(openLocalDirectory, directory.c_str(), kDrive);
+            if (!handle) {
+                return 0;
+            }
+            char name[256];
+            bool isDirectory = false;
+            while (BOXER_HOOK_BOOL(getNextDirectoryEntry, handle, name, isDirectory)) {
+                if (BOXER_HOOK_BOOL(shouldShowFileWithName, name)) {
+                    entries.emplace_back(name, isDirectory);
+                }
+            }
+            BOXER_HOOK_VOID(closeLocalDirectory, handle);
+        } else {
+            DIR* dir = opendir(directory.c_str());
+            if (!dir) {
+                return 0;
+            }
+            while (const dirent* entry = readdir(dir)) {
+                entries.emplace_back(entry->d_name, entry->d_type == DT_DIR);
+            }
+            closedir(dir);
+        }
+
+        size_t matches = 0;
+        for (const auto& entry : entries) {
+            if (!matchesPattern(entry.first.c_str(), pattern)) {
+                continue;
+            }
+            struct stat status;
+            if (stat(directory + "/" + entry.first, status)) {
+                visit(entry.first, status);
+                ++matches;
+            }
+        }
+        return matches;
+    }
+
+    // DOS_MakeName walks the path and checks each directory (TestDir)
+    bool testDirectories(const std::string& dosPath) {
+        size_t slash = 0;
+        while ((slash = dosPath.find('/', slash + 1)) != std::string::npos) {
+            if (!directoryExists(hostPath(dosPath.substr(0, slash)))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool fileExists(const std::string& dosPath) {
+        const std::string path = hostPath(dosPath);
+        if (g_boxer_delegate) {
+            return BOXER_HOOK_BOOL(localFileExists, path.c_str(), kDrive);
+        }
+        struct stat status;
+        return ::stat(path.c_str(), &status) == 0 && S_ISREG(status.st_mode);
+    }
+
+    FILE* open(const std::string& dosPath, const char* mode) {
+        const std::string path = hostPath(dosPath);
+        if (!g_boxer_delegate) {
+            return std::fopen(path.c_str(), mode);
+        }
+        if (mode[0] != 'r' || std::strchr(mode, '+')) {
+            if (!BOXER_HOOK_BOOL(shouldAllowWriteAccessToPath, path.c_str(), kDrive)) {
+                return nullptr;
+            }
+        }
+        return BOXER_HOOK_PTR(openLocalFile, path.c_str(), kDrive, mode);
+    }
+
+    FILE* create(const std::string& dosPath) {
+        const std::string path = hostPath(dosPath);
+        if (!g_boxer_delegate) {
+            return std::fopen(path.c_str(), "wb+");
+        }
+        if (!BOXER_HOOK_BOOL(shouldAllowWriteAccessToPath, path.c_str(), kDrive)) {
+            return nullptr;
+        }
+        FILE* file = BOXER_HOOK_PTR(openLocalFile, path.c_str(), kDrive, "wb+");
+        if (file) {
+            BOXER_HOOK_VOID(didCreateLocalFile, path.c_str(), kDrive);
+        }
+        return file;
+    }
+
+    bool unlink(const std::string& dosPath) {
+        const std::string path = hostPath(dosPath);
+        if (!g_boxer_delegate) {
+            return ::unlink(path.c_str()) == 0;
+        }
+        if (!BOXER_HOOK_BOOL(shouldAllowWriteAccessToPath, path.c_str(), kDrive) ||
+            !BOXER_HOOK_BOOL(removeLocalFile, path.c_str(), kDrive)) {
+            return false;
+        }
+        BOXER_HOOK_VOID(didRemoveLocalFile, path.c_str(), kDrive);
+        return true;
+    }
+
+    bool rename(const std::string& fromDosPath, const std::string& toDosPath) {
+        const std::string from = hostPath(fromDosPath);
+        const std::string to = hostPath(toDosPath);
+        if (!g_boxer_delegate) {
+            return std::rename(from.c_str(), to.c_str()) == 0;
+        }
+        return BOXER_HOOK_BOOL(shouldAllowWriteAccessToPath, from.c_str(), kDrive) &&
+               BOXER_HOOK_BOOL(shouldAllowWriteAccessToPath, to.c_str(), kDrive) &&
+               BOXER_HOOK_BOOL(moveLocalFile, from.c_str(), to.c_str(), kDrive);
+    }
+
+    bool makeDirectory(const std::string& dosPath) {
+        const std::string path = hostPath(dosPath);
+        if (!g_boxer_delegate) {
+            return mkdir(path.c_str(), 0775) == 0;
+        }
+        return BOXER_HOOK_BOOL(shouldAllowWriteAccessToPath, path.c_str(), kDrive) &&
+               BOXER_HOOK_BOOL(createLocalDir, path.c_str(), kDrive);
+    }
+
+    bool removeDirectory(const std::string& dosPath) {
+        const std::string path = hostPath(dosPath);
+        if (!g_boxer_delegate) {
+            return rmdir(path.c_str()) == 0;
+        }
+        return BOXER_HOOK_BOOL(shouldAllowWriteAccessToPath, path.c_str(), kDrive) &&
+               BOXER_HOOK_BOOL(removeLocalDir, path.c_str(), kDrive);
+    }
+
+    // INT 21h AX=4300h: attributes of a path
+    bool getAttributes(const std::string& dosPath, struct stat& status) {
+        return stat(hostPath(dosPath), status);
+    }
+
+    // DOS wildcard match: '?' one character, '*' the rest of the part
+    static bool matchesPattern(const char* name, const char* pattern) {
+        if (std::strcmp(pattern, "*.*") == 0 || std::strcmp(pattern, "*") == 0) {
+            return true;
+        }
+        const char* n = name;
+        const char* p = pattern;
+        while (*p) {
+            if (*p == '*') {
+                while (*n && *n != '.') {
+                    ++n;
+                }
+                ++p;
+            } else if (*p == '?' || std::toupper(static_cast<unsigned char>(*p)) ==
+                                        std::toupper(static_cast<unsigned char>(*n))) {
+                if (*n) {
+                    ++n;
+                }
+                ++p;
+            } else {
+                return false;
+            }
+        }
+        return *n == '\0';
+    }
+
+private:
+    bool stat(const std::string& path, struct stat& status) {
+        if (g_boxer_delegate) {
+            return BOXER_HOOK_BOOL(getLocalPathStats, path.c_str(), kDrive, &status);
+        }
+        return ::stat(path.c_str(), &status) == 0;
+    }
+
+    bool directoryExists(const std::string& path) {
+        if (g_boxer_delegate) {
+            return BOXER_HOOK_BOOL(localDirectoryExists, path.c_str(), kDrive);
+        }
+        struct stat status;
+        return ::stat(path.c_str(), &status) == 0 && S_ISDIR(status.st_mode);
+    }
+
+    std::string m_root;
+};
+
+// ============================================================================
+// Test Tree
+// ============================================================================
+
+struct TreeOptions {
+    int smallFiles = 2000;
+    int filesPerDirectory = 100;
+    int largeFiles = 4;
+    uint64_t largeFileMB = 16;
+    int depth = 24;
+};
+
+struct Tree {
+    std::string root;
+    std::vector<std::string> directories;   // DOS-style relative paths, '/' separated
+    std::vector<std::string> smallFiles;
+    std::vector<std::string> largeFiles;
+    std::vector<std::string> deepFiles;
+};
+
+Tree makeTree(const fs::path& parent, const TreeOptions& options) {
+    Tree tree;
+    tree.root = (parent / ("boxer-fileio-benchmark-" +
+                           std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())))
+                    .string();
+    fs::create_directories(tree.root);
+
+    try {
+        std::vector<char> smallData(1500, 'x');
+        for (int i = 0; i < options.smallFiles; ++i) {
+            const std::string directory = "SMALL" + std::to_string(i / options.filesPerDirectory);
+            if (i % options.filesPerDirectory == 0) {
+                fs::create_directories(tree.root + "/" + directory);
+                tree.directories.push_back(directory);
+            }
+            const std::string file = directory + "/FILE" + std::to_string(i % options.filesPerDirectory) + ".DAT";
+            std::ofstream(tree.root + "/" + file, std::ios::binary)
+                .write(smallData.data(), static_cast<std::streamsize>(smallData.size() - i % 1000));
+            tree.smallFiles.push_back(file);
+        }
+
+        fs::create_directories(tree.root + "/LARGE");
+        tree.directories.push_back("LARGE");
+        std::vector<char> block(1024 * 1024);
+        for (size_t i = 0; i < block.size(); ++i) {
+            block[i] = static_cast<char>(i * 7);
+        }
+        for (int i = 0; i < options.largeFiles; ++i) {
+            const std::string file = "LARGE/MOVIE" + std::to_string(i) + ".VID";
+            std::ofstream out(tree.root + "/" + file, std::ios::binary);
+            for (uint64_t mb = 0; mb < options.largeFileMB; ++mb) {
+                out.write(block.data(), static_cast<std::streamsize>(block.size()));
+            }
+            tree.largeFiles.push_back(file);
+        }
+
+        std::string deep = "DEEP";
+        for (int level = 0; level < options.depth; ++level) {
+            fs::create_directories(tree.root + "/" + deep);
+            tree.directories.push_back(deep);
+            const std::string file = deep + "/LEVEL" + std::to_string(level) + ".CFG";
+            std::ofstream(tree.root + "/" + file) << level;
+            tree.deepFiles.push_back(file);
+            deep += "/D" + std::to_string(level);
+        }
+    } catch (...) {
+        // A full disk mid-build must not leave the partial tree behind
+        std::error_code error;
+        fs::remove_all(tree.root, error);
+        throw;
+    }
+    return tree;
+}
+
+// Removes the tree however the run ends
+class TreeCleanup {
+public:
+    explicit TreeCleanup(std::string root) : m_root(std::move(root)) {}
+    ~TreeCleanup() {
+        std::error_code error;
+        fs::remove_all(m_root, error);
+    }
+
+    TreeCleanup(const TreeCleanup&) = delete;
+    TreeCleanup& operator=(const TreeCleanup&) = delete;
+
+private:
+    std::string m_root;
+};
+
+// The directories file workloads write to: the first ten, or all of a
+// smaller tree (--files 100 --depth 1 has three)
+const std::string& saveDirectory(const Tree& tree, size_t i) {
+    return tree.directories[i % std::min<size_t>(10, tree.directories.size())];
+}
+
+// ============================================================================
+// Workloads
+// ============================================================================
+
+struct Workload {
+    const char* name;
+    const char* unit;                        ///< What one op is
+    std::function<uint64_t(LocalDriveHarness&, const Tree&)> run;   ///< Returns ops done
+};
+
+struct WorkloadResult {
+    const char* name;
+    const char* unit;
+    uint64_t ops;
+    double directOpsPerSecond;
+    double delegateOpsPerSecond;
+    std::array<uint64_t, kHookCount> hookCalls;
+};
+
+std::vector<Workload> makeWorkloads() {
+    std::vector<Workload> workloads;
+
+    workloads.push_back({"mount", "mount+unmount", [](LocalDriveHarness& drive, const Tree&) {
+        uint64_t ops = 0;
+        for (int i = 0; i < 1000; ++i) {
+            ops += drive.mount();
+            drive.unmount();
+        }
+        return ops;
+    }});
+
+    workloads.push_back({"dir", "entry", [](LocalDriveHarness& drive, const Tree& tree) {
+        uint64_t ops = 0;
+        uint64_t bytes = 0;
+        for (const auto& directory : tree.directories) {
+            ops += drive.find(directory, "*.*", [&bytes](const std::string&, const struct stat& status) {
+                bytes += static_cast<uint64_t>(status.st_size);
+            });
+        }
+        return bytes > 0 ? ops : 0;
+    }});
+
+    workloads.push_back({"findfirst", "search", [](LocalDriveHarness& drive, const Tree& tree) {
+        uint64_t ops = 0;
+        for (size_t i = 0; i < tree.directories.size(); ++i) {
+            const std::string pattern = "FILE" + std::to_string(i % 10) + "?.DAT";
+            drive.find(tree.directories[i], pattern.c_str(), [](const std::string&, const struct stat&) {});
+            ++ops;
+        }
+        return ops;
+    }});
+
+    workloads.push_back({"open-read-close", "file", [](LocalDriveHarness& drive, const Tree& tree) {
+        uint64_t ops = 0;
+        char buffer[4096];
+        for (const auto& file : tree.smallFiles) {
+            if (!drive.testDirectories(file) || !drive.fileExists(file)) {
+                continue;
+            }
+            if (FILE* stream = drive.open(file, "rb")) {
+                while (std::fread(buffer, 1, sizeof(buffer), stream) > 0) {
+                }
+                std::fclose(stream);
+                ++ops;
+            }
+        }
+        return ops;
+    }});
+
+    workloads.push_back({"large-read", "MiB", [](LocalDriveHarness& drive, const Tree& tree) {
+        uint64_t bytes = 0;
+        std::vector<char> buffer(0x8000);
+        for (const auto& file : tree.largeFiles) {
+            if (FILE* stream = drive.open(file, "rb")) {
+                for (size_t count; (count = std::fread(buffer.data(), 1, buffer.size(), stream)) > 0;) {
+                    bytes += count;
+                }
+                std::fclose(stream);
+            }
+        }
+        return bytes / (1024 * 1024);
+    }});
+
+    workloads.push_back({"deep-stat", "path", [](LocalDriveHarness& drive, const Tree& tree) {
+        uint64_t ops = 0;
+        struct stat status;
+        for (int pass = 0; pass < 20; ++pass) {
+            for (const auto& file : tree.deepFiles) {
+                ops += drive.testDirectories(file) && drive.getAttributes(file, status);
+            }
+        }
+        return ops;
+    }});
+
+    workloads.push_back({"create-write-close", "file", [](LocalDriveHarness& drive, const Tree& tree) {
+        uint64_t ops = 0;
+        const char record[512] = {};
+        for (size_t i = 0; i < 500; ++i) {
+            const std::string file = saveDirectory(tree, i) + "/NEW" + std::to_string(i) + ".SAV";
+            if (FILE* stream = drive.create(file)) {
+                for (int r = 0; r < 8; ++r) {
+                    std::fwrite(record, 1, sizeof(record), stream);
+                }
+                std::fclose(stream);
+                ++ops;
+            }
+        }
+        return ops;
+    }});
+
+    workloads.push_back({"rename", "file", [](LocalDriveHarness& drive, const Tree& tree) {
+        uint64_t ops = 0;
+        for (size_t i = 0; i < 500; ++i) {
+            const std::string& directory = saveDirectory(tree, i);
+            ops += drive.rename(directory + "/NEW" + std::to_string(i) + ".SAV",
+                                directory + "/OLD" + std::to_string(i) + ".SAV");
+        }
+        return ops;
+    }});
+
+    workloads.push_back({"delete", "file", [](LocalDriveHarness& drive, const Tree& tree) {
+        uint64_t ops = 0;
+        for (size_t i = 0; i < 500; ++i) {
+            ops += drive.unlink(saveDirectory(tree, i) + "/OLD" + std::to_string(i) + ".SAV");
+        }
+        return ops;
+    }});
+
+    workloads.push_back({"mkdir-rmdir", "directory", [](LocalDriveHarness& drive, const Tree&) {
+        uint64_t ops = 0;
+        for (int i = 0; i < 300; ++i) {
+            const std::string directory = "TEMP" + std::to_string(i);
+            ops += drive.makeDirectory(directory) && drive.removeDirectory(directory);
+        }
+        return ops;
+    }});
+
+    return workloads;
+}
+
+// One timed run; main keeps the best over --rounds
+double opsPerSecond(const Workload& workload, LocalDriveHarness& drive, const Tree& tree, uint64_t& ops) {
+    const auto start = std::chrono::steady_clock::now();
+    ops = workload.run(drive, tree);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds > 0 ? static_cast<double>(ops) / seconds : 0;
+}
+
+// ============================================================================
+// Per-Hook Overhead
+// ============================================================================
+// Each hook against the host call it replaces, in a loop. Mutating hooks
+// are paired with the direct inverse call so only one side differs.
+
+struct HookCost {
+    double directNs;
+    double hookedNs;
+};
+
+template <typename Direct, typename Hooked>
+HookCost measureHook(int iterations, int rounds, Direct&& direct, Hooked&& hooked,
+                     PassThroughDelegate& delegate) {
+    auto time = [iterations](auto&& body) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            body(i);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+               iterations;
+    };
+    HookCost cost{1e300, 1e300};
+    for (int round = 0; round < rounds; ++round) {
+        g_boxer_delegate = nullptr;
+        cost.directNs = std::min(cost.directNs, time(direct));
+        g_boxer_delegate = &delegate;
+        cost.hookedNs = std::min(cost.hookedNs, time(hooked));
+    }
+    g_boxer_delegate = nullptr;
+    return cost;
+}
+
+std::array<HookCost, kHookCount> measureHooks(const Tree& tree, int rounds) {
+    PassThroughDelegate delegate;
+    std::array<HookCost, kHookCount> costs{};
+    const std::string file = tree.root + "/" + tree.smallFiles.front();
+    const std::string directory = tree.root + "/" + tree.directories.front();
+    const std::string scratch = tree.root + "/SCRATCH";
+    const std::string scratchTo = tree.root + "/SCRATCH2";
+    const char* path = file.c_str();
+    volatile bool sink = false;
+    const int n = 20000;
+    const int slow = 2000;   // iterations for hooks that touch the disk
+
+    // Notification and policy hooks replace nothing in stock DOSBox
+    auto nothing = [](int) {};
+    costs[kShouldMountPath] = measureHook(n, rounds, nothing,
+        [&](int) { sink = BOXER_HOOK_BOOL(shouldMountPath, path); }, delegate);
+    costs[kShouldShowFileWithName] = measureHook(n, rounds, nothing,
+        [&](int) { sink = BOXER_HOOK_BOOL(shouldShowFileWithName, "FILE0.DAT"); }, delegate);
+    costs[kShouldAllowWriteAccessToPath] = measureHook(n, rounds, nothing,
+        [&](int) { sink = BOXER_HOOK_BOOL(shouldAllowWriteAccessToPath, path, kDrive); }, delegate);
+    costs[kDriveDidMount] = measureHook(n, rounds, nothing,
+        [&](int) { BOXER_HOOK_VOID(driveDidMount, 2); }, delegate);
+    costs[kDriveDidUnmount] = measureHook(n, rounds, nothing,
+        [&](int) { BOXER_HOOK_VOID(driveDidUnmount, 2); }, delegate);
+    costs[kDidCreateLocalFile] = measureHook(n, rounds, nothing,
+        [&](int) { BOXER_HOOK_VOID(didCreateLocalFile, path, kDrive); }, delegate);
+    costs[kDidRemoveLocalFile] = measureHook(n, rounds, nothing,
+        [&](int) { BOXER_HOOK_VOID(didRemoveLocalFile, path, kDrive); }, delegate);
+
+    costs[kOpenLocalFile] = measureHook(slow, rounds,
+        [&](int) { std::fclose(std::fopen(path, "rb")); },
+        [&](int) { std::fclose(BOXER_HOOK_PTR(openLocalFile, path, kDrive, "rb")); }, delegate);
+
+    const std::string scratchFile = scratch + ".DAT";
+    const char* scratchPath = scratchFile.c_str();
+    costs[kRemoveLocalFile] = measureHook(slow, rounds,
+        [&](int) { std::fclose(std::fopen(scratchPath, "wb")); ::unlink(scratchPath); },
+        [&](int) { std::fclose(std::fopen(scratchPath, "wb")); sink = BOXER_HOOK_BOOL(removeLocalFile, scratchPath, kDrive); },
+        delegate);
+
+    const std::string movedFile = scratchTo + ".DAT";
+    std::fclose(std::fopen(scratchPath, "wb"));
+    costs[kMoveLocalFile] = measureHook(slow, rounds,
+        [&](int) { std::rename(scratchPath, movedFile.c_str()); std::rename(movedFile.c_str(), scratchPath); },
+        [&](int) {
+            sink = BOXER_HOOK_BOOL(moveLocalFile, scratchPath, movedFile.c_str(), kDrive);
+            std::rename(movedFile.c_str(), scratchPath);
+        },
+        delegate);
+    ::unlink(scratchPath);
+
+    const char* scratchDirectory = scratch.c_str();
+    costs[kCreateLocalDir] = measureHook(slow, rounds,
+        [&](int) { mkdir(scratchDirectory, 0775); rmdir(scratchDirectory); },
+        [&](int) { sink = BOXER_HOOK_BOOL(createLocalDir, scratchDirectory, kDrive); rmdir(scratchDirectory); },
+        delegate);
+    costs[kRemoveLocalDir] = measureHook(slow, rounds,
+        [&](int) { mkdir(scratchDirectory, 0775); rmdir(scratchDirectory); },
+        [&](int) { mkdir(scratchDirectory, 0775); sink = BOXER_HOOK_BOOL(removeLocalDir, scratchDirectory, kDrive); },
+        delegate);
+
+    struct stat status;
+    costs[kGetLocalPathStats] = measureHook(n, rounds,
+        [&](int) { sink = ::stat(path, &status) == 0; },
+        [&](int) { sink = BOXER_HOOK_BOOL(getLocalPathStats, path, kDrive, &status); }, delegate);
+    costs[kLocalDirectoryExists] = measureHook(n, rounds,
+        [&](int) { sink = ::stat(directory.c_str(), &status) == 0 && S_ISDIR(status.st_mode); },
+        [&](int) { sink = BOXER_HOOK_BOOL(localDirectoryExists, directory.c_str(), kDrive); }, delegate);
+    costs[kLocalFileExists] = measureHook(n, rounds,
+        [&](int) { sink = ::stat(path, &status) == 0 && S_ISREG(status.st_mode); },
+        [&](int) { sink = BOXER_HOOK_BOOL(localFileExists, path, kDrive); }, delegate);
+
+    costs[kOpenLocalDirectory] = measureHook(slow, rounds,
+        [&](int) { closedir(opendir(directory.c_str())); },
+        [&](int) { closedir(static_cast<DIR*>(BOXER_HOOK_PTR(openLocalDirectory, directory.c_str(), kDrive))); },
+        delegate);
+    costs[kCloseLocalDirectory] = measureHook(slow, rounds,
+        [&](int) { closedir(opendir(directory.c_str())); },
+        [&](int) { BOXER_HOOK_VOID(closeLocalDirectory, opendir(directory.c_str())); }, delegate);
+
+    // One full listing per iteration; cost is reported per entry
+    DIR* listing = opendir(directory.c_str());
+    size_t entries = 0;
+    while (readdir(listing)) {
+        ++entries;
+    }
+    closedir(listing);
+    char name[256];
+    bool isDirectory = false;
+    costs[kGetNextDirectoryEntry] = measureHook(slow / 10, rounds,
+        [&](int) {
+            DIR* dir = opendir(directory.c_str());
+            while (const dirent* entry = readdir(dir)) {
+                std::snprintf(name, sizeof(name), "%s", entry->d_name);
+                isDirectory = entry->d_type == DT_DIR;
+            }
+            closedir(dir);
+        },
+        [&](int) {
+            DIR* dir = opendir(directory.c_str());
+            while (BOXER_HOOK_BOOL(getNextDirectoryEntry, dir, name, isDirectory)) {
+            }
+            closedir(dir);
+        },
+        delegate);
+    costs[kGetNextDirectoryEntry].directNs /= static_cast<double>(entries + 1);
+    costs[kGetNextDirectoryEntry].hookedNs /= static_cast<double>(entries + 1);
+
+    (void)sink;
+    return costs;
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+std::string jsonNumber(double value) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << value;
+    return out.str();
+}
+
+void writeJson(std::ostream& out, const TreeOptions& options, const Tree& tree,
+               const std::vector<WorkloadResult>& results, const std::array<HookCost, kHookCount>& costs,
+               const std::array<uint64_t, kHookCount>& totalCalls) {
+    out << "{\n";
+    out << "  \"benchmark\": \"file-io-benchmark\",\n";
+    out << "  \"tree\": {\"small_files\": " << tree.smallFiles.size()
+        << ", \"directories\": " << tree.directories.size()
+        << ", \"large_files\": " << tree.largeFiles.size()
+        << ", \"large_file_mb\": " << options.largeFileMB
+        << ", \"depth\": " << options.depth << "},\n";
+
+    out << "  \"workloads\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        const double overhead = result.directOpsPerSecond > 0
+            ? (result.directOpsPerSecond / result.delegateOpsPerSecond - 1.0) * 100.0 : 0.0;
+        out << "    {\"name\": \"" << result.name << "\", \"unit\": \"" << result.unit << "\""
+            << ", \"ops\": " << result.ops
+            << ", \"direct_ops_per_sec\": " << jsonNumber(result.directOpsPerSecond)
+            << ", \"delegate_ops_per_sec\": " << jsonNumber(result.delegateOpsPerSecond)
+            << ", \"overhead_percent\": " << jsonNumber(overhead)
+            << ", \"hook_calls\": {";
+        bool first = true;
+        for (size_t hook = 0; hook < kHookCount; ++hook) {
+            if (result.hookCalls[hook]) {
+                out << (first ? "" : ", ") << "\"" << kHookNames[hook] << "\": " << result.hookCalls[hook];
+                first = false;
+            }
+        }
+        out << "}}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ],\n";
+
+    out << "  \"hooks\": [\n";
+    for (size_t hook = 0; hook < kHookCount; ++hook) {
+        const double overhead = costs[hook].hookedNs - costs[hook].directNs;
+        out << "    {\"id\": \"" << hookId(hook) << "\", \"name\": \"" << kHookNames[hook] << "\""
+            << ", \"calls\": " << totalCalls[hook]
+            << ", \"direct_ns\": " << jsonNumber(costs[hook].directNs)
+            << ", \"hooked_ns\": " << jsonNumber(costs[hook].hookedNs)
+            << ", \"overhead_ns\": " << jsonNumber(overhead)
+            << ", \"attributed_ms\": " << jsonNumber(std::max(0.0, overhead) * totalCalls[hook] / 1e6)
+            << "}" << (hook + 1 < kHookCount ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+int runBenchmark(int argc, char* argv[]) {
+    TreeOptions options;
+    fs::path directory = fs::temp_directory_path();
+    std::string jsonPath = "file-io-benchmark.json";
+    int rounds = 3;
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "--dir" && hasValue) {
+            directory = argv[++i];
+        } else if (argument == "--files" && hasValue) {
+            options.smallFiles = std::max(100, std::atoi(argv[++i]));
+        } else if (argument == "--large-mb" && hasValue) {
+            options.largeFileMB = std::max(1, std::atoi(argv[++i]));
+        } else if (argument == "--depth" && hasValue) {
+            options.depth = std::max(1, std::atoi(argv[++i]));
+        } else if (argument == "--rounds" && hasValue) {
+            rounds = std::max(1, std::atoi(argv[++i]));
+        } else if (argument == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--dir PATH] [--files N] [--large-mb N]"
+                      << " [--depth N] [--rounds N] [--json PATH|-]" << std::endl;
+            return 1;
+        }
+    }
+    const bool jsonOnly = jsonPath == "-";
+    std::ostream& log = jsonOnly ? std::cerr : std::cout;
+
+    log << "========================================" << std::endl;
+    log << "Boxer File I/O Hook Benchmark" << std::endl;
+    log << "========================================" << std::endl;
+
+    const Tree tree = makeTree(directory, options);
+    const TreeCleanup cleanup(tree.root);
+    log << "\nTree: " << tree.root << std::endl;
+    log << "  " << tree.smallFiles.size() << " small files, " << tree.largeFiles.size() << " x "
+        << options.largeFileMB << " MiB, depth " << options.depth << ", "
+        << tree.directories.size() << " directories" << std::endl;
+
+    LocalDriveHarness drive(tree.root);
+    PassThroughDelegate delegate;
+    std::vector<WorkloadResult> results;
+    std::array<uint64_t, kHookCount> totalCalls{};
+    bool ok = true;
+
+    // Each round runs every workload in order, so create/rename/delete
+    // leave the tree as they found it
+    for (const auto& workload : makeWorkloads()) {
+        results.push_back(WorkloadResult{workload.name, workload.unit, 0, 0, 0, {}});
+    }
+    const auto workloads = makeWorkloads();
+    for (int round = 0; round < rounds; ++round) {
+        for (const bool hooked : {false, true}) {
+            delegate.calls = {};
+            g_boxer_delegate = hooked ? &delegate : nullptr;
+            for (size_t i = 0; i < workloads.size(); ++i) {
+                const auto before = delegate.calls;
+                uint64_t ops = 0;
+                const double rate = opsPerSecond(workloads[i], drive, tree, ops);
+                auto& result = results[i];
+                ok &= ops > 0 && (result.ops == 0 || result.ops == ops);
+                result.ops = ops;
+                double& best = hooked ? result.delegateOpsPerSecond : result.directOpsPerSecond;
+                best = std::max(best, rate);
+                if (hooked && round == 0) {
+                    for (size_t hook = 0; hook < kHookCount; ++hook) {
+                        result.hookCalls[hook] = delegate.calls[hook] - before[hook];
+                        totalCalls[hook] += result.hookCalls[hook];
+                    }
+                }
+            }
+        }
+    }
+    g_boxer_delegate = nullptr;
+
+    log << "\n  " << std::left << std::setw(20) << "workload" << std::right << std::setw(14) << "direct/s"
+        << std::setw(14) << "delegate/s" << std::setw(11) << "overhead" << "  unit" << std::endl;
+    log << std::fixed << std::setprecision(0);
+    for (const auto& result : results) {
+        const double overhead = (result.directOpsPerSecond / result.delegateOpsPerSecond - 1.0) * 100.0;
+        log << "  " << std::left << std::setw(20) << result.name << std::right
+            << std::setw(14) << result.directOpsPerSecond << std::setw(14) << result.delegateOpsPerSecond
+            << std::setw(10) << std::setprecision(1) << overhead << "%" << std::setprecision(0)
+            << "  " << result.unit << std::endl;
+    }
+
+    const auto costs = measureHooks(tree, rounds);
+    log << "\n  " << std::left << std::setw(9) << "id" << std::setw(30) << "hook" << std::right
+        << std::setw(10) << "calls" << std::setw(12) << "direct ns" << std::setw(12) << "hooked ns"
+        << std::setw(12) << "overhead" << std::endl;
+    log << std::setprecision(1);
+    for (size_t hook = 0; hook < kHookCount; ++hook) {
+        log << "  " << std::left << std::setw(9) << hookId(hook) << std::setw(30) << kHookNames[hook]
+            << std::right << std::setw(10) << totalCalls[hook] << std::setw(12) << costs[hook].directNs
+            << std::setw(12) << costs[hook].hookedNs << std::setw(12)
+            << costs[hook].hookedNs - costs[hook].directNs << std::endl;
+    }
+    log << "\n  Disk-touching hooks are timed against the same host call; differences of a few"
+        << "\n  ns are within noise and may be negative." << std::endl;
+
+    if (jsonOnly) {
+        writeJson(std::cout, options, tree, results, costs, totalCalls);
+    } else {
+        std::ofstream json(jsonPath);
+        writeJson(json, options, tree, results, costs, totalCalls);
+        log << "\nJSON written to " << jsonPath << std::endl;
+    }
+
+    if (!ok) {
+        std::cerr << "\n❌ A workload failed or changed its op count between runs" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Unwinding through runBenchmark() removes the tree
+    try {
+        return runBenchmark(argc, argv);
+    } catch (const std::exception& exception) {
+        std::cerr << "\n❌ " << exception.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,229 @@
+/*
+ * boxer_change_journal.h - Coalesced file change notifications
+ *
+ * INT-044 didCreateLocalFile and INT-045 didRemoveLocalFile fire on every
+ * file operation, on the emulation thread. An installer unpacking a few
+ * thousand files makes a few thousand host callbacks, each one reaching
+ * Boxer's save-game detection. The journal records the events instead and
+ * delivers them from its own thread as one compact batch per flush window.
+ *
+ * ARCHITECTURE:
+ *   - record() appends to the pending batch under one short lock; a path
+ *     already in the batch is updated in place (one entry per drive and
+ *     path per window)
+ *   - The entry keeps the path's last change, which is its state at the
+ *     end of the window: Created then Removed delivers Removed, and
+ *     Removed then Created delivers Created. Entries keep the order in
+ *     which their paths first appeared
+ *   - The window starts at the first event and is not extended by later
+ *     ones, so a long storm is still delivered every window
+ *   - A batch reaching maxEntries is delivered without waiting for the
+ *     window, which bounds memory
+ *   - flush() delivers everything pending and waits for the sink (drive
+ *     unmount, emulator shutdown); the destructor flushes too
+ *
+ * Entries carry the DOS_Drive pointer they were recorded with. Call
+ * flush() before a drive is destroyed, so no batch names a dead drive.
+ *
+ * THREAD SAFETY:
+ *   All methods are thread-safe. The sink runs on the journal's thread,
+ *   one batch at a time, with no lock held; it must not call flush().
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_CHANGE_JOURNAL_H
+#define BOXER_CHANGE_JOURNAL_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class DOS_Drive;
+
+// ============================================================================
+// BoxerChangeJournal
+// ============================================================================
+
+class BoxerChangeJournal {
+public:
+    enum class Change : uint8_t {
+        Created,   ///< didCreateLocalFile: the path exists and was written
+        Removed,   ///< didRemoveLocalFile: the path is gone
+    };
+
+    struct Entry {
+        DOS_Drive* drive;
+        std::string path;
+        Change change;     ///< Last change in the window
+        uint32_t events;   ///< Events coalesced into this entry
+    };
+
+    struct Batch {
+        std::vector<Entry> entries;
+        uint64_t events;   ///< Events recorded in the window
+    };
+
+    struct Stats {
+        uint64_t events;
+        uint64_t entriesDelivered;
+        uint64_t batches;
+    };
+
+    using Sink = std::function<void(const Batch&)>;
+
+    /// Long enough to absorb an installer's burst, short enough for UI
+    static constexpr uint32_t kDefaultWindowMs = 250;
+    static constexpr size_t kDefaultMaxEntries = 4096;
+
+    /**
+     * @param sink Receives each batch on the journal's thread; in Boxer it
+     *        forwards the batch to the main thread
+     * @param windowMs Flush window, measured from its first event
+     * @param maxEntries Batch size delivered without waiting for the window
+     */
+    explicit BoxerChangeJournal(Sink sink, uint32_t windowMs = kDefaultWindowMs,
+                                size_t maxEntries = kDefaultMaxEntries)
+        : m_sink(std::move(sink)),
+          m_window(windowMs),
+          m_maxEntries(maxEntries),
+          m_thread(&BoxerChangeJournal::run, this) {}
+
+    /// Delivers whatever is still pending
+    ~BoxerChangeJournal() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        m_thread.join();
+    }
+
+    BoxerChangeJournal(const BoxerChangeJournal&) = delete;
+    BoxerChangeJournal& operator=(const BoxerChangeJournal&) = delete;
+
+    /// INT-044 replacement for drive_local.cpp
+    void didCreateLocalFile(const char* path, DOS_Drive* drive) {
+        record(path, drive, Change::Created);
+    }
+
+    /// INT-045 replacement for drive_local.cpp
+    void didRemoveLocalFile(const char* path, DOS_Drive* drive) {
+        record(path, drive, Change::Removed);
+    }
+
+    void record(const char* path, DOS_Drive* drive, Change change) {
+        bool deliverNow = false;
+        bool startWindow = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.events;
+            ++m_pendingEvents;
+            auto& paths = m_index[drive];
+            const auto found = paths.find(path);
+            if (found != paths.end()) {
+                Entry& entry = m_pending[found->second];
+                entry.change = change;
+                ++entry.events;
+                return;
+            }
+            startWindow = m_pending.empty();
+            if (startWindow) {
+                m_deadline = std::chrono::steady_clock::now() + m_window;
+            }
+            paths.emplace(path, m_pending.size());
+            m_pending.push_back(Entry{drive, path, change, 1});
+            deliverNow = m_pending.size() >= m_maxEntries;
+            m_deliverNow |= deliverNow;
+        }
+        if (startWindow || deliverNow) {
+            m_wake.notify_one();
+        }
+    }
+
+    /// Deliver everything recorded so far and wait until the sink has it
+    void flush() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_deliverNow = true;
+        m_wake.notify_all();
+        m_idle.wait(lock, [this] { return m_pending.empty() && !m_delivering; });
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            if (!m_pending.empty() && (m_deliverNow || m_stopping ||
+                                       std::chrono::steady_clock::now() >= m_deadline)) {
+                deliverLocked(lock);
+                continue;
+            }
+            m_deliverNow = false;
+            m_idle.notify_all();
+            if (m_stopping) {
+                break;
+            }
+            if (m_pending.empty()) {
+                m_wake.wait(lock);
+            } else {
+                m_wake.wait_until(lock, m_deadline);
+            }
+        }
+    }
+
+    void deliverLocked(std::unique_lock<std::mutex>& lock) {
+        Batch batch;
+        batch.entries.swap(m_pending);
+        batch.events = m_pendingEvents;
+        m_pendingEvents = 0;
+        m_index.clear();
+        m_deliverNow = false;
+        m_delivering = true;
+        ++m_stats.batches;
+        m_stats.entriesDelivered += batch.entries.size();
+        lock.unlock();
+        m_sink(batch);
+        lock.lock();
+        m_delivering = false;
+    }
+
+    // Path to its entry's index in m_pending
+    using PathIndex = std::unordered_map<std::string, size_t>;
+
+    const Sink m_sink;
+    const std::chrono::milliseconds m_window;
+    const size_t m_maxEntries;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::vector<Entry> m_pending;
+    std::unordered_map<DOS_Drive*, PathIndex> m_index;
+    uint64_t m_pendingEvents = 0;
+    std::chrono::steady_clock::time_point m_deadline;
+    bool m_deliverNow = false;
+    bool m_delivering = false;
+    bool m_stopping = false;
+    Stats m_stats{};
+
+    std::thread m_thread;   // last: starts after everything above exists
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_CHANGE_JOURNAL_H
@@ -0,0 +1,267 @@
+/*
+ * boxer_directory_cache.h - Directory snapshot cache for Boxer integration
+ *
+ * Replaces per-entry directory enumeration through INT-054
+ * openLocalDirectory, INT-056 getNextDirectoryEntry and INT-055
+ * closeLocalDirectory with one bulk read per directory.
+ *
+ * ARCHITECTURE:
+ *   - The first FindFirst on a directory reads it in one call into an
+ *     immutable snapshot; drive_cache.cpp walks the snapshot directly
+ *   - Later enumerations of the same directory reuse the snapshot until it
+ *     is invalidated by the emulator's own file operations or, on Linux,
+ *     by inotify
+ *   - Snapshots are reference counted, so a search in progress keeps its
+ *     listing even if the directory is invalidated or evicted meanwhile
+ *   - Least recently used directories are evicted beyond the capacity
+ *
+ * Without a watcher (non-Linux hosts, or inotify unavailable) host-side
+ * changes are only seen after invalidate(), the same staleness DOSBox's own
+ * drive cache has until RESCAN. On macOS Boxer's FSEvents stream calls
+ * invalidate() instead.
+ *
+ * THREAD SAFETY:
+ *   All methods are thread-safe. acquire() holds the cache lock while a
+ *   directory is being read.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_DIRECTORY_CACHE_H
+#define BOXER_DIRECTORY_CACHE_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "boxer_directory_watcher.h"
+
+// ============================================================================
+// BoxerDirectorySnapshotCache
+// ============================================================================
+
+class BoxerDirectorySnapshotCache {
+public:
+    struct Entry {
+        std::string name;
+        bool isDirectory;
+    };
+
+    using Snapshot = std::vector<Entry>;
+    using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t invalidations;
+        uint64_t evictions;
+    };
+
+    /// Directories kept; a large game tree rarely has more active at once
+    static constexpr size_t kDefaultCapacity = 256;
+
+    static BoxerDirectorySnapshotCache& shared() {
+        static BoxerDirectorySnapshotCache cache;
+        return cache;
+    }
+
+    /**
+     * @param capacity Maximum number of cached directories
+     * @param watch Use inotify for host-side changes where available
+     */
+    explicit BoxerDirectorySnapshotCache(size_t capacity = kDefaultCapacity, bool watch = true)
+        : m_capacity(std::max<size_t>(capacity, 1)),
+          m_watcher(watch, BoxerDirectoryWatcher::kEntryEvents) {}
+
+    BoxerDirectorySnapshotCache(const BoxerDirectorySnapshotCache&) = delete;
+    BoxerDirectorySnapshotCache& operator=(const BoxerDirectorySnapshotCache&) = delete;
+
+    /**
+     * @brief Snapshot of a directory, reading it on a miss
+     * @param path Host directory path
+     * @param loader Callable `bool(const std::string& path, Snapshot& out)`
+     *        that fills the whole listing in one call
+     * @return Snapshot, or nullptr if the loader failed
+     */
+    template <typename Loader>
+    SnapshotPtr acquire(const std::string& path, Loader&& loader) {
+        const std::string key = normalize(path);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        drainWatcherLocked();
+
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+            ++m_stats.hits;
+            return it->second.snapshot;
+        }
+        ++m_stats.misses;
+
+        // Watch before reading so a change during the read is not lost
+        const bool watched = m_watcher.watch(key);
+        auto snapshot = std::make_shared<Snapshot>();
+        if (!loader(key, *snapshot)) {
+            if (watched) {
+                m_watcher.unwatch(key);
+            }
+            return nullptr;
+        }
+
+        m_lru.push_front(key);
+        m_entries.emplace(key, Node{snapshot, m_lru.begin(), watched});
+        while (m_entries.size() > m_capacity) {
+            eraseLocked(m_lru.back());
+            ++m_stats.evictions;
+        }
+        return snapshot;
+    }
+
+    /// Snapshot using readDirectory() as the loader
+    SnapshotPtr acquire(const std::string& path) {
+        return acquire(path, &BoxerDirectorySnapshotCache::readDirectory);
+    }
+
+    /**
+     * @brief Drop a directory's snapshot
+     *
+     * Called for the parent directory after the emulator creates, removes
+     * or renames an entry, and by host-side watchers.
+     */
+    void invalidate(const std::string& path) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (eraseLocked(normalize(path))) {
+            ++m_stats.invalidations;
+        }
+    }
+
+    /// Drop every snapshot (drive unmount, RESCAN)
+    void invalidateAll() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.invalidations += m_entries.size();
+        while (!m_lru.empty()) {
+            eraseLocked(m_lru.back());
+        }
+    }
+
+    /**
+     * @brief Apply pending inotify events without waiting for acquire()
+     * @return Number of snapshots invalidated
+     */
+    size_t processChanges() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return drainWatcherLocked();
+    }
+
+    /// Whether host-side changes are detected automatically
+    bool isWatching() const { return m_watcher.isActive(); }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+    /**
+     * @brief Default loader: one readdir() pass
+     *
+     * Keeps "." and "..", as getNextDirectoryEntry does. Entry types the
+     * filesystem does not report are resolved with stat().
+     */
+    static bool readDirectory(const std::string& path, Snapshot& out) {
+        DIR* dir = opendir(path.c_str());
+        if (!dir) {
+            return false;
+        }
+        while (const dirent* entry = readdir(dir)) {
+            bool isDirectory = false;
+#ifdef DT_DIR
+            if (entry->d_type != DT_UNKNOWN && entry->d_type != DT_LNK) {
+                isDirectory = entry->d_type == DT_DIR;
+            } else
+#endif
+            {
+                struct stat status;
+                const std::string full = path + "/" + entry->d_name;
+                isDirectory = stat(full.c_str(), &status) == 0 && S_ISDIR(status.st_mode);
+            }
+            out.push_back(Entry{entry->d_name, isDirectory});
+        }
+        closedir(dir);
+        return true;
+    }
+
+private:
+    struct Node {
+        SnapshotPtr snapshot;
+        std::list<std::string>::iterator lruPosition;
+        bool watched;
+    };
+
+    static std::string normalize(const std::string& path) {
+        std::string key = path;
+        while (key.size() > 1 && key.back() == '/') {
+            key.pop_back();
+        }
+        return key;
+    }
+
+    bool eraseLocked(const std::string& key) {
+        auto it = m_entries.find(key);
+        if (it == m_entries.end()) {
+            return false;
+        }
+        if (it->second.watched) {
+            m_watcher.unwatch(key);
+        }
+        m_lru.erase(it->second.lruPosition);
+        m_entries.erase(it);
+        return true;
+    }
+
+    size_t drainWatcherLocked() {
+        size_t invalidated = 0;
+        m_watcher.drain([this, &invalidated](BoxerDirectoryWatcher::Change change,
+                                             const std::string& directory, std::string_view, bool) {
+            if (change == BoxerDirectoryWatcher::Change::Overflow) {
+                // Events were lost; nothing cached can be trusted
+                invalidated += m_entries.size();
+                while (!m_lru.empty()) {
+                    eraseLocked(m_lru.back());
+                }
+            } else if (eraseLocked(directory)) {
+                ++invalidated;
+            }
+        });
+        m_stats.invalidations += invalidated;
+        return invalidated;
+    }
+
+    const size_t m_capacity;
+    BoxerDirectoryWatcher m_watcher;
+
+    mutable std::mutex m_mutex;
+    std::list<std::string> m_lru;
+    std::unordered_map<std::string, Node> m_entries;
+    Stats m_stats{};
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_DIRECTORY_CACHE_H
@@ -0,0 +1,210 @@
+/*
+ * boxer_directory_watcher.h - Host directory change notification
+ *
+ * Shared by the local drive caches (directory snapshots, path stats) to
+ * learn about changes made outside the emulator.
+ *
+ * ARCHITECTURE:
+ *   - Linux: one non-blocking inotify descriptor; directories are watched
+ *     with a reference count, so several cached entries can share a watch
+ *   - Pending events are drained on demand by the owning cache; there is
+ *     no background thread
+ *   - Other hosts: every call is a no-op and isActive() is false. Boxer's
+ *     FSEvents stream invalidates the caches directly on macOS.
+ *
+ * THREAD SAFETY:
+ *   Not synchronized. Each owner calls it under its own lock.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_DIRECTORY_WATCHER_H
+#define BOXER_DIRECTORY_WATCHER_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+// ============================================================================
+// BoxerDirectoryWatcher
+// ============================================================================
+
+class BoxerDirectoryWatcher {
+public:
+    enum class Change : uint8_t {
+        Entry,     ///< An entry inside the directory changed (name is set)
+        Self,      ///< The directory itself was deleted or moved
+        Overflow,  ///< Events were lost; the owner must drop everything
+    };
+
+    /// Entry changes reported: created, deleted, renamed, attributes
+    static constexpr uint32_t kEntryEvents =
+#ifdef __linux__
+        IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB;
+#else
+        0;
+#endif
+
+    /// kEntryEvents plus content changes (size, modification time)
+    static constexpr uint32_t kContentEvents =
+#ifdef __linux__
+        kEntryEvents | IN_MODIFY | IN_CLOSE_WRITE;
+#else
+        0;
+#endif
+
+    /**
+     * @param enabled Create the host watcher (ignored where unsupported)
+     * @param events Entry events to report, kEntryEvents or kContentEvents
+     */
+    explicit BoxerDirectoryWatcher(bool enabled = true, uint32_t events = kEntryEvents)
+        : m_events(events) {
+#ifdef __linux__
+        if (enabled) {
+            m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        }
+#else
+        (void)enabled;
+#endif
+    }
+
+    ~BoxerDirectoryWatcher() {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+
+    BoxerDirectoryWatcher(const BoxerDirectoryWatcher&) = delete;
+    BoxerDirectoryWatcher& operator=(const BoxerDirectoryWatcher&) = delete;
+
+    /// Whether host changes are being reported at all
+    bool isActive() const { return m_fd >= 0; }
+
+    /**
+     * @brief Add a reference to a directory watch
+     * @return true if the directory is now watched
+     */
+    bool watch(const std::string& directory) {
+#ifdef __linux__
+        if (m_fd < 0) {
+            return false;
+        }
+        auto it = m_byPath.find(directory);
+        if (it != m_byPath.end()) {
+            ++it->second.references;
+            return true;
+        }
+        const int wd = inotify_add_watch(m_fd, directory.c_str(),
+                                         m_events | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+        if (wd < 0) {
+            return false;
+        }
+        m_byPath.emplace(directory, Watch{wd, 1});
+        // Two paths to the same inode (symlinks) share a descriptor
+        m_byDescriptor[wd].push_back(directory);
+        return true;
+#else
+        (void)directory;
+        return false;
+#endif
+    }
+
+    /// Drop a reference taken by a successful watch()
+    void unwatch(const std::string& directory) {
+#ifdef __linux__
+        auto it = m_byPath.find(directory);
+        if (it == m_byPath.end() || --it->second.references > 0) {
+            return;
+        }
+        const int wd = it->second.descriptor;
+        m_byPath.erase(it);
+        auto& paths = m_byDescriptor[wd];
+        paths.erase(std::remove(paths.begin(), paths.end(), directory), paths.end());
+        if (paths.empty()) {
+            m_byDescriptor.erase(wd);
+            inotify_rm_watch(m_fd, wd);
+        }
+#else
+        (void)directory;
+#endif
+    }
+
+    /**
+     * @brief Report pending changes without blocking
+     * @param handler Callable `void(Change, const std::string& directory,
+     *        std::string_view name, bool isDirectory)`; it may call unwatch()
+     * @return Number of changes reported
+     */
+    template <typename Handler>
+    size_t drain(Handler&& handler) {
+        size_t reported = 0;
+#ifdef __linux__
+        if (m_fd < 0) {
+            return 0;
+        }
+        alignas(inotify_event) char buffer[4096];
+        for (;;) {
+            const ssize_t length = ::read(m_fd, buffer, sizeof(buffer));
+            if (length <= 0) {
+                break;
+            }
+            for (ssize_t offset = 0; offset < length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    handler(Change::Overflow, std::string(), std::string_view(), false);
+                    ++reported;
+                    continue;
+                }
+                auto it = m_byDescriptor.find(event->wd);
+                if (it == m_byDescriptor.end()) {
+                    continue;
+                }
+                const Change change = (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+                                          ? Change::Self : Change::Entry;
+                const std::string_view name = event->len ? std::string_view(event->name)
+                                                         : std::string_view();
+                const bool isDirectory = (event->mask & IN_ISDIR) != 0;
+                // Copy: the handler may unwatch and invalidate the list
+                const std::vector<std::string> directories = it->second;
+                for (const auto& directory : directories) {
+                    handler(change, directory, name, isDirectory);
+                    ++reported;
+                }
+            }
+        }
+#else
+        (void)handler;
+#endif
+        return reported;
+    }
+
+private:
+    struct Watch {
+        int descriptor;
+        size_t references;
+    };
+
+    uint32_t m_events;
+    int m_fd = -1;
+    std::unordered_map<std::string, Watch> m_byPath;
+    std::unordered_map<int, std::vector<std::string>> m_byDescriptor;
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_DIRECTORY_WATCHER_H
@@ -0,0 +1,714 @@
+/*
+ * boxer_file_handle.h - Local file backends for DOS file handles
+ *
+ * INT-046 openLocalFile hands DOSBox a FILE*, so every DOS read of a large
+ * read-only data file (FMV, audio banks, disk images) goes through stdio:
+ * a read() into the stdio buffer and a second copy out of it. This handle
+ * keeps the hook as the only way files are opened, but serves reads of
+ * read-only regular files straight from a memory mapping.
+ *
+ * ARCHITECTURE:
+ *   - Mapped backend: the hook's descriptor is mapped PROT_READ once at
+ *     open; reads are a single memcpy from the mapping
+ *   - Access hints: MADV_SEQUENTIAL until the first non-contiguous read,
+ *     then MADV_NORMAL (disk images and level data seek around)
+ *   - Stdio backend: writable modes, non-regular files (pipes, devices),
+ *     small files and mapping failures keep the FILE* path
+ *   - Stdio readahead: once kSequentialReads reads in a row have started
+ *     where the previous one ended, reads are served from a per-handle
+ *     buffer refilled in windows that double from kInitialReadahead to
+ *     kMaxReadahead. Each refill hints the kernel to prefetch the following
+ *     window (posix_fadvise, F_RDADVISE on macOS), so the disk works while
+ *     DOS consumes the current one. A read anywhere else drops back to
+ *     plain stdio reads
+ *   - Write-behind backend (optional, writable regular files): writes are
+ *     gathered and written by a background thread, see
+ *     boxer_write_behind.h; reads and seeks then use the descriptor
+ *   - Promotion (optional): an update-mode handle can start on a read-only
+ *     stream and switch to a writable one at its first write, truncation
+ *     or write-behind switch, so a copy-on-write drive copies a file up
+ *     only when it is really changed (boxer_overlay_drive.h)
+ *
+ * A readahead buffer, like the stdio buffer it stands in for, is not
+ * refreshed when another process writes the file. Writes, seeks and
+ * truncation through the same handle discard it, and so do writes and
+ * truncation through any other handle on the same file (see below); a
+ * handle writing a file that others have open hands each write to the host
+ * file at once, so their next read sees it.
+ *
+ * The mapping covers the file as it was at open. Reads past that size
+ * return short, as if the file had not grown. Reading a page the file no
+ * longer has faults (SIGBUS), so handles are registered by device and
+ * inode: when the emulator truncates a file, through a "w" open (FileCreate)
+ * or a zero-length write on another handle, every mapped handle on that
+ * file drops back to stdio first. Files on mounted drives must still not be
+ * truncated by another process while they are open.
+ *
+ * THREAD SAFETY:
+ *   A handle belongs to one DOS file and is not synchronized. The registry
+ *   of open files is locked, but a truncation changes the other handles on
+ *   the same file, so those must all be used from one thread (DOSBox's
+ *   emulation thread).
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_FILE_HANDLE_H
+#define BOXER_FILE_HANDLE_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "boxer_write_behind.h"
+
+// ============================================================================
+// BoxerFileHandle
+// ============================================================================
+
+class BoxerFileHandle {
+public:
+    enum class Backend : uint8_t {
+        Mapped,   ///< Reads served from a read-only memory mapping
+        Stdio,    ///< Reads and writes through the FILE* from the hook
+        WriteBehind,  ///< Writes queued to a background flusher
+    };
+
+    /// Writable stream replacing the read-only one at the first change
+    using Promoter = std::function<FILE*()>;
+
+    /// Smaller files gain nothing from a mapping over one stdio buffer fill
+    static constexpr uint64_t kDefaultMapThreshold = 256 * 1024;
+
+    /// Reads in a row starting where the last ended that make a stream
+    static constexpr uint32_t kSequentialReads = 2;
+    static constexpr size_t kInitialReadahead = 64 * 1024;
+    static constexpr size_t kMaxReadahead = 1024 * 1024;
+
+    /**
+     * @brief INT-046 replacement for drive_local.cpp
+     * @param path Host filesystem path
+     * @param mode fopen() mode requested by DOSBox
+     * @param opener Callable `FILE*(const char* path, const char* mode)`,
+     *        the delegate hook
+     * @param mapThreshold Read-only regular files at least this large are
+     *        mapped
+     * @return Handle, or nullptr (with errno set) if the hook failed
+     */
+    template <typename Opener>
+    static std::unique_ptr<BoxerFileHandle> open(const char* path, const char* mode, Opener&& opener,
+                                                 uint64_t mapThreshold = kDefaultMapThreshold) {
+        FILE* stream = opener(path, mode);
+        if (!stream) {
+            return nullptr;
+        }
+        std::unique_ptr<BoxerFileHandle> handle(new BoxerFileHandle(stream));
+        handle->m_appendMode = mode && mode[0] == 'a';
+        struct stat status;
+        if (fstat(fileno(stream), &status) != 0 || !S_ISREG(status.st_mode)) {
+            return handle;
+        }
+        handle->registerOpenFile(status);
+        if (mode && mode[0] == 'w') {
+            // fopen() has already cut the file; no other handle may read the old pages
+            handle->fileTruncated();
+        }
+        if (isReadOnlyMode(mode)) {
+            handle->tryMap(status, mapThreshold);
+        }
+        return handle;
+    }
+
+    /// Open with plain fopen() as the hook
+    static std::unique_ptr<BoxerFileHandle> open(const char* path, const char* mode) {
+        return open(path, mode, &BoxerFileHandle::hostOpen);
+    }
+
+    ~BoxerFileHandle() {
+        unregisterOpenFile();
+        // The flusher owns a duplicate descriptor, so the stream can close now
+        m_writeBehind.reset();
+        if (m_mapping) {
+            munmap(m_mapping, static_cast<size_t>(m_size));
+        }
+        std::fclose(m_stream);
+    }
+
+    BoxerFileHandle(const BoxerFileHandle&) = delete;
+    BoxerFileHandle& operator=(const BoxerFileHandle&) = delete;
+
+    /**
+     * @brief Read at the current position
+     * @return Bytes read; short at end of file
+     */
+    size_t read(void* buffer, size_t length) {
+        if (m_writeBehind) {
+            if (!m_writeBehind->drain()) {
+                return 0;
+            }
+            const ssize_t count = pread(m_writeBehind->descriptor(), buffer, length,
+                                        static_cast<off_t>(m_position));
+            if (count <= 0) {
+                return 0;
+            }
+            m_position += static_cast<uint64_t>(count);
+            return static_cast<size_t>(count);
+        }
+        if (!m_mapping) {
+            return readStdio(static_cast<uint8_t*>(buffer), length);
+        }
+        if (m_position >= m_size) {
+            return 0;
+        }
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(length, m_size - m_position));
+        if (m_position != m_lastReadEnd && m_sequential) {
+            // The first jump means this is not a stream; stop aggressive readahead
+            advise(MADV_NORMAL);
+            m_sequential = false;
+        }
+        std::memcpy(buffer, m_mapping + m_position, count);
+        m_position += count;
+        m_lastReadEnd = m_position;
+        return count;
+    }
+
+    /**
+     * @brief Write at the current position
+     * @return Bytes written; 0 with errno EBADF on a mapped (read-only) handle
+     */
+    size_t write(const void* buffer, size_t length) {
+        if (!promoteForWriting()) {
+            return 0;
+        }
+        if (m_mapping) {
+            errno = EBADF;
+            return 0;
+        }
+        if (m_writeBehind) {
+            if (!m_writeBehind->write(buffer, length, m_position) ||
+                (fileWritten() && !m_writeBehind->drain())) {
+                return 0;
+            }
+            m_position += length;
+            m_size = std::max(m_size, m_position);
+            return length;
+        }
+        releaseReadBuffer();
+        switchStdioDirection(true);
+        const size_t count = std::fwrite(buffer, 1, length, m_stream);
+        m_position = m_appendMode ? currentStreamPosition() : m_position + count;
+        if (count > 0 && fileWritten()) {
+            std::fflush(m_stream);
+        }
+        return count;
+    }
+
+    /**
+     * @brief Move the file position (SEEK_SET, SEEK_CUR or SEEK_END)
+     *
+     * As in DOS, seeking past the end of the file is allowed.
+     *
+     * @param[out] outPosition New position, if non-null
+     * @return false (errno EINVAL) if the result would be negative
+     */
+    bool seek(int64_t offset, int whence, uint64_t* outPosition = nullptr) {
+        if (!m_mapping && !m_writeBehind) {
+            releaseReadBuffer();
+            if (fseeko(m_stream, static_cast<off_t>(offset), whence) != 0) {
+                return false;
+            }
+            m_lastWasWrite = false;
+            m_stdioDirectionKnown = false;
+            // Position queries (AX=4201h, offset 0) keep a stream sequential
+            m_position = currentStreamPosition();
+            if (outPosition) {
+                *outPosition = m_position;
+            }
+            return true;
+        }
+
+        int64_t base = 0;
+        switch (whence) {
+            case SEEK_SET: base = 0; break;
+            case SEEK_CUR: base = static_cast<int64_t>(m_position); break;
+            case SEEK_END: base = static_cast<int64_t>(m_size); break;
+            default: errno = EINVAL; return false;
+        }
+        if (offset < -base) {
+            errno = EINVAL;
+            return false;
+        }
+        m_position = static_cast<uint64_t>(base + offset);
+        if (outPosition) {
+            *outPosition = m_position;
+        }
+        return true;
+    }
+
+    uint64_t position() const { return m_position; }
+
+    /// Current size; for a mapped handle, the size at open
+    uint64_t size() const {
+        if (m_mapping || m_writeBehind) {
+            return m_size;
+        }
+        if (m_lastWasWrite) {
+            std::fflush(m_stream);
+        }
+        struct stat status;
+        return fstat(fileno(m_stream), &status) == 0 ? static_cast<uint64_t>(status.st_size) : 0;
+    }
+
+    /// Hand buffered data on towards the host file without waiting
+    bool flush() {
+        if (m_writeBehind) {
+            m_writeBehind->flush();
+            return true;
+        }
+        releaseReadBuffer();
+        return m_mapping || std::fflush(m_stream) == 0;
+    }
+
+    /// INT 21h AH=68h: everything written so far is on disk on return
+    bool commit() {
+        if (m_mapping) {
+            return true;
+        }
+        if (m_writeBehind) {
+            return m_writeBehind->commit();
+        }
+        return std::fflush(m_stream) == 0 && fsync(fileno(m_stream)) == 0;
+    }
+
+    /**
+     * @brief DOS handle close: remaining writes reach the host file before
+     *        this returns
+     * @return false (errno set) if a buffered write failed
+     */
+    bool close() {
+        if (m_writeBehind) {
+            return m_writeBehind->close();
+        }
+        releaseReadBuffer();
+        return m_mapping || std::fflush(m_stream) == 0;
+    }
+
+    /// DOS zero-length write: cut the file at the current position
+    bool truncate() {
+        if (!promoteForWriting()) {
+            return false;
+        }
+        if (m_mapping) {
+            errno = EBADF;
+            return false;
+        }
+        if (m_writeBehind) {
+            if (!m_writeBehind->drain()) {
+                return false;
+            }
+            fileTruncated();
+            if (ftruncate(m_writeBehind->descriptor(), static_cast<off_t>(m_position)) != 0) {
+                return false;
+            }
+            m_size = m_position;
+            return true;
+        }
+        releaseReadBuffer();
+        if (std::fflush(m_stream) != 0) {
+            return false;
+        }
+        fileTruncated();
+        return ftruncate(fileno(m_stream), static_cast<off_t>(m_position)) == 0;
+    }
+
+    /**
+     * @brief Switch a writable stdio handle to write-behind
+     * @param flusher Background writer shared by all handles
+     * @return false if the handle is mapped, in append mode (stdio keeps
+     *         the append-at-end guarantee) or not a regular file
+     */
+    bool enableWriteBehind(BoxerWriteBehind& flusher,
+                           size_t bufferSize = BoxerWriteBehindFile::kDefaultBufferSize) {
+        if (m_writeBehind) {
+            return true;
+        }
+        if (!promoteForWriting()) {
+            return false;
+        }
+        releaseReadBuffer();
+        struct stat status;
+        if (m_mapping || m_appendMode || std::fflush(m_stream) != 0 ||
+            fstat(fileno(m_stream), &status) != 0 || !S_ISREG(status.st_mode)) {
+            return false;
+        }
+        const off_t start = ftello(m_stream);
+        const int descriptor = dup(fileno(m_stream));
+        if (start < 0 || descriptor < 0) {
+            return false;
+        }
+        m_position = static_cast<uint64_t>(start);
+        m_size = static_cast<uint64_t>(status.st_size);
+        m_writeBehind = std::make_unique<BoxerWriteBehindFile>(flusher, descriptor, bufferSize);
+        return true;
+    }
+
+    /**
+     * @brief Defer the writable stream until the handle first changes the file
+     *
+     * Until then reads come from the stream the handle was opened with.
+     * The first write, truncation or enableWriteBehind() calls `promoter`,
+     * closes the current stream and continues on the returned one at the
+     * same position. If `promoter` returns nullptr (errno set), that call
+     * fails and the next one tries again.
+     */
+    void promoteOnWrite(Promoter promoter) { m_promoter = std::move(promoter); }
+
+    /// True until a promoter set with promoteOnWrite() has run
+    bool awaitingPromotion() const { return static_cast<bool>(m_promoter); }
+
+    Backend backend() const {
+        return m_mapping ? Backend::Mapped : m_writeBehind ? Backend::WriteBehind : Backend::Stdio;
+    }
+
+    /**
+     * @brief Turn stdio readahead on or off (on by default)
+     *
+     * Off suits files another process writes while DOS reads them.
+     */
+    void setReadahead(bool enabled) {
+        m_readaheadEnabled = enabled;
+        if (!enabled) {
+            endSequentialRun();
+        }
+    }
+
+    /// Current stdio readahead window in bytes; 0 while not streaming
+    size_t readaheadWindow() const { return m_window; }
+
+    /**
+     * @brief Whole file contents for zero-copy readers (CD images), or nullptr
+     *
+     * Becomes nullptr if the emulator truncates the file through another
+     * handle; do not keep the pointer across DOS file operations.
+     */
+    const uint8_t* mappedData() const { return m_mapping; }
+
+    /// Underlying stream, for locking and other descriptor-level calls
+    FILE* stream() const { return m_stream; }
+
+    /// Default hook: plain fopen()
+    static FILE* hostOpen(const char* path, const char* mode) {
+        return std::fopen(path, mode);
+    }
+
+    /// True for fopen() modes that cannot write: "r", "rb", never "+", "w" or "a"
+    static bool isReadOnlyMode(const char* mode) {
+        return mode && mode[0] == 'r' && !std::strchr(mode, '+');
+    }
+
+private:
+    explicit BoxerFileHandle(FILE* stream) : m_stream(stream) {
+        // Continue from wherever the hook left the stream
+        m_position = m_lastReadEnd = currentStreamPosition();
+    }
+
+    void tryMap(const struct stat& status, uint64_t threshold) {
+        const int descriptor = fileno(m_stream);
+        const uint64_t size = static_cast<uint64_t>(status.st_size);
+        if (size == 0 || size < threshold || size > SIZE_MAX) {
+            return;
+        }
+        void* mapping = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapping == MAP_FAILED) {
+            return;
+        }
+        m_mapping = static_cast<uint8_t*>(mapping);
+        m_size = size;
+        advise(MADV_SEQUENTIAL);
+    }
+
+    // ========================================================================
+    // Open file registry
+    // ========================================================================
+
+    using FileKey = std::pair<dev_t, ino_t>;
+
+    struct OpenFiles {
+        std::mutex mutex;
+        std::map<FileKey, std::vector<BoxerFileHandle*>> handles;
+    };
+
+    static OpenFiles& openFiles() {
+        static OpenFiles files;
+        return files;
+    }
+
+    void registerOpenFile(const struct stat& status) {
+        m_fileKey = FileKey(status.st_dev, status.st_ino);
+        m_registered = true;
+        OpenFiles& files = openFiles();
+        std::lock_guard<std::mutex> lock(files.mutex);
+        files.handles[m_fileKey].push_back(this);
+    }
+
+    void unregisterOpenFile() {
+        if (!m_registered) {
+            return;
+        }
+        OpenFiles& files = openFiles();
+        std::lock_guard<std::mutex> lock(files.mutex);
+        auto entry = files.handles.find(m_fileKey);
+        auto& handles = entry->second;
+        handles.erase(std::find(handles.begin(), handles.end(), this));
+        if (handles.empty()) {
+            files.handles.erase(entry);
+        }
+        m_registered = false;
+    }
+
+    // This handle is about to cut (or has just cut) the file
+    void fileTruncated() {
+        forOtherHandles([](BoxerFileHandle& handle) {
+            handle.dropMapping();
+            handle.dropReadBuffers();
+        });
+    }
+
+    // This handle wrote the file; true if other handles have it open and
+    // the write must reach the host file before they read again
+    bool fileWritten() {
+        return forOtherHandles([](BoxerFileHandle& handle) { handle.dropReadBuffers(); });
+    }
+
+    template <typename Action>
+    bool forOtherHandles(Action&& action) {
+        if (!m_registered) {
+            return false;
+        }
+        OpenFiles& files = openFiles();
+        std::lock_guard<std::mutex> lock(files.mutex);
+        const auto& handles = files.handles[m_fileKey];
+        for (BoxerFileHandle* handle : handles) {
+            if (handle != this) {
+                action(*handle);
+            }
+        }
+        return handles.size() > 1;
+    }
+
+    // Another handle changed the file: forget the readahead buffer and the
+    // stdio buffer behind it, but keep the readahead run going
+    void dropReadBuffers() {
+        if (m_mapping || m_writeBehind) {
+            return;
+        }
+        m_bufferLength = 0;
+        fseeko(m_stream, static_cast<off_t>(m_position), SEEK_SET);
+        m_lastWasWrite = false;
+        m_stdioDirectionKnown = false;
+    }
+
+    // Continue on stdio from the same position
+    void dropMapping() {
+        if (!m_mapping) {
+            return;
+        }
+        munmap(m_mapping, static_cast<size_t>(m_size));
+        m_mapping = nullptr;
+        fseeko(m_stream, static_cast<off_t>(m_position), SEEK_SET);
+        m_lastReadEnd = m_position;
+        m_lastWasWrite = false;
+        m_stdioDirectionKnown = false;
+    }
+
+    bool promoteForWriting() {
+        if (!m_promoter) {
+            return true;
+        }
+        FILE* stream = m_promoter();
+        if (!stream) {
+            return false;
+        }
+        m_promoter = nullptr;
+        endSequentialRun();
+        unregisterOpenFile();
+        std::fclose(m_stream);
+        m_stream = stream;
+        fseeko(m_stream, static_cast<off_t>(m_position), SEEK_SET);
+        m_lastWasWrite = false;
+        m_stdioDirectionKnown = false;
+        struct stat status;
+        if (fstat(fileno(m_stream), &status) == 0 && S_ISREG(status.st_mode)) {
+            registerOpenFile(status);
+        }
+        return true;
+    }
+
+    void advise(int advice) {
+        madvise(m_mapping, static_cast<size_t>(m_size), advice);
+    }
+
+    uint64_t currentStreamPosition() const {
+        const off_t position = ftello(m_stream);
+        return position > 0 ? static_cast<uint64_t>(position) : 0;
+    }
+
+    size_t readStdio(uint8_t* buffer, size_t length) {
+        if (m_position != m_lastReadEnd) {
+            // This read may be the first of a new stream
+            endSequentialRun();
+            m_contiguousReads = 1;
+        } else if (m_readaheadEnabled && m_window == 0 && ++m_contiguousReads >= kSequentialReads) {
+            beginSequentialRun();
+        }
+
+        // Serve what the readahead buffer already holds
+        size_t done = 0;
+        if (m_bufferLength > 0) {
+            done = std::min<size_t>(length, m_bufferStart + m_bufferLength - m_position);
+            std::memcpy(buffer, m_readBuffer.data() + (m_position - m_bufferStart), done);
+            m_position += done;
+        }
+
+        while (done < length) {
+            releaseReadBuffer();
+            switchStdioDirection(false);
+            size_t count;
+            if (m_window == 0 || length - done >= m_window) {
+                // Not streaming, or a read large enough to need no buffer
+                count = std::fread(buffer + done, 1, length - done, m_stream);
+                m_position += count;
+                done += count;
+            } else {
+                count = refillReadBuffer();
+                const size_t copied = std::min(count, length - done);
+                std::memcpy(buffer + done, m_readBuffer.data(), copied);
+                m_position += copied;
+                done += copied;
+            }
+            if (count == 0) {
+                break;
+            }
+        }
+        m_lastReadEnd = m_position;
+        return done;
+    }
+
+    void beginSequentialRun() {
+        m_window = kInitialReadahead;
+        adviseDescriptor(true);
+    }
+
+    void endSequentialRun() {
+        releaseReadBuffer();
+        if (m_window != 0) {
+            adviseDescriptor(false);
+        }
+        m_window = 0;
+        m_contiguousReads = 0;
+    }
+
+    // Fill the buffer with one window at m_position; the stream is there
+    size_t refillReadBuffer() {
+        if (m_readBuffer.size() < m_window) {
+            m_readBuffer.resize(m_window);
+        }
+        const size_t count = std::fread(m_readBuffer.data(), 1, m_window, m_stream);
+        m_bufferStart = m_position;
+        m_bufferLength = count;
+        if (count == m_window) {
+            m_window = std::min(m_window * 2, kMaxReadahead);
+            prefetch(m_position + count, m_window);
+        }
+        return count;
+    }
+
+    // Put the stream back at the logical position before any other use
+    void releaseReadBuffer() {
+        if (m_bufferLength == 0) {
+            return;
+        }
+        if (m_position != m_bufferStart + m_bufferLength) {
+            fseeko(m_stream, static_cast<off_t>(m_position), SEEK_SET);
+            m_stdioDirectionKnown = false;
+        }
+        m_bufferLength = 0;
+    }
+
+    void adviseDescriptor(bool sequential) {
+#if defined(__APPLE__)
+        fcntl(fileno(m_stream), F_RDAHEAD, sequential ? 1 : 0);
+#elif defined(POSIX_FADV_SEQUENTIAL)
+        posix_fadvise(fileno(m_stream), 0, 0, sequential ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_NORMAL);
+#else
+        (void)sequential;
+#endif
+    }
+
+    // Ask the kernel to start reading the next window in the background
+    void prefetch(uint64_t offset, size_t length) {
+#if defined(__APPLE__)
+        struct radvisory advice;
+        advice.ra_offset = static_cast<off_t>(offset);
+        advice.ra_count = static_cast<int>(length);
+        fcntl(fileno(m_stream), F_RDADVISE, &advice);
+#elif defined(POSIX_FADV_WILLNEED)
+        posix_fadvise(fileno(m_stream), static_cast<off_t>(offset), static_cast<off_t>(length),
+                      POSIX_FADV_WILLNEED);
+#else
+        (void)offset;
+        (void)length;
+#endif
+    }
+
+    // C requires a seek between a read and a write on the same stream
+    void switchStdioDirection(bool writing) {
+        if (m_stdioDirectionKnown && m_lastWasWrite != writing) {
+            fseeko(m_stream, 0, SEEK_CUR);
+        }
+        m_lastWasWrite = writing;
+        m_stdioDirectionKnown = true;
+    }
+
+    FILE* m_stream;
+    uint8_t* m_mapping = nullptr;
+    uint64_t m_size = 0;
+    uint64_t m_position = 0;
+    uint64_t m_lastReadEnd = 0;
+    bool m_sequential = true;
+    bool m_appendMode = false;
+    std::unique_ptr<BoxerWriteBehindFile> m_writeBehind;
+    bool m_lastWasWrite = false;
+    bool m_stdioDirectionKnown = false;
+    FileKey m_fileKey;
+    bool m_registered = false;
+    Promoter m_promoter;
+
+    // Stdio readahead
+    bool m_readaheadEnabled = true;
+    uint32_t m_contiguousReads = 0;
+    size_t m_window = 0;
+    std::vector<uint8_t> m_readBuffer;
+    uint64_t m_bufferStart = 0;
+    size_t m_bufferLength = 0;
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_FILE_HANDLE_H
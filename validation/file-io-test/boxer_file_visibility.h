@@ -0,0 +1,192 @@
+/*
+ * boxer_file_visibility.h - Precompiled hidden-file rules
+ *
+ * Evaluates INT-040 shouldShowFileWithName inline for the fixed rules the
+ * host registers up front (dotfiles, Icon\r, ...), instead of one virtual
+ * call per directory entry.
+ *
+ * ARCHITECTURE:
+ *   - Boxer registers its hide rules once, before the first drive is
+ *     mounted: exact names, prefixes and suffixes, plus one rule for every
+ *     "."-prefixed name other than the "." and ".." entries
+ *   - Exact names live in a hash set behind a first-byte/length prefilter;
+ *     prefixes and suffixes are bucketed by their first/last byte, so each
+ *     name is compared against only the few rules that could match it
+ *   - Names no rule hides go to the delegate hook only if the host says
+ *     it also has dynamic rules (setDynamicFallback)
+ *
+ * Matching is case-sensitive, like the host filesystem names it is given.
+ *
+ * THREAD SAFETY:
+ *   Configure before mounting; afterwards the filter is read-only and may
+ *   be evaluated from any thread without locking.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_FILE_VISIBILITY_H
+#define BOXER_FILE_VISIBILITY_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// ============================================================================
+// BoxerFileVisibilityFilter
+// ============================================================================
+
+class BoxerFileVisibilityFilter {
+public:
+    enum class Verdict : uint8_t {
+        Visible,       ///< No rule hides it and there is no dynamic fallback
+        Hidden,        ///< Matched a registered rule
+        AskDelegate,   ///< No rule matched; consult shouldShowFileWithName
+    };
+
+    static BoxerFileVisibilityFilter& shared() {
+        static BoxerFileVisibilityFilter filter;
+        return filter;
+    }
+
+    /// Hide entries named exactly `name`
+    void hideExact(std::string_view name) {
+        if (!name.empty()) {
+            m_exact.insert(store(name));
+            m_exactFirstBytes.set(static_cast<uint8_t>(name.front()));
+            m_exactLengths.set(std::min<size_t>(name.size(), kMaxTrackedLength));
+        }
+    }
+
+    /// Hide entries whose name starts with `prefix`
+    void hidePrefix(std::string_view prefix) {
+        if (!prefix.empty()) {
+            m_prefixes[static_cast<uint8_t>(prefix.front())].push_back(store(prefix));
+        }
+    }
+
+    /// Hide entries whose name ends with `suffix`
+    void hideSuffix(std::string_view suffix) {
+        if (!suffix.empty()) {
+            m_suffixes[static_cast<uint8_t>(suffix.back())].push_back(store(suffix));
+        }
+    }
+
+    /**
+     * @brief Hide every name starting with "." except "." and ".."
+     *
+     * Boxer's hook hides all dotfiles. A plain "." prefix rule would also
+     * hide the "." and ".." entries drive_cache.cpp needs, so this is a
+     * separate rule.
+     */
+    void hideDotfiles() { m_hideDotfiles = true; }
+
+    /**
+     * @brief Register the macOS metadata files Boxer hides by default
+     *
+     * Every dotfile (.DS_Store, AppleDouble ._ files, Spotlight and
+     * FSEvents stores, the Trash, .localized markers, version control
+     * folders) and custom folder icons.
+     */
+    void hideMacOSMetadata() {
+        hideDotfiles();
+        hideExact("Icon\r");
+    }
+
+    /**
+     * @brief Whether names no rule hides still need the delegate hook
+     *
+     * Off by default: the registered rules are the whole policy. Hosts with
+     * rules that depend on runtime state turn this on.
+     */
+    void setDynamicFallback(bool enabled) { m_dynamicFallback = enabled; }
+    bool hasDynamicFallback() const { return m_dynamicFallback; }
+
+    /// Drop every rule (delegate replaced)
+    void clear() {
+        m_exact.clear();
+        m_exactFirstBytes.reset();
+        m_exactLengths.reset();
+        for (auto& bucket : m_prefixes) bucket.clear();
+        for (auto& bucket : m_suffixes) bucket.clear();
+        m_storage.clear();
+        m_hideDotfiles = false;
+        m_dynamicFallback = false;
+    }
+
+    /// Evaluate the registered rules for one directory entry name
+    Verdict evaluate(std::string_view name) const {
+        if (name.empty()) {
+            return Verdict::Visible;
+        }
+        if (m_hideDotfiles && name.front() == '.' && name != "." && name != "..") {
+            return Verdict::Hidden;
+        }
+        // Most names share neither first byte nor length with any exact
+        // rule, so they never reach the hash
+        if (m_exactFirstBytes.test(static_cast<uint8_t>(name.front())) &&
+            m_exactLengths.test(std::min<size_t>(name.size(), kMaxTrackedLength)) &&
+            m_exact.count(name)) {
+            return Verdict::Hidden;
+        }
+        for (const auto& prefix : m_prefixes[static_cast<uint8_t>(name.front())]) {
+            if (name.size() >= prefix.size() && name.compare(0, prefix.size(), prefix) == 0) {
+                return Verdict::Hidden;
+            }
+        }
+        for (const auto& suffix : m_suffixes[static_cast<uint8_t>(name.back())]) {
+            if (name.size() >= suffix.size() &&
+                name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                return Verdict::Hidden;
+            }
+        }
+        return m_dynamicFallback ? Verdict::AskDelegate : Verdict::Visible;
+    }
+
+    /**
+     * @brief INT-040 replacement for drive_cache.cpp
+     * @param name Directory entry name
+     * @param fallback Callable `bool(const char*)`, the delegate hook
+     * @return true if the entry should be shown to DOS
+     */
+    template <typename Fallback>
+    bool shouldShow(const char* name, Fallback&& fallback) const {
+        switch (evaluate(name)) {
+            case Verdict::Hidden:      return false;
+            case Verdict::Visible:     return true;
+            case Verdict::AskDelegate: return fallback(name);
+        }
+        return true;
+    }
+
+private:
+    // Lengths at or above this share one bit in m_exactLengths
+    static constexpr size_t kMaxTrackedLength = 63;
+
+    // Rules point into stable storage so lookups never allocate
+    std::string_view store(std::string_view text) {
+        m_storage.emplace_back(text);
+        return m_storage.back();
+    }
+
+    std::deque<std::string> m_storage;
+    std::unordered_set<std::string_view> m_exact;
+    std::bitset<256> m_exactFirstBytes;
+    std::bitset<kMaxTrackedLength + 1> m_exactLengths;
+    std::array<std::vector<std::string_view>, 256> m_prefixes;
+    std::array<std::vector<std::string_view>, 256> m_suffixes;
+    bool m_hideDotfiles = false;
+    bool m_dynamicFallback = false;
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_FILE_VISIBILITY_H
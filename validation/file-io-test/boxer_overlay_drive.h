@@ -0,0 +1,702 @@
+/*
+ * boxer_overlay_drive.h - Copy-on-write overlay for local drives
+ *
+ * Keeps a mounted game folder pristine: every change the DOS side makes
+ * lands in a separate overlay folder, and reads see the merged result. This
+ * is the copy-on-write behaviour INT-046 openLocalFile was specified for.
+ *
+ * ARCHITECTURE:
+ *   - Base root: the game folder, never written
+ *   - Overlay root: mirrors the base layout, holding changed and new files
+ *   - Deletion markers: empty files at the same relative paths under the
+ *     overlay's ".deleted" folder. No DOS name starts with a dot and Boxer
+ *     hides dotfiles, so markers never clash with a file the DOS side made
+ *   - In-memory index of every overlay path, built by one scan at mount, so
+ *     locating a path is a hash lookup instead of probing both trees
+ *   - Copy-up: openHandle() opens a base file for update on the base and
+ *     copies it into the overlay at the first write or truncation. The
+ *     FILE* hook (openFile) cannot swap streams later, so it copies up at
+ *     open. Opening for truncation just creates the overlay file
+ *   - Removing a base path writes a deletion marker. Creating a directory
+ *     over a removed one marks every base child deleted, so the old
+ *     contents do not show through
+ *   - Directory renames are done entry by entry (mkdir, rename children,
+ *     rmdir), so they need no extra marker type
+ *
+ * Paths are host paths as passed to the INT-046..056 hooks. Paths outside
+ * the base root pass through unchanged. The overlay root must not be
+ * modified behind the drive's back while it is mounted.
+ *
+ * THREAD SAFETY:
+ *   All methods are thread-safe.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_OVERLAY_DRIVE_H
+#define BOXER_OVERLAY_DRIVE_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include <sys/stat.h>
+
+#include "boxer_directory_cache.h"
+#include "boxer_file_handle.h"
+
+// ============================================================================
+// BoxerOverlayDrive
+// ============================================================================
+
+class BoxerOverlayDrive {
+public:
+    enum class Location : uint8_t {
+        Base,      ///< Not overlaid; the base path (which may not exist)
+        Overlay,   ///< Changed or created; the overlay path
+        Deleted,   ///< Removed by the DOS side
+    };
+
+    struct Stats {
+        uint64_t overlayHits;   ///< Reads redirected to the overlay
+        uint64_t baseHits;      ///< Reads served from the base
+        uint64_t copyUps;       ///< Base files copied into the overlay
+    };
+
+    using Snapshot = BoxerDirectorySnapshotCache::Snapshot;
+
+    /// Folder in the overlay root holding the deletion markers
+    static constexpr const char* kDeletionMarkerFolder = ".deleted";
+
+    /**
+     * @param baseRoot Pristine game folder
+     * @param overlayRoot Folder receiving all changes; created if missing
+     */
+    BoxerOverlayDrive(std::string baseRoot, std::string overlayRoot)
+        : m_baseRoot(trimmed(std::move(baseRoot))),
+          m_overlayRoot(trimmed(std::move(overlayRoot))),
+          m_markerRoot(join(m_overlayRoot, kDeletionMarkerFolder)) {}
+
+    BoxerOverlayDrive(const BoxerOverlayDrive&) = delete;
+    BoxerOverlayDrive& operator=(const BoxerOverlayDrive&) = delete;
+
+    /**
+     * @brief Build the index from the overlay folder (driveDidMount)
+     * @return false if the overlay root cannot be created or read
+     */
+    bool load() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_index.clear();
+        m_children.clear();
+        m_deletedCount = 0;
+
+        std::error_code error;
+        std::filesystem::create_directories(m_overlayRoot, error);
+        if (error) {
+            errno = error.value();
+            return false;
+        }
+        for (std::filesystem::recursive_directory_iterator it(m_overlayRoot, error), end;
+             !error && it != end; it.increment(error)) {
+            if (it->path() == m_markerRoot) {
+                it.disable_recursion_pending();
+                continue;
+            }
+            const std::string relative = it->path().string().substr(m_overlayRoot.size() + 1);
+            setLocked(relative, it->is_directory(error) ? Kind::Directory : Kind::File);
+        }
+        std::error_code noMarkers;
+        if (!error && std::filesystem::is_directory(m_markerRoot, noMarkers)) {
+            for (std::filesystem::recursive_directory_iterator it(m_markerRoot, error), end;
+                 !error && it != end; it.increment(error)) {
+                const std::string relative = it->path().string().substr(m_markerRoot.size() + 1);
+                // A directory recreated over a deleted one keeps its own entry
+                if (!it->is_directory(error) && m_index.find(relative) == m_index.end()) {
+                    setLocked(relative, Kind::Deleted);
+                }
+            }
+        }
+        if (error) {
+            errno = error.value();
+            return false;
+        }
+        return true;
+    }
+
+    /// Where reads of a host path are served from
+    Location locate(const std::string& hostPath) const {
+        std::string relative;
+        if (!relativePath(hostPath, relative)) {
+            return Location::Base;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return locateLocked(relative);
+    }
+
+    /**
+     * @brief Host path to read from
+     * @return Overlay or base path, or empty (errno ENOENT) if deleted
+     */
+    std::string pathForReading(const std::string& hostPath) {
+        std::string relative;
+        if (!relativePath(hostPath, relative)) {
+            return hostPath;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        switch (locateLocked(relative)) {
+            case Location::Overlay:
+                ++m_stats.overlayHits;
+                return overlayPath(relative);
+            case Location::Deleted:
+                errno = ENOENT;
+                return std::string();
+            case Location::Base:
+                break;
+        }
+        ++m_stats.baseHits;
+        return hostPath;
+    }
+
+    /**
+     * @brief Host path to write to, copying the base file up first
+     * @param preserveContents Copy existing base contents (update and
+     *        append modes); false when the file is about to be truncated
+     * @return Overlay path, or empty with errno set
+     */
+    std::string pathForWriting(const std::string& hostPath, bool preserveContents) {
+        std::string relative;
+        if (!relativePath(hostPath, relative)) {
+            return hostPath;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return prepareFileLocked(relative, preserveContents) ? overlayPath(relative) : std::string();
+    }
+
+    /**
+     * @brief INT-046: open a file through the overlay
+     * @param mode fopen() mode; read-only modes never touch the overlay
+     *
+     * An update-mode ("r+") open of a base file copies it up at once; use
+     * openHandle() to defer that to the first change.
+     */
+    FILE* openFile(const char* hostPath, const char* mode) {
+        if (!mode || (mode[0] == 'r' && !std::strchr(mode, '+'))) {
+            const std::string path = pathForReading(hostPath);
+            return path.empty() ? nullptr : std::fopen(path.c_str(), mode ? mode : "rb");
+        }
+        std::string relative;
+        if (!relativePath(hostPath, relative)) {
+            return std::fopen(hostPath, mode);
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // "r+" must not create the file
+        if (mode[0] == 'r' && !existsLocked(relative)) {
+            return nullptr;
+        }
+        if (!prepareFileLocked(relative, mode[0] != 'w')) {
+            return nullptr;
+        }
+        return std::fopen(overlayPath(relative).c_str(), mode);
+    }
+
+    /**
+     * @brief INT-046 for BoxerFileHandle: open a file through the overlay,
+     *        copying an update-mode open of a base file up only when the
+     *        handle first writes or truncates it
+     * @return Handle, or nullptr with errno set
+     */
+    std::unique_ptr<BoxerFileHandle> openHandle(const char* hostPath, const char* mode,
+                                                uint64_t mapThreshold = BoxerFileHandle::kDefaultMapThreshold) {
+        auto opener = [this](const char* path, const char* m) { return openFile(path, m); };
+        std::string relative;
+        if (!mode || mode[0] != 'r' || !std::strchr(mode, '+') || !relativePath(hostPath, relative) ||
+            locate(hostPath) != Location::Base) {
+            return BoxerFileHandle::open(hostPath, mode, opener, mapThreshold);
+        }
+
+        // Read the base until something is written
+        const std::string base = pathForReading(hostPath);
+        auto handle = BoxerFileHandle::open(hostPath, mode, [&base](const char*, const char*) {
+            return std::fopen(base.c_str(), "rb");
+        }, mapThreshold);
+        if (handle) {
+            const std::string updateMode = mode;
+            handle->promoteOnWrite([this, relative, updateMode]() -> FILE* {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!prepareFileLocked(relative, true)) {
+                    return nullptr;
+                }
+                return std::fopen(overlayPath(relative).c_str(), updateMode.c_str());
+            });
+        }
+        return handle;
+    }
+
+    /// INT-047: remove a file
+    bool removeFile(const std::string& hostPath) {
+        std::string relative;
+        if (!relativePath(hostPath, relative)) {
+            return ::remove(hostPath.c_str()) == 0;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        struct stat status;
+        if (!statLocked(relative, &status)) {
+            return false;
+        }
+        if (S_ISDIR(status.st_mode)) {
+            errno = EISDIR;
+            return false;
+        }
+        return removeLocked(relative);
+    }
+
+    /// INT-049: create a directory
+    bool makeDirectory(const std::string& hostPath) {
+        std::string relative;
+        if (!relativePath(hostPath, relative)) {
+            return ::mkdir(hostPath.c_str(), 0755) == 0;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return makeDirectoryLocked(relative);
+    }
+
+    /// INT-050: remove an empty directory
+    bool removeDirectory(const std::string& hostPath) {
+        std::string relative;
+        if (!relativePath(hostPath, relative)) {
+            return ::rmdir(hostPath.c_str()) == 0;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return removeDirectoryLocked(relative);
+    }
+
+    /// INT-048: rename a file or directory
+    bool rename(const std::string& fromHostPath, const std::string& toHostPath) {
+        std::string from;
+        std::string to;
+        const bool fromInside = relativePath(fromHostPath, from);
+        const bool toInside = relativePath(toHostPath, to);
+        if (!fromInside && !toInside) {
+            return ::rename(fromHostPath.c_str(), toHostPath.c_str()) == 0;
+        }
+        if (!fromInside || !toInside || from.empty() || to.empty()) {
+            errno = EXDEV;
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return renameLocked(from, to);
+    }
+
+    /// INT-051: stat through the overlay
+    bool getStats(const std::string& hostPath, struct stat* outStatus) {
+        std::string relative;
+        if (!relativePath(hostPath, relative)) {
+            return ::stat(hostPath.c_str(), outStatus) == 0;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return statLocked(relative, outStatus);
+    }
+
+    /**
+     * @brief Merged listing of a directory; usable as a snapshot cache loader
+     * @return false (errno ENOENT) if the directory does not exist
+     */
+    bool readDirectory(const std::string& hostPath, Snapshot& out) const {
+        std::string relative;
+        if (!relativePath(hostPath, relative)) {
+            return BoxerDirectorySnapshotCache::readDirectory(hostPath, out);
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return readDirectoryLocked(relative, out);
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    const std::string& baseRoot() const { return m_baseRoot; }
+    const std::string& overlayRoot() const { return m_overlayRoot; }
+
+private:
+    enum class Kind : uint8_t { File, Directory, Deleted };
+
+    static std::string trimmed(std::string path) {
+        while (path.size() > 1 && path.back() == '/') {
+            path.pop_back();
+        }
+        return path;
+    }
+
+    static std::string parentOf(const std::string& relative) {
+        const size_t split = relative.rfind('/');
+        return split == std::string::npos ? std::string() : relative.substr(0, split);
+    }
+
+    static std::string nameOf(const std::string& relative) {
+        const size_t split = relative.rfind('/');
+        return split == std::string::npos ? relative : relative.substr(split + 1);
+    }
+
+    static std::string join(const std::string& directory, const std::string& name) {
+        return directory.empty() ? name : directory + "/" + name;
+    }
+
+    // Path below the base root without leading or trailing slashes ("" is the root)
+    bool relativePath(const std::string& hostPath, std::string& out) const {
+        if (hostPath.compare(0, m_baseRoot.size(), m_baseRoot) != 0 ||
+            (hostPath.size() > m_baseRoot.size() && hostPath[m_baseRoot.size()] != '/')) {
+            return false;
+        }
+        out = trimmed(hostPath.substr(m_baseRoot.size()));
+        if (!out.empty() && out.front() == '/') {
+            out.erase(0, 1);
+        }
+        if (out == "/") {
+            out.clear();
+        }
+        return true;
+    }
+
+    std::string basePath(const std::string& relative) const { return join(m_baseRoot, relative); }
+    std::string overlayPath(const std::string& relative) const { return join(m_overlayRoot, relative); }
+    std::string markerPath(const std::string& relative) const { return join(m_markerRoot, relative); }
+
+    Location locateLocked(const std::string& relative) const {
+        auto it = m_index.find(relative);
+        if (it != m_index.end()) {
+            return it->second == Kind::Deleted ? Location::Deleted : Location::Overlay;
+        }
+        // Only a deleted ancestor can hide an unindexed path
+        if (m_deletedCount > 0) {
+            for (std::string parent = parentOf(relative); !parent.empty(); parent = parentOf(parent)) {
+                auto ancestor = m_index.find(parent);
+                if (ancestor != m_index.end()) {
+                    if (ancestor->second == Kind::Deleted) {
+                        return Location::Deleted;
+                    }
+                    break;
+                }
+            }
+        }
+        return Location::Base;
+    }
+
+    bool statLocked(const std::string& relative, struct stat* out) const {
+        switch (locateLocked(relative)) {
+            case Location::Overlay:
+                return ::stat(overlayPath(relative).c_str(), out) == 0;
+            case Location::Deleted:
+                errno = ENOENT;
+                return false;
+            case Location::Base:
+                break;
+        }
+        return ::stat(basePath(relative).c_str(), out) == 0;
+    }
+
+    bool existsLocked(const std::string& relative, bool* isDirectory = nullptr) const {
+        struct stat status;
+        if (!statLocked(relative, &status)) {
+            return false;
+        }
+        if (isDirectory) {
+            *isDirectory = S_ISDIR(status.st_mode);
+        }
+        return true;
+    }
+
+    bool baseExists(const std::string& relative) const {
+        struct stat status;
+        return ::lstat(basePath(relative).c_str(), &status) == 0;
+    }
+
+    void setLocked(const std::string& relative, Kind kind) {
+        auto it = m_index.find(relative);
+        if (it != m_index.end() && it->second == Kind::Deleted) {
+            --m_deletedCount;
+        }
+        m_index[relative] = kind;
+        if (kind == Kind::Deleted) {
+            ++m_deletedCount;
+        }
+        if (!relative.empty()) {
+            m_children[parentOf(relative)].insert(nameOf(relative));
+        }
+    }
+
+    void eraseLocked(const std::string& relative) {
+        auto it = m_index.find(relative);
+        if (it == m_index.end()) {
+            return;
+        }
+        if (it->second == Kind::Deleted) {
+            --m_deletedCount;
+        }
+        m_index.erase(it);
+        auto siblings = m_children.find(parentOf(relative));
+        if (siblings != m_children.end()) {
+            siblings->second.erase(nameOf(relative));
+        }
+    }
+
+    bool writeMarkerLocked(const std::string& relative) {
+        if (!ensureOverlayDirectoryLocked(parentOf(relative))) {
+            return false;
+        }
+        std::error_code error;
+        std::filesystem::create_directories(join(m_markerRoot, parentOf(relative)), error);
+        if (error) {
+            errno = error.value();
+            return false;
+        }
+        FILE* marker = std::fopen(markerPath(relative).c_str(), "wb");
+        if (!marker) {
+            return false;
+        }
+        std::fclose(marker);
+        setLocked(relative, Kind::Deleted);
+        return true;
+    }
+
+    void clearMarkerLocked(const std::string& relative) {
+        auto it = m_index.find(relative);
+        if (it != m_index.end() && it->second == Kind::Deleted) {
+            ::remove(markerPath(relative).c_str());
+            eraseLocked(relative);
+        }
+    }
+
+    // Make sure a directory exists in the overlay, creating its parents
+    bool ensureOverlayDirectoryLocked(const std::string& relative) {
+        if (relative.empty()) {
+            return true;
+        }
+        auto it = m_index.find(relative);
+        if (it != m_index.end() && it->second == Kind::Directory) {
+            return true;
+        }
+        bool isDirectory = false;
+        if (!existsLocked(relative, &isDirectory)) {
+            return false;
+        }
+        if (!isDirectory) {
+            errno = ENOTDIR;
+            return false;
+        }
+        if (!ensureOverlayDirectoryLocked(parentOf(relative))) {
+            return false;
+        }
+        if (::mkdir(overlayPath(relative).c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+        setLocked(relative, Kind::Directory);
+        return true;
+    }
+
+    bool prepareFileLocked(const std::string& relative, bool preserveContents) {
+        if (relative.empty() || !ensureOverlayDirectoryLocked(parentOf(relative))) {
+            if (relative.empty()) {
+                errno = EISDIR;
+            }
+            return false;
+        }
+        const Location location = locateLocked(relative);
+        if (location == Location::Overlay) {
+            if (m_index.at(relative) != Kind::File) {
+                errno = EISDIR;
+                return false;
+            }
+            return true;
+        }
+        if (location == Location::Deleted) {
+            clearMarkerLocked(relative);
+        } else if (preserveContents && baseExists(relative)) {
+            std::error_code error;
+            std::filesystem::copy_file(basePath(relative), overlayPath(relative),
+                                       std::filesystem::copy_options::overwrite_existing, error);
+            if (error) {
+                errno = error.value();
+                return false;
+            }
+            ++m_stats.copyUps;
+        }
+        setLocked(relative, Kind::File);
+        return true;
+    }
+
+    bool removeLocked(const std::string& relative) {
+        if (locateLocked(relative) == Location::Overlay) {
+            // Markers for deleted entries below it go too
+            std::error_code error;
+            std::filesystem::remove_all(overlayPath(relative), error);
+            if (!error) {
+                std::filesystem::remove_all(markerPath(relative), error);
+            }
+            if (error) {
+                errno = error.value();
+                return false;
+            }
+            // Drop the index entries of anything that was below it
+            const std::string prefix = relative + "/";
+            for (auto it = m_index.begin(); it != m_index.end();) {
+                const auto& key = it->first;
+                ++it;
+                if (key.compare(0, prefix.size(), prefix) == 0) {
+                    eraseLocked(std::string(key));
+                }
+            }
+            m_children.erase(relative);
+            eraseLocked(relative);
+        }
+        return baseExists(relative) ? writeMarkerLocked(relative) : true;
+    }
+
+    bool makeDirectoryLocked(const std::string& relative) {
+        if (relative.empty() || existsLocked(relative)) {
+            errno = EEXIST;
+            return false;
+        }
+        if (!ensureOverlayDirectoryLocked(parentOf(relative))) {
+            return false;
+        }
+        const bool replacesDeleted = locateLocked(relative) == Location::Deleted && baseExists(relative);
+        if (::mkdir(overlayPath(relative).c_str(), 0755) != 0) {
+            return false;
+        }
+        clearMarkerLocked(relative);
+        setLocked(relative, Kind::Directory);
+
+        // The new directory starts empty even though the base one is not
+        Snapshot baseEntries;
+        if (replacesDeleted && BoxerDirectorySnapshotCache::readDirectory(basePath(relative), baseEntries)) {
+            for (const auto& entry : baseEntries) {
+                if (entry.name != "." && entry.name != "..") {
+                    writeMarkerLocked(join(relative, entry.name));
+                }
+            }
+        }
+        return true;
+    }
+
+    bool removeDirectoryLocked(const std::string& relative) {
+        Snapshot entries;
+        if (relative.empty() || !readDirectoryLocked(relative, entries)) {
+            errno = relative.empty() ? EBUSY : ENOENT;
+            return false;
+        }
+        if (entries.size() > 2) {
+            errno = ENOTEMPTY;
+            return false;
+        }
+        return removeLocked(relative);
+    }
+
+    bool renameLocked(const std::string& from, const std::string& to) {
+        bool isDirectory = false;
+        if (!existsLocked(from, &isDirectory)) {
+            return false;
+        }
+        if (to == from || to.compare(0, from.size() + 1, from + "/") == 0) {
+            errno = EINVAL;
+            return false;
+        }
+        if (existsLocked(to)) {
+            errno = EEXIST;
+            return false;
+        }
+
+        if (isDirectory) {
+            Snapshot entries;
+            if (!makeDirectoryLocked(to) || !readDirectoryLocked(from, entries)) {
+                return false;
+            }
+            for (const auto& entry : entries) {
+                if (entry.name != "." && entry.name != ".." &&
+                    !renameLocked(join(from, entry.name), join(to, entry.name))) {
+                    return false;
+                }
+            }
+            return removeDirectoryLocked(from);
+        }
+
+        if (!ensureOverlayDirectoryLocked(parentOf(to))) {
+            return false;
+        }
+        clearMarkerLocked(to);
+        if (locateLocked(from) == Location::Overlay) {
+            if (::rename(overlayPath(from).c_str(), overlayPath(to).c_str()) != 0) {
+                return false;
+            }
+            eraseLocked(from);
+        } else {
+            std::error_code error;
+            std::filesystem::copy_file(basePath(from), overlayPath(to), error);
+            if (error) {
+                errno = error.value();
+                return false;
+            }
+            ++m_stats.copyUps;
+        }
+        setLocked(to, Kind::File);
+        return baseExists(from) ? writeMarkerLocked(from) : true;
+    }
+
+    bool readDirectoryLocked(const std::string& relative, Snapshot& out) const {
+        auto indexed = m_index.find(relative);
+        const bool inOverlay = indexed != m_index.end() && indexed->second == Kind::Directory;
+        if (!inOverlay && locateLocked(relative) != Location::Base) {
+            errno = indexed != m_index.end() && indexed->second == Kind::File ? ENOTDIR : ENOENT;
+            return false;
+        }
+
+        Snapshot baseEntries;
+        const bool inBase = BoxerDirectorySnapshotCache::readDirectory(basePath(relative), baseEntries);
+        if (!inBase && !inOverlay) {
+            return false;
+        }
+
+        out.push_back({".", true});
+        out.push_back({"..", true});
+        for (auto& entry : baseEntries) {
+            if (entry.name != "." && entry.name != ".." &&
+                m_index.find(join(relative, entry.name)) == m_index.end()) {
+                out.push_back(std::move(entry));
+            }
+        }
+        auto children = m_children.find(relative);
+        if (children != m_children.end()) {
+            for (const auto& name : children->second) {
+                const Kind kind = m_index.at(join(relative, name));
+                if (kind != Kind::Deleted) {
+                    out.push_back({name, kind == Kind::Directory});
+                }
+            }
+        }
+        return true;
+    }
+
+    const std::string m_baseRoot;
+    const std::string m_overlayRoot;
+    const std::string m_markerRoot;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Kind> m_index;
+    std::unordered_map<std::string, std::set<std::string>> m_children;
+    size_t m_deletedCount = 0;
+    Stats m_stats{};
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_OVERLAY_DRIVE_H
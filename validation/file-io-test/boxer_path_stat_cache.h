@@ -0,0 +1,319 @@
+/*
+ * boxer_path_stat_cache.h - Bounded path metadata cache
+ *
+ * Sits in front of INT-051 getLocalPathStats, INT-052 localDirectoryExists
+ * and INT-053 localFileExists, so repeated probes of the same paths (config
+ * files reopened every frame, CD presence checks) stop costing a stat().
+ *
+ * ARCHITECTURE:
+ *   - LRU map of host path -> stat result, including "does not exist"
+ *     (negative caching); existence checks are answered from the same entry
+ *   - Each cached path watches its parent directory; creating, deleting,
+ *     renaming or writing an entry on the host invalidates just that path
+ *     (and the directory's own entry, whose times changed)
+ *   - The emulator's own writes invalidate explicitly through invalidate()
+ *     and invalidateTree()
+ *
+ * Only "not found" failures (ENOENT, ENOTDIR) are cached negatively;
+ * permission errors and other failures always go back to the hook. When
+ * the watcher is active but a parent cannot be watched, the result is not
+ * cached at all. Without a watcher host-side changes are only seen after
+ * invalidation, as with the directory snapshot cache.
+ *
+ * THREAD SAFETY:
+ *   All methods are thread-safe. The stat hook is called with the cache
+ *   lock held.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_PATH_STAT_CACHE_H
+#define BOXER_PATH_STAT_CACHE_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <sys/stat.h>
+
+#include "boxer_directory_watcher.h"
+
+// ============================================================================
+// BoxerPathStatCache
+// ============================================================================
+
+class BoxerPathStatCache {
+public:
+    struct Stats {
+        uint64_t hits;           ///< Answered from a positive entry
+        uint64_t negativeHits;   ///< Answered from a "does not exist" entry
+        uint64_t misses;         ///< Went to the hook
+        uint64_t invalidations;
+        uint64_t evictions;
+    };
+
+    /// Paths kept; probes concentrate on a small working set
+    static constexpr size_t kDefaultCapacity = 4096;
+
+    static BoxerPathStatCache& shared() {
+        static BoxerPathStatCache cache;
+        return cache;
+    }
+
+    /**
+     * @param capacity Maximum number of cached paths
+     * @param watch Use the host directory watcher where available
+     */
+    explicit BoxerPathStatCache(size_t capacity = kDefaultCapacity, bool watch = true)
+        : m_capacity(std::max<size_t>(capacity, 1)),
+          m_watcher(watch, BoxerDirectoryWatcher::kContentEvents) {}
+
+    /**
+     * @brief INT-051: stat a host path through the cache
+     * @param path Host filesystem path
+     * @param[out] outStatus Filled when the path exists
+     * @param hook Callable `bool(const char* path, struct stat* out)`, the
+     *        delegate hook; errno is inspected when it returns false
+     * @return true if the path exists
+     */
+    template <typename Hook>
+    bool getStats(const char* path, struct stat* outStatus, Hook&& hook) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Node* node = lookupLocked(path, hook);
+        if (!node->exists) {
+            errno = node->error;
+            return false;
+        }
+        if (outStatus) {
+            *outStatus = node->status;
+        }
+        return true;
+    }
+
+    bool getStats(const char* path, struct stat* outStatus) {
+        return getStats(path, outStatus, &BoxerPathStatCache::hostStat);
+    }
+
+    /// INT-053: true if the path exists and is a regular file
+    template <typename Hook>
+    bool fileExists(const char* path, Hook&& hook) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Node* node = lookupLocked(path, hook);
+        return node->exists && S_ISREG(node->status.st_mode);
+    }
+
+    bool fileExists(const char* path) {
+        return fileExists(path, &BoxerPathStatCache::hostStat);
+    }
+
+    /// INT-052: true if the path exists and is a directory
+    template <typename Hook>
+    bool directoryExists(const char* path, Hook&& hook) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Node* node = lookupLocked(path, hook);
+        return node->exists && S_ISDIR(node->status.st_mode);
+    }
+
+    bool directoryExists(const char* path) {
+        return directoryExists(path, &BoxerPathStatCache::hostStat);
+    }
+
+    /**
+     * @brief Forget a path the emulator just created, wrote, removed or
+     *        renamed, along with its parent directory
+     */
+    void invalidate(const char* path) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const std::string key = normalize(path);
+        size_t dropped = eraseLocked(key) ? 1 : 0;
+        dropped += eraseLocked(parentOf(key)) ? 1 : 0;
+        m_stats.invalidations += dropped;
+    }
+
+    /// Forget a directory and every cached path below it (rmdir, rename)
+    void invalidateTree(const char* directory) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.invalidations += eraseTreeLocked(normalize(directory));
+    }
+
+    /// Forget everything (drive unmount)
+    void invalidateAll() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.invalidations += eraseAllLocked();
+    }
+
+    /**
+     * @brief Apply pending host changes without waiting for a lookup
+     * @return Number of entries invalidated
+     */
+    size_t processChanges() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return drainWatcherLocked();
+    }
+
+    bool isWatching() const { return m_watcher.isActive(); }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+    /// Default hook: plain stat()
+    static bool hostStat(const char* path, struct stat* out) {
+        return ::stat(path, out) == 0;
+    }
+
+private:
+    struct Node {
+        bool exists;
+        bool watched;
+        int error;          // errno from the hook when !exists
+        struct stat status;
+        std::list<std::string>::iterator lruPosition;
+    };
+
+    static std::string normalize(const char* path) {
+        std::string key = path ? path : "";
+        while (key.size() > 1 && key.back() == '/') {
+            key.pop_back();
+        }
+        return key;
+    }
+
+    static std::string parentOf(const std::string& key) {
+        const size_t split = key.rfind('/');
+        if (split == std::string::npos) {
+            return ".";
+        }
+        return split == 0 ? std::string("/") : key.substr(0, split);
+    }
+
+    template <typename Hook>
+    const Node* lookupLocked(const char* path, Hook&& hook) {
+        drainWatcherLocked();
+
+        std::string key = normalize(path);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+            ++(it->second.exists ? m_stats.hits : m_stats.negativeHits);
+            return &it->second;
+        }
+        ++m_stats.misses;
+
+        // Watch before stat so a change in between is not lost
+        const std::string parent = parentOf(key);
+        const bool watched = m_watcher.watch(parent);
+
+        Node node{};
+        errno = 0;
+        node.exists = hook(key.c_str(), &node.status);
+        node.error = node.exists ? 0 : (errno ? errno : ENOENT);
+        const bool notFound = !node.exists && (node.error == ENOENT || node.error == ENOTDIR);
+        const bool cacheable = (node.exists || notFound) && (watched || !m_watcher.isActive());
+
+        if (!cacheable) {
+            if (watched) {
+                m_watcher.unwatch(parent);
+            }
+            m_scratch = node;
+            return &m_scratch;
+        }
+
+        node.watched = watched;
+        m_lru.push_front(key);
+        node.lruPosition = m_lru.begin();
+        const Node* stored = &m_entries.emplace(std::move(key), node).first->second;
+        while (m_entries.size() > m_capacity) {
+            eraseLocked(m_lru.back());
+            ++m_stats.evictions;
+        }
+        return stored;
+    }
+
+    bool eraseLocked(const std::string& key) {
+        auto it = m_entries.find(key);
+        if (it == m_entries.end()) {
+            return false;
+        }
+        if (it->second.watched) {
+            m_watcher.unwatch(parentOf(key));
+        }
+        m_lru.erase(it->second.lruPosition);
+        m_entries.erase(it);
+        return true;
+    }
+
+    size_t eraseTreeLocked(const std::string& directory) {
+        size_t dropped = eraseLocked(directory) ? 1 : 0;
+        const std::string prefix = directory == "/" ? directory : directory + "/";
+        for (auto it = m_lru.begin(); it != m_lru.end();) {
+            const std::string& key = *it++;
+            if (key.compare(0, prefix.size(), prefix) == 0) {
+                dropped += eraseLocked(std::string(key)) ? 1 : 0;
+            }
+        }
+        return dropped;
+    }
+
+    size_t eraseAllLocked() {
+        const size_t dropped = m_entries.size();
+        while (!m_lru.empty()) {
+            eraseLocked(m_lru.back());
+        }
+        return dropped;
+    }
+
+    size_t drainWatcherLocked() {
+        size_t invalidated = 0;
+        m_watcher.drain([this, &invalidated](BoxerDirectoryWatcher::Change change,
+                                             const std::string& directory, std::string_view name,
+                                             bool isDirectory) {
+            switch (change) {
+                case BoxerDirectoryWatcher::Change::Overflow:
+                    invalidated += eraseAllLocked();
+                    break;
+                case BoxerDirectoryWatcher::Change::Self:
+                    invalidated += eraseTreeLocked(directory);
+                    break;
+                case BoxerDirectoryWatcher::Change::Entry: {
+                    std::string child = directory == "/" ? directory : directory + "/";
+                    child.append(name.data(), name.size());
+                    // A renamed or removed subdirectory takes its cached children with it
+                    invalidated += isDirectory ? eraseTreeLocked(child) : (eraseLocked(child) ? 1 : 0);
+                    invalidated += eraseLocked(directory) ? 1 : 0;
+                    break;
+                }
+            }
+        });
+        m_stats.invalidations += invalidated;
+        return invalidated;
+    }
+
+    const size_t m_capacity;
+    BoxerDirectoryWatcher m_watcher;
+
+    mutable std::mutex m_mutex;
+    std::list<std::string> m_lru;
+    std::unordered_map<std::string, Node> m_entries;
+    Node m_scratch{};   // result holder for uncached lookups
+    Stats m_stats{};
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_PATH_STAT_CACHE_H
@@ -0,0 +1,421 @@
+/*
+ * boxer_short_name_index.h - DOS 8.3 name index for local drives
+ *
+ * drive_cache.cpp resolves each component of a DOS path by scanning the
+ * host directory and comparing every entry's short name case-insensitively.
+ * On large mounts every open repeats those scans. This index keeps, per
+ * mounted drive, a tree of directories keyed by canonical uppercase 8.3
+ * names, so resolving a path is one hash lookup per component.
+ *
+ * ARCHITECTURE:
+ *   - Created at driveDidMount with the drive's host root; a directory is
+ *     listed the first time a path goes through it, then kept
+ *   - Short names: a valid 8.3 name is its own uppercase form. Other names
+ *     get a "~N" tail with the smallest free N. At load, valid names are
+ *     placed first and the rest follow in host name order, so a directory
+ *     always gets the same short names
+ *   - The emulator's own create, remove and rename calls update loaded
+ *     directories in place; existing entries keep their short names
+ *   - Host-side changes (watcher, FSEvents) drop a directory with
+ *     invalidate(); it is listed again on next use
+ *
+ * DOS paths are canonical drive-relative paths as produced by DOS_MakeName
+ * ("GAMES\KEEN\SAVE1.CK4", no "." or ".." components). Host paths are
+ * the paths the INT-046..056 hooks see, under the drive's root.
+ *
+ * THREAD SAFETY:
+ *   All methods are thread-safe. The directory loader is called with the
+ *   index lock held.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_SHORT_NAME_INDEX_H
+#define BOXER_SHORT_NAME_INDEX_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "boxer_directory_cache.h"
+
+// ============================================================================
+// BoxerShortNameIndex
+// ============================================================================
+
+class BoxerShortNameIndex {
+public:
+    enum class Resolution : uint8_t {
+        Found,
+        FileNotFound,   ///< DOS error 2: the last component is missing
+        PathNotFound,   ///< DOS error 3: a directory on the way is missing
+    };
+
+    struct Stats {
+        uint64_t lookups;
+        uint64_t directoryLoads;
+    };
+
+    using Snapshot = BoxerDirectorySnapshotCache::Snapshot;
+    using Loader = std::function<bool(const std::string& hostPath, Snapshot& out)>;
+
+    /**
+     * @param hostRoot Host folder mounted as the drive
+     * @param loader Lists a host directory; the snapshot cache or overlay
+     *        drive can be passed here
+     */
+    explicit BoxerShortNameIndex(std::string hostRoot,
+                                 Loader loader = &BoxerDirectorySnapshotCache::readDirectory)
+        : m_root(trimmed(std::move(hostRoot))),
+          m_loader(std::move(loader)),
+          m_rootNode(std::make_unique<Node>()) {
+        m_rootNode->isDirectory = true;
+    }
+
+    BoxerShortNameIndex(const BoxerShortNameIndex&) = delete;
+    BoxerShortNameIndex& operator=(const BoxerShortNameIndex&) = delete;
+
+    /**
+     * @brief Map a DOS path to the host path it names
+     * @param dosPath Canonical path, '\' or '/' separated, any case
+     * @param[out] hostPath Host path when Found
+     */
+    Resolution resolve(std::string_view dosPath, std::string& hostPath) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.lookups;
+        std::string path = m_root;
+        Node* node = m_rootNode.get();
+        std::string key;
+        size_t start = 0;
+        while (start <= dosPath.size()) {
+            size_t end = dosPath.find_first_of("\\/", start);
+            if (end == std::string_view::npos) {
+                end = dosPath.size();
+            }
+            if (end > start) {
+                const bool last = dosPath.find_first_not_of("\\/", end) == std::string_view::npos;
+                if (!node->isDirectory || !ensureLoadedLocked(*node, path)) {
+                    return Resolution::PathNotFound;
+                }
+                key.assign(dosPath.substr(start, end - start));
+                uppercase(key);
+                const auto found = node->children.find(key);
+                if (found == node->children.end()) {
+                    return last ? Resolution::FileNotFound : Resolution::PathNotFound;
+                }
+                node = found->second.get();
+                path += '/';
+                path += node->hostName;
+            }
+            start = end + 1;
+        }
+        hostPath = std::move(path);
+        return Resolution::Found;
+    }
+
+    /**
+     * @brief Short name of a host entry, as FindFirst/FindNext report it
+     * @return Empty if the path is outside the drive or does not exist
+     */
+    std::string shortName(const std::string& hostPath) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::string parentPath;
+        Node* parent = parentForLocked(hostPath, true, parentPath);
+        if (!parent) {
+            return std::string();
+        }
+        const auto found = parent->shortNames.find(leafName(hostPath));
+        return found != parent->shortNames.end() ? found->second : std::string();
+    }
+
+    /// A host entry was created by the emulator (file create, mkdir)
+    void didCreate(const std::string& hostPath, bool isDirectory) {
+        // A directory made by mkdir is known to be empty: no listing needed
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::string parentPath;
+        if (Node* parent = parentForLocked(hostPath, false, parentPath)) {
+            const std::string name = leafName(hostPath);
+            if (parent->shortNames.find(name) == parent->shortNames.end()) {
+                auto node = std::make_unique<Node>();
+                node->hostName = name;
+                node->isDirectory = isDirectory;
+                node->loaded = isDirectory;
+                insertLocked(*parent, std::move(node));
+            }
+        }
+    }
+
+    /// A host entry was removed by the emulator (file delete, rmdir)
+    void didRemove(const std::string& hostPath) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::string parentPath;
+        if (Node* parent = parentForLocked(hostPath, false, parentPath)) {
+            detachLocked(*parent, leafName(hostPath));
+        }
+    }
+
+    /// A host entry was renamed by the emulator; a directory keeps its contents
+    void didRename(const std::string& fromHostPath, const std::string& toHostPath) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::string fromParentPath;
+        std::string toParentPath;
+        Node* from = parentForLocked(fromHostPath, false, fromParentPath);
+        Node* to = parentForLocked(toHostPath, false, toParentPath);
+        std::unique_ptr<Node> node = from ? detachLocked(*from, leafName(fromHostPath)) : nullptr;
+        if (!to) {
+            return;
+        }
+        const std::string name = leafName(toHostPath);
+        detachLocked(*to, name);   // rename() replaces an existing file
+        if (!node) {
+            // Source directory never listed: the entry type is unknown, so
+            // let the destination be listed again
+            unloadLocked(*to);
+            return;
+        }
+        node->hostName = name;
+        insertLocked(*to, std::move(node));
+    }
+
+    /// Drop a directory changed on the host; it is listed again on next use
+    void invalidate(const std::string& hostDirectory) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::string ignored;
+        if (trimmed(hostDirectory) == m_root) {
+            unloadLocked(*m_rootNode);
+        } else if (Node* parent = parentForLocked(hostDirectory, false, ignored)) {
+            const auto shortName = parent->shortNames.find(leafName(hostDirectory));
+            if (shortName != parent->shortNames.end()) {
+                unloadLocked(*parent->children[shortName->second]);
+            }
+        }
+    }
+
+    /// Drop everything (remount, host policy change)
+    void invalidateAll() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        unloadLocked(*m_rootNode);
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    /**
+     * @brief 8.3 name for a host name, avoiding names already taken
+     * @param taken Callable `bool(const std::string& shortName)`
+     */
+    template <typename Taken>
+    static std::string makeShortName(std::string_view hostName, Taken&& taken) {
+        std::string direct(hostName);
+        uppercase(direct);
+        if (isValidShortName(direct) && !taken(direct)) {
+            return direct;
+        }
+
+        // Strip spaces and leading dots; the last remaining dot starts the
+        // extension and every other dot is dropped
+        std::string cleaned;
+        for (const char c : direct) {
+            if (c != ' ' && !(c == '.' && cleaned.empty())) {
+                cleaned += isValidShortNameChar(c) || c == '.' ? c : '_';
+            }
+        }
+        const size_t dot = cleaned.rfind('.');
+        std::string base = cleaned.substr(0, dot);
+        base.erase(std::remove(base.begin(), base.end(), '.'), base.end());
+        const std::string extension = dot == std::string::npos ? std::string() : cleaned.substr(dot + 1, 3);
+        if (base.empty()) {
+            base = "_";
+        }
+
+        for (uint32_t number = 1;; ++number) {
+            const std::string tail = "~" + std::to_string(number);
+            std::string candidate = base.substr(0, 8 - std::min<size_t>(tail.size(), 8)) + tail;
+            if (!extension.empty()) {
+                candidate += '.';
+                candidate += extension;
+            }
+            if (!taken(candidate)) {
+                return candidate;
+            }
+        }
+    }
+
+    /// True for names DOS can use as they are (uppercase, 8.3, legal characters)
+    static bool isValidShortName(const std::string& name) {
+        if (name.empty() || name == "." || name == "..") {
+            return false;
+        }
+        const size_t dot = name.find('.');
+        const size_t baseLength = dot == std::string::npos ? name.size() : dot;
+        if (baseLength == 0 || baseLength > 8) {
+            return false;
+        }
+        if (dot != std::string::npos) {
+            const size_t extensionLength = name.size() - dot - 1;
+            if (extensionLength == 0 || extensionLength > 3 || name.find('.', dot + 1) != std::string::npos) {
+                return false;
+            }
+        }
+        return std::all_of(name.begin(), name.end(),
+                           [](char c) { return c == '.' || isValidShortNameChar(c); });
+    }
+
+private:
+    struct Node {
+        std::string hostName;
+        bool isDirectory = false;
+        bool loaded = false;
+        std::unordered_map<std::string, std::unique_ptr<Node>> children;   ///< By short name
+        std::unordered_map<std::string, std::string> shortNames;           ///< Host name to short name
+    };
+
+    static bool isValidShortNameChar(char c) {
+        const unsigned char u = static_cast<unsigned char>(c);
+        return (u >= 'A' && u <= 'Z') || (u >= '0' && u <= '9') ||
+               std::strchr("!#$%&'()-@^_`{}~", c) != nullptr;
+    }
+
+    static void uppercase(std::string& text) {
+        for (char& c : text) {
+            if (c >= 'a' && c <= 'z') {
+                c = static_cast<char>(c - 'a' + 'A');
+            }
+        }
+    }
+
+    static std::string trimmed(std::string path) {
+        while (path.size() > 1 && path.back() == '/') {
+            path.pop_back();
+        }
+        return path;
+    }
+
+    static std::string leafName(const std::string& hostPath) {
+        const std::string path = trimmed(hostPath);
+        const size_t slash = path.rfind('/');
+        return slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+
+    bool ensureLoadedLocked(Node& node, const std::string& hostPath) {
+        if (node.loaded) {
+            return true;
+        }
+        Snapshot listing;
+        if (!m_loader(hostPath, listing)) {
+            return false;
+        }
+        ++m_stats.directoryLoads;
+        node.children.clear();
+        node.shortNames.clear();
+        node.loaded = true;
+
+        // Valid names first so they are never displaced by a "~N" name,
+        // then host name order so numbering is the same on every load
+        std::vector<std::pair<bool, std::unique_ptr<Node>>> entries;
+        for (const auto& entry : listing) {
+            if (entry.name == "." || entry.name == "..") {
+                continue;
+            }
+            auto child = std::make_unique<Node>();
+            child->hostName = entry.name;
+            child->isDirectory = entry.isDirectory;
+            std::string upper = entry.name;
+            uppercase(upper);
+            entries.emplace_back(!isValidShortName(upper), std::move(child));
+        }
+        std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+            return a.first != b.first ? b.first : a.second->hostName < b.second->hostName;
+        });
+        for (auto& entry : entries) {
+            insertLocked(node, std::move(entry.second));
+        }
+        return true;
+    }
+
+    void insertLocked(Node& parent, std::unique_ptr<Node> node) {
+        const std::string shortName = makeShortName(node->hostName, [&parent](const std::string& name) {
+            return parent.children.find(name) != parent.children.end();
+        });
+        parent.shortNames[node->hostName] = shortName;
+        parent.children[shortName] = std::move(node);
+    }
+
+    std::unique_ptr<Node> detachLocked(Node& parent, const std::string& hostName) {
+        const auto shortName = parent.shortNames.find(hostName);
+        if (shortName == parent.shortNames.end()) {
+            return nullptr;
+        }
+        const auto child = parent.children.find(shortName->second);
+        std::unique_ptr<Node> node = std::move(child->second);
+        parent.children.erase(child);
+        parent.shortNames.erase(shortName);
+        return node;
+    }
+
+    void unloadLocked(Node& node) {
+        node.children.clear();
+        node.shortNames.clear();
+        node.loaded = false;
+    }
+
+    /**
+     * Loaded directory holding a host path, or nullptr if the path is
+     * outside the drive or any directory on the way has not been listed
+     * (and load is false)
+     */
+    Node* parentForLocked(const std::string& hostPath, bool load, std::string& parentPath) {
+        const std::string path = trimmed(hostPath);
+        if (path.size() <= m_root.size() + 1 || path.compare(0, m_root.size(), m_root) != 0 ||
+            path[m_root.size()] != '/') {
+            return nullptr;
+        }
+        parentPath = m_root;
+        Node* node = m_rootNode.get();
+        size_t start = m_root.size() + 1;
+        for (;;) {
+            if (load ? !ensureLoadedLocked(*node, parentPath) : !node->loaded) {
+                return nullptr;
+            }
+            const size_t slash = path.find('/', start);
+            if (slash == std::string::npos) {
+                return node;
+            }
+            const std::string name = path.substr(start, slash - start);
+            const auto shortName = node->shortNames.find(name);
+            if (shortName == node->shortNames.end()) {
+                return nullptr;
+            }
+            node = node->children[shortName->second].get();
+            if (!node->isDirectory) {
+                return nullptr;
+            }
+            parentPath += '/';
+            parentPath += name;
+            start = slash + 1;
+        }
+    }
+
+    const std::string m_root;
+    const Loader m_loader;
+
+    mutable std::mutex m_mutex;
+    std::unique_ptr<Node> m_rootNode;
+    Stats m_stats{};
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_SHORT_NAME_INDEX_H
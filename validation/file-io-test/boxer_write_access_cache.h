@@ -0,0 +1,244 @@
+/*
+ * boxer_write_access_cache.h - Cached write-permission decisions
+ *
+ * Caches INT-041 shouldAllowWriteAccessToPath answers so the four write
+ * paths in drive_local.cpp (create, open for write, delete, rename) stop
+ * calling into the host for every file operation.
+ *
+ * ARCHITECTURE:
+ *   - One trie of host path components per mounted drive
+ *   - A decision is stored on the node of the path's containing directory
+ *     and covers that directory's direct entries only; subdirectories are
+ *     asked about separately
+ *   - Misses call the hook once and store its answer; remounts drop the
+ *     drive's trie, and a host policy change can drop one subtree
+ *
+ * CONTRACT:
+ *   The host's answer must depend only on the containing directory, which
+ *   holds for prefix-based policies (protected folders). Paths with "." or
+ *   ".." components, and relative paths, are never cached.
+ *
+ * THREAD SAFETY:
+ *   All methods are thread-safe. The hook is called with the cache lock
+ *   released.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_WRITE_ACCESS_CACHE_H
+#define BOXER_WRITE_ACCESS_CACHE_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class DOS_Drive;
+
+// ============================================================================
+// BoxerWriteAccessCache
+// ============================================================================
+
+class BoxerWriteAccessCache {
+public:
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t uncacheable;
+    };
+
+    static BoxerWriteAccessCache& shared() {
+        static BoxerWriteAccessCache cache;
+        return cache;
+    }
+
+    /**
+     * @brief INT-041 replacement for drive_local.cpp
+     * @param path Host filesystem path being written
+     * @param drive Drive the path belongs to
+     * @param hook Callable `bool(const char* path, DOS_Drive* drive)`, the
+     *        delegate hook, called on a miss
+     * @return true if the write is allowed
+     */
+    template <typename Hook>
+    bool isWriteAllowed(const char* path, DOS_Drive* drive, Hook&& hook) {
+        const std::string_view directory = containingDirectory(path);
+        if (directory.empty()) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.uncacheable;
+            return hook(path, drive);
+        }
+
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const Node* node = findLocked(drive, directory);
+            if (node && node->decision != kUnknown) {
+                ++m_stats.hits;
+                return node->decision == kAllowed;
+            }
+            ++m_stats.misses;
+            generation = m_generation;
+        }
+
+        const bool allowed = hook(path, drive);
+
+        // Don't store an answer the host gave under a policy that has
+        // since been invalidated
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (generation == m_generation) {
+            insertLocked(drive, directory)->decision = allowed ? kAllowed : kDenied;
+        }
+        return allowed;
+    }
+
+    /// Drop every decision for a drive (driveDidMount, driveDidUnmount)
+    void invalidateDrive(DOS_Drive* drive) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+        m_drives.erase(drive);
+    }
+
+    /**
+     * @brief Drop decisions for a directory and everything below it
+     *
+     * Used when the host changes the policy for one folder, e.g. the user
+     * unlocks a game's install directory.
+     */
+    void invalidatePrefix(DOS_Drive* drive, const char* directory) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+        const std::string_view trimmed = trimTrailingSlashes(directory);
+        if (trimmed.empty() || trimmed == "/") {
+            m_drives.erase(drive);
+            return;
+        }
+        const size_t split = trimmed.rfind('/');
+        if (split == std::string_view::npos) {
+            return;
+        }
+        Node* parent = split == 0 ? rootLocked(drive) : findLocked(drive, trimmed.substr(0, split));
+        if (parent) {
+            parent->children.erase(trimmed.substr(split + 1));
+        }
+    }
+
+    /// Drop every decision for every drive (host policy replaced)
+    void invalidateAll() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+        m_drives.clear();
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    static constexpr int8_t kUnknown = -1;
+    static constexpr int8_t kDenied = 0;
+    static constexpr int8_t kAllowed = 1;
+
+    struct Node {
+        std::string name;
+        int8_t decision = kUnknown;
+        // Keys view the child's own name, so lookups never allocate
+        std::unordered_map<std::string_view, std::unique_ptr<Node>> children;
+    };
+
+    static std::string_view trimTrailingSlashes(const char* path) {
+        std::string_view view = path ? path : "";
+        while (view.size() > 1 && view.back() == '/') {
+            view.remove_suffix(1);
+        }
+        return view;
+    }
+
+    // Absolute, dot-free containing directory of path, or empty if the
+    // path must not be cached
+    static std::string_view containingDirectory(const char* path) {
+        const std::string_view view = trimTrailingSlashes(path);
+        if (view.empty() || view.front() != '/') {
+            return {};
+        }
+        const size_t split = view.rfind('/');
+        const std::string_view leaf = view.substr(split + 1);
+        if (leaf.empty() || leaf == "." || leaf == "..") {
+            return {};
+        }
+        const std::string_view directory = split == 0 ? view.substr(0, 1) : view.substr(0, split);
+        bool clean = true;
+        forEachComponent(directory, [&clean](std::string_view component) {
+            clean = component != "." && component != "..";
+            return clean;
+        });
+        return clean ? directory : std::string_view();
+    }
+
+    template <typename Visitor>
+    static void forEachComponent(std::string_view directory, Visitor&& visit) {
+        for (size_t start = 1; start < directory.size();) {
+            size_t end = directory.find('/', start);
+            if (end == std::string_view::npos) {
+                end = directory.size();
+            }
+            if (end > start && !visit(directory.substr(start, end - start))) {
+                return;
+            }
+            start = end + 1;
+        }
+    }
+
+    Node* rootLocked(DOS_Drive* drive) {
+        auto& root = m_drives[drive];
+        if (!root) {
+            root = std::make_unique<Node>();
+        }
+        return root.get();
+    }
+
+    Node* findLocked(DOS_Drive* drive, std::string_view directory) {
+        const auto it = m_drives.find(drive);
+        if (it == m_drives.end()) {
+            return nullptr;
+        }
+        Node* node = it->second.get();
+        forEachComponent(directory, [&node](std::string_view component) {
+            const auto child = node->children.find(component);
+            node = child == node->children.end() ? nullptr : child->second.get();
+            return node != nullptr;
+        });
+        return node;
+    }
+
+    Node* insertLocked(DOS_Drive* drive, std::string_view directory) {
+        Node* node = rootLocked(drive);
+        forEachComponent(directory, [&node](std::string_view component) {
+            auto child = node->children.find(component);
+            if (child == node->children.end()) {
+                auto created = std::make_unique<Node>();
+                created->name = std::string(component);
+                const std::string_view key = created->name;
+                child = node->children.emplace(key, std::move(created)).first;
+            }
+            node = child->second.get();
+            return true;
+        });
+        return node;
+    }
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<DOS_Drive*, std::unique_ptr<Node>> m_drives;
+    uint64_t m_generation = 0;
+    Stats m_stats{};
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_WRITE_ACCESS_CACHE_H
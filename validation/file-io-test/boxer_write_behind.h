@@ -0,0 +1,400 @@
+/*
+ * boxer_write_behind.h - Write-behind buffering for DOS file writes
+ *
+ * DOS programs write save files and logs in tiny chunks, and each chunk
+ * reaching the local drive becomes a small synchronous host write. Write-
+ * behind gathers contiguous writes per handle and hands them to one
+ * background thread, so the emulation thread stops waiting on syscalls.
+ *
+ * ARCHITECTURE:
+ *   - BoxerWriteBehindFile: per-handle buffer of one contiguous run; a
+ *     full buffer, a write elsewhere in the file, or flush() queues it
+ *   - BoxerWriteBehind: one flusher thread writing queued runs in order
+ *     with pwrite()
+ *   - Commit (INT 21h AH=68h) waits for the handle's writes and fsyncs
+ *     before returning, as DOS requires
+ *   - Close waits for the handle's writes, so a program that reopens the
+ *     file at once reads what it wrote, then hands the descriptor to the
+ *     flusher. Only the fsync and the descriptor close are deferred: closed
+ *     files are fsynced together once per sync interval, not one by one.
+ *     At most kMaxPendingCloses descriptors wait; reaching the cap syncs
+ *     the batch at once, and a close that finds it full waits for that
+ *     sync, so an installer closing files in a burst stays well inside the
+ *     descriptor limit (256 by default on macOS)
+ *
+ * ERRORS:
+ *   A failed background write is remembered on the handle and reported by
+ *   its next write, commit or close. Every write has finished by the time
+ *   close returns; the deferred fsync's result is not reported.
+ *
+ * THREAD SAFETY:
+ *   BoxerWriteBehind is thread-safe. A BoxerWriteBehindFile belongs to one
+ *   DOS handle and is not synchronized.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_WRITE_BEHIND_H
+#define BOXER_WRITE_BEHIND_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+// ============================================================================
+// BoxerWriteBehind
+// ============================================================================
+
+class BoxerWriteBehind {
+public:
+    struct Stats {
+        uint64_t runsQueued;      ///< Buffered runs handed to the flusher
+        uint64_t bytesWritten;
+        uint64_t fsyncs;          ///< Commits plus deferred syncs
+        uint64_t syncBatches;     ///< Wake-ups that synced closed files
+        uint64_t fullBatches;     ///< Batches synced early because the cap was reached
+        uint64_t peakPendingCloses;   ///< Most descriptors waiting at once
+        uint64_t failedWrites;
+    };
+
+    /// How long closed files wait so their fsyncs can share one wake-up
+    static constexpr uint32_t kDefaultSyncIntervalMs = 1000;
+    /// Closed descriptors that may wait for their fsync at once
+    static constexpr size_t kMaxPendingCloses = 64;
+
+    static BoxerWriteBehind& shared() {
+        static BoxerWriteBehind flusher;
+        return flusher;
+    }
+
+    explicit BoxerWriteBehind(uint32_t syncIntervalMs = kDefaultSyncIntervalMs)
+        : m_syncInterval(syncIntervalMs),
+          m_thread(&BoxerWriteBehind::run, this) {}
+
+    /// Finishes every queued write and deferred sync
+    ~BoxerWriteBehind() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_workAvailable.notify_all();
+        m_thread.join();
+    }
+
+    BoxerWriteBehind(const BoxerWriteBehind&) = delete;
+    BoxerWriteBehind& operator=(const BoxerWriteBehind&) = delete;
+
+    /**
+     * @brief Write and fsync everything queued so far, including closed
+     *        files, before returning (emulator shutdown, save states)
+     */
+    void syncAll() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_syncRequested = true;
+        m_workAvailable.notify_all();
+        m_idle.wait(lock, [this] { return m_jobs.empty() && m_closed.empty() && !m_busy; });
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    friend class BoxerWriteBehindFile;
+
+    // Shared by a handle and its queued runs; guarded by m_mutex
+    struct FileState {
+        int descriptor;
+        size_t pending = 0;
+        int error = 0;
+    };
+
+    struct Job {
+        std::shared_ptr<FileState> file;
+        uint64_t offset;
+        std::vector<uint8_t> data;
+    };
+
+    void submit(const std::shared_ptr<FileState>& file, uint64_t offset, std::vector<uint8_t>&& data) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++file->pending;
+            ++m_stats.runsQueued;
+            m_jobs.push_back(Job{file, offset, std::move(data)});
+        }
+        m_workAvailable.notify_one();
+    }
+
+    /// Wait for the file's queued runs; returns and clears its first error
+    int wait(const std::shared_ptr<FileState>& file) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_jobDone.wait(lock, [&file] { return file->pending == 0; });
+        return takeError(*file);
+    }
+
+    int takeError(FileState& file) {
+        const int error = file.error;
+        file.error = 0;
+        return error;
+    }
+
+    int collectError(const std::shared_ptr<FileState>& file) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return takeError(*file);
+    }
+
+    void noteFsync() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.fsyncs;
+    }
+
+    /// Take over the file's descriptor; it is fsynced and closed later
+    void deferClose(const std::shared_ptr<FileState>& file) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            // Counts the batch being synced too: its descriptors are still open
+            m_closeRoom.wait(lock, [this] { return m_pendingCloses < kMaxPendingCloses; });
+            ++m_pendingCloses;
+            m_stats.peakPendingCloses = std::max<uint64_t>(m_stats.peakPendingCloses, m_pendingCloses);
+            if (m_closed.empty()) {
+                m_syncDeadline = std::chrono::steady_clock::now() + m_syncInterval;
+            }
+            m_closed.push_back(file);
+        }
+        m_workAvailable.notify_one();
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            if (!m_jobs.empty()) {
+                Job job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+                m_busy = true;
+                lock.unlock();
+                const int error = writeAll(job.file->descriptor, job.offset, job.data);
+                lock.lock();
+                m_busy = false;
+                if (error) {
+                    ++m_stats.failedWrites;
+                    if (!job.file->error) {
+                        job.file->error = error;
+                    }
+                } else {
+                    m_stats.bytesWritten += job.data.size();
+                }
+                --job.file->pending;
+                m_jobDone.notify_all();
+                continue;
+            }
+
+            // Queue empty: every closed file's writes are done
+            const bool full = m_closed.size() >= kMaxPendingCloses;
+            if (!m_closed.empty() && (m_stopping || m_syncRequested || full ||
+                                      std::chrono::steady_clock::now() >= m_syncDeadline)) {
+                m_stats.fullBatches += full ? 1 : 0;
+                syncClosedLocked(lock);
+                continue;
+            }
+            if (m_stopping) {
+                break;
+            }
+            m_syncRequested = false;
+            m_idle.notify_all();
+
+            if (m_closed.empty()) {
+                m_workAvailable.wait(lock);
+            } else {
+                m_workAvailable.wait_until(lock, m_syncDeadline);
+            }
+        }
+        m_idle.notify_all();
+    }
+
+    void syncClosedLocked(std::unique_lock<std::mutex>& lock) {
+        std::vector<std::shared_ptr<FileState>> closed(m_closed.begin(), m_closed.end());
+        m_closed.clear();
+        m_busy = true;
+        lock.unlock();
+        for (const auto& file : closed) {
+            fsync(file->descriptor);
+            ::close(file->descriptor);
+        }
+        lock.lock();
+        m_busy = false;
+        m_pendingCloses -= closed.size();
+        m_stats.fsyncs += closed.size();
+        ++m_stats.syncBatches;
+        m_closeRoom.notify_all();
+    }
+
+    static int writeAll(int descriptor, uint64_t offset, const std::vector<uint8_t>& data) {
+        size_t done = 0;
+        while (done < data.size()) {
+            const ssize_t written = pwrite(descriptor, data.data() + done, data.size() - done,
+                                           static_cast<off_t>(offset + done));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errno;
+            }
+            done += static_cast<size_t>(written);
+        }
+        return 0;
+    }
+
+    const std::chrono::milliseconds m_syncInterval;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_jobDone;
+    std::condition_variable m_idle;
+    std::condition_variable m_closeRoom;
+    std::deque<Job> m_jobs;
+    std::deque<std::shared_ptr<FileState>> m_closed;
+    size_t m_pendingCloses = 0;   ///< m_closed plus the batch being synced
+    bool m_busy = false;
+    bool m_stopping = false;
+    bool m_syncRequested = false;
+    std::chrono::steady_clock::time_point m_syncDeadline;
+    Stats m_stats{};
+
+    std::thread m_thread;   // last: starts after everything above exists
+};
+
+// ============================================================================
+// BoxerWriteBehindFile
+// ============================================================================
+
+class BoxerWriteBehindFile {
+public:
+    /// Largest run gathered before it is queued
+    static constexpr size_t kDefaultBufferSize = 64 * 1024;
+
+    /**
+     * @param flusher Background writer
+     * @param descriptor Writable descriptor; the handle takes ownership
+     * @param bufferSize Largest run gathered before it is queued
+     */
+    BoxerWriteBehindFile(BoxerWriteBehind& flusher, int descriptor,
+                         size_t bufferSize = kDefaultBufferSize)
+        : m_flusher(flusher),
+          m_file(std::make_shared<BoxerWriteBehind::FileState>()),
+          m_bufferSize(bufferSize) {
+        m_file->descriptor = descriptor;
+        m_buffer.reserve(m_bufferSize);
+    }
+
+    /// Closes if close() was not called; errors are then lost
+    ~BoxerWriteBehindFile() {
+        if (!m_closed) {
+            close();
+        }
+    }
+
+    BoxerWriteBehindFile(const BoxerWriteBehindFile&) = delete;
+    BoxerWriteBehindFile& operator=(const BoxerWriteBehindFile&) = delete;
+
+    /**
+     * @brief Buffer a write at an absolute file offset
+     * @return false (errno set) if an earlier background write failed
+     */
+    bool write(const void* data, size_t length, uint64_t offset) {
+        if (!reportError(m_flusher.collectError(m_file))) {
+            return false;
+        }
+        if (!m_buffer.empty() && offset != m_bufferOffset + m_buffer.size()) {
+            flush();
+        }
+        if (m_buffer.empty()) {
+            m_bufferOffset = offset;
+        }
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + length);
+        if (m_buffer.size() >= m_bufferSize) {
+            flush();
+        }
+        return true;
+    }
+
+    /// Queue the buffered run without waiting for it
+    void flush() {
+        if (m_buffer.empty()) {
+            return;
+        }
+        std::vector<uint8_t> run;
+        run.reserve(m_bufferSize);
+        run.swap(m_buffer);
+        m_flusher.submit(m_file, m_bufferOffset, std::move(run));
+    }
+
+    /**
+     * @brief Wait until every write so far has reached the host file, so
+     *        the descriptor can be read, stat'd or truncated directly
+     */
+    bool drain() {
+        flush();
+        return reportError(m_flusher.wait(m_file));
+    }
+
+    /// INT 21h AH=68h: everything written so far is on disk on return
+    bool commit() {
+        if (!drain()) {
+            return false;
+        }
+        m_flusher.noteFsync();
+        return fsync(m_file->descriptor) == 0;
+    }
+
+    /**
+     * @brief Handle close: wait for the remaining writes, defer the fsync
+     * @return false (errno set) if any write failed
+     */
+    bool close() {
+        if (m_closed) {
+            return true;
+        }
+        m_closed = true;
+        flush();
+        const int error = m_flusher.wait(m_file);
+        m_flusher.deferClose(m_file);
+        return reportError(error);
+    }
+
+    int descriptor() const { return m_file->descriptor; }
+
+private:
+    static bool reportError(int error) {
+        if (error) {
+            errno = error;
+            return false;
+        }
+        return true;
+    }
+
+    BoxerWriteBehind& m_flusher;
+    std::shared_ptr<BoxerWriteBehind::FileState> m_file;
+    const size_t m_bufferSize;
+    std::vector<uint8_t> m_buffer;
+    uint64_t m_bufferOffset = 0;
+    bool m_closed = false;
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_WRITE_BEHIND_H
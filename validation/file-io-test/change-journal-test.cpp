@@ -0,0 +1,356 @@
+/*
+ * change-journal-test.cpp - Coalesced file change journal test suite
+ *
+ * Validates BoxerChangeJournal, the batching layer for:
+ * - INT-044: didCreateLocalFile
+ * - INT-045: didRemoveLocalFile
+ *
+ * Test cases:
+ * 1. Events coalesced per drive and path; last change wins
+ * 2. Batches delivered off the emulation thread
+ * 3. A long storm still delivered every window
+ * 4. Full batches delivered early
+ * 5. flush() and destruction deliver everything pending
+ * 6. Installer workload: host callbacks and emulation-thread cost
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_change_journal.h"
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Change = BoxerChangeJournal::Change;
+using Batch = BoxerChangeJournal::Batch;
+
+namespace {
+
+DOS_Drive* const kDriveC = reinterpret_cast<DOS_Drive*>(0x1000);
+DOS_Drive* const kDriveD = reinterpret_cast<DOS_Drive*>(0x2000);
+
+// Collects delivered batches for inspection
+class Recorder {
+public:
+    void operator()(const Batch& batch) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_batches.push_back(batch);
+    }
+
+    std::vector<Batch> batches() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_batches;
+    }
+
+    size_t count() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_batches.size();
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<Batch> m_batches;
+};
+
+BoxerChangeJournal::Sink sinkFor(Recorder& recorder) {
+    return [&recorder](const Batch& batch) { recorder(batch); };
+}
+
+} // namespace
+
+bool testCoalescing() {
+    std::cout << "\n[TEST 1] Events Coalesced Per Drive And Path; Last Change Wins" << std::endl;
+
+    Recorder recorder;
+    {
+        BoxerChangeJournal journal(sinkFor(recorder), 60000);
+        journal.didCreateLocalFile("/games/KEEN/SAVE1.CK4", kDriveC);
+        journal.didCreateLocalFile("/games/KEEN/SAVE1.CK4", kDriveC);   // rewritten
+        journal.didCreateLocalFile("/games/KEEN/TEMP.$$$", kDriveC);
+        journal.didRemoveLocalFile("/games/KEEN/TEMP.$$$", kDriveC);    // scratch file
+        journal.didRemoveLocalFile("/games/KEEN/CONFIG.CK4", kDriveC);
+        journal.didCreateLocalFile("/games/KEEN/CONFIG.CK4", kDriveC);  // replaced
+        journal.didCreateLocalFile("/games/KEEN/SAVE1.CK4", kDriveD);   // other drive
+        journal.flush();
+    }
+
+    const auto batches = recorder.batches();
+    bool passed = batches.size() == 1;
+    if (passed) {
+        const Batch& batch = batches[0];
+        passed = batch.events == 7 && batch.entries.size() == 4;
+        const struct {
+            DOS_Drive* drive;
+            const char* path;
+            Change change;
+            uint32_t events;
+        } expected[] = {
+            {kDriveC, "/games/KEEN/SAVE1.CK4", Change::Created, 2},
+            {kDriveC, "/games/KEEN/TEMP.$$$", Change::Removed, 2},
+            {kDriveC, "/games/KEEN/CONFIG.CK4", Change::Created, 2},
+            {kDriveD, "/games/KEEN/SAVE1.CK4", Change::Created, 1},
+        };
+        for (size_t i = 0; passed && i < 4; ++i) {
+            const auto& entry = batch.entries[i];
+            passed = entry.drive == expected[i].drive && entry.path == expected[i].path &&
+                     entry.change == expected[i].change && entry.events == expected[i].events;
+        }
+    }
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Batch does not hold one entry per drive and path" << std::endl;
+    } else {
+        std::cout << "  ✓ 7 events → 4 entries, in first-seen order" << std::endl;
+        std::cout << "  ✓ Create+remove → Removed; remove+create → Created; drives kept apart" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testOffThread() {
+    std::cout << "\n[TEST 2] Batches Delivered Off The Emulation Thread" << std::endl;
+
+    // A sink as slow as a busy main thread must not hold up record()
+    std::atomic<int> delivered{0};
+    std::atomic<bool> sinkBusy{false};
+    std::thread::id sinkThread;   // read after flush(), which orders it
+    BoxerChangeJournal journal([&](const Batch&) {
+        sinkThread = std::this_thread::get_id();
+        sinkBusy = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        ++delivered;
+    }, 10);
+
+    journal.didCreateLocalFile("/games/DOOM/DOOMSAV0.DSG", kDriveC);
+    const auto waitStart = std::chrono::steady_clock::now();
+    while (!sinkBusy &&
+           std::chrono::steady_clock::now() - waitStart < std::chrono::seconds(5)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // The sink is now busy; recording must not wait for it
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000; ++i) {
+        journal.didCreateLocalFile(("/games/DOOM/FILE" + std::to_string(i)).c_str(), kDriveC);
+    }
+    const double recordMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    journal.flush();
+
+    const bool passed = sinkThread != std::thread::id() && sinkThread != std::this_thread::get_id() &&
+                        recordMs < 150 && delivered == 2;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Sink ran on the caller or blocked recording (" << recordMs
+                  << " ms, " << delivered << " batches)" << std::endl;
+    } else {
+        std::cout << "  ✓ Sink ran on the journal thread" << std::endl;
+        std::cout << "  ✓ 1,000 events recorded in " << std::fixed << std::setprecision(2) << recordMs
+                  << " ms while the sink was busy" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testWindowNotExtended() {
+    std::cout << "\n[TEST 3] A Long Storm Still Delivered Every Window" << std::endl;
+
+    Recorder recorder;
+    BoxerChangeJournal journal(sinkFor(recorder), 50);
+
+    // 400 ms of continuous events, one every millisecond or so
+    const auto start = std::chrono::steady_clock::now();
+    int events = 0;
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(400)) {
+        journal.didCreateLocalFile(("/games/INSTALL/F" + std::to_string(events++)).c_str(), kDriveC);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const size_t duringStorm = recorder.count();
+    journal.flush();
+
+    uint64_t total = 0;
+    for (const auto& batch : recorder.batches()) {
+        total += batch.events;
+    }
+    const bool passed = duringStorm >= 3 && total == static_cast<uint64_t>(events);
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: " << duringStorm << " batches during the storm, "
+                  << total << "/" << events << " events delivered" << std::endl;
+    } else {
+        std::cout << "  ✓ " << duringStorm << " batches delivered during a 400 ms storm (50 ms window)" << std::endl;
+        std::cout << "  ✓ All " << events << " events accounted for" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testMaxEntries() {
+    std::cout << "\n[TEST 4] Full Batches Delivered Early" << std::endl;
+
+    Recorder recorder;
+    BoxerChangeJournal journal(sinkFor(recorder), 60000, 100);
+    auto waitForBatches = [&recorder](size_t count, std::chrono::milliseconds limit) {
+        const auto start = std::chrono::steady_clock::now();
+        while (recorder.count() < count && std::chrono::steady_clock::now() - start < limit) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return recorder.count();
+    };
+
+    // A full batch goes out without waiting for the minute-long window
+    for (int i = 0; i < 100; ++i) {
+        journal.didCreateLocalFile(("/games/ULTIMA/F" + std::to_string(i)).c_str(), kDriveC);
+    }
+    const size_t atCap = waitForBatches(1, std::chrono::seconds(5));
+
+    // A partial one waits
+    for (int i = 100; i < 150; ++i) {
+        journal.didCreateLocalFile(("/games/ULTIMA/F" + std::to_string(i)).c_str(), kDriveC);
+    }
+    const size_t belowCap = waitForBatches(2, std::chrono::milliseconds(100));
+    journal.flush();
+
+    const auto batches = recorder.batches();
+    const bool passed = atCap == 1 && belowCap == 1 && batches.size() == 2 &&
+                        batches[0].entries.size() == 100 && batches[1].entries.size() == 50;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: " << atCap << " batches at the cap, " << belowCap
+                  << " below it" << std::endl;
+    } else {
+        std::cout << "  ✓ 100-entry batch delivered at the cap, not after the window" << std::endl;
+        std::cout << "  ✓ 50 entries held until flush()" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testFlushAndDestruction() {
+    std::cout << "\n[TEST 5] flush() And Destruction Deliver Everything Pending" << std::endl;
+
+    Recorder recorder;
+    bool passed = true;
+    {
+        BoxerChangeJournal journal(sinkFor(recorder), 60000);
+        journal.didCreateLocalFile("/games/SIMCITY/CITY1.CTY", kDriveC);
+        journal.flush();
+        passed &= recorder.count() == 1;
+
+        journal.flush();   // nothing pending: returns without a batch
+        passed &= recorder.count() == 1;
+
+        journal.didRemoveLocalFile("/games/SIMCITY/CITY1.CTY", kDriveC);
+    }
+    const auto batches = recorder.batches();
+    passed &= batches.size() == 2 && batches[1].entries.size() == 1 &&
+              batches[1].entries[0].change == Change::Removed;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Pending events lost or empty batch delivered" << std::endl;
+    } else {
+        std::cout << "  ✓ flush() delivered at once; empty flush sent nothing" << std::endl;
+        std::cout << "  ✓ Destructor delivered the last event" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testInstallerWorkload() {
+    std::cout << "\n[TEST 6] Installer Workload: Host Callbacks And Emulation-Thread Cost" << std::endl;
+
+    // 20 directories of 250 files, each written to a temp name, removed and
+    // created again under its real name, as many DOS installers do
+    constexpr int kDirectories = 20;
+    constexpr int kFiles = 250;
+    std::vector<std::string> finals;
+    std::vector<std::string> temps;
+    for (int d = 0; d < kDirectories; ++d) {
+        for (int f = 0; f < kFiles; ++f) {
+            const std::string directory = "/games/WING/DIR" + std::to_string(d) + "/";
+            finals.push_back(directory + "FILE" + std::to_string(f) + ".DAT");
+            temps.push_back(directory + "~INST" + std::to_string(f) + ".TMP");
+        }
+    }
+
+    Recorder recorder;
+    uint64_t events = 0;
+    double recordNs = 0;
+    {
+        BoxerChangeJournal journal(sinkFor(recorder));
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < finals.size(); ++i) {
+            journal.didCreateLocalFile(temps[i].c_str(), kDriveC);
+            journal.didCreateLocalFile(finals[i].c_str(), kDriveC);
+            journal.didRemoveLocalFile(temps[i].c_str(), kDriveC);
+            journal.didCreateLocalFile(finals[i].c_str(), kDriveC);
+            events += 4;
+        }
+        recordNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                   static_cast<double>(events);
+        journal.flush();
+    }
+
+    // Final state per path
+    std::map<std::string, Change> state;
+    uint64_t delivered = 0;
+    for (const auto& batch : recorder.batches()) {
+        delivered += batch.events;
+        for (const auto& entry : batch.entries) {
+            state[entry.path] = entry.change;
+        }
+    }
+    bool passed = delivered == events && state.size() == finals.size() + temps.size();
+    for (size_t i = 0; passed && i < finals.size(); ++i) {
+        passed = state[finals[i]] == Change::Created && state[temps[i]] == Change::Removed;
+    }
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "  Events:          " << events << " (" << events << " host callbacks without the journal)" << std::endl;
+    std::cout << "  Batches:         " << recorder.count() << std::endl;
+    std::cout << "  record() cost:   " << recordNs << " ns/event on the emulation thread" << std::endl;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Final state per path wrong after coalescing" << std::endl;
+    } else {
+        std::cout << "  ✓ Every file Created, every temp file Removed" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Change Journal Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-044/INT-045 change batching" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testCoalescing()) passed++; else failed++;
+    if (testOffThread()) passed++; else failed++;
+    if (testWindowNotExtended()) passed++; else failed++;
+    if (testMaxEntries()) passed++; else failed++;
+    if (testFlushAndDestruction()) passed++; else failed++;
+    if (testInstallerWorkload()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
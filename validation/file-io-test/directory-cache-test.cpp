@@ -0,0 +1,303 @@
+/*
+ * directory-cache-test.cpp - Directory snapshot cache test suite
+ *
+ * Validates BoxerDirectorySnapshotCache, the replacement for per-entry
+ * directory enumeration hooks:
+ * - INT-054: openLocalDirectory
+ * - INT-055: closeLocalDirectory
+ * - INT-056: getNextDirectoryEntry
+ *
+ * Test cases:
+ * 1. Snapshot matches the directory contents
+ * 2. Repeat enumerations are served from the cache
+ * 3. Emulator-side invalidation forces a reload
+ * 4. Host-side changes picked up by the watcher
+ * 5. Least recently used directories evicted
+ * 6. Enumeration cost vs per-entry hook calls
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_directory_cache.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+
+namespace fs = std::filesystem;
+
+using Snapshot = BoxerDirectorySnapshotCache::Snapshot;
+
+namespace {
+
+class TempTree {
+public:
+    TempTree() {
+        m_root = fs::temp_directory_path() /
+                 ("boxer-dircache-test-" + std::to_string(std::chrono::steady_clock::now()
+                                                             .time_since_epoch().count()));
+        fs::create_directories(m_root / "GAME" / "DATA");
+        for (int i = 0; i < 5000; ++i) {
+            std::ofstream(m_root / "GAME" / "DATA" / ("FILE" + std::to_string(i) + ".DAT"));
+        }
+        std::ofstream(m_root / "GAME" / "GAME.EXE");
+        fs::create_directories(m_root / "GAME" / "SAVES");
+    }
+
+    ~TempTree() {
+        std::error_code error;
+        fs::remove_all(m_root, error);
+    }
+
+    std::string path(const char* relative) const { return (m_root / relative).string(); }
+
+private:
+    fs::path m_root;
+};
+
+bool contains(const Snapshot& snapshot, const char* name, bool isDirectory) {
+    for (const auto& entry : snapshot) {
+        if (entry.name == name) {
+            return entry.isDirectory == isDirectory;
+        }
+    }
+    return false;
+}
+
+// Legacy model: one virtual call per entry, each copying into a 256-byte buffer
+class LegacyDirectoryDelegate {
+public:
+    virtual ~LegacyDirectoryDelegate() = default;
+
+    virtual void* openLocalDirectory(const char* path) {
+        return opendir(path);
+    }
+    virtual void closeLocalDirectory(void* handle) {
+        closedir(static_cast<DIR*>(handle));
+    }
+    virtual bool getNextDirectoryEntry(void* handle, char* outName, bool& isDirectory) {
+        const dirent* entry = readdir(static_cast<DIR*>(handle));
+        if (!entry) {
+            return false;
+        }
+        std::strncpy(outName, entry->d_name, 256);
+        isDirectory = entry->d_type == DT_DIR;
+        return true;
+    }
+};
+
+} // namespace
+
+bool testSnapshotContents(const TempTree& tree) {
+    std::cout << "\n[TEST 1] Snapshot Matches The Directory Contents" << std::endl;
+
+    BoxerDirectorySnapshotCache cache;
+    const auto snapshot = cache.acquire(tree.path("GAME"));
+
+    // ".", "..", GAME.EXE, DATA, SAVES
+    const bool passed = snapshot && snapshot->size() == 5 &&
+                        contains(*snapshot, "GAME.EXE", false) &&
+                        contains(*snapshot, "DATA", true) &&
+                        contains(*snapshot, "SAVES", true) &&
+                        contains(*snapshot, "..", true) &&
+                        !cache.acquire(tree.path("MISSING"));
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Snapshot does not match readdir()" << std::endl;
+    } else {
+        std::cout << "  ✓ Names and directory flags match" << std::endl;
+        std::cout << "  ✓ Missing directory yields no snapshot" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testCacheHits(const TempTree& tree) {
+    std::cout << "\n[TEST 2] Repeat Enumerations Served From The Cache" << std::endl;
+
+    BoxerDirectorySnapshotCache cache;
+    int loads = 0;
+    auto countingLoader = [&loads](const std::string& path, Snapshot& out) {
+        ++loads;
+        return BoxerDirectorySnapshotCache::readDirectory(path, out);
+    };
+
+    const auto first = cache.acquire(tree.path("GAME/DATA"), countingLoader);
+    for (int i = 0; i < 99; ++i) {
+        cache.acquire(tree.path("GAME/DATA/"), countingLoader);
+    }
+    const auto stats = cache.stats();
+
+    const bool passed = loads == 1 && stats.hits == 99 && stats.misses == 1 &&
+                        first && first->size() == 5002;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Expected 1 load and 99 hits, got " << loads << " loads" << std::endl;
+    } else {
+        std::cout << "  ✓ 100 enumerations of 5,002 entries, 1 directory read" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testInvalidation(const TempTree& tree) {
+    std::cout << "\n[TEST 3] Emulator-Side Invalidation Forces A Reload" << std::endl;
+
+    // No watcher, so only explicit invalidation can refresh the listing
+    BoxerDirectorySnapshotCache cache(16, false);
+    const auto before = cache.acquire(tree.path("GAME/SAVES"));
+
+    std::ofstream(tree.path("GAME/SAVES/SAVE0.SAV"));
+    const auto stale = cache.acquire(tree.path("GAME/SAVES"));
+    cache.invalidate(tree.path("GAME/SAVES"));
+    const auto after = cache.acquire(tree.path("GAME/SAVES"));
+
+    const bool passed = before && stale == before && after &&
+                        !contains(*before, "SAVE0.SAV", false) &&
+                        contains(*after, "SAVE0.SAV", false) &&
+                        cache.stats().invalidations == 1;
+    fs::remove(tree.path("GAME/SAVES/SAVE0.SAV"));
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: New file not visible after invalidate()" << std::endl;
+    } else {
+        std::cout << "  ✓ Earlier snapshot unchanged, reload sees SAVE0.SAV" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testWatcher(const TempTree& tree) {
+    std::cout << "\n[TEST 4] Host-Side Changes Picked Up By The Watcher" << std::endl;
+
+    BoxerDirectorySnapshotCache cache;
+    if (!cache.isWatching()) {
+        std::cout << "  - No directory watcher on this platform, skipped" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+        return true;
+    }
+
+    cache.acquire(tree.path("GAME"));
+    cache.acquire(tree.path("GAME/DATA"));
+    std::ofstream(tree.path("GAME/README.TXT"));
+
+    const size_t invalidated = cache.processChanges();
+    const auto refreshed = cache.acquire(tree.path("GAME"));
+    const bool data_kept = cache.stats().hits == 0 && cache.size() == 2;
+
+    fs::remove(tree.path("GAME/README.TXT"));
+    cache.processChanges();
+
+    const bool passed = invalidated == 1 && refreshed &&
+                        contains(*refreshed, "README.TXT", false) && data_kept;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Watcher did not invalidate exactly the changed directory" << std::endl;
+    } else {
+        std::cout << "  ✓ Create in GAME invalidated GAME only" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testEviction(const TempTree& tree) {
+    std::cout << "\n[TEST 5] Least Recently Used Directories Evicted" << std::endl;
+
+    BoxerDirectorySnapshotCache cache(2);
+    const auto game = cache.acquire(tree.path("GAME"));
+    cache.acquire(tree.path("GAME/DATA"));
+    cache.acquire(tree.path("GAME"));         // GAME now most recent
+    cache.acquire(tree.path("GAME/SAVES"));   // evicts DATA
+    cache.acquire(tree.path("GAME"));         // still cached
+    const auto stats = cache.stats();
+
+    const bool passed = cache.size() == 2 && stats.evictions == 1 &&
+                        stats.hits == 2 && stats.misses == 3 &&
+                        game && game->size() == 5;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Wrong directory evicted" << std::endl;
+    } else {
+        std::cout << "  ✓ DATA evicted, GAME kept; held snapshots stay valid" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testEnumerationCost(const TempTree& tree) {
+    std::cout << "\n[TEST 6] Enumeration Cost vs Per-Entry Hook Calls" << std::endl;
+
+    const std::string data = tree.path("GAME/DATA");
+    const int scans = 50;
+
+    std::unique_ptr<LegacyDirectoryDelegate> delegate(new LegacyDirectoryDelegate());
+    size_t legacy_entries = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < scans; ++i) {
+        void* handle = delegate->openLocalDirectory(data.c_str());
+        char name[256];
+        bool isDirectory = false;
+        while (delegate->getNextDirectoryEntry(handle, name, isDirectory)) {
+            ++legacy_entries;
+        }
+        delegate->closeLocalDirectory(handle);
+    }
+    const double legacy_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    BoxerDirectorySnapshotCache cache;
+    size_t cached_entries = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < scans; ++i) {
+        const auto snapshot = cache.acquire(data);
+        for (const auto& entry : *snapshot) {
+            cached_entries += entry.name.empty() ? 0 : 1;
+        }
+    }
+    const double cached_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "  " << scans << " scans of 5,002 entries" << std::endl;
+    std::cout << "  Per-entry hooks: " << legacy_ms << " ms" << std::endl;
+    std::cout << "  Snapshot cache:  " << cached_ms << " ms" << std::endl;
+
+    const bool passed = legacy_entries == cached_entries && cached_ms < legacy_ms;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Entry counts differ or cache is slower" << std::endl;
+    } else {
+        std::cout << "  ✓ Speedup: " << legacy_ms / cached_ms << "x" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Directory Cache Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-054, INT-055, INT-056 replacement" << std::endl;
+
+    TempTree tree;
+    int passed = 0;
+    int failed = 0;
+
+    if (testSnapshotContents(tree)) passed++; else failed++;
+    if (testCacheHits(tree)) passed++; else failed++;
+    if (testInvalidation(tree)) passed++; else failed++;
+    if (testWatcher(tree)) passed++; else failed++;
+    if (testEviction(tree)) passed++; else failed++;
+    if (testEnumerationCost(tree)) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
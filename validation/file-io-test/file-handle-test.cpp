@@ -0,0 +1,342 @@
+/*
+ * file-handle-test.cpp - Local file backend test suite
+ *
+ * Validates BoxerFileHandle, the DOS file handle backend behind:
+ * - INT-046: openLocalFile
+ *
+ * Test cases:
+ * 1. Large read-only files mapped; contents match
+ * 2. Writable, small and special files stay on stdio
+ * 3. Mapped and stdio handles agree on seeks and reads
+ * 4. Writes rejected on mapped handles; stdio read/write mix
+ * 5. Sequential read throughput vs stdio
+ * 6. Truncation through another handle drops the mapping
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_file_handle.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using Backend = BoxerFileHandle::Backend;
+
+namespace {
+
+class TempTree {
+public:
+    TempTree() {
+        m_root = fs::temp_directory_path() /
+                 ("boxer-filehandle-test-" + std::to_string(std::chrono::steady_clock::now()
+                                                               .time_since_epoch().count()));
+        fs::create_directories(m_root);
+    }
+
+    ~TempTree() {
+        std::error_code error;
+        fs::remove_all(m_root, error);
+    }
+
+    // File whose byte at offset i is pattern(i)
+    std::string makeFile(const char* name, size_t size) const {
+        const fs::path path = m_root / name;
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = pattern(i);
+        }
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(data.data()),
+                                                    static_cast<std::streamsize>(size));
+        return path.string();
+    }
+
+    static uint8_t pattern(uint64_t offset) {
+        return static_cast<uint8_t>((offset * 131) ^ (offset >> 11));
+    }
+
+private:
+    fs::path m_root;
+};
+
+bool matchesPattern(const uint8_t* data, size_t length, uint64_t offset) {
+    for (size_t i = 0; i < length; ++i) {
+        if (data[i] != TempTree::pattern(offset + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool testMappedRead(const TempTree& tree) {
+    std::cout << "\n[TEST 1] Large Read-Only Files Mapped; Contents Match" << std::endl;
+
+    const size_t size = 3 * 1024 * 1024 + 17;
+    const std::string path = tree.makeFile("MOVIE.FMV", size);
+    int opens = 0;
+    auto hook = [&opens](const char* p, const char* m) { ++opens; return std::fopen(p, m); };
+
+    auto handle = BoxerFileHandle::open(path.c_str(), "rb", hook);
+    bool passed = handle && opens == 1 && handle->backend() == Backend::Mapped &&
+                  handle->size() == size && handle->mappedData() != nullptr;
+
+    // DOS-sized reads (under 64 KiB) across the whole file
+    std::vector<uint8_t> buffer(0xFFFF);
+    uint64_t offset = 0;
+    while (passed) {
+        const size_t count = handle->read(buffer.data(), buffer.size());
+        if (count == 0) {
+            break;
+        }
+        passed &= matchesPattern(buffer.data(), count, offset);
+        offset += count;
+    }
+    passed &= offset == size && handle->position() == size;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Mapped handle missing or contents differ at " << offset << std::endl;
+    } else {
+        std::cout << "  ✓ 3 MiB file mapped through the hook and read back intact" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testFallbacks(const TempTree& tree) {
+    std::cout << "\n[TEST 2] Writable, Small And Special Files Stay On Stdio" << std::endl;
+
+    const std::string large = tree.makeFile("LARGE.DAT", 1024 * 1024);
+    const std::string small = tree.makeFile("SMALL.CFG", 512);
+
+    bool passed = true;
+    for (const char* mode : {"r+b", "wb+", "ab", "a+b"}) {
+        const std::string copy = tree.makeFile((std::string("W") + mode[0] + ".DAT").c_str(), 1024 * 1024);
+        auto handle = BoxerFileHandle::open(copy.c_str(), mode);
+        passed &= handle && handle->backend() == Backend::Stdio;
+    }
+
+    auto smallHandle = BoxerFileHandle::open(small.c_str(), "rb");
+    passed &= smallHandle && smallHandle->backend() == Backend::Stdio;
+
+    auto device = BoxerFileHandle::open("/dev/zero", "rb", &BoxerFileHandle::hostOpen, 0);
+    uint8_t bytes[16] = {1};
+    passed &= device && device->backend() == Backend::Stdio &&
+              device->read(bytes, sizeof(bytes)) == sizeof(bytes) && bytes[0] == 0;
+
+    auto refused = BoxerFileHandle::open(large.c_str(), "rb",
+                                         [](const char*, const char*) -> FILE* { errno = EACCES; return nullptr; });
+    passed &= !refused && errno == EACCES;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: A non-mappable file was mapped or a refusal was lost" << std::endl;
+    } else {
+        std::cout << "  ✓ Writable modes, 512-byte file and /dev/zero on stdio; hook refusal kept" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testBackendAgreement(const TempTree& tree) {
+    std::cout << "\n[TEST 3] Mapped And Stdio Handles Agree On Seeks And Reads" << std::endl;
+
+    const size_t size = 1024 * 1024 + 333;
+    const std::string path = tree.makeFile("LEVELS.DAT", size);
+    auto mapped = BoxerFileHandle::open(path.c_str(), "rb", &BoxerFileHandle::hostOpen, 0);
+    auto stdio = BoxerFileHandle::open(path.c_str(), "rb", &BoxerFileHandle::hostOpen, UINT64_MAX);
+    bool passed = mapped && mapped->backend() == Backend::Mapped &&
+                  stdio && stdio->backend() == Backend::Stdio;
+
+    std::mt19937 random(1993);
+    std::vector<uint8_t> a(0x8000);
+    std::vector<uint8_t> b(0x8000);
+    const int whences[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+    for (int op = 0; op < 2000 && passed; ++op) {
+        const int whence = whences[random() % 3];
+        const int64_t offset = static_cast<int64_t>(random() % (size + 4096)) - 2048 -
+                               (whence == SEEK_END ? static_cast<int64_t>(size) : 0);
+        uint64_t positionA = 0;
+        uint64_t positionB = 0;
+        const bool seekA = mapped->seek(offset, whence, &positionA);
+        const bool seekB = stdio->seek(offset, whence, &positionB);
+        passed &= seekA == seekB && (!seekA || positionA == positionB);
+
+        const size_t length = random() % a.size();
+        const size_t countA = mapped->read(a.data(), length);
+        const size_t countB = stdio->read(b.data(), length);
+        passed &= countA == countB && std::memcmp(a.data(), b.data(), countA) == 0 &&
+                  mapped->position() == stdio->position();
+    }
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Backends diverged" << std::endl;
+    } else {
+        std::cout << "  ✓ 2,000 random seeks (including before start and past end) agree" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testWrites(const TempTree& tree) {
+    std::cout << "\n[TEST 4] Writes Rejected On Mapped Handles; Stdio Read/Write Mix" << std::endl;
+
+    const std::string path = tree.makeFile("SAVE.DAT", 1024 * 1024);
+    bool passed = true;
+    {
+        auto mapped = BoxerFileHandle::open(path.c_str(), "rb");
+        const uint8_t byte = 0xAA;
+        errno = 0;
+        passed &= mapped->write(&byte, 1) == 0 && errno == EBADF;
+    }
+
+    // Read, then write without an explicit seek, as DOS programs do
+    auto handle = BoxerFileHandle::open(path.c_str(), "r+b");
+    uint8_t header[4];
+    const uint8_t patch[4] = {'B', 'O', 'X', 'R'};
+    passed &= handle->read(header, 4) == 4 && matchesPattern(header, 4, 0);
+    passed &= handle->write(patch, 4) == 4 && handle->position() == 8;
+    passed &= handle->read(header, 4) == 4 && matchesPattern(header, 4, 8);
+    passed &= handle->flush();
+
+    auto check = BoxerFileHandle::open(path.c_str(), "rb");
+    uint8_t written[4];
+    check->seek(4, SEEK_SET);
+    passed &= check->read(written, 4) == 4 && std::memcmp(written, patch, 4) == 0;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Mapped write accepted or stdio mix corrupted data" << std::endl;
+    } else {
+        std::cout << "  ✓ Mapped write refused with EBADF; read/write/read on r+b correct" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testThroughput(const TempTree& tree) {
+    std::cout << "\n[TEST 5] Sequential Read Throughput vs Stdio" << std::endl;
+
+    const size_t size = 64 * 1024 * 1024;
+    const std::string path = tree.makeFile("INTRO.VID", size);
+    std::vector<uint8_t> buffer(0x8000);
+
+    auto measure = [&](uint64_t threshold, Backend expected, bool& ok) {
+        double best = 0;
+        for (int pass = 0; pass < 3; ++pass) {
+            auto handle = BoxerFileHandle::open(path.c_str(), "rb", &BoxerFileHandle::hostOpen, threshold);
+            ok &= handle && handle->backend() == expected;
+            if (!ok) {
+                return 0.0;
+            }
+            uint64_t total = 0;
+            uint32_t checksum = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t count; (count = handle->read(buffer.data(), buffer.size())) > 0;) {
+                checksum += buffer[count - 1];
+                total += count;
+            }
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            ok &= total == size && checksum != 0;
+            best = std::max(best, total / (1024.0 * 1024.0) / seconds);
+        }
+        return best;
+    };
+
+    bool passed = true;
+    const double stdioRate = measure(UINT64_MAX, Backend::Stdio, passed);
+    const double mappedRate = measure(0, Backend::Mapped, passed);
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "  Stdio:  " << stdioRate << " MB/s (32 KiB DOS reads, warm cache)" << std::endl;
+    std::cout << "  Mapped: " << mappedRate << " MB/s" << std::endl;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Short read during benchmark" << std::endl;
+    } else {
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testTruncatedByEmulator(const TempTree& tree) {
+    std::cout << "\n[TEST 6] Truncation Through Another Handle Drops The Mapping" << std::endl;
+
+    // A mapped read of a page past the new end would raise SIGBUS
+    const std::string path = tree.makeFile("SCORES.DAT", 1024 * 1024);
+    auto mapped = BoxerFileHandle::open(path.c_str(), "rb");
+    std::vector<uint8_t> buffer(0x8000);
+    bool passed = mapped && mapped->backend() == Backend::Mapped &&
+                  mapped->read(buffer.data(), 4096) == 4096;
+
+    // Zero-length DOS write on an r+b handle
+    auto writer = BoxerFileHandle::open(path.c_str(), "r+b");
+    passed &= writer && writer->seek(8192, SEEK_SET) && writer->truncate();
+    passed &= mapped->backend() == Backend::Stdio && mapped->mappedData() == nullptr &&
+              mapped->position() == 4096;
+    passed &= mapped->read(buffer.data(), buffer.size()) == 4096 &&
+              matchesPattern(buffer.data(), 4096, 4096) && mapped->read(buffer.data(), 1) == 0;
+
+    // FileCreate over a file that is still open and mapped
+    auto again = BoxerFileHandle::open(path.c_str(), "rb", &BoxerFileHandle::hostOpen, 0);
+    passed &= again && again->backend() == Backend::Mapped && again->seek(6000, SEEK_SET);
+    auto created = BoxerFileHandle::open(path.c_str(), "wb+");
+    const uint8_t text[] = "NEW";
+    passed &= created && created->write(text, 3) == 3 && created->flush();
+    passed &= again->backend() == Backend::Stdio && again->read(buffer.data(), buffer.size()) == 0 &&
+              again->seek(0, SEEK_SET) && again->read(buffer.data(), buffer.size()) == 3 &&
+              std::memcmp(buffer.data(), text, 3) == 0;
+
+    // Handles on other files keep their mappings
+    const std::string other = tree.makeFile("OTHER.DAT", 1024 * 1024);
+    auto untouched = BoxerFileHandle::open(other.c_str(), "rb");
+    auto cut = BoxerFileHandle::open(path.c_str(), "wb");
+    passed &= untouched && cut && untouched->backend() == Backend::Mapped;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Mapping kept after truncation or reads wrong afterwards" << std::endl;
+    } else {
+        std::cout << "  ✓ Zero-length write and \"wb+\" reopen move mapped handles to stdio" << std::endl;
+        std::cout << "  ✓ Reads continue at the same position with the file's new contents" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer File Handle Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-046 read backend" << std::endl;
+
+    TempTree tree;
+    int passed = 0;
+    int failed = 0;
+
+    if (testMappedRead(tree)) passed++; else failed++;
+    if (testFallbacks(tree)) passed++; else failed++;
+    if (testBackendAgreement(tree)) passed++; else failed++;
+    if (testWrites(tree)) passed++; else failed++;
+    if (testThroughput(tree)) passed++; else failed++;
+    if (testTruncatedByEmulator(tree)) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
@@ -0,0 +1,201 @@
+/*
+ * file-read-benchmark.cpp - DOS file read throughput benchmark
+ *
+ * Streams a large file through BoxerFileHandle the way DOSBox serves
+ * INT 21h AH=3Fh: each call reads up to CX bytes into dos_copybuf and then
+ * copies them into guest memory at DS:DX. Reports MB/s per DOS read size
+ * for each backend:
+ *
+ *   stdio      - the hook's FILE*, readahead off (the old behaviour)
+ *   readahead  - the FILE* with sequential detection and readahead
+ *   mapped     - the read-only memory mapping
+ *
+ * Before every run the file's pages are dropped from the host cache with
+ * POSIX_FADV_DONTNEED, and the fraction still resident is reported. The
+ * drop only works on disk-backed filesystems; on tmpfs (often the default
+ * temp directory) every run is warm. Use --dir to put the file on a real
+ * disk.
+ *
+ * Usage: ./file-read-benchmark [--dir PATH] [--size MB] [read_size ...]
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_file_handle.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kCopyBufferSize = 0x10000;     // DOSBox dos_copybuf
+constexpr size_t kGuestMemorySize = 1024 * 1024;
+constexpr uint32_t kGuestBuffer = 0x20000;      // DS:DX = 2000:0000
+
+struct Config {
+    const char* name;
+    uint64_t mapThreshold;
+    bool readahead;
+};
+
+// INT 21h AH=3Fh: read CX bytes from handle BX into DS:DX
+uint16_t dosReadFile(BoxerFileHandle& handle, uint8_t* copyBuffer, std::vector<uint8_t>& guest,
+                     uint32_t address, uint16_t count) {
+    const size_t read = handle.read(copyBuffer, count);
+    std::memcpy(guest.data() + address, copyBuffer, read);
+    return static_cast<uint16_t>(read);
+}
+
+bool writeTestFile(const std::string& path, uint64_t size) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> block(1024 * 1024);
+    for (size_t i = 0; i < block.size(); ++i) {
+        block[i] = static_cast<uint8_t>(i * 131 + (i >> 9));
+    }
+    bool ok = true;
+    for (uint64_t written = 0; ok && written < size; written += block.size()) {
+        ok = std::fwrite(block.data(), 1, block.size(), file) == block.size();
+    }
+    // Dirty pages cannot be dropped, so make them clean first
+    ok &= std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+    return std::fclose(file) == 0 && ok;
+}
+
+// Evict the file from the page cache; returns the percentage still resident
+double dropFromCache(const std::string& path, uint64_t size) {
+    const int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return 100.0;
+    }
+#ifdef POSIX_FADV_DONTNEED
+    posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    double resident = 100.0;
+    void* mapping = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_SHARED, descriptor, 0);
+    if (mapping != MAP_FAILED) {
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t pages = (static_cast<size_t>(size) + page - 1) / page;
+#if defined(__APPLE__)
+        std::vector<char> status(pages);
+#else
+        std::vector<unsigned char> status(pages);
+#endif
+        if (mincore(mapping, static_cast<size_t>(size), status.data()) == 0) {
+            size_t count = 0;
+            for (const auto entry : status) {
+                count += entry & 1;
+            }
+            resident = 100.0 * static_cast<double>(count) / static_cast<double>(pages);
+        }
+        munmap(mapping, static_cast<size_t>(size));
+    }
+    ::close(descriptor);
+    return resident;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    fs::path directory = fs::temp_directory_path();
+    uint64_t sizeMB = 256;
+    std::vector<uint16_t> readSizes;
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        if (argument == "--dir" && i + 1 < argc) {
+            directory = argv[++i];
+        } else if (argument == "--size" && i + 1 < argc) {
+            sizeMB = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            const unsigned long value = std::strtoul(argv[i], nullptr, 10);
+            if (value == 0 || value > 0xFFFF) {
+                std::cerr << "Read sizes must be 1-65535 (one INT 21h call)" << std::endl;
+                return 1;
+            }
+            readSizes.push_back(static_cast<uint16_t>(value));
+        }
+    }
+    if (readSizes.empty()) {
+        readSizes = {512, 4096, 32768, 65535};
+    }
+    if (sizeMB == 0) {
+        std::cerr << "--size must be at least 1" << std::endl;
+        return 1;
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer DOS File Read Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    const uint64_t size = sizeMB * 1024 * 1024;
+    const std::string path = (directory / ("boxer-read-benchmark-" +
+                              std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) +
+                              ".DAT")).string();
+    if (!writeTestFile(path, size)) {
+        std::cerr << "Could not create " << path << std::endl;
+        return 1;
+    }
+    std::cout << "\nFile: " << path << " (" << sizeMB << " MiB)" << std::endl;
+    std::cout << "Path: INT 21h AH=3Fh -> dos_copybuf -> guest memory" << std::endl;
+
+    const Config configs[] = {
+        {"stdio", UINT64_MAX, false},
+        {"readahead", UINT64_MAX, true},
+        {"mapped", 0, true},
+    };
+
+    std::vector<uint8_t> copyBuffer(kCopyBufferSize);
+    std::vector<uint8_t> guest(kGuestMemorySize);
+    bool ok = true;
+
+    std::cout << std::fixed;
+    std::cout << "\n  " << std::left << std::setw(8) << "CX" << std::setw(12) << "backend"
+              << std::right << std::setw(10) << "MB/s" << std::setw(12) << "resident" << std::endl;
+    for (const uint16_t readSize : readSizes) {
+        for (const Config& config : configs) {
+            const double resident = dropFromCache(path, size);
+            auto handle = BoxerFileHandle::open(path.c_str(), "rb", &BoxerFileHandle::hostOpen,
+                                                config.mapThreshold);
+            if (!handle) {
+                std::cerr << "Could not open " << path << std::endl;
+                ok = false;
+                break;
+            }
+            handle->setReadahead(config.readahead);
+
+            uint64_t total = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (uint16_t count; (count = dosReadFile(*handle, copyBuffer.data(), guest,
+                                                      kGuestBuffer, readSize)) > 0;) {
+                total += count;
+            }
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            ok &= total == size;
+
+            std::cout << "  " << std::left << std::setw(8) << readSize << std::setw(12) << config.name
+                      << std::right << std::setw(10) << std::setprecision(0)
+                      << total / (1024.0 * 1024.0) / seconds
+                      << std::setw(11) << std::setprecision(1) << resident << "%" << std::endl;
+        }
+    }
+
+    std::error_code error;
+    fs::remove(path, error);
+
+    if (!ok) {
+        std::cerr << "\n❌ Short read during benchmark" << std::endl;
+        return 1;
+    }
+    std::cout << "\nresident: share of the file in the host cache when the run started" << std::endl;
+    return 0;
+}
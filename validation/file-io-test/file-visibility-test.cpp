@@ -0,0 +1,255 @@
+/*
+ * file-visibility-test.cpp - Precompiled hidden-file rule test suite
+ *
+ * Validates BoxerFileVisibilityFilter, the inline replacement for:
+ * - INT-040: shouldShowFileWithName
+ *
+ * Test cases:
+ * 1. Exact, prefix and suffix rules
+ * 2. Default rules: dotfiles hidden, . and .. kept
+ * 3. Dynamic fallback consulted only when enabled
+ * 4. Agreement with a reference hook on generated names
+ * 5. Per-entry cost vs virtual hook
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_file_visibility.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+
+using Verdict = BoxerFileVisibilityFilter::Verdict;
+
+namespace {
+
+// Reference: the documented hook (hide dot files), keeping the "." and
+// ".." entries, plus the Icon\r custom icon from the TASK 5-3 list
+class LegacyVisibilityDelegate {
+public:
+    virtual ~LegacyVisibilityDelegate() = default;
+
+    virtual bool shouldShowFileWithName(const char* name) {
+        if (std::strcmp(name, ".") == 0 || std::strcmp(name, "..") == 0) {
+            return true;
+        }
+        if (name[0] == '.') {
+            return false;
+        }
+        return std::strcmp(name, "Icon\r") != 0;
+    }
+};
+
+std::vector<std::string> makeNames(size_t count) {
+    static const char* samples[] = {
+        "GAME.EXE", "SETUP.CFG", ".DS_Store", "._GAME.EXE", ".Spotlight-V100",
+        "Icon\r", "Icon", ".Trashes", "SAVE01.SAV", ".", "..", "._", ".localized",
+        "README.TXT", ".fseventsd", "DS_Store", ".DS_Store2", "SOUND.DAT",
+        ".git", ".svn", ".hidden", "...", "GAME.",
+    };
+    std::mt19937 rng(4040);
+    std::uniform_int_distribution<size_t> pick(0, sizeof(samples) / sizeof(samples[0]) - 1);
+    std::vector<std::string> names;
+    names.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        names.push_back(samples[pick(rng)]);
+    }
+    return names;
+}
+
+} // namespace
+
+bool testRuleKinds() {
+    std::cout << "\n[TEST 1] Exact, Prefix And Suffix Rules" << std::endl;
+
+    BoxerFileVisibilityFilter filter;
+    filter.hideExact("THUMBS.DB");
+    filter.hidePrefix("~$");
+    filter.hideSuffix(".BAK");
+
+    const bool passed =
+        filter.evaluate("THUMBS.DB") == Verdict::Hidden &&
+        filter.evaluate("THUMBS.DB2") == Verdict::Visible &&
+        filter.evaluate("~$REPORT.DOC") == Verdict::Hidden &&
+        filter.evaluate("~") == Verdict::Visible &&
+        filter.evaluate("CONFIG.BAK") == Verdict::Hidden &&
+        filter.evaluate(".BAK") == Verdict::Hidden &&
+        filter.evaluate("BAK") == Verdict::Visible &&
+        filter.evaluate("config.bak") == Verdict::Visible &&
+        filter.evaluate("") == Verdict::Visible;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Rule matched the wrong names" << std::endl;
+    } else {
+        std::cout << "  ✓ Exact, prefix and suffix match; case-sensitive" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testMacOSDefaults() {
+    std::cout << "\n[TEST 2] Default macOS Metadata Rules" << std::endl;
+
+    BoxerFileVisibilityFilter filter;
+    filter.hideMacOSMetadata();
+
+    bool passed = true;
+    for (const char* name : {".DS_Store", "._GAME.EXE", ".Spotlight-V100", ".Trashes",
+                             ".fseventsd", "Icon\r", ".localized", ".DS_Store2",
+                             ".git", ".svn", "..."}) {
+        if (filter.evaluate(name) != Verdict::Hidden) {
+            std::cerr << "  ✗ FAIL: Not hidden: " << name << std::endl;
+            passed = false;
+        }
+    }
+    for (const char* name : {"GAME.EXE", ".", "..", "Icon", "DS_Store", "GAME."}) {
+        if (filter.evaluate(name) != Verdict::Visible) {
+            std::cerr << "  ✗ FAIL: Wrongly hidden: " << name << std::endl;
+            passed = false;
+        }
+    }
+
+    if (passed) {
+        std::cout << "  ✓ Dotfiles and Icon\\r hidden, DOS files and . / .. visible" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testDynamicFallback() {
+    std::cout << "\n[TEST 3] Dynamic Fallback Consulted Only When Enabled" << std::endl;
+
+    BoxerFileVisibilityFilter filter;
+    filter.hideMacOSMetadata();
+    int calls = 0;
+    auto hideSaves = [&calls](const char* name) {
+        ++calls;
+        return std::strstr(name, ".SAV") == nullptr;
+    };
+
+    bool passed = filter.shouldShow("SAVE01.SAV", hideSaves) && calls == 0;
+
+    filter.setDynamicFallback(true);
+    passed = passed &&
+             !filter.shouldShow("SAVE01.SAV", hideSaves) &&
+             filter.shouldShow("GAME.EXE", hideSaves) &&
+             !filter.shouldShow(".DS_Store", hideSaves) &&
+             calls == 2;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Fallback called for matched names or when disabled" << std::endl;
+    } else {
+        std::cout << "  ✓ Hook skipped when off, and for names a rule already hides" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testReferenceAgreement() {
+    std::cout << "\n[TEST 4] Agreement With Reference Hook" << std::endl;
+
+    BoxerFileVisibilityFilter filter;
+    filter.hideMacOSMetadata();
+    LegacyVisibilityDelegate reference;
+
+    const auto names = makeNames(100000);
+    size_t mismatches = 0;
+    for (const auto& name : names) {
+        const bool expected = reference.shouldShowFileWithName(name.c_str());
+        const bool actual = filter.shouldShow(name.c_str(), [](const char*) { return true; });
+        if (expected != actual) {
+            ++mismatches;
+        }
+    }
+
+    const bool passed = mismatches == 0;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: " << mismatches << " names disagree with the hook" << std::endl;
+    } else {
+        std::cout << "  ✓ 100,000 names, identical visibility" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testEntryCost() {
+    std::cout << "\n[TEST 5] Per-Entry Cost vs Virtual Hook" << std::endl;
+
+    // Typical game folder: mostly DOS names, some metadata
+    std::vector<std::string> names;
+    std::mt19937 rng(4041);
+    const auto metadata = makeNames(100000);
+    for (size_t i = 0; i < 1000000; ++i) {
+        if (i % 10 == 0) {
+            names.push_back(metadata[i / 10]);
+        } else {
+            names.push_back("FILE" + std::to_string(rng() % 100000) + ".DAT");
+        }
+    }
+    std::unique_ptr<LegacyVisibilityDelegate> delegate(new LegacyVisibilityDelegate());
+    BoxerFileVisibilityFilter filter;
+    filter.hideMacOSMetadata();
+
+    size_t legacy_visible = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& name : names) {
+        legacy_visible += delegate->shouldShowFileWithName(name.c_str()) ? 1 : 0;
+    }
+    const double legacy_ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / names.size();
+
+    size_t filter_visible = 0;
+    start = std::chrono::steady_clock::now();
+    for (const auto& name : names) {
+        filter_visible += filter.evaluate(name) == Verdict::Visible ? 1 : 0;
+    }
+    const double filter_ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / names.size();
+
+    std::cout << "  Virtual hook:     " << legacy_ns << " ns per entry" << std::endl;
+    std::cout << "  Compiled rules:   " << filter_ns << " ns per entry" << std::endl;
+
+    // The hook here is an in-process strcmp loop; Boxer's real hook goes
+    // through Objective-C and NSString, so only agreement is asserted
+    const bool passed = legacy_visible == filter_visible;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Visible counts differ" << std::endl;
+    } else {
+        std::cout << "  ✓ " << filter_visible << " visible entries in both" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer File Visibility Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-040 replacement" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testRuleKinds()) passed++; else failed++;
+    if (testMacOSDefaults()) passed++; else failed++;
+    if (testDynamicFallback()) passed++; else failed++;
+    if (testReferenceAgreement()) passed++; else failed++;
+    if (testEntryCost()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
@@ -0,0 +1,329 @@
+/*
+ * path-stat-cache-test.cpp - Path metadata cache test suite
+ *
+ * Validates BoxerPathStatCache, the cache in front of:
+ * - INT-051: getLocalPathStats
+ * - INT-052: localDirectoryExists
+ * - INT-053: localFileExists
+ *
+ * Test cases:
+ * 1. Cached stat matches the host
+ * 2. Missing paths cached negatively
+ * 3. Existence checks share the stat entry
+ * 4. Emulator-side invalidation forces a re-stat
+ * 5. Host-side changes picked up by the watcher
+ * 6. Permission errors never cached; LRU bound respected
+ * 7. Hook calls for a config probe workload
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_path_stat_cache.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class TempTree {
+public:
+    TempTree() {
+        m_root = fs::temp_directory_path() /
+                 ("boxer-statcache-test-" + std::to_string(std::chrono::steady_clock::now()
+                                                              .time_since_epoch().count()));
+        fs::create_directories(m_root / "GAME" / "SAVES");
+        std::ofstream(m_root / "GAME" / "GAME.EXE") << "MZ";
+        std::ofstream(m_root / "GAME" / "SETUP.CFG") << "sound=sb16\n";
+    }
+
+    ~TempTree() {
+        std::error_code error;
+        fs::remove_all(m_root, error);
+    }
+
+    std::string path(const char* relative) const { return (m_root / relative).string(); }
+
+private:
+    fs::path m_root;
+};
+
+// Counts calls into the stand-in delegate hook
+struct CountingStat {
+    int calls = 0;
+
+    bool operator()(const char* path, struct stat* out) {
+        ++calls;
+        return ::stat(path, out) == 0;
+    }
+};
+
+} // namespace
+
+bool testPositiveStat(const TempTree& tree) {
+    std::cout << "\n[TEST 1] Cached Stat Matches The Host" << std::endl;
+
+    BoxerPathStatCache cache;
+    CountingStat hook;
+    const std::string exe = tree.path("GAME/GAME.EXE");
+
+    struct stat expected;
+    ::stat(exe.c_str(), &expected);
+
+    bool passed = true;
+    for (int i = 0; i < 100; ++i) {
+        struct stat status{};
+        passed &= cache.getStats(exe.c_str(), &status, std::ref(hook));
+        passed &= status.st_size == expected.st_size && status.st_ino == expected.st_ino &&
+                  status.st_mode == expected.st_mode;
+    }
+    const auto stats = cache.stats();
+    passed &= hook.calls == 1 && stats.misses == 1 && stats.hits == 99;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Expected 1 hook call and matching results, got "
+                  << hook.calls << " calls" << std::endl;
+    } else {
+        std::cout << "  ✓ 100 stats, 1 hook call, size/inode/mode match" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testNegativeCaching(const TempTree& tree) {
+    std::cout << "\n[TEST 2] Missing Paths Cached Negatively" << std::endl;
+
+    BoxerPathStatCache cache;
+    CountingStat hook;
+    const std::string missing = tree.path("GAME/GAME.INI");
+    const std::string slot = tree.path("GAME/SAVES/SLOT9.SAV");
+
+    bool passed = true;
+    for (int i = 0; i < 50; ++i) {
+        errno = 0;
+        passed &= !cache.getStats(missing.c_str(), nullptr, std::ref(hook)) && errno == ENOENT;
+        passed &= !cache.fileExists(slot.c_str(), std::ref(hook));
+    }
+    const auto stats = cache.stats();
+    passed &= hook.calls == 2 && stats.negativeHits == 98;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Missing paths re-stated or errno lost" << std::endl;
+    } else {
+        std::cout << "  ✓ 100 probes of 2 missing paths, 2 hook calls, ENOENT on every hit" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testExistenceChecks(const TempTree& tree) {
+    std::cout << "\n[TEST 3] Existence Checks Share The Stat Entry" << std::endl;
+
+    BoxerPathStatCache cache;
+    CountingStat hook;
+    const std::string exe = tree.path("GAME/GAME.EXE");
+    const std::string saves = tree.path("GAME/SAVES");
+
+    const bool passed =
+        cache.fileExists(exe.c_str(), std::ref(hook)) &&
+        !cache.directoryExists(exe.c_str(), std::ref(hook)) &&
+        cache.getStats(exe.c_str(), nullptr, std::ref(hook)) &&
+        cache.directoryExists(saves.c_str(), std::ref(hook)) &&
+        !cache.fileExists(saves.c_str(), std::ref(hook)) &&
+        cache.directoryExists((saves + "/").c_str(), std::ref(hook)) &&
+        hook.calls == 2;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Expected one hook call per path, got " << hook.calls << std::endl;
+    } else {
+        std::cout << "  ✓ File/directory checks and stat answered from 2 hook calls" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testEmulatorInvalidation(const TempTree& tree) {
+    std::cout << "\n[TEST 4] Emulator-Side Invalidation Forces A Re-Stat" << std::endl;
+
+    // Watcher off: only explicit invalidation can refresh entries
+    BoxerPathStatCache cache(BoxerPathStatCache::kDefaultCapacity, false);
+    CountingStat hook;
+    const std::string save = tree.path("GAME/SAVES/SLOT1.SAV");
+    const std::string saves = tree.path("GAME/SAVES");
+    const std::string cfg = tree.path("GAME/SETUP.CFG");
+
+    bool passed = !cache.fileExists(save.c_str(), std::ref(hook)) &&
+                  cache.directoryExists(saves.c_str(), std::ref(hook)) &&
+                  cache.fileExists(cfg.c_str(), std::ref(hook));
+
+    // DOS program creates a save: file and its directory re-stated
+    std::ofstream(save) << "slot";
+    cache.invalidate(save.c_str());
+    passed &= cache.fileExists(save.c_str(), std::ref(hook)) &&
+              cache.directoryExists(saves.c_str(), std::ref(hook)) &&
+              cache.fileExists(cfg.c_str(), std::ref(hook)) &&
+              hook.calls == 3 + 2;
+
+    // DOS program deletes the whole folder
+    fs::remove_all(saves);
+    cache.invalidateTree(saves.c_str());
+    passed &= !cache.directoryExists(saves.c_str(), std::ref(hook)) &&
+              !cache.fileExists(save.c_str(), std::ref(hook)) &&
+              cache.fileExists(cfg.c_str(), std::ref(hook)) &&
+              hook.calls == 5 + 2;
+    fs::create_directories(saves);
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Stale entry after invalidation (" << hook.calls << " calls)" << std::endl;
+    } else {
+        std::cout << "  ✓ Created file and emptied folder re-stated; siblings kept" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testHostChanges(const TempTree& tree) {
+    std::cout << "\n[TEST 5] Host-Side Changes Picked Up By The Watcher" << std::endl;
+
+    BoxerPathStatCache cache;
+    if (!cache.isWatching()) {
+        std::cout << "  - No directory watcher on this platform, skipped" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+        return true;
+    }
+
+    const std::string cfg = tree.path("GAME/SETUP.CFG");
+    const std::string added = tree.path("GAME/SAVES/HOST.SAV");
+    const std::string exe = tree.path("GAME/GAME.EXE");
+
+    struct stat before;
+    bool passed = cache.getStats(cfg.c_str(), &before) &&
+                  !cache.fileExists(added.c_str()) &&
+                  cache.fileExists(exe.c_str());
+
+    // Another host process edits the config and drops in a new file
+    std::ofstream(cfg, std::ios::app) << "music=gm\n";
+    std::ofstream(added) << "host";
+
+    struct stat after;
+    passed &= cache.getStats(cfg.c_str(), &after) && after.st_size > before.st_size;
+    passed &= cache.fileExists(added.c_str());
+    passed &= cache.fileExists(exe.c_str());
+    const uint64_t hitsBeforeRemove = cache.stats().hits;
+
+    fs::remove(added);
+    passed &= !cache.fileExists(added.c_str());
+    passed &= cache.stats().hits == hitsBeforeRemove;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Watcher did not invalidate the changed paths" << std::endl;
+    } else {
+        std::cout << "  ✓ Modify, create and delete on the host seen; unchanged sibling kept" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testErrorsAndEviction(const TempTree& tree) {
+    std::cout << "\n[TEST 6] Permission Errors Never Cached; LRU Bound Respected" << std::endl;
+
+    BoxerPathStatCache cache(2);
+    int calls = 0;
+    auto denied = [&calls](const char*, struct stat*) {
+        ++calls;
+        errno = EACCES;
+        return false;
+    };
+
+    const std::string locked = tree.path("GAME/LOCKED.DAT");
+    bool passed = true;
+    for (int i = 0; i < 3; ++i) {
+        errno = 0;
+        passed &= !cache.getStats(locked.c_str(), nullptr, denied) && errno == EACCES;
+    }
+    passed &= calls == 3 && cache.size() == 0;
+
+    CountingStat hook;
+    for (const char* path : {"GAME/GAME.EXE", "GAME/SETUP.CFG", "GAME/SAVES", "GAME/GAME.EXE"}) {
+        cache.getStats(tree.path(path).c_str(), nullptr, std::ref(hook));
+    }
+    const auto stats = cache.stats();
+    passed &= hook.calls == 4 && cache.size() == 2 && stats.evictions == 2;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: EACCES cached or capacity exceeded" << std::endl;
+    } else {
+        std::cout << "  ✓ EACCES re-asked every time; oldest paths evicted at capacity" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testProbeWorkload(const TempTree& tree) {
+    std::cout << "\n[TEST 7] Hook Calls For A Config Probe Workload" << std::endl;
+
+    // A game checking for its config, a missing override and the CD once
+    // per frame for 10 seconds at 70 Hz
+    BoxerPathStatCache cache;
+    CountingStat hook;
+    const std::string cfg = tree.path("GAME/SETUP.CFG");
+    const std::string override = tree.path("GAME/OVERRIDE.CFG");
+    const std::string cd = tree.path("CDROM");
+
+    uint64_t probes = 0;
+    for (int frame = 0; frame < 700; ++frame) {
+        cache.fileExists(cfg.c_str(), std::ref(hook));
+        cache.fileExists(override.c_str(), std::ref(hook));
+        cache.directoryExists(cd.c_str(), std::ref(hook));
+        probes += 3;
+    }
+
+    std::cout << "  Legacy hook calls: " << probes << std::endl;
+    std::cout << "  Cached hook calls: " << hook.calls << std::endl;
+
+    const bool passed = hook.calls == 3;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Expected one call per path" << std::endl;
+    } else {
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Path Stat Cache Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-051/052/053 cache" << std::endl;
+
+    TempTree tree;
+    int passed = 0;
+    int failed = 0;
+
+    if (testPositiveStat(tree)) passed++; else failed++;
+    if (testNegativeCaching(tree)) passed++; else failed++;
+    if (testExistenceChecks(tree)) passed++; else failed++;
+    if (testEmulatorInvalidation(tree)) passed++; else failed++;
+    if (testHostChanges(tree)) passed++; else failed++;
+    if (testErrorsAndEviction(tree)) passed++; else failed++;
+    if (testProbeWorkload(tree)) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
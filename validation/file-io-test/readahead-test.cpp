@@ -0,0 +1,374 @@
+/*
+ * readahead-test.cpp - Stdio readahead test suite
+ *
+ * Validates sequential-read detection and readahead in BoxerFileHandle,
+ * the DOS file handle backend behind:
+ * - INT-046: openLocalFile
+ *
+ * Test cases:
+ * 1. Sequential reads switch to readahead; window grows to the cap
+ * 2. Seeks elsewhere end readahead; position queries do not
+ * 3. Buffered and plain handles agree under a mixed workload
+ * 4. Writes and truncation after buffered reads land at the DOS position
+ * 5. Sector-sized read throughput with and without readahead
+ * 6. Writes through a second handle seen by a buffered reader
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_file_handle.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using Backend = BoxerFileHandle::Backend;
+
+namespace {
+
+class TempTree {
+public:
+    TempTree() {
+        m_root = fs::temp_directory_path() /
+                 ("boxer-readahead-test-" + std::to_string(std::chrono::steady_clock::now()
+                                                               .time_since_epoch().count()));
+        fs::create_directories(m_root);
+    }
+
+    ~TempTree() {
+        std::error_code error;
+        fs::remove_all(m_root, error);
+    }
+
+    // File whose byte at offset i is pattern(i)
+    std::string makeFile(const char* name, size_t size) const {
+        const fs::path path = m_root / name;
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = pattern(i);
+        }
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(data.data()),
+                                                    static_cast<std::streamsize>(size));
+        return path.string();
+    }
+
+    static uint8_t pattern(uint64_t offset) {
+        return static_cast<uint8_t>((offset * 131) ^ (offset >> 11));
+    }
+
+private:
+    fs::path m_root;
+};
+
+bool matchesPattern(const uint8_t* data, size_t length, uint64_t offset) {
+    for (size_t i = 0; i < length; ++i) {
+        if (data[i] != TempTree::pattern(offset + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Keep large read-only files on stdio so readahead is what gets tested
+std::unique_ptr<BoxerFileHandle> openStdio(const std::string& path, const char* mode) {
+    return BoxerFileHandle::open(path.c_str(), mode, &BoxerFileHandle::hostOpen, UINT64_MAX);
+}
+
+} // namespace
+
+bool testSequentialDetection(const TempTree& tree) {
+    std::cout << "\n[TEST 1] Sequential Reads Switch To Readahead; Window Grows To The Cap" << std::endl;
+
+    const size_t size = 8 * 1024 * 1024 + 100;
+    const std::string path = tree.makeFile("CUTSCENE.DAT", size);
+    auto handle = openStdio(path, "rb");
+    bool passed = handle && handle->backend() == Backend::Stdio && handle->readaheadWindow() == 0;
+
+    // 512-byte sector reads, as most DOS loaders issue them
+    uint8_t sector[512];
+    uint64_t offset = 0;
+    size_t largestWindow = 0;
+    bool windowAfterFirstRead = true;
+    while (passed) {
+        const size_t count = handle->read(sector, sizeof(sector));
+        if (offset == 0) {
+            windowAfterFirstRead = handle->readaheadWindow() != 0;
+        }
+        if (count == 0) {
+            break;
+        }
+        passed &= matchesPattern(sector, count, offset);
+        offset += count;
+        largestWindow = std::max(largestWindow, handle->readaheadWindow());
+    }
+    passed &= !windowAfterFirstRead && offset == size && handle->position() == size &&
+              largestWindow == BoxerFileHandle::kMaxReadahead;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Contents differ at " << offset << " or window "
+                  << largestWindow << " is wrong" << std::endl;
+    } else {
+        std::cout << "  ✓ 8 MiB read intact in 512-byte sectors" << std::endl;
+        std::cout << "  ✓ Readahead from the second read, window grew to "
+                  << largestWindow / 1024 << " KiB" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testSeeks(const TempTree& tree) {
+    std::cout << "\n[TEST 2] Seeks Elsewhere End Readahead; Position Queries Do Not" << std::endl;
+
+    const std::string path = tree.makeFile("LEVEL1.MAP", 2 * 1024 * 1024);
+    auto handle = openStdio(path, "rb");
+    uint8_t buffer[4096];
+    bool passed = handle != nullptr;
+    for (int i = 0; i < 4 && passed; ++i) {
+        passed &= handle->read(buffer, sizeof(buffer)) == sizeof(buffer);
+    }
+    passed &= handle->readaheadWindow() != 0;
+
+    // INT 21h AX=4201h CX:DX=0 just reports the position
+    uint64_t position = 0;
+    passed &= handle->seek(0, SEEK_CUR, &position) && position == 4 * sizeof(buffer);
+    passed &= handle->read(buffer, sizeof(buffer)) == sizeof(buffer) &&
+              matchesPattern(buffer, sizeof(buffer), position) && handle->readaheadWindow() != 0;
+
+    // A real jump: back to plain reads until the stream is re-established
+    passed &= handle->seek(1024 * 1024, SEEK_SET);
+    passed &= handle->read(buffer, sizeof(buffer)) == sizeof(buffer) &&
+              matchesPattern(buffer, sizeof(buffer), 1024 * 1024) && handle->readaheadWindow() == 0;
+    passed &= handle->read(buffer, sizeof(buffer)) == sizeof(buffer) &&
+              matchesPattern(buffer, sizeof(buffer), 1024 * 1024 + sizeof(buffer)) &&
+              handle->readaheadWindow() != 0;
+
+    // Turning readahead off drops the buffer but keeps the position
+    handle->setReadahead(false);
+    passed &= handle->readaheadWindow() == 0 &&
+              handle->read(buffer, sizeof(buffer)) == sizeof(buffer) &&
+              matchesPattern(buffer, sizeof(buffer), 1024 * 1024 + 2 * sizeof(buffer)) &&
+              handle->read(buffer, sizeof(buffer)) == sizeof(buffer) && handle->readaheadWindow() == 0;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Readahead state or data wrong around seeks" << std::endl;
+    } else {
+        std::cout << "  ✓ AX=4201h position query kept readahead" << std::endl;
+        std::cout << "  ✓ Jump ended it; two contiguous reads restarted it" << std::endl;
+        std::cout << "  ✓ setReadahead(false) kept data and position intact" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testAgreement(const TempTree& tree) {
+    std::cout << "\n[TEST 3] Buffered And Plain Handles Agree Under A Mixed Workload" << std::endl;
+
+    const size_t size = 3 * 1024 * 1024 + 777;
+    const std::string path = tree.makeFile("RESOURCE.PAK", size);
+    auto buffered = openStdio(path, "rb");
+    auto plain = openStdio(path, "rb");
+    plain->setReadahead(false);
+    bool passed = buffered && plain;
+
+    std::mt19937 random(1994);
+    std::vector<uint8_t> a(0x10000);
+    std::vector<uint8_t> b(0x10000);
+    const int whences[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+    int streamedRuns = 0;
+    for (int op = 0; op < 1500 && passed; ++op) {
+        if (random() % 3 == 0) {
+            const int whence = whences[random() % 3];
+            const int64_t offset = static_cast<int64_t>(random() % (size + 4096)) - 2048 -
+                                   (whence == SEEK_END ? static_cast<int64_t>(size) : 0);
+            uint64_t positionA = 0;
+            uint64_t positionB = 0;
+            const bool seekA = buffered->seek(offset, whence, &positionA);
+            const bool seekB = plain->seek(offset, whence, &positionB);
+            passed &= seekA == seekB && (!seekA || positionA == positionB);
+        }
+
+        // A short run of contiguous reads of one size, up to the DOS maximum
+        const size_t length = 1 + random() % (random() % 2 ? 2048 : a.size() - 1);
+        const int reads = 1 + static_cast<int>(random() % 8);
+        for (int i = 0; i < reads && passed; ++i) {
+            const size_t countA = buffered->read(a.data(), length);
+            const size_t countB = plain->read(b.data(), length);
+            passed &= countA == countB && std::memcmp(a.data(), b.data(), countA) == 0 &&
+                      buffered->position() == plain->position();
+        }
+        streamedRuns += buffered->readaheadWindow() != 0;
+    }
+    passed &= streamedRuns > 0;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Buffered handle diverged from plain stdio" << std::endl;
+    } else {
+        std::cout << "  ✓ 1,500 seek/read runs agree (" << streamedRuns << " ended in readahead)" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testWritesAfterReadahead(const TempTree& tree) {
+    std::cout << "\n[TEST 4] Writes And Truncation After Buffered Reads Land At The DOS Position" << std::endl;
+
+    const std::string path = tree.makeFile("SAVEGAME.DAT", 1024 * 1024);
+    bool passed = true;
+    {
+        auto handle = openStdio(path, "r+b");
+        uint8_t record[512];
+        for (int i = 0; i < 10 && passed; ++i) {
+            passed &= handle->read(record, sizeof(record)) == sizeof(record);
+        }
+        passed &= handle->readaheadWindow() != 0 && handle->position() == 5120;
+
+        // The stream itself is a whole window ahead; the write must not be
+        const uint8_t patch[4] = {'B', 'O', 'X', 'R'};
+        passed &= handle->write(patch, 4) == 4 && handle->position() == 5124;
+        passed &= handle->read(record, 16) == 16 && matchesPattern(record, 16, 5124);
+
+        for (int i = 0; i < 20 && passed; ++i) {
+            passed &= handle->read(record, sizeof(record)) == sizeof(record);
+        }
+        const uint64_t cut = handle->position();
+        passed &= handle->truncate() && handle->size() == cut;
+        passed &= handle->read(record, sizeof(record)) == 0;
+        passed &= handle->close();
+    }
+
+    auto check = openStdio(path, "rb");
+    uint8_t written[4];
+    passed &= check->seek(5120, SEEK_SET) && check->read(written, 4) == 4 &&
+              std::memcmp(written, "BOXR", 4) == 0 && check->size() == 5140 + 20 * 512;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Write or truncate used the readahead position" << std::endl;
+    } else {
+        std::cout << "  ✓ Write after 10 buffered sector reads landed at offset 5120" << std::endl;
+        std::cout << "  ✓ Truncation cut at the DOS position, not the stream's" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testThroughput(const TempTree& tree) {
+    std::cout << "\n[TEST 5] Sector-Sized Read Throughput With And Without Readahead" << std::endl;
+
+    const size_t size = 64 * 1024 * 1024;
+    const std::string path = tree.makeFile("INTRO.VID", size);
+    std::vector<uint8_t> buffer(512);
+
+    auto measure = [&](bool readahead, bool& ok) {
+        double best = 0;
+        for (int pass = 0; pass < 3; ++pass) {
+            auto handle = openStdio(path, "rb");
+            handle->setReadahead(readahead);
+            uint64_t total = 0;
+            uint32_t checksum = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t count; (count = handle->read(buffer.data(), buffer.size())) > 0;) {
+                checksum += buffer[count - 1];
+                total += count;
+            }
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            ok &= total == size && checksum != 0;
+            best = std::max(best, total / (1024.0 * 1024.0) / seconds);
+        }
+        return best;
+    };
+
+    bool passed = true;
+    const double plainRate = measure(false, passed);
+    const double readaheadRate = measure(true, passed);
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "  Plain stdio: " << plainRate << " MB/s (512-byte DOS reads, warm cache)" << std::endl;
+    std::cout << "  Readahead:   " << readaheadRate << " MB/s" << std::endl;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Short read during benchmark" << std::endl;
+    } else {
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testSecondHandleWrites(const TempTree& tree) {
+    std::cout << "\n[TEST 6] Writes Through A Second Handle Seen By A Buffered Reader" << std::endl;
+
+    // A DOS program that streams a file through one handle and patches it
+    // through another, both open at once
+    const std::string path = tree.makeFile("DATABASE.DAT", 4 * 1024 * 1024);
+    auto reader = openStdio(path, "rb");
+    auto writer = openStdio(path, "r+b");
+    uint8_t record[512];
+    bool passed = reader && writer;
+    for (int i = 0; i < 64 && passed; ++i) {
+        passed &= reader->read(record, sizeof(record)) == sizeof(record);
+    }
+    passed &= reader->readaheadWindow() != 0;
+
+    // Ahead of the reader, inside the window it has already buffered
+    const uint64_t start = reader->position();
+    const uint8_t patch[4] = {'B', 'O', 'X', 'R'};
+    passed &= writer->seek(static_cast<int64_t>(start + 1000), SEEK_SET) && writer->write(patch, 4) == 4;
+    passed &= reader->read(record, sizeof(record)) == sizeof(record) &&
+              matchesPattern(record, sizeof(record), start);
+    passed &= reader->read(record, sizeof(record)) == sizeof(record) &&
+              matchesPattern(record, 488, start + 512) && std::memcmp(record + 488, patch, 4) == 0 &&
+              matchesPattern(record + 492, 20, start + 1004);
+    passed &= reader->readaheadWindow() != 0;
+
+    // Truncation through the writer ends the reader's data at the cut
+    const uint64_t cut = reader->position() + 100;
+    passed &= writer->seek(static_cast<int64_t>(cut), SEEK_SET) && writer->truncate();
+    passed &= reader->read(record, sizeof(record)) == 100 && reader->read(record, 1) == 0;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Reader served stale buffered data" << std::endl;
+    } else {
+        std::cout << "  ✓ Patch inside the reader's buffered window read back" << std::endl;
+        std::cout << "  ✓ Truncation through the writer ends the reader at the cut" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Readahead Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-046 stdio readahead" << std::endl;
+
+    TempTree tree;
+    int passed = 0;
+    int failed = 0;
+
+    if (testSequentialDetection(tree)) passed++; else failed++;
+    if (testSeeks(tree)) passed++; else failed++;
+    if (testAgreement(tree)) passed++; else failed++;
+    if (testWritesAfterReadahead(tree)) passed++; else failed++;
+    if (testThroughput(tree)) passed++; else failed++;
+    if (testSecondHandleWrites(tree)) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
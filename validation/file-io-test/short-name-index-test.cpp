@@ -0,0 +1,420 @@
+/*
+ * short-name-index-test.cpp - DOS 8.3 name index test suite
+ *
+ * Validates BoxerShortNameIndex, the per-drive path resolution index for
+ * drive_cache.cpp and the local drive hooks:
+ * - INT-042: driveDidMount (index creation)
+ * - INT-046 - INT-050: open, remove, move, mkdir, rmdir (maintenance)
+ *
+ * Test cases:
+ * 1. Short names: valid names kept, others get stable "~N" tails
+ * 2. Resolution is case-insensitive; error 2 vs error 3
+ * 3. Directories listed lazily, once
+ * 4. Emulator operations update the index without relisting
+ * 5. Host-side changes picked up after invalidation
+ * 6. Resolution cost on a large mount vs directory scans
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_short_name_index.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <strings.h>
+
+namespace fs = std::filesystem;
+
+using Resolution = BoxerShortNameIndex::Resolution;
+
+namespace {
+
+class TempTree {
+public:
+    TempTree() {
+        m_root = fs::temp_directory_path() /
+                 ("boxer-shortname-test-" + std::to_string(std::chrono::steady_clock::now()
+                                                               .time_since_epoch().count()));
+        fs::create_directories(m_root);
+    }
+
+    ~TempTree() {
+        std::error_code error;
+        fs::remove_all(m_root, error);
+    }
+
+    std::string path(const std::string& relative = std::string()) const {
+        return relative.empty() ? m_root.string() : (m_root / relative).string();
+    }
+
+    void makeFile(const std::string& relative) const {
+        const fs::path full = m_root / relative;
+        fs::create_directories(full.parent_path());
+        std::ofstream(full) << relative;
+    }
+
+    void makeDirectory(const std::string& relative) const {
+        fs::create_directories(m_root / relative);
+    }
+
+private:
+    fs::path m_root;
+};
+
+// Short name with only the given names taken
+std::string shortNameAmong(const char* hostName, std::set<std::string> taken) {
+    return BoxerShortNameIndex::makeShortName(hostName, [&taken](const std::string& name) {
+        return taken.count(name) != 0;
+    });
+}
+
+// Directory listing that counts its calls
+struct CountingLoader {
+    int* calls;
+    bool operator()(const std::string& path, BoxerShortNameIndex::Snapshot& out) const {
+        ++*calls;
+        return BoxerDirectorySnapshotCache::readDirectory(path, out);
+    }
+};
+
+} // namespace
+
+bool testShortNames(const TempTree& tree) {
+    std::cout << "\n[TEST 1] Short Names: Valid Names Kept, Others Get Stable \"~N\" Tails" << std::endl;
+
+    bool passed = true;
+    passed &= shortNameAmong("readme.txt", {}) == "README.TXT";
+    passed &= shortNameAmong("KEEN4E.EXE", {}) == "KEEN4E.EXE";
+    passed &= shortNameAmong("Long Filename.text", {}) == "LONGFI~1.TEX";
+    passed &= shortNameAmong("Long Filename.text", {"LONGFI~1.TEX"}) == "LONGFI~2.TEX";
+    passed &= shortNameAmong("archive.tar.gz", {}) == "ARCHIV~1.GZ";
+    passed &= shortNameAmong(".hidden", {}) == "HIDDEN~1";
+    passed &= shortNameAmong("a+b=c.dat", {}) == "A_B_C~1.DAT";
+    passed &= shortNameAmong("SAVE1.CK4", {"SAVE1.CK4"}) == "SAVE1~1.CK4";
+
+    // Ten collisions push the tail into the base
+    std::set<std::string> taken;
+    for (int i = 1; i <= 9; ++i) {
+        taken.insert("DOCUME~" + std::to_string(i) + ".TXT");
+    }
+    passed &= shortNameAmong("Documentation.txt", taken) == "DOCUM~10.TXT";
+
+    // Same names on every load regardless of listing order
+    tree.makeFile("names/Long Filename One.txt");
+    tree.makeFile("names/Long Filename Two.txt");
+    tree.makeFile("names/LONGFI~1.TXT");
+    std::string first;
+    std::string second;
+    for (int load = 0; load < 2; ++load) {
+        BoxerShortNameIndex index(tree.path(), [load](const std::string& path, BoxerShortNameIndex::Snapshot& out) {
+            const bool ok = BoxerDirectorySnapshotCache::readDirectory(path, out);
+            if (load == 1) {
+                std::reverse(out.begin(), out.end());
+            }
+            return ok;
+        });
+        const std::string names = index.shortName(tree.path("names/LONGFI~1.TXT")) + " " +
+                                  index.shortName(tree.path("names/Long Filename One.txt")) + " " +
+                                  index.shortName(tree.path("names/Long Filename Two.txt"));
+        (load == 0 ? first : second) = names;
+    }
+    passed &= first == "LONGFI~1.TXT LONGFI~2.TXT LONGFI~3.TXT" && first == second;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Wrong short name (load order gave \"" << first << "\" / \""
+                  << second << "\")" << std::endl;
+    } else {
+        std::cout << "  ✓ Valid names uppercased; long names truncated with ~N" << std::endl;
+        std::cout << "  ✓ Existing LONGFI~1.TXT kept its name; others numbered around it" << std::endl;
+        std::cout << "  ✓ Same names when the directory lists in reverse order" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testResolution(const TempTree& tree) {
+    std::cout << "\n[TEST 2] Resolution Is Case-Insensitive; Error 2 vs Error 3" << std::endl;
+
+    tree.makeFile("resolve/Games/Commander Keen/save1.ck4");
+    tree.makeFile("resolve/Games/Commander Keen/KEEN4E.EXE");
+    BoxerShortNameIndex index(tree.path("resolve"));
+
+    std::string host;
+    bool passed = true;
+    passed &= index.resolve("GAMES\\COMMAN~1\\SAVE1.CK4", host) == Resolution::Found &&
+              host == tree.path("resolve/Games/Commander Keen/save1.ck4");
+    passed &= index.resolve("games/comman~1/keen4e.exe", host) == Resolution::Found &&
+              host == tree.path("resolve/Games/Commander Keen/KEEN4E.EXE");
+    passed &= index.resolve("GAMES\\COMMAN~1\\", host) == Resolution::Found &&
+              host == tree.path("resolve/Games/Commander Keen");
+    passed &= index.resolve("", host) == Resolution::Found && host == tree.path("resolve");
+    passed &= index.resolve("GAMES\\COMMAN~1\\SAVE2.CK4", host) == Resolution::FileNotFound;
+    passed &= index.resolve("GAMES\\KEEN\\SAVE1.CK4", host) == Resolution::PathNotFound;
+    passed &= index.resolve("GAMES\\COMMAN~1\\KEEN4E.EXE\\X", host) == Resolution::PathNotFound;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Wrong resolution (last host path " << host << ")" << std::endl;
+    } else {
+        std::cout << "  ✓ Mixed case and both separators resolve to the long host names" << std::endl;
+        std::cout << "  ✓ Missing file → FileNotFound; missing directory or file as directory → PathNotFound" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testLazyLoading(const TempTree& tree) {
+    std::cout << "\n[TEST 3] Directories Listed Lazily, Once" << std::endl;
+
+    for (int d = 0; d < 5; ++d) {
+        for (int f = 0; f < 10; ++f) {
+            tree.makeFile("lazy/DIR" + std::to_string(d) + "/FILE" + std::to_string(f) + ".DAT");
+        }
+    }
+    int loads = 0;
+    BoxerShortNameIndex index(tree.path("lazy"), CountingLoader{&loads});
+    bool passed = loads == 0;
+
+    std::string host;
+    for (int pass = 0; pass < 100 && passed; ++pass) {
+        passed &= index.resolve("DIR1\\FILE" + std::to_string(pass % 10) + ".DAT", host) == Resolution::Found;
+        passed &= index.resolve("DIR2\\FILE" + std::to_string(pass % 10) + ".DAT", host) == Resolution::Found;
+    }
+    // Root, DIR1 and DIR2 only
+    passed &= loads == 3 && index.stats().directoryLoads == 3 && index.stats().lookups == 200;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: " << loads << " directory listings for 200 lookups" << std::endl;
+    } else {
+        std::cout << "  ✓ Nothing listed at mount" << std::endl;
+        std::cout << "  ✓ 200 lookups listed 3 of 6 directories, each once" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testMaintenance(const TempTree& tree) {
+    std::cout << "\n[TEST 4] Emulator Operations Update The Index Without Relisting" << std::endl;
+
+    tree.makeFile("ops/SAVES/Old Save Game.sav");
+    tree.makeFile("ops/SAVES/Other Save Game.sav");
+    tree.makeFile("ops/DATA/LEVEL1.MAP");
+    int loads = 0;
+    BoxerShortNameIndex index(tree.path("ops"), CountingLoader{&loads});
+    std::string host;
+    bool passed = index.resolve("SAVES\\OTHERS~1.SAV", host) == Resolution::Found &&
+                  index.resolve("DATA\\LEVEL1.MAP", host) == Resolution::Found;
+    const int loadsBefore = loads;
+
+    // Create: the hook creates the host file, then reports it
+    tree.makeFile("ops/SAVES/NEWSAVE.SAV");
+    index.didCreate(tree.path("ops/SAVES/NEWSAVE.SAV"), false);
+    passed &= index.resolve("SAVES\\NEWSAVE.SAV", host) == Resolution::Found;
+
+    // Remove: the other long name keeps its number
+    fs::remove(tree.path("ops/SAVES/Old Save Game.sav"));
+    index.didRemove(tree.path("ops/SAVES/Old Save Game.sav"));
+    passed &= index.resolve("SAVES\\OLDSAV~1.SAV", host) == Resolution::FileNotFound &&
+              index.resolve("SAVES\\OTHERS~1.SAV", host) == Resolution::Found &&
+              host == tree.path("ops/SAVES/Other Save Game.sav");
+
+    // Rename a file over an existing one
+    fs::rename(tree.path("ops/SAVES/NEWSAVE.SAV"), tree.path("ops/SAVES/Other Save Game.sav"));
+    index.didRename(tree.path("ops/SAVES/NEWSAVE.SAV"), tree.path("ops/SAVES/Other Save Game.sav"));
+    passed &= index.resolve("SAVES\\NEWSAVE.SAV", host) == Resolution::FileNotFound &&
+              index.resolve("SAVES\\OTHERS~1.SAV", host) == Resolution::Found;
+
+    // mkdir, then rename a listed directory: its contents move with it
+    tree.makeDirectory("ops/BACKUP");
+    index.didCreate(tree.path("ops/BACKUP"), true);
+    fs::rename(tree.path("ops/DATA"), tree.path("ops/BACKUP/Level Data"));
+    index.didRename(tree.path("ops/DATA"), tree.path("ops/BACKUP/Level Data"));
+    passed &= index.resolve("DATA\\LEVEL1.MAP", host) == Resolution::PathNotFound &&
+              index.resolve("BACKUP\\LEVELD~1\\LEVEL1.MAP", host) == Resolution::Found &&
+              host == tree.path("ops/BACKUP/Level Data/LEVEL1.MAP");
+
+    // rmdir
+    fs::remove_all(tree.path("ops/BACKUP"));
+    index.didRemove(tree.path("ops/BACKUP"));
+    passed &= index.resolve("BACKUP\\LEVELD~1\\LEVEL1.MAP", host) == Resolution::PathNotFound;
+
+    passed &= loads == loadsBefore;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Index out of step with emulator operations (" << loads - loadsBefore
+                  << " relistings)" << std::endl;
+    } else {
+        std::cout << "  ✓ Create, remove, rename-over and directory rename applied in place" << std::endl;
+        std::cout << "  ✓ Surviving entries kept their short names" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testHostChanges(const TempTree& tree) {
+    std::cout << "\n[TEST 5] Host-Side Changes Picked Up After Invalidation" << std::endl;
+
+    tree.makeFile("host/MUSIC/TRACK01.MID");
+    BoxerShortNameIndex index(tree.path("host"));
+    std::string host;
+    bool passed = index.resolve("MUSIC\\TRACK01.MID", host) == Resolution::Found;
+
+    // Copied in by the user in Finder: unseen until invalidated
+    tree.makeFile("host/MUSIC/Bonus Track.mid");
+    passed &= index.resolve("MUSIC\\BONUST~1.MID", host) == Resolution::FileNotFound;
+    index.invalidate(tree.path("host/MUSIC"));
+    passed &= index.resolve("MUSIC\\BONUST~1.MID", host) == Resolution::Found;
+
+    tree.makeFile("host/README.TXT");
+    index.invalidateAll();
+    passed &= index.resolve("README.TXT", host) == Resolution::Found &&
+              index.resolve("MUSIC\\TRACK01.MID", host) == Resolution::Found;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Host change missed after invalidation" << std::endl;
+    } else {
+        std::cout << "  ✓ invalidate() relisted one directory; invalidateAll() the drive" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testLargeMount(const TempTree& tree) {
+    std::cout << "\n[TEST 6] Resolution Cost On A Large Mount vs Directory Scans" << std::endl;
+
+    constexpr int kDirectories = 20;
+    constexpr int kFiles = 400;
+    std::vector<std::string> dosPaths;
+    for (int d = 0; d < kDirectories; ++d) {
+        const std::string directory = "Level Pack " + std::to_string(d);
+        tree.makeDirectory("large/" + directory);
+        for (int f = 0; f < kFiles; ++f) {
+            const std::string name = "Map Segment " + std::to_string(f) + ".dat";
+            std::ofstream(tree.path("large/" + directory + "/" + name));
+        }
+    }
+
+    BoxerShortNameIndex index(tree.path("large"));
+    // DOS-side names come from the index itself, as FindFirst would report them
+    std::mt19937 random(2025);
+    for (int i = 0; i < 2000; ++i) {
+        const std::string directory = "Level Pack " + std::to_string(random() % kDirectories);
+        const std::string name = "Map Segment " + std::to_string(random() % kFiles) + ".dat";
+        dosPaths.push_back(index.shortName(tree.path("large/" + directory)) + "\\" +
+                           index.shortName(tree.path("large/" + directory + "/" + name)));
+    }
+
+    // Per-lookup scan: list each directory and compare every entry's short name
+    auto scanResolve = [&](const std::string& dosPath, std::string& host) {
+        host = tree.path("large");
+        size_t start = 0;
+        while (start < dosPath.size()) {
+            size_t end = dosPath.find('\\', start);
+            if (end == std::string::npos) {
+                end = dosPath.size();
+            }
+            const std::string wanted = dosPath.substr(start, end - start);
+            BoxerShortNameIndex::Snapshot listing;
+            BoxerDirectorySnapshotCache::readDirectory(host, listing);
+            std::sort(listing.begin(), listing.end(),
+                      [](const auto& a, const auto& b) { return a.name < b.name; });
+            std::set<std::string> taken;
+            bool found = false;
+            for (const auto& entry : listing) {
+                if (entry.name == "." || entry.name == "..") {
+                    continue;
+                }
+                const std::string shortName = BoxerShortNameIndex::makeShortName(
+                    entry.name, [&taken](const std::string& name) { return taken.count(name) != 0; });
+                taken.insert(shortName);
+                if (strcasecmp(shortName.c_str(), wanted.c_str()) == 0) {
+                    host += "/" + entry.name;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                return false;
+            }
+            start = end + 1;
+        }
+        return true;
+    };
+
+    bool passed = true;
+    std::string indexHost;
+    std::string scanHost;
+    const size_t scanLookups = 200;
+    const auto scanStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < scanLookups; ++i) {
+        passed &= scanResolve(dosPaths[i], scanHost);
+    }
+    const double scanUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - scanStart).count() /
+                          static_cast<double>(scanLookups);
+
+    const auto indexStart = std::chrono::steady_clock::now();
+    for (const auto& dosPath : dosPaths) {
+        passed &= index.resolve(dosPath, indexHost) == Resolution::Found;
+    }
+    const double indexUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - indexStart).count() /
+                           static_cast<double>(dosPaths.size());
+
+    // Both resolvers agree on every path the scan tried
+    for (size_t i = 0; i < scanLookups && passed; ++i) {
+        passed &= scanResolve(dosPaths[i], scanHost) &&
+                  index.resolve(dosPaths[i], indexHost) == Resolution::Found && scanHost == indexHost;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  Mount:          " << kDirectories * kFiles << " files in " << kDirectories << " directories" << std::endl;
+    std::cout << "  Uncached scan:  " << scanUs << " us/lookup" << std::endl;
+    std::cout << "  Index:          " << indexUs << " us/lookup" << std::endl;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Index and scan disagree" << std::endl;
+    } else {
+        std::cout << "  ✓ Index and scan resolve to the same host paths" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Short Name Index Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting drive_cache.cpp 8.3 name resolution" << std::endl;
+
+    TempTree tree;
+    int passed = 0;
+    int failed = 0;
+
+    if (testShortNames(tree)) passed++; else failed++;
+    if (testResolution(tree)) passed++; else failed++;
+    if (testLazyLoading(tree)) passed++; else failed++;
+    if (testMaintenance(tree)) passed++; else failed++;
+    if (testHostChanges(tree)) passed++; else failed++;
+    if (testLargeMount(tree)) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
@@ -0,0 +1,242 @@
+/*
+ * write-access-cache-test.cpp - Write permission cache test suite
+ *
+ * Validates BoxerWriteAccessCache, the cache in front of:
+ * - INT-041: shouldAllowWriteAccessToPath
+ *
+ * Test cases:
+ * 1. One hook call per containing directory
+ * 2. Subdirectories asked separately
+ * 3. Dot components and relative paths never cached
+ * 4. Drives isolated; remount drops decisions
+ * 5. Prefix invalidation drops only that subtree
+ * 6. Hook calls for a simulated installer
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_write_access_cache.h"
+
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// Stand-in drive objects; the cache only uses their addresses
+DOS_Drive* const kDriveC = reinterpret_cast<DOS_Drive*>(0x1000);
+DOS_Drive* const kDriveD = reinterpret_cast<DOS_Drive*>(0x2000);
+
+// Boxer-like policy: the game bundle is read-only except for its SAVES
+// folder (and anything below it)
+struct ProtectedBundlePolicy {
+    int calls = 0;
+
+    bool operator()(const char* path, DOS_Drive*) {
+        ++calls;
+        const bool inBundle = std::strncmp(path, "/Games/Doom.boxer/", 18) == 0;
+        const bool inSaves = std::strncmp(path, "/Games/Doom.boxer/SAVES/", 24) == 0;
+        return !inBundle || inSaves;
+    }
+};
+
+} // namespace
+
+bool testDirectoryGranularity() {
+    std::cout << "\n[TEST 1] One Hook Call Per Containing Directory" << std::endl;
+
+    BoxerWriteAccessCache cache;
+    ProtectedBundlePolicy policy;
+    bool passed = true;
+
+    for (int i = 0; i < 1000; ++i) {
+        const std::string save = "/Games/Doom.boxer/SAVES/SLOT" + std::to_string(i) + ".DSG";
+        const std::string exe = "/Games/Doom.boxer/DOOM" + std::to_string(i) + ".EXE";
+        passed &= cache.isWriteAllowed(save.c_str(), kDriveC, std::ref(policy));
+        passed &= !cache.isWriteAllowed(exe.c_str(), kDriveC, std::ref(policy));
+    }
+    const auto stats = cache.stats();
+    passed &= policy.calls == 2 && stats.misses == 2 && stats.hits == 1998;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Expected 2 hook calls, got " << policy.calls << std::endl;
+    } else {
+        std::cout << "  ✓ 2,000 writes, 2 hook calls, decisions preserved" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testSubdirectories() {
+    std::cout << "\n[TEST 2] Subdirectories Asked Separately" << std::endl;
+
+    BoxerWriteAccessCache cache;
+    ProtectedBundlePolicy policy;
+
+    // Denied for the bundle root must not leak into SAVES/, and vice versa
+    const bool passed =
+        !cache.isWriteAllowed("/Games/Doom.boxer/DOOM.WAD", kDriveC, std::ref(policy)) &&
+        cache.isWriteAllowed("/Games/Doom.boxer/SAVES/A.DSG", kDriveC, std::ref(policy)) &&
+        cache.isWriteAllowed("/Games/Doom.boxer/SAVES/OLD/B.DSG", kDriveC, std::ref(policy)) &&
+        cache.isWriteAllowed("/Games/NOTES.TXT", kDriveC, std::ref(policy)) &&
+        !cache.isWriteAllowed("/Games/Doom.boxer/SAVES", kDriveC, std::ref(policy)) &&
+        cache.isWriteAllowed("/ROOT.TXT", kDriveC, std::ref(policy)) &&
+        policy.calls == 5;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Decision leaked between directory levels" << std::endl;
+    } else {
+        std::cout << "  ✓ Bundle, SAVES, SAVES/OLD, parent and / decided independently" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testUncacheablePaths() {
+    std::cout << "\n[TEST 3] Dot Components And Relative Paths Never Cached" << std::endl;
+
+    BoxerWriteAccessCache cache;
+    ProtectedBundlePolicy policy;
+
+    cache.isWriteAllowed("/Games/Doom.boxer/SAVES/A.DSG", kDriveC, std::ref(policy));
+
+    // SAVES/../DOOM.EXE is textually under the cached SAVES decision but
+    // really lives in the protected bundle root
+    for (const char* path : {"/Games/Doom.boxer/SAVES/../DOOM.EXE", "/Games/Doom.boxer/SAVES/./B.DSG",
+                             "SAVES/C.DSG", "/Games/Doom.boxer/SAVES/..", ""}) {
+        cache.isWriteAllowed(path, kDriveC, std::ref(policy));
+    }
+
+    const bool passed = policy.calls == 1 + 5 && cache.stats().uncacheable == 5;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: A dot or relative path was answered from the cache" << std::endl;
+    } else {
+        std::cout << "  ✓ Every ./.. and relative path went to the hook" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testDriveIsolation() {
+    std::cout << "\n[TEST 4] Drives Isolated; Remount Drops Decisions" << std::endl;
+
+    BoxerWriteAccessCache cache;
+    int calls = 0;
+    bool allowC = false;
+    auto hook = [&](const char*, DOS_Drive* drive) {
+        ++calls;
+        return drive == kDriveC ? allowC : true;
+    };
+
+    bool passed = !cache.isWriteAllowed("/Shared/A.TXT", kDriveC, hook) &&
+                  cache.isWriteAllowed("/Shared/A.TXT", kDriveD, hook) &&
+                  calls == 2;
+
+    // Drive C remounted read-write
+    allowC = true;
+    passed &= !cache.isWriteAllowed("/Shared/B.TXT", kDriveC, hook) && calls == 2;
+    cache.invalidateDrive(kDriveC);
+    passed &= cache.isWriteAllowed("/Shared/B.TXT", kDriveC, hook) && calls == 3;
+    passed &= cache.isWriteAllowed("/Shared/C.TXT", kDriveD, hook) && calls == 3;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Decisions shared between drives or survived remount" << std::endl;
+    } else {
+        std::cout << "  ✓ Same path decided per drive; remount re-asks only that drive" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testPrefixInvalidation() {
+    std::cout << "\n[TEST 5] Prefix Invalidation Drops Only That Subtree" << std::endl;
+
+    BoxerWriteAccessCache cache;
+    int calls = 0;
+    auto hook = [&calls](const char*, DOS_Drive*) { ++calls; return false; };
+
+    for (const char* path : {"/G/A/1.TXT", "/G/A/B/2.TXT", "/G/C/3.TXT", "/G/4.TXT"}) {
+        cache.isWriteAllowed(path, kDriveC, hook);
+    }
+    cache.invalidatePrefix(kDriveC, "/G/A/");
+    for (const char* path : {"/G/A/1.TXT", "/G/A/B/2.TXT", "/G/C/3.TXT", "/G/4.TXT"}) {
+        cache.isWriteAllowed(path, kDriveC, hook);
+    }
+
+    bool passed = calls == 4 + 2;
+    cache.invalidatePrefix(kDriveC, "/");
+    cache.isWriteAllowed("/G/4.TXT", kDriveC, hook);
+    passed &= calls == 7;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Expected only /G/A and /G/A/B re-asked" << std::endl;
+    } else {
+        std::cout << "  ✓ /G/A and below re-asked, /G and /G/C kept" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testInstallerWorkload() {
+    std::cout << "\n[TEST 6] Hook Calls For A Simulated Installer" << std::endl;
+
+    // 40 directories x 250 files, each created, written and renamed
+    // (4 write checks per file, as at the four drive_local.cpp call sites)
+    BoxerWriteAccessCache cache;
+    ProtectedBundlePolicy policy;
+    uint64_t checks = 0;
+    for (int d = 0; d < 40; ++d) {
+        const std::string dir = "/Games/Install/DIR" + std::to_string(d) + "/";
+        for (int f = 0; f < 250; ++f) {
+            const std::string file = dir + "FILE" + std::to_string(f) + ".DAT";
+            for (int op = 0; op < 4; ++op) {
+                cache.isWriteAllowed(file.c_str(), kDriveC, std::ref(policy));
+                ++checks;
+            }
+        }
+    }
+
+    std::cout << "  Legacy hook calls: " << checks << std::endl;
+    std::cout << "  Cached hook calls: " << policy.calls << std::endl;
+
+    const bool passed = policy.calls == 40;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Expected one call per directory" << std::endl;
+    } else {
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Write Access Cache Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-041 cache" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testDirectoryGranularity()) passed++; else failed++;
+    if (testSubdirectories()) passed++; else failed++;
+    if (testUncacheablePaths()) passed++; else failed++;
+    if (testDriveIsolation()) passed++; else failed++;
+    if (testPrefixInvalidation()) passed++; else failed++;
+    if (testInstallerWorkload()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
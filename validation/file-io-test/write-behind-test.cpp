@@ -0,0 +1,404 @@
+/*
+ * write-behind-test.cpp - Write-behind buffering test suite
+ *
+ * Validates BoxerWriteBehind and the write-behind backend of
+ * BoxerFileHandle, used for files opened through:
+ * - INT-046: openLocalFile
+ *
+ * Test cases:
+ * 1. Small writes arrive intact and in order
+ * 2. Reads, seeks and truncation see pending writes
+ * 3. Commit (AH=68h) reaches the disk before returning
+ * 4. Closed files fsynced in batches
+ * 5. Background write errors reported to the handle
+ * 6. Small-write workload vs synchronous writes
+ * 7. Reopen right after close sees every write
+ * 8. Pending closes capped under a low descriptor limit
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_file_handle.h"
+
+#include <chrono>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+
+namespace fs = std::filesystem;
+
+using Backend = BoxerFileHandle::Backend;
+
+namespace {
+
+class TempTree {
+public:
+    TempTree() {
+        m_root = fs::temp_directory_path() /
+                 ("boxer-writebehind-test-" + std::to_string(std::chrono::steady_clock::now()
+                                                                .time_since_epoch().count()));
+        fs::create_directories(m_root);
+    }
+
+    ~TempTree() {
+        std::error_code error;
+        fs::remove_all(m_root, error);
+    }
+
+    std::string path(const std::string& name) const { return (m_root / name).string(); }
+
+private:
+    fs::path m_root;
+};
+
+std::string contentsOf(const std::string& path) {
+    std::ostringstream contents;
+    contents << std::ifstream(path, std::ios::binary).rdbuf();
+    return contents.str();
+}
+
+// Contents as another process sees them, without going through the handle
+std::string contentsOnHost(const std::string& path) {
+    const int descriptor = ::open(path.c_str(), O_RDONLY);
+    std::string contents;
+    char buffer[4096];
+    for (ssize_t count; (count = ::read(descriptor, buffer, sizeof(buffer))) > 0;) {
+        contents.append(buffer, static_cast<size_t>(count));
+    }
+    ::close(descriptor);
+    return contents;
+}
+
+std::unique_ptr<BoxerFileHandle> openBuffered(const std::string& path, const char* mode,
+                                              BoxerWriteBehind& flusher) {
+    auto handle = BoxerFileHandle::open(path.c_str(), mode);
+    if (handle && !handle->enableWriteBehind(flusher)) {
+        return nullptr;
+    }
+    return handle;
+}
+
+} // namespace
+
+bool testSmallWrites(const TempTree& tree) {
+    std::cout << "\n[TEST 1] Small Writes Arrive Intact And In Order" << std::endl;
+
+    BoxerWriteBehind flusher;
+    const std::string path = tree.path("GAME.LOG");
+    std::string expected;
+    bool passed = true;
+    {
+        auto handle = openBuffered(path, "wb", flusher);
+        passed &= handle && handle->backend() == Backend::WriteBehind;
+        for (int i = 0; passed && i < 20000; ++i) {
+            const std::string line = "tick " + std::to_string(i) + "\r\n";
+            passed &= handle->write(line.data(), line.size()) == line.size();
+            expected += line;
+        }
+        passed &= handle && handle->close();
+    }
+    flusher.syncAll();
+
+    const auto stats = flusher.stats();
+    passed &= contentsOf(path) == expected;
+    passed &= stats.runsQueued < 20000 / 100 && stats.bytesWritten == expected.size();
+
+    // Append mode and non-regular files keep the stdio path
+    auto append = BoxerFileHandle::open(path.c_str(), "ab");
+    auto device = BoxerFileHandle::open("/dev/null", "wb");
+    passed &= !append->enableWriteBehind(flusher) && append->backend() == Backend::Stdio;
+    passed &= !device->enableWriteBehind(flusher) && device->backend() == Backend::Stdio;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Contents differ or writes not gathered" << std::endl;
+    } else {
+        std::cout << "  ✓ 20,000 writes in " << stats.runsQueued << " host writes, contents intact" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testReadsSeeWrites(const TempTree& tree) {
+    std::cout << "\n[TEST 2] Reads, Seeks And Truncation See Pending Writes" << std::endl;
+
+    BoxerWriteBehind flusher;
+    const std::string path = tree.path("SAVE.DAT");
+    std::ofstream(path, std::ios::binary) << "0123456789";
+
+    auto handle = openBuffered(path, "r+b", flusher);
+    bool passed = handle && handle->size() == 10;
+
+    char buffer[16] = {};
+    passed &= handle->write("AB", 2) == 2;                          // 0..1
+    uint64_t position = 0;
+    passed &= handle->seek(6, SEEK_SET) && handle->write("XY", 2) == 2;  // 6..7, new run
+    passed &= handle->seek(-4, SEEK_END, &position) && position == 6;
+    passed &= handle->read(buffer, 4) == 4 && std::string(buffer, 4) == "XY89";
+    passed &= handle->seek(0, SEEK_SET) && handle->read(buffer, 3) == 3 && std::string(buffer, 3) == "AB2";
+
+    // Extend past the end, then cut back with a zero-length write
+    passed &= handle->seek(12, SEEK_SET) && handle->write("Z", 1) == 1 && handle->size() == 13;
+    passed &= handle->seek(8, SEEK_SET) && handle->truncate() && handle->size() == 8;
+    passed &= handle->close();
+    handle.reset();
+    flusher.syncAll();
+
+    passed &= contentsOf(path) == "AB2345XY";
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Handle view diverged from pending writes" << std::endl;
+    } else {
+        std::cout << "  ✓ Overwrites, gaps, SEEK_END and truncate consistent; file \"AB2345XY\"" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testCommit(const TempTree& tree) {
+    std::cout << "\n[TEST 3] Commit (AH=68h) Reaches The Disk Before Returning" << std::endl;
+
+    // Long sync interval: nothing would reach the disk on its own
+    BoxerWriteBehind flusher(60000);
+    const std::string path = tree.path("HISCORE.DAT");
+    auto handle = openBuffered(path, "wb", flusher);
+
+    bool passed = handle->write("ACE 99999", 9) == 9;
+    const bool pendingBeforeCommit = contentsOnHost(path).empty();
+    passed &= handle->commit();
+    passed &= contentsOnHost(path) == "ACE 99999";
+    passed &= flusher.stats().fsyncs == 1;
+    passed &= handle->close();
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Commit returned before data reached the file" << std::endl;
+    } else {
+        std::cout << "  ✓ Data " << (pendingBeforeCommit ? "buffered until" : "on host at")
+                  << " commit, fsynced once" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testBatchedSync(const TempTree& tree) {
+    std::cout << "\n[TEST 4] Closed Files Fsynced In Batches" << std::endl;
+
+    BoxerWriteBehind flusher(200);
+    bool passed = true;
+    for (int i = 0; i < 20; ++i) {
+        const std::string name = "SLOT" + std::to_string(i) + ".SAV";
+        auto handle = openBuffered(tree.path(name), "wb", flusher);
+        passed &= handle && handle->write(name.data(), name.size()) == name.size() && handle->close();
+    }
+
+    // Nothing synced yet; one wake-up after the interval syncs them all
+    const uint64_t syncedAtClose = flusher.stats().fsyncs;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (flusher.stats().fsyncs < 20 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    const auto stats = flusher.stats();
+    passed &= syncedAtClose == 0 && stats.fsyncs == 20 && stats.syncBatches <= 2;
+    for (int i = 0; i < 20; ++i) {
+        const std::string name = "SLOT" + std::to_string(i) + ".SAV";
+        passed &= contentsOf(tree.path(name)) == name;
+    }
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Expected 20 fsyncs in at most 2 batches, got " << stats.fsyncs
+                  << " in " << stats.syncBatches << std::endl;
+    } else {
+        std::cout << "  ✓ 20 closes, 20 fsyncs in " << stats.syncBatches << " batch(es)" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testErrors() {
+    std::cout << "\n[TEST 5] Background Write Errors Reported To The Handle" << std::endl;
+
+    BoxerWriteBehind flusher;
+    const int descriptor = ::open("/dev/full", O_WRONLY);
+    if (descriptor < 0) {
+        std::cout << "  - /dev/full not available, skipped" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+        return true;
+    }
+
+    BoxerWriteBehindFile file(flusher, descriptor);
+    bool passed = file.write("doomed", 6, 0);   // buffered: no error yet
+    errno = 0;
+    passed &= !file.drain() && errno == ENOSPC;
+    passed &= file.write("more", 4, 6);          // error already reported once
+    errno = 0;
+    passed &= !file.commit() && errno == ENOSPC;
+    passed &= file.close();
+    flusher.syncAll();
+    passed &= flusher.stats().failedWrites == 2;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: ENOSPC lost" << std::endl;
+    } else {
+        std::cout << "  ✓ ENOSPC from the flusher surfaced on drain and commit" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testWorkload(const TempTree& tree) {
+    std::cout << "\n[TEST 6] Small-Write Workload vs Synchronous Writes" << std::endl;
+
+    // A logger writing 16-byte records, 100,000 times
+    const int records = 100000;
+    const char record[16] = "score=000000000";
+
+    const std::string syncPath = tree.path("SYNC.LOG");
+    auto start = std::chrono::steady_clock::now();
+    {
+        const int descriptor = ::open(syncPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        for (int i = 0; i < records; ++i) {
+            if (::write(descriptor, record, sizeof(record)) != sizeof(record)) {
+                break;
+            }
+        }
+        ::close(descriptor);
+    }
+    const double syncMs = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - start).count();
+
+    BoxerWriteBehind flusher;
+    const std::string bufferedPath = tree.path("BUFFERED.LOG");
+    start = std::chrono::steady_clock::now();
+    {
+        auto handle = openBuffered(bufferedPath, "wb", flusher);
+        for (int i = 0; i < records; ++i) {
+            handle->write(record, sizeof(record));
+        }
+        handle->close();
+    }
+    const double bufferedMs = std::chrono::duration<double, std::milli>(
+                                  std::chrono::steady_clock::now() - start).count();
+    flusher.syncAll();
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  One write() per record: " << syncMs << " ms" << std::endl;
+    std::cout << "  Write-behind:           " << bufferedMs << " ms on the emulation thread ("
+              << flusher.stats().runsQueued << " host writes)" << std::endl;
+
+    const bool passed = fs::file_size(bufferedPath) == records * sizeof(record) &&
+                        contentsOf(bufferedPath) == contentsOf(syncPath);
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Output differs from synchronous writes" << std::endl;
+    } else {
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testReopenAfterClose(const TempTree& tree) {
+    std::cout << "\n[TEST 7] Reopen Right After Close Sees Every Write" << std::endl;
+
+    // Save, close, load at once: DOS close semantics, whatever the flusher
+    // is still doing with other files
+    BoxerWriteBehind flusher;
+    const std::string path = tree.path("QUICK.SAV");
+    bool passed = true;
+    int round = 0;
+    for (; passed && round < 200; ++round) {
+        const std::string data(200 * 1024 + round, static_cast<char>('A' + round % 26));
+        auto handle = openBuffered(path, "wb", flusher);
+        passed &= handle && handle->write(data.data(), data.size()) == data.size() && handle->close();
+        handle.reset();
+        passed &= fs::file_size(path) == data.size() && contentsOf(path) == data;
+    }
+    flusher.syncAll();
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Reopen after close " << round << " saw stale or short data" << std::endl;
+    } else {
+        std::cout << "  ✓ 200 close-then-reopen rounds saw the full size and contents" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testPendingCloseCap(const TempTree& tree) {
+    std::cout << "\n[TEST 8] Pending Closes Capped Under A Low Descriptor Limit" << std::endl;
+
+    // macOS's default soft limit; an installer closes far more files than
+    // that within one sync interval
+    struct rlimit original;
+    getrlimit(RLIMIT_NOFILE, &original);
+    struct rlimit lowered = original;
+    lowered.rlim_cur = std::min<rlim_t>(original.rlim_cur, 256);
+    setrlimit(RLIMIT_NOFILE, &lowered);
+
+    const int files = 1000;
+    bool passed = true;
+    int opened = 0;
+    {
+        BoxerWriteBehind flusher(60000);
+        for (; passed && opened < files; ++opened) {
+            const std::string name = "F" + std::to_string(opened) + ".DAT";
+            auto handle = openBuffered(tree.path(name), "wb", flusher);
+            passed &= handle && handle->write(name.data(), name.size()) == name.size() && handle->close();
+        }
+        const auto stats = flusher.stats();
+        passed &= stats.peakPendingCloses <= BoxerWriteBehind::kMaxPendingCloses &&
+                  stats.fullBatches >= files / BoxerWriteBehind::kMaxPendingCloses;
+        if (passed) {
+            std::cout << "  ✓ " << files << " closes, at most " << stats.peakPendingCloses
+                      << " descriptors waiting, " << stats.fullBatches << " early batches" << std::endl;
+        }
+    }
+    setrlimit(RLIMIT_NOFILE, &original);
+    for (int i = 0; passed && i < files; i += 97) {
+        const std::string name = "F" + std::to_string(i) + ".DAT";
+        passed &= contentsOf(tree.path(name)) == name;
+    }
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Ran out of descriptors or lost data after " << opened << " files" << std::endl;
+    } else {
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Write-Behind Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-046 write backend" << std::endl;
+
+    TempTree tree;
+    int passed = 0;
+    int failed = 0;
+
+    if (testSmallWrites(tree)) passed++; else failed++;
+    if (testReadsSeeWrites(tree)) passed++; else failed++;
+    if (testCommit(tree)) passed++; else failed++;
+    if (testBatchedSync(tree)) passed++; else failed++;
+    if (testErrors()) passed++; else failed++;
+    if (testWorkload(tree)) passed++; else failed++;
+    if (testReopenAfterClose(tree)) passed++; else failed++;
+    if (testPendingCloseCap(tree)) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
@@ -0,0 +1,359 @@
+/*
+ * boxer_input_latency.h - End-to-end input latency instrumentation
+ *
+ * Measures how long a host key press or mouse event takes to be observed by
+ * the DOS program, so MaybeProcessEvents (INT-011) and frame pacing can be
+ * tuned against real numbers.
+ *
+ * ARCHITECTURE:
+ *   - Entry stamps: taken where events enter the emulator, or supplied by
+ *     Boxer from the host event timestamp
+ *   - Consume stamps: taken where the DOS program observes the event
+ *   - Each keyed channel mirrors one real buffer, so entries and consumes
+ *     pair one to one: BIOS key buffer (BIOS_AddKeyToBuffer -> INT 16h
+ *     read) and keyboard controller (each scancode byte -> port 0x60 read)
+ *   - Mouse events coalesce: INT 33h poll or mouse IRQ
+ *   - Differences go into lock-free log-linear histograms, one per channel
+ *
+ * THREAD SAFETY:
+ *   Recording is wait-free. keyEntered() and scancodeEntered() have a
+ *   single producer: keys enter the emulator on the emulation thread.
+ *   Consume stamps and mouse events may be recorded from any thread.
+ *   stats() may be called from any thread at any time.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_INPUT_LATENCY_H
+#define BOXER_INPUT_LATENCY_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// BoxerLatencyHistogram - Log-linear histogram of nanosecond durations
+// ============================================================================
+
+/**
+ * @brief Fixed-size histogram with 4 linear sub-buckets per power of two
+ *
+ * Relative error of any reported percentile is below 25%, which is plenty
+ * to compare event pump intervals measured in milliseconds.
+ */
+class BoxerLatencyHistogram {
+public:
+    static constexpr size_t kSubBuckets = 4;
+    static constexpr size_t kOctaves = 40;  // up to ~18 minutes
+    static constexpr size_t kBuckets = kOctaves * kSubBuckets;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t minNs = 0;
+        uint64_t maxNs = 0;
+        double meanNs = 0.0;
+        std::array<uint64_t, kBuckets> buckets{};
+
+        /// Upper bound of the bucket holding the given percentile (0-100)
+        uint64_t percentileNs(double percentile) const {
+            if (count == 0) {
+                return 0;
+            }
+            const double rank = (percentile / 100.0) * static_cast<double>(count);
+            uint64_t seen = 0;
+            for (size_t i = 0; i < kBuckets; ++i) {
+                seen += buckets[i];
+                if (static_cast<double>(seen) >= rank && buckets[i] > 0) {
+                    const uint64_t upper = bucketUpperBound(i);
+                    return upper < maxNs ? upper : maxNs;
+                }
+            }
+            return maxNs;
+        }
+    };
+
+    void record(uint64_t ns) {
+        m_buckets[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+        m_sumNs.fetch_add(ns, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t current = m_minNs.load(std::memory_order_relaxed);
+        while (ns < current &&
+               !m_minNs.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {
+        }
+        current = m_maxNs.load(std::memory_order_relaxed);
+        while (ns > current &&
+               !m_maxNs.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    Snapshot snapshot() const {
+        Snapshot result;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            result.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+            result.count += result.buckets[i];
+        }
+        if (result.count > 0) {
+            result.minNs = m_minNs.load(std::memory_order_relaxed);
+            result.maxNs = m_maxNs.load(std::memory_order_relaxed);
+            result.meanNs = static_cast<double>(m_sumNs.load(std::memory_order_relaxed)) /
+                            static_cast<double>(result.count);
+        }
+        return result;
+    }
+
+    void reset() {
+        for (auto& bucket : m_buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        m_count.store(0, std::memory_order_relaxed);
+        m_sumNs.store(0, std::memory_order_relaxed);
+        m_minNs.store(UINT64_MAX, std::memory_order_relaxed);
+        m_maxNs.store(0, std::memory_order_relaxed);
+    }
+
+    static size_t bucketIndex(uint64_t ns) {
+        if (ns < kSubBuckets) {
+            return static_cast<size_t>(ns);
+        }
+        size_t octave = 63 - static_cast<size_t>(__builtin_clzll(ns));
+        const size_t sub = static_cast<size_t>((ns >> (octave - 2)) & (kSubBuckets - 1));
+        // Octaves 0 and 1 are covered by the direct buckets above
+        size_t index = (octave - 1) * kSubBuckets + sub;
+        return index < kBuckets ? index : kBuckets - 1;
+    }
+
+    static uint64_t bucketUpperBound(size_t index) {
+        if (index < kSubBuckets) {
+            return index;
+        }
+        const size_t octave = index / kSubBuckets + 1;
+        const uint64_t sub = index % kSubBuckets;
+        return ((kSubBuckets + sub + 1) << (octave - 2)) - 1;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> m_buckets{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sumNs{0};
+    std::atomic<uint64_t> m_minNs{UINT64_MAX};
+    std::atomic<uint64_t> m_maxNs{0};
+};
+
+// ============================================================================
+// BoxerInputLatencyTracker - Pairs entry and consume stamps per channel
+// ============================================================================
+
+class BoxerInputLatencyTracker {
+public:
+    /// Keyboard stamps awaiting consumption (BIOS buffer holds 15 keys)
+    static constexpr size_t kPendingKeys = 256;
+
+    /**
+     * Keyboard: BIOS key buffer entries, entered by BIOS_AddKeyToBuffer and
+     *           consumed by INT 16h reads
+     * Mouse:    host mouse events, observed by INT 33h polls or the IRQ
+     * Scancode: keyboard controller bytes (make, break, prefix), consumed
+     *           by port 0x60 reads
+     */
+    enum class Channel { Keyboard = 0, Mouse = 1, Scancode = 2 };
+
+    struct Stats {
+        BoxerLatencyHistogram::Snapshot latency;
+        uint64_t droppedEntries = 0;    // entry stamps overwritten before use
+        uint64_t unmatchedConsumes = 0; // consume stamps with no pending entry
+    };
+
+    static BoxerInputLatencyTracker& shared() {
+        static BoxerInputLatencyTracker tracker;
+        return tracker;
+    }
+
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    // ========================================================================
+    // Keyboard: FIFO pairing, one consume per BIOS buffer entry
+    // ========================================================================
+    // Stamp where entries are added to the BIOS buffer, not where scancodes
+    // are queued: break codes, modifiers and prefixes never reach the
+    // buffer, so pairing them with INT 16h reads would drift.
+
+    /**
+     * @brief A key was added to the BIOS key buffer
+     * @param timestampNs Host event time on the steady clock, 0 for "now"
+     *
+     * Single producer: call from one thread only (the emulation thread).
+     */
+    void keyEntered(uint64_t timestampNs = 0) {
+        if (isEnabled()) {
+            m_keys.enter(timestampNs ? timestampNs : nowNs());
+        }
+    }
+
+    /**
+     * @brief The DOS program read the oldest key from the BIOS buffer
+     * @param timestampNs Observation time, 0 for "now"
+     */
+    void keyConsumed(uint64_t timestampNs = 0) {
+        if (isEnabled()) {
+            m_keys.consume(m_keyboard, timestampNs);
+        }
+    }
+
+    // ========================================================================
+    // Scancode: FIFO pairing, one consume per controller byte
+    // ========================================================================
+
+    /// A scancode byte was queued in the keyboard controller (single producer)
+    void scancodeEntered(uint64_t timestampNs = 0) {
+        if (isEnabled()) {
+            m_scancodes.enter(timestampNs ? timestampNs : nowNs());
+        }
+    }
+
+    /// Port 0x60 returned a newly latched scancode for the first time
+    void scancodeConsumed(uint64_t timestampNs = 0) {
+        if (isEnabled()) {
+            m_scancodes.consume(m_scancode, timestampNs);
+        }
+    }
+
+    // ========================================================================
+    // Mouse: state-based, measured from first unobserved event
+    // ========================================================================
+
+    /// A mouse event entered the emulator; later events coalesce into it
+    void mouseEntered(uint64_t timestampNs = 0) {
+        if (!isEnabled()) {
+            return;
+        }
+        uint64_t expected = 0;
+        m_mousePendingSince.compare_exchange_strong(
+            expected, timestampNs ? timestampNs : nowNs(), std::memory_order_relaxed);
+    }
+
+    /// The DOS program polled the mouse (INT 33h or mouse IRQ handler)
+    void mouseObserved(uint64_t timestampNs = 0) {
+        if (!isEnabled()) {
+            return;
+        }
+        const uint64_t entered = m_mousePendingSince.exchange(0, std::memory_order_relaxed);
+        if (entered != 0) {
+            recordDelta(m_mouse, entered, timestampNs);
+        }
+    }
+
+    // ========================================================================
+    // Query API
+    // ========================================================================
+
+    Stats stats(Channel channel) const {
+        Stats result;
+        switch (channel) {
+            case Channel::Keyboard:
+                result.latency = m_keyboard.snapshot();
+                m_keys.counts(result);
+                break;
+            case Channel::Scancode:
+                result.latency = m_scancode.snapshot();
+                m_scancodes.counts(result);
+                break;
+            case Channel::Mouse:
+                result.latency = m_mouse.snapshot();
+                break;
+        }
+        return result;
+    }
+
+    /// Clear histograms and pending stamps (call between benchmark runs)
+    void reset() {
+        m_keyboard.reset();
+        m_scancode.reset();
+        m_mouse.reset();
+        m_keys.reset();
+        m_scancodes.reset();
+        m_mousePendingSince.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static void recordDelta(BoxerLatencyHistogram& histogram, uint64_t entered, uint64_t timestampNs) {
+        const uint64_t consumed = timestampNs ? timestampNs : nowNs();
+        histogram.record(consumed > entered ? consumed - entered : 0);
+    }
+
+    // Entry stamps of one FIFO buffer: a single producer, any consumers
+    class PendingStamps {
+    public:
+        void enter(uint64_t stamp) {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            size_t head = m_head.load(std::memory_order_acquire);
+            if (tail - head >= kPendingKeys) {
+                // Oldest stamp is lost; the entry it belonged to was never read
+                if (m_head.compare_exchange_strong(head, head + 1, std::memory_order_acq_rel)) {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            m_stamps[tail % kPendingKeys].store(stamp, std::memory_order_relaxed);
+            m_tail.store(tail + 1, std::memory_order_release);
+        }
+
+        void consume(BoxerLatencyHistogram& histogram, uint64_t timestampNs) {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            for (;;) {
+                if (head == m_tail.load(std::memory_order_acquire)) {
+                    m_unmatched.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                const uint64_t entered = m_stamps[head % kPendingKeys].load(std::memory_order_relaxed);
+                if (m_head.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel)) {
+                    recordDelta(histogram, entered, timestampNs);
+                    return;
+                }
+            }
+        }
+
+        void counts(Stats& stats) const {
+            stats.droppedEntries = m_dropped.load(std::memory_order_relaxed);
+            stats.unmatchedConsumes = m_unmatched.load(std::memory_order_relaxed);
+        }
+
+        void reset() {
+            m_head.store(m_tail.load(std::memory_order_acquire), std::memory_order_release);
+            m_dropped.store(0, std::memory_order_relaxed);
+            m_unmatched.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, kPendingKeys> m_stamps{};
+        std::atomic<size_t> m_head{0};
+        std::atomic<size_t> m_tail{0};
+        std::atomic<uint64_t> m_dropped{0};
+        std::atomic<uint64_t> m_unmatched{0};
+    };
+
+    std::atomic<bool> m_enabled{false};
+
+    BoxerLatencyHistogram m_keyboard;
+    BoxerLatencyHistogram m_scancode;
+    BoxerLatencyHistogram m_mouse;
+
+    PendingStamps m_keys;
+    PendingStamps m_scancodes;
+
+    std::atomic<uint64_t> m_mousePendingSince{0};
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_INPUT_LATENCY_H
@@ -0,0 +1,125 @@
+/*
+ * boxer_joystick_gate.h - Lazy host joystick polling for Boxer integration
+ *
+ * Drives INT-060 setJoystickActive from actual gameport use, and tells the
+ * event pump whether host joysticks need polling at all.
+ *
+ * ARCHITECTURE:
+ *   - The gate starts dormant: no host joystick polling, no gameport
+ *     timing work, no setJoystickActive traffic
+ *   - The first guest access to port 0x201 wakes it (setJoystickActive(true))
+ *   - The event pump calls update() before polling; once the guest has not
+ *     touched the gameport for the idle timeout the gate sleeps again
+ *     (setJoystickActive(false))
+ *   - Timestamps are in milliseconds from any monotonic source; DOSBox
+ *     passes PIC_Ticks so the port handler never reads a host clock
+ *
+ * THREAD SAFETY:
+ *   noteGameportAccess() and update() are called from the emulation thread
+ *   only. isActive() may be called from any thread.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_JOYSTICK_GATE_H
+#define BOXER_JOYSTICK_GATE_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <atomic>
+#include <cstdint>
+
+// ============================================================================
+// BoxerJoystickGate - Dormant until the guest reads the gameport
+// ============================================================================
+
+class BoxerJoystickGate {
+public:
+    /// State change the caller should forward to setJoystickActive()
+    enum class Transition : uint8_t {
+        None,
+        Woke,   ///< setJoystickActive(true), poll host joysticks now
+        Slept,  ///< setJoystickActive(false), stop polling
+    };
+
+    /// Long enough to cover menus and loading screens between gameport reads
+    static constexpr uint64_t kDefaultIdleTimeoutMs = 5000;
+
+    static BoxerJoystickGate& shared() {
+        static BoxerJoystickGate gate;
+        return gate;
+    }
+
+    explicit BoxerJoystickGate(uint64_t idleTimeoutMs = kDefaultIdleTimeoutMs)
+        : m_idleTimeoutMs(idleTimeoutMs) {}
+
+    /**
+     * @brief Record a guest read or write of port 0x201
+     * @param nowMs Current emulated time in milliseconds
+     * @return Transition::Woke on the first access after dormancy
+     *
+     * Called from read_p201/write_p201 in place of the unconditional
+     * setJoystickActive(true). While active this is one relaxed store.
+     */
+    Transition noteGameportAccess(uint64_t nowMs) {
+        m_lastAccessMs.store(nowMs, std::memory_order_relaxed);
+        if (m_active.load(std::memory_order_relaxed)) {
+            return Transition::None;
+        }
+        m_active.store(true, std::memory_order_release);
+        m_wakeCount.fetch_add(1, std::memory_order_relaxed);
+        return Transition::Woke;
+    }
+
+    /**
+     * @brief Put the gate to sleep if the gameport has gone idle
+     * @param nowMs Current emulated time in milliseconds
+     * @return Transition::Slept when the idle timeout has just expired
+     *
+     * Called once per event pump, before deciding whether to poll host
+     * joysticks. A single relaxed load while dormant.
+     */
+    Transition update(uint64_t nowMs) {
+        if (!m_active.load(std::memory_order_relaxed)) {
+            return Transition::None;
+        }
+        const uint64_t last = m_lastAccessMs.load(std::memory_order_relaxed);
+        if (nowMs < last || nowMs - last < m_idleTimeoutMs) {
+            return Transition::None;
+        }
+        m_active.store(false, std::memory_order_release);
+        return Transition::Slept;
+    }
+
+    /// Whether host joysticks should be polled (any thread)
+    bool isActive() const {
+        return m_active.load(std::memory_order_acquire);
+    }
+
+    /// Number of dormant-to-active transitions since construction or reset()
+    uint64_t wakeCount() const {
+        return m_wakeCount.load(std::memory_order_relaxed);
+    }
+
+    void setIdleTimeout(uint64_t idleTimeoutMs) {
+        m_idleTimeoutMs = idleTimeoutMs;
+    }
+
+    /// Return to dormant without a Slept transition (emulator reset/shutdown)
+    void reset() {
+        m_active.store(false, std::memory_order_release);
+        m_lastAccessMs.store(0, std::memory_order_relaxed);
+        m_wakeCount.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    uint64_t m_idleTimeoutMs;
+    std::atomic<bool> m_active{false};
+    std::atomic<uint64_t> m_lastAccessMs{0};
+    std::atomic<uint64_t> m_wakeCount{0};
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_JOYSTICK_GATE_H
@@ -0,0 +1,266 @@
+/*
+ * boxer_keyboard_layouts.h - Indexed keyboard layout registry
+ *
+ * Backs INT-063 keyboardLayoutLoaded, INT-064 keyboardLayoutName and
+ * INT-065 keyboardLayoutSupported with a prebuilt index instead of string
+ * searches and KL/KCF parsing at layout switch time.
+ *
+ * ARCHITECTURE:
+ *   - Layout files (.kl, .kcf and KCF-format keyboard*.sys) are mapped
+ *     read-only once, at startup
+ *   - Every layout code in every file is indexed, including the numeric
+ *     aliases DOSBox accepts (e.g. "gr" and "gr129")
+ *   - Support checks are a single hash lookup; a layout switch hands the
+ *     loader a pointer into the mapping instead of re-reading the file
+ *
+ * THREAD SAFETY:
+ *   Build the registry once, then treat it as read-only; lookups need no
+ *   locking. Mappings live as long as the registry.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_KEYBOARD_LAYOUTS_H
+#define BOXER_KEYBOARD_LAYOUTS_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ============================================================================
+// BoxerKeyboardLayoutRegistry
+// ============================================================================
+
+class BoxerKeyboardLayoutRegistry {
+public:
+    /**
+     * @brief Location of one layout inside a mapped file
+     *
+     * For KCF files `entryOffset` is the same file position DOSBox's
+     * read_kcl_file() returns, so the existing loader can parse from
+     * `fileData + entryOffset` without touching the disk.
+     */
+    struct Layout {
+        const uint8_t* fileData;
+        size_t fileSize;
+        size_t entryOffset;
+        size_t entrySize;
+        const std::string* path;
+
+        const uint8_t* data() const { return fileData + entryOffset; }
+    };
+
+    static BoxerKeyboardLayoutRegistry& shared() {
+        static BoxerKeyboardLayoutRegistry registry;
+        return registry;
+    }
+
+    BoxerKeyboardLayoutRegistry() = default;
+    BoxerKeyboardLayoutRegistry(const BoxerKeyboardLayoutRegistry&) = delete;
+    BoxerKeyboardLayoutRegistry& operator=(const BoxerKeyboardLayoutRegistry&) = delete;
+
+    /**
+     * @brief Map and index one layout file
+     * @param path Path to a .kl file or a KCF container
+     * @return Number of new layout codes indexed (0 if unreadable/invalid)
+     *
+     * Codes already indexed keep their earlier mapping, so add the most
+     * specific files first (same precedence as DOSBox's layout search).
+     */
+    size_t addFile(const std::string& path) {
+        auto mapping = MappedFile::open(path);
+        if (!mapping) {
+            return 0;
+        }
+        const MappedFile& file = *mapping;
+        m_files.push_back(std::move(mapping));
+
+        if (hasMagic(file, "KCF")) {
+            return indexContainer(file);
+        }
+        if (hasMagic(file, "KLF")) {
+            const std::string code = std::filesystem::path(path).stem().string();
+            return insert(code, Layout{file.data, file.size, 0, file.size, &file.path}) ? 1 : 0;
+        }
+        m_files.pop_back();
+        return 0;
+    }
+
+    /**
+     * @brief Index every layout file in a directory
+     * @return Number of layout codes indexed
+     *
+     * Single-layout .kl files are added before KCF containers, matching
+     * DOSBox's lookup order.
+     */
+    size_t addDirectory(const std::string& directory) {
+        std::vector<std::string> single;
+        std::vector<std::string> containers;
+        std::error_code error;
+        for (const auto& item : std::filesystem::directory_iterator(directory, error)) {
+            if (!item.is_regular_file(error)) {
+                continue;
+            }
+            const std::string extension = lowercase(item.path().extension().string());
+            if (extension == ".kl") {
+                single.push_back(item.path().string());
+            } else if (extension == ".kcf" || extension == ".sys") {
+                containers.push_back(item.path().string());
+            }
+        }
+        std::sort(single.begin(), single.end());
+        std::sort(containers.begin(), containers.end());
+
+        size_t added = 0;
+        for (const auto& path : single) {
+            added += addFile(path);
+        }
+        for (const auto& path : containers) {
+            added += addFile(path);
+        }
+        return added;
+    }
+
+    /// INT-065: O(1), case-insensitive
+    bool isSupported(const char* code) const {
+        return find(code) != nullptr;
+    }
+
+    /// Layout for a code, or nullptr if no indexed file provides it
+    const Layout* find(const char* code) const {
+        if (!code) {
+            return nullptr;
+        }
+        const auto it = m_index.find(lowercase(code));
+        return it == m_index.end() ? nullptr : &it->second;
+    }
+
+    /// All indexed codes, sorted (for KEYB help and Boxer's layout menu)
+    std::vector<std::string> codes() const {
+        std::vector<std::string> result;
+        result.reserve(m_index.size());
+        for (const auto& entry : m_index) {
+            result.push_back(entry.first);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    size_t size() const { return m_index.size(); }
+
+private:
+    // Read-only mapping of one layout file
+    struct MappedFile {
+        std::string path;
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+
+        static std::unique_ptr<MappedFile> open(const std::string& path) {
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return nullptr;
+            }
+            struct stat status;
+            if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size < 3) {
+                ::close(fd);
+                return nullptr;
+            }
+            void* address = mmap(nullptr, static_cast<size_t>(status.st_size),
+                                 PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (address == MAP_FAILED) {
+                return nullptr;
+            }
+            auto file = std::make_unique<MappedFile>();
+            file->path = path;
+            file->data = static_cast<const uint8_t*>(address);
+            file->size = static_cast<size_t>(status.st_size);
+            return file;
+        }
+
+        ~MappedFile() {
+            if (data) {
+                munmap(const_cast<uint8_t*>(data), size);
+            }
+        }
+    };
+
+    static std::string lowercase(std::string text) {
+        for (auto& c : text) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return text;
+    }
+
+    static bool hasMagic(const MappedFile& file, const char* magic) {
+        return file.data[0] == magic[0] && file.data[1] == magic[1] && file.data[2] == magic[2];
+    }
+
+    bool insert(const std::string& code, const Layout& layout) {
+        return !code.empty() && m_index.emplace(lowercase(code), layout).second;
+    }
+
+    // Same walk as DOSBox's read_kcl_file(), done once for every entry
+    size_t indexContainer(const MappedFile& file) {
+        const uint8_t* data = file.data;
+        if (file.size < 7) {
+            return 0;
+        }
+        size_t added = 0;
+        size_t pos = 7 + data[6];
+
+        while (pos + 5 <= file.size) {
+            const size_t length = data[pos] | (data[pos + 1] << 8);
+            const size_t codesLength = data[pos + 2];
+            const size_t entrySize = 3 + length;
+            if (pos + entrySize > file.size || codesLength > length) {
+                break;
+            }
+            const Layout layout{data, file.size, pos, entrySize, &file.path};
+
+            // Codes region: repeated [u16 number][chars up to ',']
+            size_t i = 0;
+            const uint8_t* codes = data + pos + 3;
+            while (i + 2 <= codesLength) {
+                const unsigned number = codes[i] | (codes[i + 1] << 8);
+                i += 2;
+                std::string code;
+                while (i < codesLength && codes[i] != ',') {
+                    code.push_back(static_cast<char>(codes[i++]));
+                }
+                if (i < codesLength) {
+                    ++i;  // skip ','
+                }
+                if (insert(code, layout)) {
+                    ++added;
+                }
+                if (number != 0 && insert(code + std::to_string(number), layout)) {
+                    ++added;
+                }
+            }
+            pos += entrySize;
+        }
+        return added;
+    }
+
+    std::vector<std::unique_ptr<MappedFile>> m_files;
+    std::unordered_map<std::string, Layout> m_index;
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_KEYBOARD_LAYOUTS_H
@@ -0,0 +1,119 @@
+/*
+ * boxer_lock_state.h - Consolidated lock-key LED state word
+ *
+ * Replaces three virtual calls per BIOS keyboard state change
+ * (INT-068 setNumLockActive, INT-069 setCapsLockActive,
+ * INT-070 setScrollLockActive) with one atomic word.
+ *
+ * ARCHITECTURE:
+ *   - The BIOS keyboard handler publishes the full lock state on every
+ *     change of the BIOS shift flags; identical states are absorbed here
+ *   - The word carries a generation counter, so Boxer can poll it cheaply
+ *     (e.g. once per frame) and only act when the generation moves
+ *   - Callers that still want push notification get a mask of the bits
+ *     that actually changed and call only those hooks
+ *
+ * THREAD SAFETY:
+ *   publish() is called from the emulation thread only. load() may be called
+ *   from any thread and always returns a consistent state/generation pair.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_LOCK_STATE_H
+#define BOXER_LOCK_STATE_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <atomic>
+#include <cstdint>
+
+// ============================================================================
+// BoxerLockState - Lock-key bitfield plus change generation
+// ============================================================================
+
+class BoxerLockState {
+public:
+    /// Lock bits, matching the LED order of the keyboard 0xED command
+    enum : uint8_t {
+        ScrollLock = 1 << 0,
+        NumLock    = 1 << 1,
+        CapsLock   = 1 << 2,
+        AllLocks   = ScrollLock | NumLock | CapsLock,
+    };
+
+    struct Snapshot {
+        uint8_t locks;
+        uint32_t generation;
+
+        bool numLock() const { return (locks & NumLock) != 0; }
+        bool capsLock() const { return (locks & CapsLock) != 0; }
+        bool scrollLock() const { return (locks & ScrollLock) != 0; }
+    };
+
+    static BoxerLockState& shared() {
+        static BoxerLockState state;
+        return state;
+    }
+
+    /**
+     * @brief Convert BIOS shift flags (BDA 0040:0017) to lock bits
+     * @param biosFlags Value of the first BIOS keyboard flag byte
+     */
+    static uint8_t locksFromBiosFlags(uint8_t biosFlags) {
+        // BDA bit 4 = Scroll, bit 5 = Num, bit 6 = Caps
+        return static_cast<uint8_t>((biosFlags >> 4) & AllLocks);
+    }
+
+    /**
+     * @brief Publish the current lock state
+     * @param locks Combination of NumLock, CapsLock and ScrollLock
+     * @return Mask of bits that changed (0 if nothing changed)
+     *
+     * Called on every BIOS keyboard flag update; only real changes bump the
+     * generation, so pollers see no churn from repeated identical states.
+     */
+    uint8_t publish(uint8_t locks) {
+        locks &= AllLocks;
+        const uint32_t current = m_word.load(std::memory_order_relaxed);
+        const uint8_t changed = static_cast<uint8_t>((current & AllLocks) ^ locks);
+        if (changed != 0) {
+            const uint32_t generation = (current >> kGenerationShift) + 1;
+            m_word.store((generation << kGenerationShift) | locks, std::memory_order_release);
+        }
+        return changed;
+    }
+
+    /// Current lock state and generation (any thread)
+    Snapshot load() const {
+        const uint32_t word = m_word.load(std::memory_order_acquire);
+        return Snapshot{static_cast<uint8_t>(word & AllLocks), word >> kGenerationShift};
+    }
+
+    /**
+     * @brief Poll for a change since a previously seen generation
+     * @param[in,out] lastGeneration Generation the caller last acted on
+     * @param[out] outSnapshot Current state if it changed
+     * @return true if the state changed since lastGeneration
+     */
+    bool pollChange(uint32_t& lastGeneration, Snapshot& outSnapshot) const {
+        const Snapshot snapshot = load();
+        if (snapshot.generation == lastGeneration) {
+            return false;
+        }
+        lastGeneration = snapshot.generation;
+        outSnapshot = snapshot;
+        return true;
+    }
+
+private:
+    // Bits 0-2 lock state, bits 8-31 generation (wraps after 16M changes)
+    static constexpr uint32_t kGenerationShift = 8;
+
+    std::atomic<uint32_t> m_word{0};
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_LOCK_STATE_H
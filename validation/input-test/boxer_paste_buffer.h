@@ -0,0 +1,205 @@
+/*
+ * boxer_paste_buffer.h - Bulk clipboard paste ring for Boxer integration
+ *
+ * Replaces the per-key paste hooks (INT-073 numKeyCodesInPasteBuffer,
+ * INT-074 getNextKeyCodeInPasteBuffer, INT-062 keyboardBufferRemaining)
+ * with a single-producer/single-consumer ring of BIOS keycodes.
+ *
+ * ARCHITECTURE:
+ *   - Boxer (producer) pushes whole spans of keycodes from its UI thread
+ *   - DOSBox (consumer) moves as many keycodes as the BIOS keyboard buffer
+ *     can take whenever space frees up, with no delegate round trip
+ *   - Paste throughput is bounded by how fast the DOS program drains the
+ *     BIOS buffer, not by hook overhead
+ *
+ * THREAD SAFETY:
+ *   Exactly one producer thread and one consumer thread. Both sides are
+ *   lock-free; head and tail live on separate cache lines.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_PASTE_BUFFER_H
+#define BOXER_PASTE_BUFFER_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// ============================================================================
+// BoxerPasteBuffer - SPSC ring of BIOS keycodes
+// ============================================================================
+
+class BoxerPasteBuffer {
+public:
+    /// Default capacity in keycodes (must be a power of two)
+    static constexpr size_t kDefaultCapacity = 16384;
+
+    /**
+     * @brief Create a ring holding at least `capacity` keycodes
+     * @param capacity Requested capacity, rounded up to a power of two
+     */
+    explicit BoxerPasteBuffer(size_t capacity = kDefaultCapacity)
+        : m_capacity(roundUpToPowerOfTwo(capacity)),
+          m_mask(m_capacity - 1),
+          m_keyCodes(new uint16_t[m_capacity])
+    {}
+
+    BoxerPasteBuffer(const BoxerPasteBuffer&) = delete;
+    BoxerPasteBuffer& operator=(const BoxerPasteBuffer&) = delete;
+
+    /**
+     * @brief Process-wide paste buffer shared by Boxer and the BIOS
+     *
+     * Boxer pushes into this instance; bios_keyboard.cpp drains it.
+     */
+    static BoxerPasteBuffer& shared() {
+        static BoxerPasteBuffer buffer;
+        return buffer;
+    }
+
+    size_t capacity() const { return m_capacity; }
+
+    // ========================================================================
+    // Producer side (Boxer UI thread)
+    // ========================================================================
+
+    /**
+     * @brief Append a span of BIOS keycodes
+     * @param keyCodes Keycodes in BIOS format (scancode << 8 | ASCII)
+     * @param count Number of keycodes in the span
+     * @return Number of keycodes accepted (less than count if full)
+     *
+     * Boxer should retry the remainder once the ring drains; nothing is
+     * dropped silently.
+     */
+    size_t enqueue(const uint16_t* keyCodes, size_t count) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        const size_t space = m_capacity - (tail - head);
+        const size_t accepted = count < space ? count : space;
+
+        for (size_t i = 0; i < accepted; ++i) {
+            m_keyCodes[(tail + i) & m_mask] = keyCodes[i];
+        }
+        m_tail.store(tail + accepted, std::memory_order_release);
+        return accepted;
+    }
+
+    /**
+     * @brief Discard everything pushed so far (e.g. user cancelled paste)
+     *
+     * Safe to call from the producer while the consumer is draining.
+     * Keycodes enqueued after this call are kept.
+     */
+    void clear() {
+        m_clearMark.store(m_tail.load(std::memory_order_relaxed),
+                          std::memory_order_release);
+    }
+
+    // ========================================================================
+    // Consumer side (emulation thread)
+    // ========================================================================
+
+    /// Number of keycodes waiting to be delivered
+    size_t size() {
+        const size_t head = applyPendingClear();
+        return m_tail.load(std::memory_order_acquire) - head;
+    }
+
+    bool empty() { return size() == 0; }
+
+    /**
+     * @brief Look at the next keycode without consuming it
+     * @param[out] outKeyCode Receives the keycode
+     * @return true if a keycode was available
+     */
+    bool peek(uint16_t* outKeyCode) {
+        const size_t head = applyPendingClear();
+        if (m_tail.load(std::memory_order_acquire) == head) {
+            return false;
+        }
+        *outKeyCode = m_keyCodes[head & m_mask];
+        return true;
+    }
+
+    /**
+     * @brief Move up to `maxCount` keycodes into `outKeyCodes`
+     * @return Number of keycodes copied
+     */
+    size_t dequeue(uint16_t* outKeyCodes, size_t maxCount) {
+        const size_t head = applyPendingClear();
+        const size_t available = m_tail.load(std::memory_order_acquire) - head;
+        const size_t count = maxCount < available ? maxCount : available;
+
+        for (size_t i = 0; i < count; ++i) {
+            outKeyCodes[i] = m_keyCodes[(head + i) & m_mask];
+        }
+        m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Fill free BIOS keyboard buffer slots in one pass
+     * @param freeSlots Slots currently free in the BIOS keyboard buffer
+     * @param reservedSlots Slots left free for real keystrokes (Esc, Ctrl+C)
+     * @param addKey Callable `bool(uint16_t)`, normally BIOS_AddKeyToBuffer
+     * @return Number of keycodes delivered
+     *
+     * Stops early if addKey refuses a key; that key stays queued.
+     */
+    template <typename AddKey>
+    size_t fillKeyboardBuffer(size_t freeSlots, size_t reservedSlots, AddKey&& addKey) {
+        if (freeSlots <= reservedSlots) {
+            return 0;
+        }
+        const size_t budget = freeSlots - reservedSlots;
+        const size_t head = applyPendingClear();
+        const size_t available = m_tail.load(std::memory_order_acquire) - head;
+        const size_t count = budget < available ? budget : available;
+
+        size_t delivered = 0;
+        while (delivered < count && addKey(m_keyCodes[(head + delivered) & m_mask])) {
+            ++delivered;
+        }
+        m_head.store(head + delivered, std::memory_order_release);
+        return delivered;
+    }
+
+private:
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // Consumer-only: skip past anything the producer cleared
+    size_t applyPendingClear() {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t mark = m_clearMark.load(std::memory_order_acquire);
+        if (mark > head) {
+            m_head.store(mark, std::memory_order_release);
+            return mark;
+        }
+        return head;
+    }
+
+    const size_t m_capacity;
+    const size_t m_mask;
+    std::unique_ptr<uint16_t[]> m_keyCodes;
+
+    // Monotonic counters; index into the ring with `& m_mask`
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+    alignas(64) std::atomic<size_t> m_clearMark{0};
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_PASTE_BUFFER_H
@@ -0,0 +1,187 @@
+/*
+ * input-latency-benchmark.cpp - Headless input latency benchmark
+ *
+ * Replays a fixed stream of host key presses and mouse moves through a
+ * simulated emulator on a virtual clock, and reports the latency that
+ * BoxerInputLatencyTracker records for each event pump interval
+ * (MaybeProcessEvents, INT-011) and DOS polling style.
+ *
+ * The virtual clock makes results deterministic and independent of host
+ * load, so different pump intervals can be compared directly. The last
+ * section measures the real cost of the instrumentation itself.
+ *
+ * Usage: ./input-latency-benchmark [pump_ms ...]
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_input_latency.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using Channel = BoxerInputLatencyTracker::Channel;
+
+namespace {
+
+constexpr uint64_t kTickNs = 100000;          // 0.1ms simulation step
+constexpr uint64_t kFrameNs = 14285714;       // 70Hz VGA frame
+constexpr uint64_t kMouseReportNs = 8000000;  // 125Hz host mouse
+constexpr int kKeyPresses = 2000;
+
+struct PollStyle {
+    const char* name;
+    uint64_t pollIntervalNs;
+};
+
+// Host key press times, identical for every run
+std::vector<uint64_t> makeKeyPressTimes() {
+    std::mt19937_64 rng(20251115);
+    std::uniform_int_distribution<uint64_t> gap_us(30000, 150000);
+    std::vector<uint64_t> times;
+    uint64_t t = 1000000;
+    for (int i = 0; i < kKeyPresses; ++i) {
+        t += gap_us(rng) * 1000;
+        times.push_back(t);
+    }
+    return times;
+}
+
+void runScenario(BoxerInputLatencyTracker& tracker, const std::vector<uint64_t>& key_times,
+                 uint64_t pump_ns, const PollStyle& style) {
+    tracker.reset();
+
+    std::deque<uint64_t> host_keys(key_times.begin(), key_times.end());
+    std::deque<uint64_t> bios_buffer;
+    uint64_t first_unpumped_mouse = 0;
+    uint64_t next_pump = pump_ns;
+    uint64_t next_poll = style.pollIntervalNs;
+    uint64_t next_mouse = kMouseReportNs + 350000;  // not aligned with pumps
+    const uint64_t end = key_times.back() + 1000000000;
+
+    for (uint64_t t = 0; t < end; t += kTickNs) {
+        // Host side: mouse reports accumulate until the next pump
+        if (t >= next_mouse) {
+            if (first_unpumped_mouse == 0) {
+                first_unpumped_mouse = next_mouse;
+            }
+            next_mouse += kMouseReportNs;
+        }
+
+        // Event pump: host events enter the emulator stamped with host time
+        if (t >= next_pump) {
+            while (!host_keys.empty() && host_keys.front() <= t) {
+                tracker.keyEntered(host_keys.front());
+                bios_buffer.push_back(host_keys.front());
+                host_keys.pop_front();
+            }
+            if (first_unpumped_mouse != 0) {
+                tracker.mouseEntered(first_unpumped_mouse);
+                first_unpumped_mouse = 0;
+            }
+            next_pump += pump_ns;
+        }
+
+        // DOS program: INT 16h / INT 33h poll
+        if (t >= next_poll) {
+            if (!bios_buffer.empty()) {
+                bios_buffer.pop_front();
+                tracker.keyConsumed(t);
+            }
+            tracker.mouseObserved(t);
+            next_poll += style.pollIntervalNs;
+        }
+    }
+}
+
+void printRow(const char* style, double pump_ms, const char* channel,
+              const BoxerInputLatencyTracker::Stats& stats) {
+    const auto& h = stats.latency;
+    std::cout << std::left << std::setw(14) << style
+              << std::right << std::setw(8) << std::fixed << std::setprecision(1) << pump_ms
+              << std::setw(10) << channel
+              << std::setw(9) << h.count
+              << std::setw(10) << std::setprecision(2) << h.meanNs / 1e6
+              << std::setw(10) << h.percentileNs(50) / 1e6
+              << std::setw(10) << h.percentileNs(95) / 1e6
+              << std::setw(10) << h.percentileNs(99) / 1e6
+              << std::setw(10) << h.maxNs / 1e6 << std::endl;
+}
+
+void measureOverhead() {
+    std::cout << "\nInstrumentation overhead (real clock):" << std::endl;
+
+    BoxerInputLatencyTracker tracker;
+    const int pairs = 5000000;
+
+    for (bool enabled : {false, true}) {
+        tracker.setEnabled(enabled);
+        tracker.reset();
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < pairs; ++i) {
+            tracker.keyEntered(1);
+            tracker.keyConsumed(2);
+        }
+        const double ns = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << (enabled ? "Enabled:  " : "Disabled: ")
+                  << std::setprecision(2) << ns / pairs << " ns per key (enter + consume)" << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<double> pump_intervals_ms = {1.0, 5.0, 10.0, 16.7, 33.3};
+    if (argc > 1) {
+        pump_intervals_ms.clear();
+        for (int i = 1; i < argc; ++i) {
+            pump_intervals_ms.push_back(std::atof(argv[i]));
+        }
+    }
+
+    const PollStyle styles[] = {
+        {"busy-int16", 200000},  // tight INT 16h AH=01h loop
+        {"per-frame", kFrameNs}, // game polling once per retrace
+    };
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Input Latency Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << kKeyPresses << " key presses, 125Hz mouse, virtual clock\n" << std::endl;
+
+    std::cout << std::left << std::setw(14) << "poll"
+              << std::right << std::setw(8) << "pump_ms"
+              << std::setw(10) << "channel"
+              << std::setw(9) << "events"
+              << std::setw(10) << "mean_ms"
+              << std::setw(10) << "p50_ms"
+              << std::setw(10) << "p95_ms"
+              << std::setw(10) << "p99_ms"
+              << std::setw(10) << "max_ms" << std::endl;
+
+    const auto key_times = makeKeyPressTimes();
+    BoxerInputLatencyTracker tracker;
+    tracker.setEnabled(true);
+
+    for (const auto& style : styles) {
+        for (double pump_ms : pump_intervals_ms) {
+            const auto pump_ns = static_cast<uint64_t>(pump_ms * 1e6);
+            if (pump_ns == 0) {
+                continue;
+            }
+            runScenario(tracker, key_times, pump_ns, style);
+            printRow(style.name, pump_ms, "keyboard", tracker.stats(Channel::Keyboard));
+            printRow(style.name, pump_ms, "mouse", tracker.stats(Channel::Mouse));
+        }
+    }
+
+    measureOverhead();
+    return 0;
+}
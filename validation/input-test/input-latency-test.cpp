@@ -0,0 +1,323 @@
+/*
+ * input-latency-test.cpp - Input latency instrumentation test suite
+ *
+ * Validates BoxerLatencyHistogram and BoxerInputLatencyTracker.
+ *
+ * Test cases:
+ * 1. Histogram bucket boundaries
+ * 2. Percentiles and summary statistics
+ * 3. Keyboard FIFO pairing and overflow accounting
+ * 4. Mouse event coalescing
+ * 5. Disabled tracker records nothing
+ * 6. Concurrent recording and snapshots
+ * 7. Press, release and shift sequences pair per channel
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_input_latency.h"
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using Channel = BoxerInputLatencyTracker::Channel;
+
+bool testBucketBoundaries() {
+    std::cout << "\n[TEST 1] Histogram Bucket Boundaries" << std::endl;
+
+    bool passed = true;
+    for (uint64_t ns = 0; ns < (1u << 20) && passed; ++ns) {
+        const size_t index = BoxerLatencyHistogram::bucketIndex(ns);
+        const uint64_t upper = BoxerLatencyHistogram::bucketUpperBound(index);
+        const uint64_t lower = index == 0 ? 0 : BoxerLatencyHistogram::bucketUpperBound(index - 1) + 1;
+        if (ns < lower || ns > upper) {
+            std::cerr << "  ✗ FAIL: " << ns << "ns landed in [" << lower << ", " << upper << "]" << std::endl;
+            passed = false;
+        }
+    }
+
+    if (BoxerLatencyHistogram::bucketIndex(UINT64_MAX) != BoxerLatencyHistogram::kBuckets - 1) {
+        std::cerr << "  ✗ FAIL: Huge durations must clamp to the last bucket" << std::endl;
+        passed = false;
+    }
+
+    if (passed) {
+        std::cout << "  ✓ Every duration below 1ms falls inside its bucket bounds" << std::endl;
+        std::cout << "  ✓ Out-of-range durations clamp to the last bucket" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testPercentiles() {
+    std::cout << "\n[TEST 2] Percentiles And Summary Statistics" << std::endl;
+
+    BoxerLatencyHistogram histogram;
+    for (uint64_t ms = 1; ms <= 100; ++ms) {
+        histogram.record(ms * 1000000);
+    }
+    const auto snapshot = histogram.snapshot();
+
+    bool passed = true;
+    if (snapshot.count != 100 || snapshot.minNs != 1000000 || snapshot.maxNs != 100000000) {
+        std::cerr << "  ✗ FAIL: Wrong count/min/max" << std::endl;
+        passed = false;
+    }
+
+    // Bucket resolution is within 25% of the true value
+    const struct { double percentile; double expected_ms; } checks[] = {
+        {50.0, 50.0}, {95.0, 95.0}, {99.0, 99.0},
+    };
+    for (const auto& check : checks) {
+        const double got_ms = snapshot.percentileNs(check.percentile) / 1e6;
+        if (got_ms < check.expected_ms || got_ms > check.expected_ms * 1.25) {
+            std::cerr << "  ✗ FAIL: p" << check.percentile << " = " << got_ms
+                      << "ms, expected ~" << check.expected_ms << "ms" << std::endl;
+            passed = false;
+        } else {
+            std::cout << "  ✓ p" << check.percentile << " = " << got_ms << " ms" << std::endl;
+        }
+    }
+
+    if (snapshot.meanNs < 50.4e6 || snapshot.meanNs > 50.6e6) {
+        std::cerr << "  ✗ FAIL: Mean " << snapshot.meanNs << "ns, expected 50.5ms" << std::endl;
+        passed = false;
+    }
+
+    if (passed) {
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testKeyboardPairing() {
+    std::cout << "\n[TEST 3] Keyboard FIFO Pairing And Overflow" << std::endl;
+
+    BoxerInputLatencyTracker tracker;
+    tracker.setEnabled(true);
+    bool passed = true;
+
+    // Three keys typed at t=1,2,3ms, read at t=10,20,30ms
+    tracker.keyEntered(1000000);
+    tracker.keyEntered(2000000);
+    tracker.keyEntered(3000000);
+    tracker.keyConsumed(10000000);
+    tracker.keyConsumed(20000000);
+    tracker.keyConsumed(30000000);
+    tracker.keyConsumed(40000000);  // no pending key
+
+    auto stats = tracker.stats(Channel::Keyboard);
+    if (stats.latency.count != 3 || stats.latency.minNs != 9000000 || stats.latency.maxNs != 27000000) {
+        std::cerr << "  ✗ FAIL: Keys were not paired in FIFO order" << std::endl;
+        passed = false;
+    } else {
+        std::cout << "  ✓ Entry and consume stamps paired oldest-first" << std::endl;
+    }
+    if (stats.unmatchedConsumes != 1) {
+        std::cerr << "  ✗ FAIL: Unmatched consume not counted" << std::endl;
+        passed = false;
+    } else {
+        std::cout << "  ✓ Consume without a pending key counted as unmatched" << std::endl;
+    }
+
+    // Never-read keys overflow the pending ring
+    tracker.reset();
+    for (size_t i = 0; i < BoxerInputLatencyTracker::kPendingKeys + 10; ++i) {
+        tracker.keyEntered(1 + i);
+    }
+    stats = tracker.stats(Channel::Keyboard);
+    if (stats.droppedEntries != 10) {
+        std::cerr << "  ✗ FAIL: Expected 10 dropped stamps, got " << stats.droppedEntries << std::endl;
+        passed = false;
+    } else {
+        std::cout << "  ✓ Overflowed stamps counted as dropped" << std::endl;
+    }
+
+    if (passed) {
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testMouseCoalescing() {
+    std::cout << "\n[TEST 4] Mouse Event Coalescing" << std::endl;
+
+    BoxerInputLatencyTracker tracker;
+    tracker.setEnabled(true);
+
+    // Several moves before one poll: latency runs from the first move
+    tracker.mouseEntered(5000000);
+    tracker.mouseEntered(6000000);
+    tracker.mouseEntered(7000000);
+    tracker.mouseObserved(15000000);
+    tracker.mouseObserved(16000000);  // nothing new to observe
+
+    const auto stats = tracker.stats(Channel::Mouse);
+    const bool passed = stats.latency.count == 1 && stats.latency.maxNs == 10000000;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Expected one 10ms sample" << std::endl;
+    } else {
+        std::cout << "  ✓ Three moves and two polls produced one 10ms sample" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testDisabled() {
+    std::cout << "\n[TEST 5] Disabled Tracker Records Nothing" << std::endl;
+
+    BoxerInputLatencyTracker tracker;
+    tracker.keyEntered();
+    tracker.keyConsumed();
+    tracker.mouseEntered();
+    tracker.mouseObserved();
+    tracker.scancodeEntered();
+    tracker.scancodeConsumed();
+
+    // A mouse event pending from before the tracker was disabled
+    BoxerInputLatencyTracker stale;
+    stale.setEnabled(true);
+    stale.mouseEntered(1000000);
+    stale.setEnabled(false);
+    stale.mouseObserved(2000000);
+
+    const bool passed = tracker.stats(Channel::Keyboard).latency.count == 0 &&
+                        tracker.stats(Channel::Mouse).latency.count == 0 &&
+                        tracker.stats(Channel::Scancode).latency.count == 0 &&
+                        stale.stats(Channel::Mouse).latency.count == 0;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Samples recorded while disabled" << std::endl;
+    } else {
+        std::cout << "  ✓ No samples while disabled (default)" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testConcurrentSnapshots() {
+    std::cout << "\n[TEST 6] Concurrent Recording And Snapshots" << std::endl;
+
+    BoxerInputLatencyTracker tracker;
+    tracker.setEnabled(true);
+    const int keys = 200000;
+    std::atomic<bool> done{false};
+
+    std::thread reader([&]() {
+        while (!done.load()) {
+            tracker.stats(Channel::Keyboard);
+            std::this_thread::yield();
+        }
+    });
+
+    for (int i = 0; i < keys; ++i) {
+        tracker.keyEntered();
+        tracker.keyConsumed();
+    }
+    done.store(true);
+    reader.join();
+
+    const auto stats = tracker.stats(Channel::Keyboard);
+    const bool passed = stats.latency.count == static_cast<uint64_t>(keys) &&
+                        stats.unmatchedConsumes == 0;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Lost samples under concurrent snapshots" << std::endl;
+    } else {
+        std::cout << "  ✓ " << keys << " samples recorded while another thread read stats" << std::endl;
+        std::cout << "  ✓ Median recording overhead sample: "
+                  << stats.latency.percentileNs(50) << " ns" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testPressReleaseSequences() {
+    std::cout << "\n[TEST 7] Press, Release And Shift Sequences" << std::endl;
+
+    BoxerInputLatencyTracker tracker;
+    tracker.setEnabled(true);
+
+    // Typing "aA" 50 times. Each letter is a make and a break scancode; the
+    // capital adds Shift make and break. Only the letters reach the BIOS
+    // buffer. INT 9 reads every scancode 0.1ms after it is queued; the
+    // program reads the BIOS buffer 5ms after each letter.
+    const uint64_t ms = 1000000;
+    uint64_t t = ms;
+    auto scancode = [&tracker, &t, ms](bool addsKey) {
+        tracker.scancodeEntered(t);
+        tracker.scancodeConsumed(t + ms / 10);
+        if (addsKey) {
+            tracker.keyEntered(t + ms / 10);
+        }
+        t += ms;
+    };
+    for (int i = 0; i < 50; ++i) {
+        scancode(true);    // A make
+        scancode(false);   // A break
+        tracker.keyConsumed(t + 5 * ms);
+        t += 10 * ms;
+        scancode(false);   // Shift make
+        scancode(true);    // A make
+        scancode(false);   // A break
+        scancode(false);   // Shift break
+        tracker.keyConsumed(t + 5 * ms);
+        t += 10 * ms;
+    }
+
+    const auto keys = tracker.stats(Channel::Keyboard);
+    const auto scancodes = tracker.stats(Channel::Scancode);
+    bool passed = true;
+    // First letter: added at +0.1ms, read 2ms + 5ms after its make code;
+    // the capital: added at +1.1ms, read 4ms + 5ms after Shift make
+    if (keys.latency.count != 100 || keys.latency.minNs != 6900000 || keys.latency.maxNs != 7900000 ||
+        keys.droppedEntries != 0 || keys.unmatchedConsumes != 0) {
+        std::cerr << "  ✗ FAIL: BIOS key pairing drifted (" << keys.latency.count << " samples, "
+                  << keys.latency.minNs << "-" << keys.latency.maxNs << "ns)" << std::endl;
+        passed = false;
+    } else {
+        std::cout << "  ✓ 100 letters, every INT 16h read paired with its own key" << std::endl;
+    }
+    if (scancodes.latency.count != 300 || scancodes.latency.maxNs != ms / 10 ||
+        scancodes.unmatchedConsumes != 0) {
+        std::cerr << "  ✗ FAIL: Scancode channel did not pair every byte" << std::endl;
+        passed = false;
+    } else {
+        std::cout << "  ✓ 300 make, break and Shift codes paired on the scancode channel" << std::endl;
+    }
+
+    if (passed) {
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Input Latency Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testBucketBoundaries()) passed++; else failed++;
+    if (testPercentiles()) passed++; else failed++;
+    if (testKeyboardPairing()) passed++; else failed++;
+    if (testMouseCoalescing()) passed++; else failed++;
+    if (testDisabled()) passed++; else failed++;
+    if (testConcurrentSnapshots()) passed++; else failed++;
+    if (testPressReleaseSequences()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
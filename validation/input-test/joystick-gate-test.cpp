@@ -0,0 +1,194 @@
+/*
+ * joystick-gate-test.cpp - Lazy joystick polling test suite
+ *
+ * Validates BoxerJoystickGate, which drives:
+ * - INT-060: setJoystickActive
+ *
+ * Test cases:
+ * 1. Gate starts dormant
+ * 2. First gameport access wakes it exactly once
+ * 3. Idle timeout puts it back to sleep
+ * 4. Later access wakes it again
+ * 5. Host polls over simulated sessions
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_joystick_gate.h"
+
+#include <iostream>
+
+using Transition = BoxerJoystickGate::Transition;
+
+bool testStartsDormant() {
+    std::cout << "\n[TEST 1] Gate Starts Dormant" << std::endl;
+
+    BoxerJoystickGate gate;
+    const bool passed = !gate.isActive() &&
+                        gate.update(0) == Transition::None &&
+                        gate.update(1000000) == Transition::None &&
+                        gate.wakeCount() == 0;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Gate active or transitioning without gameport access" << std::endl;
+    } else {
+        std::cout << "  ✓ No polling and no transitions before port 0x201 is touched" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testWakesOnce() {
+    std::cout << "\n[TEST 2] First Gameport Access Wakes It Exactly Once" << std::endl;
+
+    BoxerJoystickGate gate;
+    bool passed = gate.noteGameportAccess(100) == Transition::Woke && gate.isActive();
+    for (uint64_t t = 101; t < 10000; ++t) {
+        if (gate.noteGameportAccess(t) != Transition::None) {
+            passed = false;
+        }
+    }
+    passed = passed && gate.wakeCount() == 1;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Expected a single Woke transition" << std::endl;
+    } else {
+        std::cout << "  ✓ 9,900 accesses, one setJoystickActive(true)" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testIdleTimeout() {
+    std::cout << "\n[TEST 3] Idle Timeout Puts It Back To Sleep" << std::endl;
+
+    BoxerJoystickGate gate(1000);
+    gate.noteGameportAccess(5000);
+    bool passed = true;
+
+    if (gate.update(5999) != Transition::None || !gate.isActive()) {
+        std::cerr << "  ✗ FAIL: Slept before the timeout" << std::endl;
+        passed = false;
+    }
+    // Clock behind the last access (e.g. after a reset) must not underflow
+    if (gate.update(10) != Transition::None) {
+        std::cerr << "  ✗ FAIL: Earlier timestamp treated as idle" << std::endl;
+        passed = false;
+    }
+    if (gate.update(6000) != Transition::Slept || gate.isActive()) {
+        std::cerr << "  ✗ FAIL: Did not sleep at the timeout" << std::endl;
+        passed = false;
+    }
+    if (gate.update(7000) != Transition::None) {
+        std::cerr << "  ✗ FAIL: Slept twice" << std::endl;
+        passed = false;
+    }
+
+    if (passed) {
+        std::cout << "  ✓ Sleeps exactly once, at the timeout" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testRewake() {
+    std::cout << "\n[TEST 4] Later Access Wakes It Again" << std::endl;
+
+    BoxerJoystickGate gate(1000);
+    gate.noteGameportAccess(0);
+    gate.update(2000);
+    const bool passed = gate.noteGameportAccess(3000) == Transition::Woke &&
+                        gate.update(3500) == Transition::None &&
+                        gate.wakeCount() == 2;
+
+    gate.reset();
+    const bool reset_ok = !gate.isActive() && gate.wakeCount() == 0;
+
+    if (!passed || !reset_ok) {
+        std::cerr << "  ✗ FAIL: Wake/sleep cycle or reset broken" << std::endl;
+    } else {
+        std::cout << "  ✓ Wake, sleep, wake; reset returns to dormant" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed && reset_ok;
+}
+
+// Counts host polls for a session pumped every 1ms; the guest reads the
+// gameport once per 14ms frame between the given times
+static uint64_t simulateSession(uint64_t durationMs, uint64_t readFromMs, uint64_t readUntilMs,
+                                uint64_t& transitions) {
+    BoxerJoystickGate gate;
+    uint64_t host_polls = 0;
+    transitions = 0;
+    for (uint64_t t = 0; t < durationMs; ++t) {
+        if (t >= readFromMs && t < readUntilMs && t % 14 == 0) {
+            if (gate.noteGameportAccess(t) != Transition::None) {
+                ++transitions;
+            }
+        }
+        if (gate.update(t) != Transition::None) {
+            ++transitions;
+        }
+        if (gate.isActive()) {
+            ++host_polls;
+        }
+    }
+    return host_polls;
+}
+
+bool testSessionPolls() {
+    std::cout << "\n[TEST 5] Host Polls Over Simulated Sessions" << std::endl;
+
+    const uint64_t ten_minutes = 600000;
+    uint64_t transitions = 0;
+
+    // Legacy: every pump polls host joysticks
+    std::cout << "  Legacy polls (any session):  " << ten_minutes << std::endl;
+
+    const uint64_t no_joystick = simulateSession(ten_minutes, 0, 0, transitions);
+    std::cout << "  No gameport use:             " << no_joystick << std::endl;
+    bool passed = no_joystick == 0 && transitions == 0;
+
+    // Joystick game for 2 minutes, then back to the DOS prompt
+    const uint64_t game = simulateSession(ten_minutes, 60000, 180000, transitions);
+    std::cout << "  2 min of joystick game:      " << game << std::endl;
+    passed = passed && transitions == 2 &&
+             game >= 120000 && game <= 120000 + BoxerJoystickGate::kDefaultIdleTimeoutMs + 14;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Polling not limited to gameport activity" << std::endl;
+    } else {
+        std::cout << "  ✓ Polling only while the guest uses the gameport (+ idle timeout)" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Joystick Gate Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-060 replacement" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testStartsDormant()) passed++; else failed++;
+    if (testWakesOnce()) passed++; else failed++;
+    if (testIdleTimeout()) passed++; else failed++;
+    if (testRewake()) passed++; else failed++;
+    if (testSessionPolls()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
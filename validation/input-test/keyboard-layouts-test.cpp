@@ -0,0 +1,338 @@
+/*
+ * keyboard-layouts-test.cpp - Keyboard layout registry test suite
+ *
+ * Validates BoxerKeyboardLayoutRegistry, the index behind:
+ * - INT-063: keyboardLayoutLoaded
+ * - INT-064: keyboardLayoutName
+ * - INT-065: keyboardLayoutSupported
+ *
+ * Test cases:
+ * 1. KCF container codes and numeric aliases indexed
+ * 2. Lookups are case-insensitive
+ * 3. Entry points at the right bytes in the mapping
+ * 4. .kl files indexed by name and take precedence
+ * 5. Invalid and missing files rejected
+ * 6. Lookup cost vs legacy per-query file scan
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_keyboard_layouts.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <strings.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct KcfCode {
+    uint16_t number;
+    std::string name;
+};
+
+// One KCF entry: [u16 length][u8 codes length][codes][payload]
+void appendKcfEntry(std::vector<uint8_t>& file, const std::vector<KcfCode>& codes,
+                    const std::vector<uint8_t>& payload) {
+    std::vector<uint8_t> region;
+    for (size_t i = 0; i < codes.size(); ++i) {
+        region.push_back(codes[i].number & 0xFF);
+        region.push_back(codes[i].number >> 8);
+        region.insert(region.end(), codes[i].name.begin(), codes[i].name.end());
+        if (i + 1 < codes.size()) {
+            region.push_back(',');
+        }
+    }
+    const size_t length = region.size() + payload.size();
+    file.push_back(length & 0xFF);
+    file.push_back(length >> 8);
+    file.push_back(static_cast<uint8_t>(region.size()));
+    file.insert(file.end(), region.begin(), region.end());
+    file.insert(file.end(), payload.begin(), payload.end());
+}
+
+std::vector<uint8_t> kcfHeader() {
+    // Magic, version, 2-byte description
+    return {'K', 'C', 'F', 0x01, 0x00, 0x00, 0x02, 'x', 'x'};
+}
+
+void writeFile(const fs::path& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+class TempLayoutDirectory {
+public:
+    TempLayoutDirectory() {
+        m_path = fs::temp_directory_path() /
+                 ("boxer-layouts-test-" + std::to_string(std::chrono::steady_clock::now()
+                                                            .time_since_epoch().count()));
+        fs::create_directories(m_path);
+
+        std::vector<uint8_t> kcf = kcfHeader();
+        appendKcfEntry(kcf, {{0, "us"}}, {0xA0, 0xA1});
+        appendKcfEntry(kcf, {{129, "gr"}, {0, "de"}}, {0xB0, 0xB1, 0xB2});
+        appendKcfEntry(kcf, {{189, "fr"}, {120, "be"}}, {0xC0});
+        writeFile(m_path / "keyboard.sys", kcf);
+
+        // Standalone .kl overrides the container's "fr"
+        writeFile(m_path / "FR.kl", {'K', 'L', 'F', 0x01, 0x00, 0xD0, 0xD1});
+        writeFile(m_path / "notes.txt", {'n', 'o', 'p', 'e'});
+    }
+
+    ~TempLayoutDirectory() {
+        std::error_code error;
+        fs::remove_all(m_path, error);
+    }
+
+    const fs::path& path() const { return m_path; }
+
+private:
+    fs::path m_path;
+};
+
+// Legacy model: scan the container from disk for every query
+bool legacyLayoutSupported(const std::string& path, const char* code) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    uint8_t buffer[4096];
+    const size_t size = std::fread(buffer, 1, sizeof(buffer), file);
+    std::fclose(file);
+
+    size_t pos = 7 + buffer[6];
+    while (pos + 5 <= size) {
+        const size_t length = buffer[pos] | (buffer[pos + 1] << 8);
+        const size_t codesLength = buffer[pos + 2];
+        size_t i = 0;
+        while (i + 2 <= codesLength) {
+            i += 2;
+            std::string name;
+            while (i < codesLength && buffer[pos + 3 + i] != ',') {
+                name.push_back(static_cast<char>(buffer[pos + 3 + i++]));
+            }
+            ++i;
+            if (strcasecmp(name.c_str(), code) == 0) {
+                return true;
+            }
+        }
+        pos += 3 + length;
+    }
+    return false;
+}
+
+} // namespace
+
+bool testContainerIndex(const TempLayoutDirectory& dir) {
+    std::cout << "\n[TEST 1] KCF Container Codes And Numeric Aliases" << std::endl;
+
+    BoxerKeyboardLayoutRegistry registry;
+    const size_t added = registry.addFile((dir.path() / "keyboard.sys").string());
+
+    // us, gr, gr129, de, fr, fr189, be, be120
+    bool passed = added == 8 && registry.size() == 8;
+    for (const char* code : {"us", "gr", "gr129", "de", "fr189", "be120"}) {
+        if (!registry.isSupported(code)) {
+            std::cerr << "  ✗ FAIL: Missing code " << code << std::endl;
+            passed = false;
+        }
+    }
+    if (registry.isSupported("de0") || registry.isSupported("xx")) {
+        std::cerr << "  ✗ FAIL: Indexed a code that is not in the file" << std::endl;
+        passed = false;
+    }
+
+    if (passed) {
+        std::cout << "  ✓ " << added << " codes indexed from one container" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testCaseInsensitive(const TempLayoutDirectory& dir) {
+    std::cout << "\n[TEST 2] Lookups Are Case-Insensitive" << std::endl;
+
+    BoxerKeyboardLayoutRegistry registry;
+    registry.addDirectory(dir.path().string());
+
+    const bool passed = registry.isSupported("GR") && registry.isSupported("Gr129") &&
+                        registry.find("DE") == registry.find("de") &&
+                        !registry.isSupported(nullptr);
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Case variants resolved differently" << std::endl;
+    } else {
+        std::cout << "  ✓ GR, Gr129 and DE resolve like their lowercase forms" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testEntryLocation(const TempLayoutDirectory& dir) {
+    std::cout << "\n[TEST 3] Entry Points At The Right Bytes" << std::endl;
+
+    BoxerKeyboardLayoutRegistry registry;
+    registry.addFile((dir.path() / "keyboard.sys").string());
+
+    const auto* gr = registry.find("gr");
+    const auto* de = registry.find("de129");
+    const auto* us = registry.find("us");
+    bool passed = gr && us && !de;
+
+    if (passed) {
+        // gr follows the 9-byte us entry: 3-byte header, 9 bytes of codes, payload
+        const uint8_t* payload = gr->data() + 3 + gr->data()[2];
+        passed = gr->entryOffset == 9 + 9 &&
+                 gr->entrySize == 3 + 9 + 3 &&
+                 payload[0] == 0xB0 && payload[2] == 0xB2 &&
+                 us->entryOffset == 9 &&
+                 registry.find("gr129")->entryOffset == gr->entryOffset;
+    }
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Layout entry offsets or payload wrong" << std::endl;
+    } else {
+        std::cout << "  ✓ Offsets match read_kcl_file() positions" << std::endl;
+        std::cout << "  ✓ Aliases share their entry" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testStandaloneLayoutPrecedence(const TempLayoutDirectory& dir) {
+    std::cout << "\n[TEST 4] .kl Files Indexed By Name And Take Precedence" << std::endl;
+
+    BoxerKeyboardLayoutRegistry registry;
+    registry.addDirectory(dir.path().string());
+
+    const auto* fr = registry.find("fr");
+    const auto* fr189 = registry.find("fr189");
+    bool passed = fr && fr189 &&
+                  fr->entryOffset == 0 && fr->data()[5] == 0xD0 &&
+                  fs::path(*fr->path).extension() == ".kl" &&
+                  fs::path(*fr189->path).filename() == "keyboard.sys";
+
+    const auto codes = registry.codes();
+    const std::vector<std::string> expected = {"be", "be120", "de", "fr", "fr189", "gr", "gr129", "us"};
+    if (codes != expected) {
+        std::cerr << "  ✗ FAIL: Unexpected code list" << std::endl;
+        passed = false;
+    }
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: FR.kl did not override the container entry" << std::endl;
+    } else {
+        std::cout << "  ✓ fr from FR.kl, fr189 from keyboard.sys" << std::endl;
+        std::cout << "  ✓ notes.txt ignored, code list sorted" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testInvalidFiles(const TempLayoutDirectory& dir) {
+    std::cout << "\n[TEST 5] Invalid And Missing Files Rejected" << std::endl;
+
+    writeFile(dir.path() / "bogus.kcf", {'M', 'Z', 0x90, 0x00, 0x03, 0x00, 0x00, 0x00});
+    std::vector<uint8_t> truncated = kcfHeader();
+    appendKcfEntry(truncated, {{0, "it"}}, {0x01, 0x02, 0x03});
+    truncated.resize(truncated.size() - 2);
+    writeFile(dir.path() / "truncated.kcf", truncated);
+
+    BoxerKeyboardLayoutRegistry registry;
+    const bool passed =
+        registry.addFile((dir.path() / "bogus.kcf").string()) == 0 &&
+        registry.addFile((dir.path() / "missing.kcf").string()) == 0 &&
+        registry.addFile((dir.path() / "truncated.kcf").string()) == 0 &&
+        registry.size() == 0;
+
+    fs::remove(dir.path() / "bogus.kcf");
+    fs::remove(dir.path() / "truncated.kcf");
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Indexed codes from an invalid file" << std::endl;
+    } else {
+        std::cout << "  ✓ Wrong magic, missing file and truncated entry all ignored" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testLookupCost(const TempLayoutDirectory& dir) {
+    std::cout << "\n[TEST 6] Lookup Cost vs Legacy File Scan" << std::endl;
+
+    const std::string container = (dir.path() / "keyboard.sys").string();
+    const char* queries[] = {"us", "GR", "be", "xx"};
+    const int legacy_iterations = 20000;
+    const int indexed_iterations = 2000000;
+
+    int legacy_hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < legacy_iterations; ++i) {
+        legacy_hits += legacyLayoutSupported(container, queries[i % 4]) ? 1 : 0;
+    }
+    const double legacy_ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / legacy_iterations;
+
+    BoxerKeyboardLayoutRegistry registry;
+    registry.addFile(container);
+    int indexed_hits = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < indexed_iterations; ++i) {
+        indexed_hits += registry.isSupported(queries[i % 4]) ? 1 : 0;
+    }
+    const double indexed_ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / indexed_iterations;
+
+    std::cout << "  Legacy scan:   " << legacy_ns << " ns per query" << std::endl;
+    std::cout << "  Indexed:       " << indexed_ns << " ns per query" << std::endl;
+
+    const bool passed = legacy_hits == legacy_iterations * 3 / 4 &&
+                        indexed_hits == indexed_iterations * 3 / 4 &&
+                        indexed_ns < legacy_ns;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Index disagrees with scan or is slower" << std::endl;
+    } else {
+        std::cout << "  ✓ Speedup: " << legacy_ns / indexed_ns << "x" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Keyboard Layout Registry Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-063, INT-064, INT-065 replacement" << std::endl;
+
+    TempLayoutDirectory dir;
+    int passed = 0;
+    int failed = 0;
+
+    if (testContainerIndex(dir)) passed++; else failed++;
+    if (testCaseInsensitive(dir)) passed++; else failed++;
+    if (testEntryLocation(dir)) passed++; else failed++;
+    if (testStandaloneLayoutPrecedence(dir)) passed++; else failed++;
+    if (testInvalidFiles(dir)) passed++; else failed++;
+    if (testLookupCost(dir)) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
@@ -0,0 +1,211 @@
+/*
+ * lock-state-test.cpp - Lock-key state word test suite
+ *
+ * Validates BoxerLockState, the replacement for per-event lock hooks:
+ * - INT-068: setNumLockActive
+ * - INT-069: setCapsLockActive
+ * - INT-070: setScrollLockActive
+ *
+ * Test cases:
+ * 1. BIOS flag byte conversion
+ * 2. Publish reports only changed bits
+ * 3. Generation moves only on real changes
+ * 4. Hook calls on a simulated INT 9 stream
+ * 5. Concurrent readers see consistent snapshots
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_lock_state.h"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+bool testBiosFlagConversion() {
+    std::cout << "\n[TEST 1] BIOS Flag Byte Conversion" << std::endl;
+
+    // BDA 0040:0017 bit 4 = Scroll, bit 5 = Num, bit 6 = Caps, others unrelated
+    const bool passed =
+        BoxerLockState::locksFromBiosFlags(0x10) == BoxerLockState::ScrollLock &&
+        BoxerLockState::locksFromBiosFlags(0x20) == BoxerLockState::NumLock &&
+        BoxerLockState::locksFromBiosFlags(0x40) == BoxerLockState::CapsLock &&
+        BoxerLockState::locksFromBiosFlags(0x8F) == 0 &&
+        BoxerLockState::locksFromBiosFlags(0xFF) == BoxerLockState::AllLocks;
+
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Wrong lock bits from BIOS flags" << std::endl;
+    } else {
+        std::cout << "  ✓ Scroll/Num/Caps mapped, shift/ctrl/alt/insert ignored" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testChangedMask() {
+    std::cout << "\n[TEST 2] Publish Reports Only Changed Bits" << std::endl;
+
+    BoxerLockState state;
+    bool passed = true;
+
+    if (state.publish(BoxerLockState::NumLock) != BoxerLockState::NumLock) {
+        std::cerr << "  ✗ FAIL: Num Lock on not reported" << std::endl;
+        passed = false;
+    }
+    if (state.publish(BoxerLockState::NumLock) != 0) {
+        std::cerr << "  ✗ FAIL: Identical state reported as a change" << std::endl;
+        passed = false;
+    }
+    const uint8_t changed = state.publish(BoxerLockState::CapsLock);
+    if (changed != (BoxerLockState::NumLock | BoxerLockState::CapsLock)) {
+        std::cerr << "  ✗ FAIL: Expected Num and Caps in change mask" << std::endl;
+        passed = false;
+    }
+    if (state.publish(0xF8 | BoxerLockState::CapsLock) != 0) {
+        std::cerr << "  ✗ FAIL: Bits outside the lock mask leaked in" << std::endl;
+        passed = false;
+    }
+
+    if (passed) {
+        std::cout << "  ✓ Change mask contains exactly the toggled locks" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testGeneration() {
+    std::cout << "\n[TEST 3] Generation Moves Only On Real Changes" << std::endl;
+
+    BoxerLockState state;
+    uint32_t seen = state.load().generation;
+    BoxerLockState::Snapshot snapshot{};
+    bool passed = true;
+
+    state.publish(0);
+    if (state.pollChange(seen, snapshot)) {
+        std::cerr << "  ✗ FAIL: Republishing the initial state bumped the generation" << std::endl;
+        passed = false;
+    }
+
+    state.publish(BoxerLockState::ScrollLock);
+    if (!state.pollChange(seen, snapshot) || !snapshot.scrollLock() || snapshot.numLock()) {
+        std::cerr << "  ✗ FAIL: Poller missed Scroll Lock turning on" << std::endl;
+        passed = false;
+    }
+    if (state.pollChange(seen, snapshot)) {
+        std::cerr << "  ✗ FAIL: Same change reported twice" << std::endl;
+        passed = false;
+    }
+
+    if (passed) {
+        std::cout << "  ✓ Poller sees each change exactly once" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testHookCallReduction() {
+    std::cout << "\n[TEST 4] Hook Calls On A Simulated INT 9 Stream" << std::endl;
+
+    // 100k key events; Caps Lock toggled every 500 events, Num Lock on throughout
+    const int events = 100000;
+    BoxerLockState state;
+    uint64_t legacy_calls = 0;
+    uint64_t new_calls = 0;
+    uint8_t bios_flags = 0x20;
+
+    for (int i = 0; i < events; ++i) {
+        if (i % 500 == 0) {
+            bios_flags ^= 0x40;
+        }
+        // Legacy: all three setters on every flag update
+        legacy_calls += 3;
+
+        // New: one publish, hooks only for bits that changed
+        const uint8_t changed = state.publish(BoxerLockState::locksFromBiosFlags(bios_flags));
+        for (uint8_t bit = 1; bit <= BoxerLockState::CapsLock; bit <<= 1) {
+            if (changed & bit) {
+                ++new_calls;
+            }
+        }
+    }
+
+    std::cout << "  Legacy hook calls: " << legacy_calls << std::endl;
+    std::cout << "  Change-only calls: " << new_calls << std::endl;
+
+    // 200 Caps toggles + the initial Num Lock
+    const bool passed = new_calls == 201;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Expected 201 change notifications" << std::endl;
+    } else {
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testConcurrentReaders() {
+    std::cout << "\n[TEST 5] Concurrent Readers See Consistent Snapshots" << std::endl;
+
+    BoxerLockState state;
+    const uint32_t changes = 1000000;
+    std::atomic<bool> done{false};
+    std::atomic<bool> consistent{true};
+
+    // Writer publishes i % 8 for generation i, so readers can verify pairing
+    std::thread reader([&]() {
+        while (!done.load(std::memory_order_relaxed)) {
+            const auto snapshot = state.load();
+            if (snapshot.locks != (snapshot.generation % 8)) {
+                consistent.store(false);
+            }
+        }
+    });
+
+    for (uint32_t i = 1; i <= changes; ++i) {
+        state.publish(static_cast<uint8_t>(i % 8));
+        if (i % 4096 == 0) {
+            std::this_thread::yield();
+        }
+    }
+    done.store(true);
+    reader.join();
+
+    const bool passed = consistent.load() && state.load().generation == changes;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Reader saw a torn state/generation pair" << std::endl;
+    } else {
+        std::cout << "  ✓ " << changes << " changes, every snapshot consistent" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Lock State Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-068, INT-069, INT-070 replacement" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testBiosFlagConversion()) passed++; else failed++;
+    if (testChangedMask()) passed++; else failed++;
+    if (testGeneration()) passed++; else failed++;
+    if (testHookCallReduction()) passed++; else failed++;
+    if (testConcurrentReaders()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
@@ -0,0 +1,368 @@
+/*
+ * paste-buffer-test.cpp - Bulk paste ring test suite
+ *
+ * Validates BoxerPasteBuffer, the replacement for the per-key paste hooks:
+ * - INT-062: keyboardBufferRemaining
+ * - INT-073: numKeyCodesInPasteBuffer
+ * - INT-074: getNextKeyCodeInPasteBuffer
+ *
+ * Test cases:
+ * 1. FIFO order across ring wraparound
+ * 2. Partial enqueue when the ring is full
+ * 3. BIOS buffer fill respects free and reserved slots
+ * 4. Clear drops only keycodes queued before it
+ * 5. Threaded producer/consumer ordering
+ * 6. Throughput versus per-key hook round trips
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_paste_buffer.h"
+
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// Simulated BIOS keyboard buffer (15 usable slots, like the real BDA ring)
+// ============================================================================
+
+class SimulatedBiosKeyboard {
+public:
+    static constexpr size_t kSlots = 15;
+
+    size_t freeSlots() const { return kSlots - m_keys.size(); }
+
+    bool addKey(uint16_t keyCode) {
+        if (m_keys.size() >= kSlots) {
+            return false;
+        }
+        m_keys.push_back(keyCode);
+        return true;
+    }
+
+    bool readKey(uint16_t& keyCode) {
+        if (m_keys.empty()) {
+            return false;
+        }
+        keyCode = m_keys.front();
+        m_keys.pop_front();
+        return true;
+    }
+
+private:
+    std::deque<uint16_t> m_keys;
+};
+
+// Legacy per-key interface, as Boxer implemented it behind the delegate
+class LegacyPasteDelegate {
+public:
+    virtual ~LegacyPasteDelegate() = default;
+    virtual size_t numKeyCodesInPasteBuffer() = 0;
+    virtual bool getNextKeyCodeInPasteBuffer(uint16_t* outKeyCode, bool consumeKey) = 0;
+};
+
+class DequePasteDelegate : public LegacyPasteDelegate {
+public:
+    std::deque<uint16_t> keys;
+
+    size_t numKeyCodesInPasteBuffer() override { return keys.size(); }
+
+    bool getNextKeyCodeInPasteBuffer(uint16_t* outKeyCode, bool consumeKey) override {
+        if (keys.empty()) {
+            return false;
+        }
+        *outKeyCode = keys.front();
+        if (consumeKey) {
+            keys.pop_front();
+        }
+        return true;
+    }
+};
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+bool testWraparoundOrder() {
+    std::cout << "\n[TEST 1] FIFO Order Across Wraparound" << std::endl;
+
+    BoxerPasteBuffer buffer(8);
+    bool passed = true;
+    uint16_t next_in = 0;
+    uint16_t next_out = 0;
+
+    for (int round = 0; round < 100 && passed; ++round) {
+        uint16_t span[5];
+        for (auto& code : span) {
+            code = next_in++;
+        }
+        if (buffer.enqueue(span, 5) != 5) {
+            std::cerr << "  ✗ FAIL: Enqueue rejected keys in round " << round << std::endl;
+            passed = false;
+            break;
+        }
+        uint16_t out[5];
+        const size_t count = buffer.dequeue(out, 5);
+        for (size_t i = 0; i < count; ++i) {
+            if (out[i] != next_out++) {
+                std::cerr << "  ✗ FAIL: Out of order keycode in round " << round << std::endl;
+                passed = false;
+                break;
+            }
+        }
+    }
+
+    if (passed) {
+        std::cout << "  ✓ 500 keycodes delivered in order through an 8-slot ring" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testPartialEnqueue() {
+    std::cout << "\n[TEST 2] Partial Enqueue When Full" << std::endl;
+
+    BoxerPasteBuffer buffer(16);
+    std::vector<uint16_t> codes(40, 0x1E61);
+    bool passed = true;
+
+    const size_t accepted = buffer.enqueue(codes.data(), codes.size());
+    if (accepted != buffer.capacity()) {
+        std::cerr << "  ✗ FAIL: Accepted " << accepted << ", expected " << buffer.capacity() << std::endl;
+        passed = false;
+    } else {
+        std::cout << "  ✓ Accepted exactly " << accepted << " of " << codes.size() << std::endl;
+    }
+
+    if (buffer.enqueue(codes.data(), 1) != 0) {
+        std::cerr << "  ✗ FAIL: Full ring accepted another keycode" << std::endl;
+        passed = false;
+    } else {
+        std::cout << "  ✓ Full ring refuses further keycodes" << std::endl;
+    }
+
+    if (passed) {
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testFillRespectsBiosSpace() {
+    std::cout << "\n[TEST 3] BIOS Fill Respects Free And Reserved Slots" << std::endl;
+
+    BoxerPasteBuffer buffer;
+    SimulatedBiosKeyboard bios;
+    std::vector<uint16_t> codes(100);
+    for (size_t i = 0; i < codes.size(); ++i) {
+        codes[i] = static_cast<uint16_t>(i);
+    }
+    buffer.enqueue(codes.data(), codes.size());
+
+    auto add_key = [&bios](uint16_t code) { return bios.addKey(code); };
+    bool passed = true;
+
+    size_t delivered = buffer.fillKeyboardBuffer(bios.freeSlots(), 1, add_key);
+    if (delivered != SimulatedBiosKeyboard::kSlots - 1) {
+        std::cerr << "  ✗ FAIL: Delivered " << delivered << ", expected 14" << std::endl;
+        passed = false;
+    } else {
+        std::cout << "  ✓ First fill delivered 14 keys, leaving one slot reserved" << std::endl;
+    }
+
+    if (buffer.fillKeyboardBuffer(bios.freeSlots(), 1, add_key) != 0) {
+        std::cerr << "  ✗ FAIL: Filled into the reserved slot" << std::endl;
+        passed = false;
+    }
+
+    // DOS program reads three keys; the next fill tops the buffer back up
+    uint16_t key = 0;
+    for (int i = 0; i < 3; ++i) {
+        bios.readKey(key);
+    }
+    delivered = buffer.fillKeyboardBuffer(bios.freeSlots(), 1, add_key);
+    if (delivered != 3) {
+        std::cerr << "  ✗ FAIL: Refill delivered " << delivered << ", expected 3" << std::endl;
+        passed = false;
+    } else {
+        std::cout << "  ✓ Refill delivered exactly the 3 freed slots" << std::endl;
+    }
+
+    // A refusing sink leaves the key queued
+    const size_t before = buffer.size();
+    buffer.fillKeyboardBuffer(10, 0, [](uint16_t) { return false; });
+    if (buffer.size() != before) {
+        std::cerr << "  ✗ FAIL: Refused key was consumed" << std::endl;
+        passed = false;
+    } else {
+        std::cout << "  ✓ Keys refused by the BIOS stay queued" << std::endl;
+    }
+
+    if (passed) {
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testClear() {
+    std::cout << "\n[TEST 4] Clear Drops Only Earlier Keycodes" << std::endl;
+
+    BoxerPasteBuffer buffer(64);
+    const uint16_t before[] = {1, 2, 3, 4};
+    const uint16_t after[] = {9};
+    buffer.enqueue(before, 4);
+    buffer.clear();
+    buffer.enqueue(after, 1);
+
+    uint16_t code = 0;
+    bool passed = buffer.size() == 1 && buffer.peek(&code) && code == 9;
+    if (!passed) {
+        std::cerr << "  ✗ FAIL: Expected only keycode 9 after clear" << std::endl;
+    } else {
+        std::cout << "  ✓ Cleared keys skipped, later key kept" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+    }
+    return passed;
+}
+
+bool testThreadedOrdering() {
+    std::cout << "\n[TEST 5] Threaded Producer/Consumer Ordering" << std::endl;
+
+    const uint32_t total = 2000000;
+    BoxerPasteBuffer buffer(1024);
+
+    std::thread producer([&buffer, total]() {
+        uint16_t span[64];
+        uint32_t next = 0;
+        while (next < total) {
+            size_t count = 0;
+            while (count < 64 && next + count < total) {
+                span[count] = static_cast<uint16_t>(next + count);
+                ++count;
+            }
+            size_t sent = 0;
+            while (sent < count) {
+                sent += buffer.enqueue(span + sent, count - sent);
+                if (sent < count) {
+                    std::this_thread::yield();
+                }
+            }
+            next += static_cast<uint32_t>(count);
+        }
+    });
+
+    uint32_t received = 0;
+    bool in_order = true;
+    uint16_t out[32];
+    while (received < total) {
+        const size_t count = buffer.dequeue(out, 32);
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (out[i] != static_cast<uint16_t>(received + i)) {
+                in_order = false;
+            }
+        }
+        received += static_cast<uint32_t>(count);
+    }
+    producer.join();
+
+    if (!in_order) {
+        std::cerr << "  ✗ FAIL: Keycodes arrived out of order" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ " << total << " keycodes crossed threads in order" << std::endl;
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testThroughput() {
+    std::cout << "\n[TEST 6] Throughput: Bulk Fill vs Per-Key Hooks" << std::endl;
+
+    const size_t total = 1000000;
+    std::vector<uint16_t> text(total, 0x1E61);
+
+    // Legacy: one count check, one peek and one consume per key
+    DequePasteDelegate legacy_impl;
+    legacy_impl.keys.assign(text.begin(), text.end());
+    LegacyPasteDelegate* legacy = &legacy_impl;
+    SimulatedBiosKeyboard legacy_bios;
+
+    auto start = std::chrono::steady_clock::now();
+    size_t legacy_delivered = 0;
+    uint16_t key = 0;
+    while (legacy->numKeyCodesInPasteBuffer() > 0) {
+        if (legacy_bios.freeSlots() > 0 && legacy->getNextKeyCodeInPasteBuffer(&key, false)) {
+            legacy->getNextKeyCodeInPasteBuffer(&key, true);
+            legacy_bios.addKey(key);
+            ++legacy_delivered;
+        }
+        legacy_bios.readKey(key);
+    }
+    const double legacy_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    // Ring: one bulk fill per BIOS drain
+    BoxerPasteBuffer buffer(total);
+    buffer.enqueue(text.data(), text.size());
+    SimulatedBiosKeyboard bios;
+    auto add_key = [&bios](uint16_t code) { return bios.addKey(code); };
+
+    start = std::chrono::steady_clock::now();
+    size_t ring_delivered = 0;
+    while (!buffer.empty()) {
+        ring_delivered += buffer.fillKeyboardBuffer(bios.freeSlots(), 0, add_key);
+        while (bios.readKey(key)) {
+        }
+    }
+    const double ring_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "  Per-key hooks: " << legacy_delivered << " keys in " << legacy_ms << " ms" << std::endl;
+    std::cout << "  Bulk ring:     " << ring_delivered << " keys in " << ring_ms << " ms" << std::endl;
+
+    if (legacy_delivered != total || ring_delivered != total) {
+        std::cerr << "  ✗ FAIL: Not every key was delivered" << std::endl;
+        return false;
+    }
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Paste Buffer Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-062, INT-073, INT-074 replacement" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testWraparoundOrder()) passed++; else failed++;
+    if (testPartialEnqueue()) passed++; else failed++;
+    if (testFillRespectsBiosSpace()) passed++; else failed++;
+    if (testClear()) passed++; else failed++;
+    if (testThreadedOrdering()) passed++; else failed++;
+    if (testThroughput()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
@@ -0,0 +1,367 @@
+/*
+ * boxer_lpt_file_writer.h - Buffered asynchronous output for file-backed LPT ports
+ *
+ * The legacy file LPT device (filelpt.cpp) writes each printed byte straight
+ * to its output file, so printing to a file costs one host write per byte
+ * on the emulation thread. This writer gathers printed bytes into large
+ * buffers and writes them from a background thread.
+ *
+ * ARCHITECTURE:
+ *   - A print job is one output file. It is opened lazily by the first byte,
+ *     at the path PathForJob gives for the job number
+ *   - The emulation thread fills one buffer at a time. A full buffer is
+ *     handed to the writer thread and the next one is taken from a small
+ *     fixed pool. With every buffer in flight, submit() accepts only what
+ *     it has room for; in front of a BoxerPrinterStream the port then
+ *     reports BUSY. The emulation thread never waits on the disk
+ *   - idleTick() runs from a periodic PIC event. The first quiet tick
+ *     hands over a partly filled buffer. After closeAfterIdleTicks quiet
+ *     ticks the job's file is closed, and the next byte starts a new job
+ *   - INIT going low (printer reset) closes the job at once, as the legacy
+ *     device did
+ *   - Open, write and close run in order on the writer thread
+ *
+ * ERRORS:
+ *   A failed open or write drops the rest of that job's bytes; the DOS
+ *   side has nowhere to report it. Failures are counted (Stats::failures)
+ *   and the first error code is kept for lastError().
+ *
+ * THREAD SAFETY:
+ *   submit(), controlChanged(), reset(), idleTick() and busy() are called
+ *   from the emulation thread. sync(), stats() and lastError() may be
+ *   called from any thread.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_LPT_FILE_WRITER_H
+#define BOXER_LPT_FILE_WRITER_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// ============================================================================
+// BoxerLptFileWriter
+// ============================================================================
+
+class BoxerLptFileWriter {
+public:
+    struct Stats {
+        uint64_t bytesQueued;
+        uint64_t bytesWritten;
+        uint64_t writeCalls;     ///< write() system calls
+        uint64_t jobsOpened;
+        uint64_t jobsClosed;
+        uint64_t idleFlushes;    ///< Partial buffers handed over by idleTick()
+        uint64_t failures;       ///< Failed opens and writes
+    };
+
+    /// Output file for a print job; job numbers start at 1
+    using PathForJob = std::function<std::string(uint32_t job)>;
+
+    static constexpr size_t kDefaultBufferBytes = 256 * 1024;
+    static constexpr size_t kDefaultBufferCount = 4;
+    /// Control register INIT line; low resets the printer
+    static constexpr uint8_t kControlInit = 1 << 2;
+
+    /**
+     * @param closeAfterIdleTicks Quiet idleTick() calls before a job's file
+     *        is closed; 0 keeps it open until reset or destruction
+     */
+    explicit BoxerLptFileWriter(PathForJob pathForJob, uint32_t closeAfterIdleTicks,
+                                size_t bufferBytes = kDefaultBufferBytes,
+                                size_t bufferCount = kDefaultBufferCount)
+        : m_pathForJob(std::move(pathForJob)),
+          m_closeAfterIdleTicks(closeAfterIdleTicks),
+          m_bufferBytes(std::max<size_t>(1, bufferBytes)),
+          m_thread(&BoxerLptFileWriter::run, this) {
+        // At least two, so the emulation thread fills one while another is written
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < std::max<size_t>(2, bufferCount); ++i) {
+            m_free.emplace_back();
+            m_free.back().reserve(m_bufferBytes);
+        }
+    }
+
+    /// Writes and closes everything queued, then stops the writer thread
+    ~BoxerLptFileWriter() {
+        closeJob();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_workAvailable.notify_all();
+        m_thread.join();
+    }
+
+    BoxerLptFileWriter(const BoxerLptFileWriter&) = delete;
+    BoxerLptFileWriter& operator=(const BoxerLptFileWriter&) = delete;
+
+    // ========================================================================
+    // Emulation side
+    // ========================================================================
+
+    /**
+     * @brief Queue printed bytes (BoxerPrinterStream::DataSink)
+     * @return Bytes accepted; less than length while every buffer is in flight
+     */
+    size_t submit(const uint8_t* data, size_t length) {
+        if (length == 0) {
+            return 0;
+        }
+        if (!m_jobOpen) {
+            openJob();
+        }
+        size_t accepted = 0;
+        while (accepted < length) {
+            if (!m_haveBuffer && !takeBuffer()) {
+                break;
+            }
+            const size_t room = m_bufferBytes - m_buffer.size();
+            const size_t chunk = std::min(room, length - accepted);
+            m_buffer.insert(m_buffer.end(), data + accepted, data + accepted + chunk);
+            accepted += chunk;
+            if (m_buffer.size() == m_bufferBytes) {
+                handOff();
+            }
+        }
+        m_sawBytes = m_sawBytes || accepted > 0;
+        m_bytesQueued.fetch_add(accepted, std::memory_order_relaxed);
+        return accepted;
+    }
+
+    /// Control line change (BoxerPrinterStream::ControlSink)
+    void controlChanged(uint8_t control) {
+        if (!(control & kControlInit)) {
+            reset();
+        }
+    }
+
+    /// Printer reset: close the job; the next byte starts a new file
+    void reset() { closeJob(); }
+
+    /// Periodic call (a PIC event)
+    void idleTick() {
+        if (m_sawBytes) {
+            m_sawBytes = false;
+            m_quietTicks = 0;
+            return;
+        }
+        if (!m_jobOpen) {
+            return;
+        }
+        ++m_quietTicks;
+        if (m_quietTicks == 1 && m_haveBuffer && !m_buffer.empty()) {
+            handOff();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.idleFlushes;
+        }
+        if (m_closeAfterIdleTicks && m_quietTicks >= m_closeAfterIdleTicks) {
+            closeJob();
+        }
+    }
+
+    /// True while every buffer is waiting to be written
+    bool busy() {
+        return !m_haveBuffer && !takeBuffer();
+    }
+
+    // ========================================================================
+    // Any thread
+    // ========================================================================
+
+    /// Wait until everything handed over so far has been written
+    void sync() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this] { return m_ops.empty() && !m_working; });
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats stats = m_stats;
+        stats.bytesQueued = m_bytesQueued.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    /// The first error code since the last call, or 0
+    int lastError() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int error = m_error;
+        m_error = 0;
+        return error;
+    }
+
+private:
+    struct Op {
+        enum Type : uint8_t { Open, Write, Close } type;
+        std::string path;
+        std::vector<uint8_t> data;
+    };
+
+    void openJob() {
+        m_jobOpen = true;
+        m_quietTicks = 0;
+        push(Op{Op::Open, m_pathForJob(++m_job), {}});
+    }
+
+    void closeJob() {
+        if (!m_jobOpen) {
+            return;
+        }
+        if (m_haveBuffer && !m_buffer.empty()) {
+            handOff();
+        }
+        m_jobOpen = false;
+        push(Op{Op::Close, {}, {}});
+    }
+
+    bool takeBuffer() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free.empty()) {
+            return false;
+        }
+        m_buffer = std::move(m_free.back());
+        m_free.pop_back();
+        m_haveBuffer = true;
+        return true;
+    }
+
+    void handOff() {
+        m_haveBuffer = false;
+        push(Op{Op::Write, {}, std::move(m_buffer)});
+        m_buffer = std::vector<uint8_t>();
+    }
+
+    void push(Op&& op) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_ops.push_back(std::move(op));
+        }
+        m_workAvailable.notify_one();
+    }
+
+    void run() {
+        int descriptor = -1;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            if (!m_ops.empty()) {
+                Op op = std::move(m_ops.front());
+                m_ops.pop_front();
+                m_working = true;
+                lock.unlock();
+                int error = 0;
+                uint64_t calls = 0;
+                size_t written = 0;
+                switch (op.type) {
+                    case Op::Open:
+                        descriptor = ::open(op.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                        error = descriptor < 0 ? errno : 0;
+                        break;
+                    case Op::Write:
+                        if (descriptor >= 0) {
+                            error = writeAll(descriptor, op.data, calls, written);
+                            if (error) {
+                                // Drop the rest of the job rather than leave a gap
+                                ::close(descriptor);
+                                descriptor = -1;
+                            }
+                        }
+                        break;
+                    case Op::Close:
+                        if (descriptor >= 0) {
+                            ::close(descriptor);
+                            descriptor = -1;
+                        }
+                        break;
+                }
+                lock.lock();
+                m_working = false;
+                if (error) {
+                    ++m_stats.failures;
+                    if (!m_error) {
+                        m_error = error;
+                    }
+                }
+                m_stats.writeCalls += calls;
+                m_stats.bytesWritten += written;
+                m_stats.jobsOpened += (op.type == Op::Open && !error) ? 1 : 0;
+                m_stats.jobsClosed += op.type == Op::Close ? 1 : 0;
+                if (op.type == Op::Write) {
+                    op.data.clear();
+                    m_free.push_back(std::move(op.data));
+                }
+                continue;
+            }
+            m_idle.notify_all();
+            if (m_stopping) {
+                break;
+            }
+            m_workAvailable.wait(lock);
+        }
+        if (descriptor >= 0) {
+            ::close(descriptor);
+        }
+    }
+
+    static int writeAll(int descriptor, const std::vector<uint8_t>& data, uint64_t& calls, size_t& written) {
+        while (written < data.size()) {
+            const ssize_t result = ::write(descriptor, data.data() + written, data.size() - written);
+            ++calls;
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errno;
+            }
+            written += static_cast<size_t>(result);
+        }
+        return 0;
+    }
+
+    const PathForJob m_pathForJob;
+    const uint32_t m_closeAfterIdleTicks;
+    const size_t m_bufferBytes;
+
+    // Emulation thread only
+    std::vector<uint8_t> m_buffer;
+    bool m_haveBuffer = false;
+    bool m_jobOpen = false;
+    bool m_sawBytes = false;
+    uint32_t m_quietTicks = 0;
+    uint32_t m_job = 0;
+
+    std::atomic<uint64_t> m_bytesQueued{0};   ///< Bumped by submit(), read by stats()
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_idle;
+    std::deque<Op> m_ops;
+    std::vector<std::vector<uint8_t>> m_free;
+    bool m_working = false;
+    bool m_stopping = false;
+    int m_error = 0;
+    Stats m_stats{};
+
+    std::thread m_thread;   // last: starts after everything above exists
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_LPT_FILE_WRITER_H
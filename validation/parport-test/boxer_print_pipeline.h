@@ -0,0 +1,230 @@
+/*
+ * boxer_print_pipeline.h - Off-thread ESC/P interpretation and page output
+ *
+ * The legacy ESC/P printer emulation (printer.cpp) interprets and
+ * rasterizes each byte as it arrives, so glyph rendering and page encoding
+ * run on the emulation thread inside the port write. The pipeline moves
+ * the printer onto a worker thread fed by a command queue. The emulated
+ * port stays ready while the worker renders.
+ *
+ * ARCHITECTURE:
+ *   - BoxerPrintEngine: the migrated CPrinter, adapted to take bytes in
+ *     blocks. It owns the ESC/P state, the page raster and page output, and
+ *     is only ever called on the worker thread
+ *   - BoxerPrintPipeline: queues data blocks, control line changes and job
+ *     ends in the order the port produced them. Consecutive data blocks
+ *     are merged while they wait
+ *   - submit() and controlChanged() match BoxerPrinterStream's DataSink
+ *     and ControlSink, so the stream can feed the pipeline directly
+ *   - The queue has a byte cap. Past it, submit() accepts only what fits;
+ *     the stream keeps the rest and the port reports BUSY until the worker
+ *     catches up. The emulation thread never waits on the worker
+ *
+ * THREAD SAFETY:
+ *   submit(), controlChanged() and finishJob() are called from the
+ *   emulation thread. busy(), drain() and stats() may be called from any
+ *   thread.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_PRINT_PIPELINE_H
+#define BOXER_PRINT_PIPELINE_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// BoxerPrintEngine - Printer emulation run by the worker
+// ============================================================================
+
+class BoxerPrintEngine {
+public:
+    virtual ~BoxerPrintEngine() = default;
+
+    /// Interpret and rasterize printed bytes; eject and output full pages
+    virtual void printData(const uint8_t* data, size_t length) = 0;
+
+    /// A control register write other than a strobe (INIT resets the printer)
+    virtual void controlChanged(uint8_t control) = 0;
+
+    /// The print job ended: eject a partial page and finish the document
+    virtual void finishJob() = 0;
+};
+
+// ============================================================================
+// BoxerPrintPipeline
+// ============================================================================
+
+class BoxerPrintPipeline {
+public:
+    struct Stats {
+        uint64_t bytesQueued;
+        uint64_t bytesPrinted;     ///< Handed to the engine
+        uint64_t commands;         ///< Queue entries after merging
+        uint64_t refusedSubmits;   ///< submit() calls cut short by the cap
+        size_t maxBacklogBytes;
+    };
+
+    static constexpr size_t kDefaultBacklogBytes = 4 * 1024 * 1024;
+
+    explicit BoxerPrintPipeline(std::unique_ptr<BoxerPrintEngine> engine,
+                                size_t backlogBytes = kDefaultBacklogBytes)
+        : m_engine(std::move(engine)),
+          m_backlogLimit(backlogBytes),
+          m_thread(&BoxerPrintPipeline::run, this) {}
+
+    /// Prints everything queued, then stops the worker
+    ~BoxerPrintPipeline() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_workAvailable.notify_all();
+        m_thread.join();
+    }
+
+    BoxerPrintPipeline(const BoxerPrintPipeline&) = delete;
+    BoxerPrintPipeline& operator=(const BoxerPrintPipeline&) = delete;
+
+    // ========================================================================
+    // Emulation side
+    // ========================================================================
+
+    /**
+     * @brief Queue printed bytes
+     * @return Bytes accepted; less than length once the backlog is full
+     */
+    size_t submit(const uint8_t* data, size_t length) {
+        size_t accepted;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            accepted = std::min(length, m_backlogLimit - std::min(m_backlogLimit, m_backlog));
+            if (accepted < length) {
+                ++m_stats.refusedSubmits;
+            }
+            if (accepted == 0) {
+                return 0;
+            }
+            if (m_commands.empty() || m_commands.back().type != Command::Data) {
+                m_commands.push_back(Command{Command::Data, {}, 0});
+                ++m_stats.commands;
+            }
+            auto& bytes = m_commands.back().data;
+            bytes.insert(bytes.end(), data, data + accepted);
+            m_backlog += accepted;
+            m_busyFlag.store(m_backlog >= m_backlogLimit, std::memory_order_relaxed);
+            m_stats.bytesQueued += accepted;
+            m_stats.maxBacklogBytes = std::max(m_stats.maxBacklogBytes, m_backlog);
+        }
+        m_workAvailable.notify_one();
+        return accepted;
+    }
+
+    /// Queue a control line change behind the bytes before it
+    void controlChanged(uint8_t control) {
+        push(Command{Command::Control, {}, control});
+    }
+
+    /// Queue the end of the print job
+    void finishJob() {
+        push(Command{Command::FinishJob, {}, 0});
+    }
+
+    /// True while the backlog is at its cap; the port reports BUSY
+    bool busy() const {
+        return m_busyFlag.load(std::memory_order_relaxed);
+    }
+
+    /// Wait until the engine has processed everything queued so far
+    void drain() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this] { return m_commands.empty() && !m_working; });
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    struct Command {
+        enum Type : uint8_t { Data, Control, FinishJob } type;
+        std::vector<uint8_t> data;
+        uint8_t control;
+    };
+
+    void push(Command&& command) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_commands.push_back(std::move(command));
+            ++m_stats.commands;
+        }
+        m_workAvailable.notify_one();
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            if (!m_commands.empty()) {
+                Command command = std::move(m_commands.front());
+                m_commands.pop_front();
+                m_working = true;
+                lock.unlock();
+                switch (command.type) {
+                    case Command::Data:
+                        m_engine->printData(command.data.data(), command.data.size());
+                        break;
+                    case Command::Control:
+                        m_engine->controlChanged(command.control);
+                        break;
+                    case Command::FinishJob:
+                        m_engine->finishJob();
+                        break;
+                }
+                lock.lock();
+                m_working = false;
+                m_backlog -= command.data.size();
+                m_busyFlag.store(m_backlog >= m_backlogLimit, std::memory_order_relaxed);
+                m_stats.bytesPrinted += command.data.size();
+                continue;
+            }
+            m_idle.notify_all();
+            if (m_stopping) {
+                break;
+            }
+            m_workAvailable.wait(lock);
+        }
+    }
+
+    const std::unique_ptr<BoxerPrintEngine> m_engine;
+    const size_t m_backlogLimit;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_idle;
+    std::deque<Command> m_commands;
+    size_t m_backlog = 0;            ///< Queued bytes not yet printed
+    bool m_working = false;
+    bool m_stopping = false;
+    std::atomic<bool> m_busyFlag{false};
+    Stats m_stats{};
+
+    std::thread m_thread;   // last: starts after everything above exists
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_PRINT_PIPELINE_H
@@ -0,0 +1,167 @@
+/*
+ * boxer_printer_registers.h - Shared printer status/control register word
+ *
+ * Replaces the polled printer query hooks with one atomic word:
+ *
+ *   - INT-077 PRINTER_readstatus   -> readStatus()
+ *   - INT-079 PRINTER_readcontrol  -> readControl()
+ *   - INT-080 PRINTER_isInited     -> isInited()
+ *
+ * DOS print drivers busy-poll the status port between bytes, so the legacy
+ * hook turned every poll into a delegate call. Boxer now pushes its printer
+ * state into the word when that state changes, and port reads are served
+ * at IO-handler speed.
+ *
+ * ARCHITECTURE:
+ *   - One 64-bit word: status, control and the inited flag in the low half,
+ *     a change generation in the high half. A read is one atomic load and
+ *     always sees a consistent set of registers
+ *   - Boxer writes status and inited; the emulation thread writes control.
+ *     Writers use compare-and-swap, so neither loses the other's update
+ *   - Identical writes are absorbed and do not move the generation, so
+ *     Boxer can poll it cheaply (e.g. once per frame) for control changes
+ *   - The ACK pulse real printers send after each byte is emulated here:
+ *     acknowledge() makes the next status read show ACK low, once
+ *
+ * THREAD SAFETY:
+ *   Boxer-side methods and load() may be called from any thread. The
+ *   emulation-side methods are called from the emulation thread only; the
+ *   ACK latch is not shared.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_PRINTER_REGISTERS_H
+#define BOXER_PRINTER_REGISTERS_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <atomic>
+#include <cstdint>
+
+// ============================================================================
+// BoxerPrinterRegisters
+// ============================================================================
+
+class BoxerPrinterRegisters {
+public:
+    /// Status register (base+1) bits; BUSY, ACK and ERROR are active low
+    enum : uint8_t {
+        StatusNotError = 1 << 3,
+        StatusSelect   = 1 << 4,
+        StatusPaperOut = 1 << 5,
+        StatusNotAck   = 1 << 6,
+        StatusNotBusy  = 1 << 7,
+    };
+
+    /// An idle, online printer with paper (the legacy always-ready value)
+    static constexpr uint8_t kReadyStatus = 0xDF;
+    /// The control register after reset: INIT high, SELECT IN set
+    static constexpr uint8_t kResetControl = 0x0C;
+
+    struct Snapshot {
+        uint8_t status;
+        uint8_t control;
+        bool inited;
+        uint32_t generation;
+    };
+
+    explicit BoxerPrinterRegisters(uint8_t status = kReadyStatus, uint8_t control = kResetControl,
+                                   bool inited = false)
+        : m_word(pack(status, control, inited, 0)) {}
+
+    BoxerPrinterRegisters(const BoxerPrinterRegisters&) = delete;
+    BoxerPrinterRegisters& operator=(const BoxerPrinterRegisters&) = delete;
+
+    // ========================================================================
+    // Boxer side
+    // ========================================================================
+
+    /// The printer's status lines changed (paper out, offline, busy)
+    bool setStatus(uint8_t status) {
+        return update(0x00FF, status);
+    }
+
+    /// A printer was attached to or detached from the port
+    bool setInited(bool inited) {
+        return update(kInitedBit, inited ? kInitedBit : 0);
+    }
+
+    /// All registers and the generation, consistently
+    Snapshot load() const {
+        return unpack(m_word.load(std::memory_order_acquire));
+    }
+
+    // ========================================================================
+    // Emulation side
+    // ========================================================================
+
+    /// Control register write (base+2)
+    bool writeControl(uint8_t control) {
+        return update(0xFF00, uint32_t(control) << 8);
+    }
+
+    /**
+     * @brief Status register read (base+1)
+     * @param busy Also report BUSY (e.g. the printer stream's ring is full)
+     */
+    uint8_t readStatus(bool busy = false) {
+        uint8_t status = static_cast<uint8_t>(m_word.load(std::memory_order_relaxed));
+        if (busy) {
+            status &= static_cast<uint8_t>(~StatusNotBusy);
+        }
+        if (m_ackPending) {
+            m_ackPending = false;
+            status &= static_cast<uint8_t>(~StatusNotAck);
+        }
+        return status;
+    }
+
+    /// Control register read (base+2)
+    uint8_t readControl() const {
+        return static_cast<uint8_t>(m_word.load(std::memory_order_relaxed) >> 8);
+    }
+
+    bool isInited() const {
+        return (m_word.load(std::memory_order_relaxed) & kInitedBit) != 0;
+    }
+
+    /// A byte was strobed in: pulse ACK on the next status read
+    void acknowledge() { m_ackPending = true; }
+
+private:
+    static constexpr uint32_t kInitedBit = 1u << 16;
+
+    static uint64_t pack(uint8_t status, uint8_t control, bool inited, uint32_t generation) {
+        return (uint64_t(generation) << 32) | status | (uint32_t(control) << 8) | (inited ? kInitedBit : 0);
+    }
+
+    static Snapshot unpack(uint64_t word) {
+        return Snapshot{static_cast<uint8_t>(word), static_cast<uint8_t>(word >> 8),
+                        (word & kInitedBit) != 0, static_cast<uint32_t>(word >> 32)};
+    }
+
+    // Replace the masked bits; false if they already held that value
+    bool update(uint32_t mask, uint32_t bits) {
+        uint64_t current = m_word.load(std::memory_order_relaxed);
+        for (;;) {
+            const uint32_t registers = static_cast<uint32_t>(current);
+            if ((registers & mask) == bits) {
+                return false;
+            }
+            const uint64_t next = (((current >> 32) + 1) << 32) | ((registers & ~mask) | bits);
+            if (m_word.compare_exchange_weak(current, next, std::memory_order_acq_rel,
+                                             std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+
+    std::atomic<uint64_t> m_word;
+    bool m_ackPending = false;
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_PRINTER_REGISTERS_H
@@ -0,0 +1,254 @@
+/*
+ * boxer_printer_stream.h - Buffered printer data stream for an LPT port
+ *
+ * Replaces the per-byte printer hooks on the data path:
+ *
+ *   - INT-076 PRINTER_writedata     -> latched locally, no hook
+ *   - INT-078 PRINTER_writecontrol  -> strobe pulses capture the latched byte
+ *                                      locally; other line changes still
+ *                                      reach the host
+ *   - INT-075 PRINTER_readdata      -> served from the latch
+ *
+ * The legacy CPrinterRedir made five delegate calls per printed byte (data,
+ * three control writes for the strobe pulse, status read). A page of ESC/P
+ * graphics is tens of thousands of bytes.
+ *
+ * ARCHITECTURE:
+ *   - A strobe is the rising edge of control bit 0. It appends the data
+ *     latch to a fixed ring; DOS device output (CParallel::Putchar) appends
+ *     directly
+ *   - The ring is handed to the host in chunks, at most two contiguous
+ *     spans per flush. It is flushed:
+ *       * when it is full
+ *       * before a control change other than the strobe is forwarded
+ *         (init, auto feed, select), so the host sees bytes and line
+ *         changes in the order DOS produced them
+ *       * from idleTick() when no byte has arrived since the previous
+ *         tick, so a short print job does not sit in the buffer
+ *   - The host may accept only part of a chunk. The rest stays in the ring
+ *     and the port reports busy until there is room, which is how a real
+ *     printer throttles the PC
+ *   - A control change that arrives while earlier bytes are still in the
+ *     ring is held until they have been accepted, and the port reports
+ *     busy meanwhile. It is forwarded by whichever flush drains them
+ *
+ * THREAD SAFETY:
+ *   None. All calls happen on the emulation thread; the sinks are called on
+ *   it too.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_PRINTER_STREAM_H
+#define BOXER_PRINTER_STREAM_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// BoxerPrinterStream
+// ============================================================================
+
+class BoxerPrinterStream {
+public:
+    /// Control register (base+2) bits
+    enum : uint8_t {
+        ControlStrobe   = 1 << 0,
+        ControlAutoFeed = 1 << 1,
+        ControlInit     = 1 << 2,   ///< 0 resets the printer
+        ControlSelectIn = 1 << 3,
+        ControlIrq      = 1 << 4,
+        ControlBidi     = 1 << 5,
+    };
+
+    struct Stats {
+        uint64_t bytes;           ///< Bytes accepted into the ring
+        uint64_t chunks;          ///< DataSink calls
+        uint64_t fullFlushes;
+        uint64_t controlFlushes;
+        uint64_t idleFlushes;
+        uint64_t controlChanges;  ///< Line changes forwarded to the host
+    };
+
+    /**
+     * @brief Hands printed bytes to the host
+     * @return Bytes the host accepted, from the front of the span
+     */
+    using DataSink = std::function<size_t(const uint8_t* data, size_t length)>;
+    /// Forwards a control register write other than a strobe pulse
+    using ControlSink = std::function<void(uint8_t control)>;
+
+    static constexpr size_t kDefaultCapacity = 4096;
+    /// Suggested idleTick() period
+    static constexpr uint32_t kIdleTickMs = 50;
+
+    /// The control register after reset, as the BIOS leaves it
+    static constexpr uint8_t kResetControl = ControlInit | ControlSelectIn;
+
+    /**
+     * @param capacity Ring size, rounded up to a power of two
+     */
+    BoxerPrinterStream(DataSink dataSink, ControlSink controlSink, size_t capacity = kDefaultCapacity)
+        : m_dataSink(std::move(dataSink)),
+          m_controlSink(std::move(controlSink)),
+          m_ring(roundUpPowerOfTwo(capacity)),
+          m_mask(m_ring.size() - 1) {}
+
+    BoxerPrinterStream(const BoxerPrinterStream&) = delete;
+    BoxerPrinterStream& operator=(const BoxerPrinterStream&) = delete;
+
+    // ========================================================================
+    // Port I/O (emulation thread)
+    // ========================================================================
+
+    /// Data register write (base+0)
+    void writeData(uint8_t value) { m_data = value; }
+
+    /// Data register read (base+0)
+    uint8_t readData() const { return m_data; }
+
+    /// Control register write (base+2)
+    void writeControl(uint8_t value) {
+        const uint8_t changed = m_control ^ value;
+        m_control = value;
+        if ((changed & ControlStrobe) && (value & ControlStrobe)) {
+            append(m_data);
+        }
+        if (changed & ~ControlStrobe) {
+            // Queued behind the bytes strobed so far; forwarded once they
+            // have all been accepted
+            m_pendingControls.emplace_back(m_tail, value);
+            if (used()) {
+                ++m_stats.controlFlushes;
+            }
+            deliver();
+        }
+    }
+
+    /// Control register read (base+2)
+    uint8_t readControl() const { return m_control; }
+
+    /// DOS device output (CParallel::Putchar): one byte, no handshake
+    void putchar(uint8_t value) { append(value); }
+
+    /**
+     * @brief True while the host is refusing bytes and the ring is full,
+     *        or a control change is waiting behind unaccepted bytes
+     *
+     * The status register reports BUSY while this holds.
+     */
+    bool busy() {
+        if (used() < m_ring.size() && m_pendingControls.empty()) {
+            return false;
+        }
+        deliver();
+        return used() == m_ring.size() || !m_pendingControls.empty();
+    }
+
+    // ========================================================================
+    // Flushing
+    // ========================================================================
+
+    /**
+     * @brief Periodic call (a PIC event every kIdleTickMs)
+     *
+     * Flushes if no byte has arrived since the previous tick, so the clock
+     * is never read on the per-byte path.
+     */
+    void idleTick() {
+        if ((used() && m_stats.bytes == m_bytesAtLastTick) || !m_pendingControls.empty()) {
+            deliver();
+            ++m_stats.idleFlushes;
+        }
+        m_bytesAtLastTick = m_stats.bytes;
+    }
+
+    /// Offer everything buffered to the host (port reset, shutdown)
+    void flush() { deliver(); }
+
+    size_t pending() const { return used(); }
+    size_t capacity() const { return m_ring.size(); }
+    const Stats& stats() const { return m_stats; }
+
+private:
+    static size_t roundUpPowerOfTwo(size_t value) {
+        size_t size = 1;
+        while (size < value) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    size_t used() const { return m_tail - m_head; }
+
+    void append(uint8_t value) {
+        if (used() == m_ring.size()) {
+            deliver();
+            ++m_stats.fullFlushes;
+            if (used() == m_ring.size()) {
+                // Host refused everything; DOS ignored BUSY. Real printers
+                // lose the byte too
+                return;
+            }
+        }
+        m_ring[m_tail++ & m_mask] = value;
+        ++m_stats.bytes;
+        if (used() == m_ring.size()) {
+            deliver();
+            ++m_stats.fullFlushes;
+        }
+    }
+
+    // Hand over the bytes in contiguous spans, stopping if the host takes
+    // less. A pending control change is forwarded once the bytes before it
+    // are gone
+    void deliver() {
+        for (;;) {
+            const size_t limit = m_pendingControls.empty() ? m_tail : m_pendingControls.front().first;
+            while (m_head != limit) {
+                const size_t start = m_head & m_mask;
+                const size_t span = std::min(limit - m_head, m_ring.size() - start);
+                const size_t accepted = m_dataSink ? std::min(span, m_dataSink(&m_ring[start], span)) : span;
+                ++m_stats.chunks;
+                m_head += accepted;
+                if (accepted < span) {
+                    return;
+                }
+            }
+            if (m_pendingControls.empty()) {
+                return;
+            }
+            const uint8_t control = m_pendingControls.front().second;
+            m_pendingControls.pop_front();
+            ++m_stats.controlChanges;
+            if (m_controlSink) {
+                m_controlSink(control);
+            }
+        }
+    }
+
+    const DataSink m_dataSink;
+    const ControlSink m_controlSink;
+    std::vector<uint8_t> m_ring;
+    const size_t m_mask;
+    size_t m_head = 0;    ///< Free-running read index
+    size_t m_tail = 0;    ///< Free-running write index
+    /// Control changes not yet forwarded, with the ring index they follow
+    std::deque<std::pair<size_t, uint8_t>> m_pendingControls;
+    uint8_t m_data = 0;
+    uint8_t m_control = kResetControl;
+    uint64_t m_bytesAtLastTick = 0;
+    Stats m_stats{};
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_PRINTER_STREAM_H
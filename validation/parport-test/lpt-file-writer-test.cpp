@@ -0,0 +1,436 @@
+/*
+ * lpt-file-writer-test.cpp - Asynchronous file LPT writer test suite
+ *
+ * Validates BoxerLptFileWriter, the buffered replacement for the per-byte
+ * file writes in the file-backed LPT device.
+ *
+ * Test cases:
+ * 1. Bytes reach the file in order, in few large writes, opened lazily
+ * 2. Idle flush, idle close, and the next byte starting a new job
+ * 3. INIT low closes the job; no empty files from resets
+ * 4. A stalled output pipe makes the port BUSY without blocking
+ * 5. Failed opens are counted and reported; later jobs still print
+ * 6. Destruction writes and closes everything queued
+ * 7. A failed write truncates the job instead of leaving a gap
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_lpt_file_writer.h"
+#include "boxer_printer_registers.h"
+#include "boxer_printer_stream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ============================================================================
+// Test fixtures
+// ============================================================================
+
+// A scratch directory for print job files, removed with its contents
+class ScratchDirectory {
+public:
+    ScratchDirectory() {
+        char pattern[] = "/tmp/boxer-lpt-XXXXXX";
+        m_path = mkdtemp(pattern) ? pattern : "";
+    }
+    ~ScratchDirectory() {
+        for (uint32_t job = 1; job <= 16; ++job) {
+            ::unlink(jobPath(job).c_str());
+        }
+        ::unlink((m_path + "/pipe").c_str());
+        ::rmdir(m_path.c_str());
+    }
+
+    std::string jobPath(uint32_t job) const { return m_path + "/job" + std::to_string(job) + ".prn"; }
+    std::string path() const { return m_path; }
+
+    BoxerLptFileWriter::PathForJob pathForJob() const {
+        return [this](uint32_t job) { return jobPath(job); };
+    }
+
+private:
+    std::string m_path;
+};
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+bool fileExists(const std::string& path) {
+    struct stat info;
+    return ::stat(path.c_str(), &info) == 0;
+}
+
+std::vector<uint8_t> makeJob(size_t length, uint32_t seed) {
+    std::vector<uint8_t> job(length);
+    for (size_t i = 0; i < length; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        job[i] = static_cast<uint8_t>(seed >> 16);
+    }
+    return job;
+}
+
+// A DOS print driver: latch the byte, pulse STROBE, wait while BUSY
+void printByte(BoxerPrinterStream& stream, BoxerPrinterRegisters& registers, uint8_t value) {
+    while (!(registers.readStatus(stream.busy()) & BoxerPrinterRegisters::StatusNotBusy)) {
+        std::this_thread::yield();
+    }
+    stream.writeData(value);
+    stream.writeControl(0x0D);
+    stream.writeControl(0x0C);
+    registers.acknowledge();
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+bool testOrderedLargeWrites() {
+    std::cout << "\n[TEST 1] Ordered Output in Large Writes" << std::endl;
+
+    ScratchDirectory scratch;
+    BoxerLptFileWriter writer(scratch.pathForJob(), 0, 64 * 1024);
+    if (fileExists(scratch.jobPath(1))) {
+        std::cerr << "  ✗ FAIL: Job file created before any byte was printed" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ No file until the first byte" << std::endl;
+
+    const auto job = makeJob(1024 * 1024 + 123, 1);
+    BoxerPrinterStream stream([&writer](const uint8_t* data, size_t length) { return writer.submit(data, length); },
+                              [&writer](uint8_t control) { writer.controlChanged(control); });
+    BoxerPrinterRegisters registers;
+    for (uint8_t value : job) {
+        printByte(stream, registers, value);
+    }
+    stream.flush();
+    writer.reset();
+    writer.sync();
+
+    if (readFile(scratch.jobPath(1)) != job) {
+        std::cerr << "  ✗ FAIL: File contents differ from the printed bytes" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ " << job.size() << " bytes on disk, in order" << std::endl;
+
+    const auto stats = writer.stats();
+    if (stats.writeCalls > 20 || stats.bytesWritten != job.size() || stats.jobsOpened != 1 ||
+        stats.jobsClosed != 1) {
+        std::cerr << "  ✗ FAIL: " << stats.writeCalls << " write calls, " << stats.jobsOpened << " opens, "
+                  << stats.jobsClosed << " closes" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ " << stats.writeCalls << " write calls instead of " << job.size() << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testIdleFlushAndClose() {
+    std::cout << "\n[TEST 2] Idle Flush and Idle Close" << std::endl;
+
+    ScratchDirectory scratch;
+    BoxerLptFileWriter writer(scratch.pathForJob(), 3);
+    const std::string first = "HELLO\r\n";
+    writer.submit(reinterpret_cast<const uint8_t*>(first.data()), first.size());
+
+    writer.idleTick();   // bytes arrived since the last tick
+    writer.sync();
+    if (readFile(scratch.jobPath(1)).size() != 0) {
+        std::cerr << "  ✗ FAIL: Flushed while bytes were still arriving" << std::endl;
+        return false;
+    }
+    writer.idleTick();   // first quiet tick
+    writer.sync();
+    if (readFile(scratch.jobPath(1)).size() != first.size() || writer.stats().idleFlushes != 1 ||
+        writer.stats().jobsClosed != 0) {
+        std::cerr << "  ✗ FAIL: First quiet tick did not flush the open job" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ First quiet tick puts the partial buffer on disk; job stays open" << std::endl;
+
+    writer.idleTick();
+    writer.idleTick();   // third quiet tick
+    writer.sync();
+    if (writer.stats().jobsClosed != 1) {
+        std::cerr << "  ✗ FAIL: Job not closed after three quiet ticks" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Job closed after three quiet ticks" << std::endl;
+
+    const std::string second = "PAGE 2\f";
+    writer.submit(reinterpret_cast<const uint8_t*>(second.data()), second.size());
+    writer.reset();
+    writer.sync();
+    if (readFile(scratch.jobPath(1)) != std::vector<uint8_t>(first.begin(), first.end()) ||
+        readFile(scratch.jobPath(2)) != std::vector<uint8_t>(second.begin(), second.end())) {
+        std::cerr << "  ✗ FAIL: Second job did not go to a new file" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ The next byte started job 2 in its own file" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testCloseOnReset() {
+    std::cout << "\n[TEST 3] Close on Printer Reset" << std::endl;
+
+    ScratchDirectory scratch;
+    BoxerLptFileWriter writer(scratch.pathForJob(), 0);
+    BoxerPrinterStream stream([&writer](const uint8_t* data, size_t length) { return writer.submit(data, length); },
+                              [&writer](uint8_t control) { writer.controlChanged(control); });
+    BoxerPrinterRegisters registers;
+
+    // Drivers reset the printer before their first job
+    stream.writeControl(0x08);
+    stream.writeControl(0x0C);
+    for (char c : std::string("JOB ONE")) {
+        printByte(stream, registers, static_cast<uint8_t>(c));
+    }
+    stream.writeControl(0x08);   // INIT low: the stream flushes, then forwards
+    stream.writeControl(0x0C);
+    for (char c : std::string("JOB TWO")) {
+        printByte(stream, registers, static_cast<uint8_t>(c));
+    }
+    stream.writeControl(0x08);
+    stream.writeControl(0x0C);
+    writer.sync();
+
+    const auto stats = writer.stats();
+    if (stats.jobsOpened != 2 || stats.jobsClosed != 2 || fileExists(scratch.jobPath(3))) {
+        std::cerr << "  ✗ FAIL: " << stats.jobsOpened << " jobs opened, " << stats.jobsClosed << " closed"
+                  << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Each reset closed the job; resets with no job made no files" << std::endl;
+
+    const auto one = readFile(scratch.jobPath(1));
+    const auto two = readFile(scratch.jobPath(2));
+    if (std::string(one.begin(), one.end()) != "JOB ONE" || std::string(two.begin(), two.end()) != "JOB TWO") {
+        std::cerr << "  ✗ FAIL: Job files hold the wrong bytes" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Bytes before each reset landed in their own job" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testStalledOutput() {
+    std::cout << "\n[TEST 4] Stalled Output Pipe" << std::endl;
+
+    // Printing to a pipe (e.g. a spooler) that nobody reads yet: the
+    // writer thread blocks opening it, the emulation thread must not
+    ScratchDirectory scratch;
+    const std::string pipePath = scratch.path() + "/pipe";
+    if (::mkfifo(pipePath.c_str(), 0600) != 0) {
+        std::cerr << "  ✗ FAIL: Could not create a pipe" << std::endl;
+        return false;
+    }
+
+    const auto job = makeJob(64 * 1024, 4);
+    std::vector<uint8_t> received;
+    size_t busyAfter = 0;
+    {
+        BoxerLptFileWriter writer([&pipePath](uint32_t) { return pipePath; }, 0, 1024, 2);
+        BoxerPrinterStream stream(
+            [&writer](const uint8_t* data, size_t length) { return writer.submit(data, length); }, nullptr, 256);
+        BoxerPrinterRegisters registers;
+
+        size_t printed = 0;
+        while (printed < job.size() && (registers.readStatus(stream.busy()) & BoxerPrinterRegisters::StatusNotBusy)) {
+            printByte(stream, registers, job[printed++]);
+        }
+        busyAfter = printed;
+
+        // Start reading even on failure, or the writer thread never returns
+        std::thread spooler([&pipePath, &received]() {
+            const int descriptor = ::open(pipePath.c_str(), O_RDONLY);
+            uint8_t chunk[4096];
+            ssize_t result;
+            while ((result = ::read(descriptor, chunk, sizeof(chunk))) > 0) {
+                received.insert(received.end(), chunk, chunk + result);
+            }
+            ::close(descriptor);
+        });
+        while (printed < job.size()) {
+            printByte(stream, registers, job[printed++]);
+        }
+        stream.flush();
+        writer.reset();
+        writer.sync();
+        spooler.join();
+    }
+
+    if (busyAfter != 2 * 1024 + 256) {
+        std::cerr << "  ✗ FAIL: BUSY after " << busyAfter << " bytes, expected two buffers and the ring"
+                  << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ BUSY after " << busyAfter << " bytes; the port never blocked" << std::endl;
+
+    if (received != job) {
+        std::cerr << "  ✗ FAIL: Spooler received " << received.size() << " bytes, not the job" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ The whole job reached the spooler in order once it read" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testOpenFailure() {
+    std::cout << "\n[TEST 5] Failed Open" << std::endl;
+
+    ScratchDirectory scratch;
+    const std::string missing = scratch.path() + "/missing/job.prn";
+    BoxerLptFileWriter writer([&](uint32_t job) { return job == 1 ? missing : scratch.jobPath(job); }, 0);
+
+    const auto lost = makeJob(300 * 1024, 5);
+    if (writer.submit(lost.data(), lost.size()) != lost.size()) {
+        std::cerr << "  ✗ FAIL: Emulation side refused bytes for a failed job" << std::endl;
+        return false;
+    }
+    writer.reset();
+    writer.sync();
+    const auto stats = writer.stats();
+    if (stats.failures != 1 || stats.bytesWritten != 0 || writer.lastError() != ENOENT || writer.lastError() != 0) {
+        std::cerr << "  ✗ FAIL: Failure not reported once (" << stats.failures << " failures)" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Open failure counted once and reported as ENOENT; bytes dropped" << std::endl;
+
+    const auto job = makeJob(1000, 6);
+    writer.submit(job.data(), job.size());
+    writer.reset();
+    writer.sync();
+    if (readFile(scratch.jobPath(2)) != job) {
+        std::cerr << "  ✗ FAIL: The next job did not print" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ The next job printed normally" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testDestruction() {
+    std::cout << "\n[TEST 6] Destruction Writes Everything" << std::endl;
+
+    ScratchDirectory scratch;
+    const auto job = makeJob(700 * 1024 + 7, 7);
+    {
+        BoxerLptFileWriter writer(scratch.pathForJob(), 0, 64 * 1024, 16);
+        writer.submit(job.data(), job.size());
+    }
+    if (readFile(scratch.jobPath(1)) != job) {
+        std::cerr << "  ✗ FAIL: Queued bytes lost at destruction" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Open job flushed and closed by the destructor" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testWriteFailure() {
+    std::cout << "\n[TEST 7] Failed Write Truncates the Job" << std::endl;
+
+    // A file size limit makes the second buffer's write fail part way
+    // (EFBIG), and is lifted before the third buffer is written: a
+    // transient error, like a disk that fills and then frees space
+    struct rlimit original;
+    if (::getrlimit(RLIMIT_FSIZE, &original) != 0 || original.rlim_max < 4096) {
+        std::cout << "  - File size limit not adjustable, skipped" << std::endl;
+        std::cout << "  ✅ TEST PASSED" << std::endl;
+        return true;
+    }
+    const auto previousHandler = std::signal(SIGXFSZ, SIG_IGN);
+    struct rlimit limited = original;
+    limited.rlim_cur = 1500;
+
+    ScratchDirectory scratch;
+    const auto job = makeJob(3 * 1024, 7);
+    BoxerLptFileWriter writer(scratch.pathForJob(), 0, 1024, 4);
+    ::setrlimit(RLIMIT_FSIZE, &limited);
+    writer.submit(job.data(), 2 * 1024);
+    writer.sync();
+    ::setrlimit(RLIMIT_FSIZE, &original);
+    std::signal(SIGXFSZ, previousHandler);
+    const int error = writer.lastError();
+
+    writer.submit(job.data() + 2 * 1024, 1024);
+    writer.reset();
+    writer.sync();
+
+    const auto written = readFile(scratch.jobPath(1));
+    if (error != EFBIG || writer.stats().failures != 1) {
+        std::cerr << "  ✗ FAIL: Write failure not reported (error " << error << ")" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Failed write counted once and reported as EFBIG" << std::endl;
+
+    if (written.size() != 1500 || !std::equal(written.begin(), written.end(), job.begin())) {
+        std::cerr << "  ✗ FAIL: " << written.size() << " bytes on disk; expected the 1500 byte prefix"
+                  << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ File holds the bytes before the failure, with no gap after it" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer LPT File Writer Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting buffered output for file-backed LPT ports" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testOrderedLargeWrites()) passed++; else failed++;
+    if (testIdleFlushAndClose()) passed++; else failed++;
+    if (testCloseOnReset()) passed++; else failed++;
+    if (testStalledOutput()) passed++; else failed++;
+    if (testOpenFailure()) passed++; else failed++;
+    if (testDestruction()) passed++; else failed++;
+    if (testWriteFailure()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
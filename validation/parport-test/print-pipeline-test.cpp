@@ -0,0 +1,467 @@
+/*
+ * print-pipeline-test.cpp - Off-thread print pipeline test suite
+ *
+ * Validates BoxerPrintPipeline, which runs the ESC/P printer emulation
+ * behind the INT-076 / INT-078 data path on a worker thread.
+ *
+ * Test cases:
+ * 1. Bytes, control changes and job ends reach the engine in order, off thread
+ * 2. The emulation thread never waits for rendering
+ * 3. Backlog cap: partial accepts, BUSY through stream and registers
+ * 4. INIT resets the printer and a job end ejects the partial page
+ * 5. Destruction prints everything queued
+ * 6. Emulation-thread cost per byte, synchronous versus pipelined
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_print_pipeline.h"
+#include "boxer_printer_registers.h"
+#include "boxer_printer_stream.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// Stub ESC/P engine
+// ============================================================================
+// Stands in for the migrated CPrinter: a small ESC/P subset (ESC @ reset,
+// ESC E / ESC F bold), CR, LF and FF. "Rendering" a glyph and "encoding" a
+// page spin for a set time, like FreeType and the page writer would.
+
+struct PrintedPage {
+    uint32_t glyphs = 0;
+    uint32_t boldGlyphs = 0;
+    uint32_t lines = 0;
+    uint32_t checksum = 0;
+
+    bool operator==(const PrintedPage& other) const {
+        return glyphs == other.glyphs && boldGlyphs == other.boldGlyphs && lines == other.lines &&
+               checksum == other.checksum;
+    }
+};
+
+// Lets a test hold the engine until it has finished submitting
+class Gate {
+public:
+    void close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_open = false;
+    }
+    void open() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_open = true;
+        }
+        m_changed.notify_all();
+    }
+    void pass() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [this] { return m_open; });
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    bool m_open = true;
+};
+
+void spin(uint64_t ns) {
+    if (ns == 0) {
+        return;
+    }
+    const auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(ns);
+    while (std::chrono::steady_clock::now() < until) {
+    }
+}
+
+class StubEscpPrinter : public BoxerPrintEngine {
+public:
+    // Shared with the test, which reads them after drain()
+    struct Output {
+        std::vector<PrintedPage> pages;
+        std::vector<std::string> events;
+        std::thread::id thread;
+    };
+
+    StubEscpPrinter(Output& output, Gate* gate = nullptr, uint64_t glyphNs = 0, uint64_t pageNs = 0)
+        : m_output(output), m_gate(gate), m_glyphNs(glyphNs), m_pageNs(pageNs) {}
+
+    void printData(const uint8_t* data, size_t length) override {
+        enter("data:" + std::to_string(length));
+        for (size_t i = 0; i < length; ++i) {
+            printChar(data[i]);
+        }
+    }
+
+    void controlChanged(uint8_t control) override {
+        enter("control:" + std::to_string(control));
+        if (!(control & BoxerPrinterStream::ControlInit)) {
+            reset();
+        }
+    }
+
+    void finishJob() override {
+        enter("finish");
+        if (m_page.glyphs || m_page.lines) {
+            eject();
+        }
+    }
+
+private:
+    void enter(const std::string& event) {
+        if (m_gate) {
+            m_gate->pass();
+        }
+        m_output.thread = std::this_thread::get_id();
+        m_output.events.push_back(event);
+    }
+
+    void printChar(uint8_t c) {
+        if (m_escape) {
+            m_escape = false;
+            if (c == '@') {
+                reset();
+            } else if (c == 'E') {
+                m_bold = true;
+            } else if (c == 'F') {
+                m_bold = false;
+            }
+            return;
+        }
+        switch (c) {
+            case 0x1B: m_escape = true; break;
+            case '\r': break;
+            case '\n': ++m_page.lines; break;
+            case '\f': eject(); break;
+            default:
+                spin(m_glyphNs);
+                ++m_page.glyphs;
+                m_page.boldGlyphs += m_bold ? 1 : 0;
+                m_page.checksum = m_page.checksum * 31 + c + (m_bold ? 0x100 : 0);
+                break;
+        }
+    }
+
+    void reset() {
+        m_bold = false;
+        m_escape = false;
+    }
+
+    void eject() {
+        spin(m_pageNs);
+        m_output.pages.push_back(m_page);
+        m_page = PrintedPage();
+    }
+
+    Output& m_output;
+    Gate* m_gate;
+    const uint64_t m_glyphNs;
+    const uint64_t m_pageNs;
+    PrintedPage m_page;
+    bool m_bold = false;
+    bool m_escape = false;
+};
+
+// A page of text: 60 lines of 80 columns, every other line bold
+std::string textPage(int number) {
+    std::string page;
+    for (int line = 0; line < 60; ++line) {
+        page += (line & 1) ? "\x1B" "E" : "\x1B" "F";
+        for (int column = 0; column < 80; ++column) {
+            page += static_cast<char>('A' + (number + line + column) % 26);
+        }
+        page += "\r\n";
+    }
+    return page + "\f";
+}
+
+size_t submitAll(BoxerPrintPipeline& pipeline, const std::string& text) {
+    return pipeline.submit(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+bool testOrderOffThread() {
+    std::cout << "\n[TEST 1] Commands Reach the Engine in Order, Off Thread" << std::endl;
+
+    StubEscpPrinter::Output output;
+    {
+        BoxerPrintPipeline pipeline(std::make_unique<StubEscpPrinter>(output));
+        submitAll(pipeline, "HELLO\r\n");
+        pipeline.drain();
+        submitAll(pipeline, "WORLD\r\n");
+        pipeline.controlChanged(0xD6);
+        submitAll(pipeline, "!");
+        pipeline.finishJob();
+        pipeline.drain();
+    }
+
+    const std::vector<std::string> expected = {"data:7", "data:7", "control:214", "data:1", "finish"};
+    if (output.events != expected) {
+        std::cerr << "  ✗ FAIL: Engine saw:";
+        for (const auto& event : output.events) {
+            std::cerr << " " << event;
+        }
+        std::cerr << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Data, control change and job end arrived in port order" << std::endl;
+
+    if (output.thread == std::this_thread::get_id() || output.pages.size() != 1 ||
+        output.pages[0].glyphs != 11 || output.pages[0].lines != 2) {
+        std::cerr << "  ✗ FAIL: Engine ran on the emulation thread or page wrong" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Engine ran on the worker; 11 glyphs on 2 lines printed" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testNeverWaits() {
+    std::cout << "\n[TEST 2] Emulation Thread Never Waits for Rendering" << std::endl;
+
+    StubEscpPrinter::Output output;
+    Gate gate;
+    gate.close();
+    BoxerPrintPipeline pipeline(std::make_unique<StubEscpPrinter>(output, &gate));
+
+    // The engine is held: every call below must return without it
+    size_t accepted = 0;
+    for (int page = 0; page < 3; ++page) {
+        accepted += submitAll(pipeline, textPage(page));
+    }
+    pipeline.finishJob();
+    const auto queued = pipeline.stats();
+    if (accepted != 3 * textPage(0).size() || queued.bytesPrinted != 0 || pipeline.busy()) {
+        std::cerr << "  ✗ FAIL: Submits were refused or waited for the engine" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ 3 pages queued while the engine was blocked; port stays ready" << std::endl;
+    // The held worker can have taken at most the first block off the queue
+    if (queued.commands > 3) {
+        std::cerr << "  ✗ FAIL: Expected at most 3 queue entries, got " << queued.commands << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Waiting data blocks merged (" << queued.commands << " queue entries)" << std::endl;
+
+    gate.open();
+    pipeline.drain();
+    if (output.pages.size() != 3) {
+        std::cerr << "  ✗ FAIL: Expected 3 pages, got " << output.pages.size() << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ All 3 pages printed once the engine ran" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testBacklogCap() {
+    std::cout << "\n[TEST 3] Backlog Cap and BUSY" << std::endl;
+
+    StubEscpPrinter::Output output;
+    Gate gate;
+    gate.close();
+    BoxerPrintPipeline pipeline(std::make_unique<StubEscpPrinter>(output, &gate), 1024);
+    BoxerPrinterStream stream([&pipeline](const uint8_t* data, size_t length) {
+                                  return pipeline.submit(data, length);
+                              },
+                              [&pipeline](uint8_t control) { pipeline.controlChanged(control); }, 256);
+    BoxerPrinterRegisters registers;
+
+    // Strobe two pages through the port while the engine is held
+    const std::string document = textPage(0) + textPage(1);
+    size_t sent = 0;
+    stream.writeControl(0xD4);
+    while (sent < document.size() &&
+           (registers.readStatus(stream.busy()) & BoxerPrinterRegisters::StatusNotBusy)) {
+        stream.writeData(static_cast<uint8_t>(document[sent++]));
+        stream.writeControl(0xD5);
+        stream.writeControl(0xD4);
+    }
+    if (sent != 1024 + 256 || !pipeline.busy()) {
+        std::cerr << "  ✗ FAIL: Expected BUSY after 1280 bytes, got " << sent << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Port went BUSY after 1024 queued + 256 in the ring" << std::endl;
+
+    // The driver waits on BUSY; the worker catches up
+    gate.open();
+    while (sent < document.size()) {
+        if (registers.readStatus(stream.busy()) & BoxerPrinterRegisters::StatusNotBusy) {
+            stream.writeData(static_cast<uint8_t>(document[sent++]));
+            stream.writeControl(0xD5);
+            stream.writeControl(0xD4);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    while (stream.pending()) {
+        stream.flush();
+        std::this_thread::yield();
+    }
+    pipeline.drain();
+
+    StubEscpPrinter::Output direct;
+    StubEscpPrinter reference(direct);
+    reference.printData(reinterpret_cast<const uint8_t*>(document.data()), document.size());
+    if (output.pages.size() != 2 || !(output.pages[0] == direct.pages[0]) || !(output.pages[1] == direct.pages[1])) {
+        std::cerr << "  ✗ FAIL: Throttled pages differ from a direct print" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Both pages identical to a direct print after throttling" << std::endl;
+    std::cout << "  ✓ Peak backlog " << pipeline.stats().maxBacklogBytes << " bytes" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testInitAndFinish() {
+    std::cout << "\n[TEST 4] INIT Reset and Partial Page Eject" << std::endl;
+
+    StubEscpPrinter::Output output;
+    BoxerPrintPipeline pipeline(std::make_unique<StubEscpPrinter>(output));
+    submitAll(pipeline, "\x1B" "EBOLD");
+    // INIT pulse: the printer forgets bold
+    pipeline.controlChanged(0xD0);
+    pipeline.controlChanged(0xD4);
+    submitAll(pipeline, "PLAIN\r\n");
+    pipeline.finishJob();
+    pipeline.drain();
+
+    if (output.pages.size() != 1 || output.pages[0].glyphs != 9 || output.pages[0].boldGlyphs != 4) {
+        std::cerr << "  ✗ FAIL: Expected one page with 4 of 9 glyphs bold" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ INIT reset bold between queued data blocks" << std::endl;
+    std::cout << "  ✓ Job end ejected the partial page" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testDestructorDrains() {
+    std::cout << "\n[TEST 5] Destruction Prints Everything Queued" << std::endl;
+
+    StubEscpPrinter::Output output;
+    {
+        BoxerPrintPipeline pipeline(std::make_unique<StubEscpPrinter>(output, nullptr, 0, 1000000));
+        for (int page = 0; page < 5; ++page) {
+            submitAll(pipeline, textPage(page));
+        }
+        pipeline.finishJob();
+    }
+    if (output.pages.size() != 5) {
+        std::cerr << "  ✗ FAIL: Expected 5 pages after shutdown, got " << output.pages.size() << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ 5 pages printed before the worker stopped" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testEmulationThreadCost() {
+    std::cout << "\n[TEST 6] Emulation-Thread Cost per Byte" << std::endl;
+
+    const uint64_t glyphNs = 300;
+    const uint64_t pageNs = 2000000;
+    std::string document;
+    for (int page = 0; page < 5; ++page) {
+        document += textPage(page);
+    }
+
+    // Synchronous: printer.cpp as it was, rendering inside the port write
+    StubEscpPrinter::Output syncOutput;
+    StubEscpPrinter sync(syncOutput, nullptr, glyphNs, pageNs);
+    auto start = std::chrono::steady_clock::now();
+    for (const char c : document) {
+        const uint8_t byte = static_cast<uint8_t>(c);
+        sync.printData(&byte, 1);
+    }
+    const double syncNs =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+        document.size();
+
+    // Pipelined: the port writes go through the stream into the queue
+    StubEscpPrinter::Output pipeOutput;
+    double pipeNs;
+    {
+        BoxerPrintPipeline pipeline(std::make_unique<StubEscpPrinter>(pipeOutput, nullptr, glyphNs, pageNs));
+        BoxerPrinterStream stream([&pipeline](const uint8_t* data, size_t length) {
+                                      return pipeline.submit(data, length);
+                                  },
+                                  nullptr);
+        start = std::chrono::steady_clock::now();
+        for (const char c : document) {
+            stream.putchar(static_cast<uint8_t>(c));
+        }
+        stream.flush();
+        pipeNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                 document.size();
+        pipeline.drain();
+    }
+
+    if (pipeOutput.pages.size() != 5 || pipeOutput.pages.size() != syncOutput.pages.size()) {
+        std::cerr << "  ✗ FAIL: Paths printed different pages" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < 5; ++i) {
+        if (!(pipeOutput.pages[i] == syncOutput.pages[i])) {
+            std::cerr << "  ✗ FAIL: Page " << i << " differs" << std::endl;
+            return false;
+        }
+    }
+    std::cout << "  Synchronous rendering: " << syncNs << " ns per byte on the emulation thread" << std::endl;
+    std::cout << "  Pipelined rendering:   " << pipeNs << " ns per byte on the emulation thread" << std::endl;
+    std::cout << "  ✓ Same 5 pages from both paths" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Print Pipeline Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting off-thread ESC/P printing behind INT-076 / INT-078" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testOrderOffThread()) passed++; else failed++;
+    if (testNeverWaits()) passed++; else failed++;
+    if (testBacklogCap()) passed++; else failed++;
+    if (testInitAndFinish()) passed++; else failed++;
+    if (testDestructorDrains()) passed++; else failed++;
+    if (testEmulationThreadCost()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
@@ -0,0 +1,224 @@
+/*
+ * print-throughput-benchmark.cpp - File LPT print throughput benchmark
+ *
+ * Streams one large print job through an emulated printer port into a
+ * file, the way a DOS program printing to a file-backed LPT device does:
+ * latch a byte, pulse STROBE, poll status. Three output paths are timed:
+ *
+ *   - legacy unbuffered: the file device writes each byte straight to the
+ *     file, one host write per byte on the emulation thread
+ *   - legacy stdio: the same with a default stdio buffer
+ *   - async: BoxerPrinterStream feeding BoxerLptFileWriter
+ *
+ * For each path it reports the emulation thread's throughput (until the
+ * last byte is strobed), the time until the job is closed on disk, and the
+ * number of write system calls. The output files are compared against the
+ * job and removed.
+ *
+ * Usage: ./print-throughput-benchmark [megabytes] [directory]
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_lpt_file_writer.h"
+#include "boxer_printer_registers.h"
+#include "boxer_printer_stream.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double strobeSeconds;   ///< Emulation thread, until the last byte is strobed
+    double closedSeconds;   ///< Until the job is closed on disk
+    uint64_t writeCalls;
+};
+
+// Printed text: lines of ASCII with CR LF, a form feed every 66 lines
+std::vector<uint8_t> makeJob(size_t length) {
+    std::vector<uint8_t> job;
+    job.reserve(length);
+    uint32_t line = 0;
+    while (job.size() < length) {
+        for (int column = 0; column < 78 && job.size() < length; ++column) {
+            job.push_back(static_cast<uint8_t>(' ' + (line * 7 + column) % 95));
+        }
+        job.push_back('\r');
+        job.push_back(++line % 66 ? '\n' : '\f');
+    }
+    job.resize(length);
+    return job;
+}
+
+bool matches(const std::string& path, const std::vector<uint8_t>& job) {
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<uint8_t> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ::unlink(path.c_str());
+    return contents == job;
+}
+
+// ============================================================================
+// Legacy path
+// ============================================================================
+// The legacy device sits behind a virtual port handler; each strobed byte
+// goes straight to the device's FILE*.
+
+class LegacyPortDevice {
+public:
+    virtual ~LegacyPortDevice() = default;
+    virtual void writeData(uint8_t value) = 0;
+    virtual void writeControl(uint8_t value) = 0;
+    virtual uint8_t readStatus() = 0;
+};
+
+class LegacyFileDevice : public LegacyPortDevice {
+public:
+    LegacyFileDevice(const std::string& path, bool buffered) : m_file(std::fopen(path.c_str(), "wb")) {
+        if (m_file && !buffered) {
+            std::setvbuf(m_file, nullptr, _IONBF, 0);
+        }
+    }
+    ~LegacyFileDevice() override { close(); }
+
+    void writeData(uint8_t value) override { m_data = value; }
+    void writeControl(uint8_t value) override {
+        if ((value & 1) && !(m_control & 1) && m_file) {
+            std::fputc(m_data, m_file);
+        }
+        m_control = value;
+    }
+    uint8_t readStatus() override { return BoxerPrinterRegisters::kReadyStatus; }
+
+    void close() {
+        if (m_file) {
+            std::fclose(m_file);
+            m_file = nullptr;
+        }
+    }
+
+private:
+    std::FILE* m_file;
+    uint8_t m_data = 0;
+    uint8_t m_control = BoxerPrinterRegisters::kResetControl;
+};
+
+Result runLegacy(const std::string& path, const std::vector<uint8_t>& job, bool buffered) {
+    const auto start = Clock::now();
+    LegacyFileDevice file(path, buffered);
+    LegacyPortDevice* volatile deviceSlot = &file;
+    LegacyPortDevice* device = deviceSlot;
+    for (uint8_t value : job) {
+        while (!(device->readStatus() & BoxerPrinterRegisters::StatusNotBusy)) {
+        }
+        device->writeData(value);
+        device->writeControl(0x0D);
+        device->writeControl(0x0C);
+    }
+    const auto strobed = Clock::now();
+    file.close();
+    const auto closed = Clock::now();
+
+    const uint64_t bufferBytes = BUFSIZ;
+    return Result{std::chrono::duration<double>(strobed - start).count(),
+                  std::chrono::duration<double>(closed - start).count(),
+                  buffered ? (job.size() + bufferBytes - 1) / bufferBytes : job.size()};
+}
+
+// ============================================================================
+// Async path
+// ============================================================================
+
+Result runAsync(const std::string& path, const std::vector<uint8_t>& job) {
+    const auto start = Clock::now();
+    BoxerLptFileWriter writer([&path](uint32_t) { return path; }, 0);
+    BoxerPrinterStream stream([&writer](const uint8_t* data, size_t length) { return writer.submit(data, length); },
+                              [&writer](uint8_t control) { writer.controlChanged(control); });
+    BoxerPrinterRegisters registers;
+    for (uint8_t value : job) {
+        while (!(registers.readStatus(stream.busy()) & BoxerPrinterRegisters::StatusNotBusy)) {
+        }
+        stream.writeData(value);
+        stream.writeControl(0x0D);
+        stream.writeControl(0x0C);
+        registers.acknowledge();
+    }
+    const auto strobed = Clock::now();
+    stream.flush();
+    stream.writeControl(0x08);   // the driver resets the printer at the end of the job
+    writer.sync();
+    const auto closed = Clock::now();
+
+    return Result{std::chrono::duration<double>(strobed - start).count(),
+                  std::chrono::duration<double>(closed - start).count(), writer.stats().writeCalls};
+}
+
+void printRow(const char* name, size_t bytes, const Result& result, bool correct) {
+    const double megabytes = bytes / (1024.0 * 1024.0);
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << megabytes / result.strobeSeconds << std::setw(12)
+              << result.strobeSeconds * 1e9 / bytes << std::setw(12) << result.closedSeconds * 1e3
+              << std::setw(12) << result.writeCalls << (correct ? "" : "  OUTPUT MISMATCH") << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double megabytes = 8.0;
+    std::string directory = "/tmp";
+    if (argc > 1) {
+        megabytes = std::atof(argv[1]);
+    }
+    if (argc > 2) {
+        directory = argv[2];
+    }
+    const size_t bytes = static_cast<size_t>(megabytes * 1024 * 1024);
+    if (bytes == 0) {
+        std::cerr << "Usage: " << argv[0] << " [megabytes] [directory]" << std::endl;
+        return 1;
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Print Throughput Benchmark" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << bytes << " byte job, strobed through the printer port into " << directory << "\n" << std::endl;
+
+    std::cout << std::left << std::setw(20) << "path" << std::right << std::setw(12) << "port_MB/s"
+              << std::setw(12) << "ns/byte" << std::setw(12) << "closed_ms" << std::setw(12) << "writes"
+              << std::endl;
+
+    const auto job = makeJob(bytes);
+    const std::string path = directory + "/boxer-print-benchmark-" + std::to_string(::getpid()) + ".prn";
+    bool correct = true;
+
+    Result result = runLegacy(path, job, false);
+    bool ok = matches(path, job);
+    printRow("legacy unbuffered", bytes, result, ok);
+    correct = correct && ok;
+
+    result = runLegacy(path, job, true);
+    ok = matches(path, job);
+    printRow("legacy stdio", bytes, result, ok);
+    correct = correct && ok;
+
+    result = runAsync(path, job);
+    ok = matches(path, job);
+    printRow("async writer", bytes, result, ok);
+    correct = correct && ok;
+
+    std::cout << "\nWrite counts for the legacy paths are estimated (one per byte, one per BUFSIZ)" << std::endl;
+    return correct ? 0 : 1;
+}
@@ -0,0 +1,448 @@
+/*
+ * printer-stream-test.cpp - Buffered printer data stream test suite
+ *
+ * Validates BoxerPrinterStream, which takes these hooks off the per-byte path:
+ * - INT-075: PRINTER_readdata
+ * - INT-076: PRINTER_writedata
+ * - INT-078: PRINTER_writecontrol (strobe pulses)
+ *
+ * Test cases:
+ * 1. Strobed bytes reach the host in order, in chunks
+ * 2. Control line changes flush the buffer first
+ * 3. A full ring is flushed
+ * 4. Host backpressure, wraparound and BUSY
+ * 5. Idle flush and DOS device output
+ * 6. Hook cost for a page of ESC/P graphics
+ * 7. Control changes wait behind bytes the host has not accepted
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_printer_stream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Test fixtures
+// ============================================================================
+
+// What a DOS print driver does per byte (CPrinterRedir::Putchar)
+template <typename Port>
+void strobeByte(Port& port, uint8_t value) {
+    port.writeControl(0xD4);
+    port.writeData(value);
+    port.writeControl(0xD5);   // strobe pulse
+    port.writeControl(0xD4);   // strobe off
+}
+
+// Host side of the new path, recording chunks and control changes in order
+struct HostPrinter {
+    std::vector<uint8_t> received;
+    std::vector<std::string> events;
+    size_t acceptLimit = SIZE_MAX;   ///< Bytes accepted per call
+
+    BoxerPrinterStream::DataSink dataSink() {
+        return [this](const uint8_t* data, size_t length) {
+            const size_t accepted = std::min(length, acceptLimit);
+            if (accepted) {
+                received.insert(received.end(), data, data + accepted);
+                events.push_back("data:" + std::string(data, data + accepted));
+            }
+            return accepted;
+        };
+    }
+    BoxerPrinterStream::ControlSink controlSink() {
+        return [this](uint8_t control) { events.push_back("control:" + std::to_string(control)); };
+    }
+};
+
+// The legacy delegate: every port access is a virtual call
+class LegacyPrinterDelegate {
+public:
+    virtual ~LegacyPrinterDelegate() = default;
+    virtual void PRINTER_writedata(uintptr_t port, uintptr_t val, uintptr_t iolen) = 0;
+    virtual void PRINTER_writecontrol(uintptr_t port, uintptr_t val, uintptr_t iolen) = 0;
+    virtual uintptr_t PRINTER_readstatus(uintptr_t port, uintptr_t iolen) = 0;
+};
+
+// Stands in for one Objective-C message send: an indirect call the
+// compiler cannot see through
+class LegacyHostPrinter;
+using MessageSend = LegacyHostPrinter* (*)(LegacyHostPrinter*);
+LegacyHostPrinter* sendMessage(LegacyHostPrinter* receiver) { return receiver; }
+MessageSend volatile messageSend = sendMessage;
+
+// BXEmulatedPrinter's register model: a strobe latches the data register.
+// BXCoalface reaches it through [BXEmulator currentEmulator].printer, two
+// message sends before the register access itself
+class LegacyHostPrinter : public LegacyPrinterDelegate {
+public:
+    std::vector<uint8_t> received;
+    uint64_t calls = 0;
+
+    void PRINTER_writedata(uintptr_t, uintptr_t val, uintptr_t) override {
+        LegacyHostPrinter* printer = currentPrinter();
+        printer->m_data = static_cast<uint8_t>(val);
+    }
+    void PRINTER_writecontrol(uintptr_t, uintptr_t val, uintptr_t) override {
+        LegacyHostPrinter* printer = currentPrinter();
+        if ((val & 1) && !(printer->m_control & 1)) {
+            printer->received.push_back(printer->m_data);
+        }
+        printer->m_control = static_cast<uint8_t>(val);
+    }
+    uintptr_t PRINTER_readstatus(uintptr_t, uintptr_t) override {
+        currentPrinter();
+        return 0xDF;
+    }
+
+private:
+    LegacyHostPrinter* currentPrinter() {
+        ++calls;
+        return messageSend(messageSend(this));
+    }
+
+    uint8_t m_data = 0;
+    uint8_t m_control = 0;
+};
+
+// CPrinterRedir as it was: hooks for every register access
+struct LegacyPort {
+    LegacyPrinterDelegate* delegate;
+    void writeData(uint8_t value) { delegate->PRINTER_writedata(0, value, 1); }
+    void writeControl(uint8_t value) { delegate->PRINTER_writecontrol(0, value, 1); }
+};
+
+std::vector<uint8_t> graphicsPage(size_t length) {
+    // ESC * 39 column graphics: a header, then pseudo-random dot columns
+    std::vector<uint8_t> page;
+    page.reserve(length);
+    uint32_t seed = 12345;
+    while (page.size() < length) {
+        page.insert(page.end(), {0x1B, '*', 39, 0x40, 0x06});
+        for (int i = 0; i < 1600 * 3 && page.size() < length; ++i) {
+            seed = seed * 1103515245 + 12345;
+            page.push_back(static_cast<uint8_t>(seed >> 16));
+        }
+        page.insert(page.end(), {'\r', '\n'});
+    }
+    page.resize(length);
+    return page;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+bool testStrobedBytes() {
+    std::cout << "\n[TEST 1] Strobed Bytes Reach the Host in Chunks" << std::endl;
+
+    HostPrinter host;
+    BoxerPrinterStream port(host.dataSink(), host.controlSink(), 4096);
+    const auto page = graphicsPage(10000);
+    for (const uint8_t byte : page) {
+        strobeByte(port, byte);
+        port.busy();
+    }
+    port.flush();
+
+    if (host.received != page) {
+        std::cerr << "  ✗ FAIL: Host received " << host.received.size() << " bytes, not the page" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ 10000 bytes arrived in order" << std::endl;
+
+    const auto& stats = port.stats();
+    if (stats.chunks != 3 || stats.controlChanges != 1) {
+        std::cerr << "  ✗ FAIL: Expected 3 chunks and 1 control change, got " << stats.chunks << " and "
+                  << stats.controlChanges << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ 3 host calls instead of 40000 (only the first 0xD4 was a real line change)" << std::endl;
+
+    if (port.readData() != page.back() || port.readControl() != 0xD4) {
+        std::cerr << "  ✗ FAIL: Register reads not served from the latch" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Data and control reads served locally" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testControlFlush() {
+    std::cout << "\n[TEST 2] Control Line Changes Flush First" << std::endl;
+
+    HostPrinter host;
+    BoxerPrinterStream port(host.dataSink(), host.controlSink(), 4096);
+    strobeByte(port, 'A');
+    strobeByte(port, 'B');
+    // Init pulse: INIT low, then high again
+    port.writeControl(0xD0);
+    port.writeControl(0xD4);
+    strobeByte(port, 'C');
+    // Auto feed on
+    port.writeControl(0xD6);
+    port.flush();
+
+    const std::vector<std::string> expected = {"control:212", "data:AB", "control:208", "control:212",
+                                               "data:C", "control:214"};
+    if (host.events != expected) {
+        std::cerr << "  ✗ FAIL: Events out of order:";
+        for (const auto& event : host.events) {
+            std::cerr << " " << event;
+        }
+        std::cerr << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Bytes before a line change reach the host before the change" << std::endl;
+    std::cout << "  ✓ Strobe pulses were never forwarded" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testFullRing() {
+    std::cout << "\n[TEST 3] Full Ring Flush" << std::endl;
+
+    HostPrinter host;
+    BoxerPrinterStream port(host.dataSink(), host.controlSink(), 12);
+    if (port.capacity() != 16) {
+        std::cerr << "  ✗ FAIL: Capacity 12 should round up to 16, got " << port.capacity() << std::endl;
+        return false;
+    }
+    port.writeControl(0xD4);
+    for (int i = 0; i < 40; ++i) {
+        strobeByte(port, static_cast<uint8_t>(i));
+    }
+    if (host.received.size() != 32 || port.pending() != 8 || port.stats().fullFlushes != 2) {
+        std::cerr << "  ✗ FAIL: Expected 32 delivered and 8 pending, got " << host.received.size() << " and "
+                  << port.pending() << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Two full rings of 16 delivered; 8 bytes wait for the next flush" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testBackpressure() {
+    std::cout << "\n[TEST 4] Host Backpressure and BUSY" << std::endl;
+
+    HostPrinter host;
+    BoxerPrinterStream port(host.dataSink(), host.controlSink(), 16);
+    port.writeControl(0xD4);
+
+    // Host takes 5 bytes per call: the ring wraps around partial deliveries
+    host.acceptLimit = 5;
+    std::vector<uint8_t> sent;
+    for (int i = 0; i < 100; ++i) {
+        strobeByte(port, static_cast<uint8_t>(i));
+        sent.push_back(static_cast<uint8_t>(i));
+    }
+    port.flush();
+    while (port.pending()) {
+        port.flush();
+    }
+    if (host.received != sent) {
+        std::cerr << "  ✗ FAIL: Partial deliveries lost or reordered bytes" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ 100 bytes in order through partial host deliveries" << std::endl;
+
+    // Host refuses everything: the ring fills and the port reports BUSY
+    host.acceptLimit = 0;
+    for (int i = 0; i < 16; ++i) {
+        strobeByte(port, 'x');
+    }
+    if (!port.busy()) {
+        std::cerr << "  ✗ FAIL: Full ring with a refusing host not busy" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ BUSY while the host refuses and the ring is full" << std::endl;
+
+    host.acceptLimit = SIZE_MAX;
+    if (port.busy() || port.pending() != 0 || host.received.size() != 116) {
+        std::cerr << "  ✗ FAIL: BUSY did not clear once the host accepted" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ BUSY clears and the ring drains once the host accepts" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testIdleFlush() {
+    std::cout << "\n[TEST 5] Idle Flush and DOS Device Output" << std::endl;
+
+    HostPrinter host;
+    BoxerPrinterStream port(host.dataSink(), host.controlSink(), 4096);
+    for (const char c : std::string("DIR > LPT1\r\n")) {
+        port.putchar(static_cast<uint8_t>(c));
+    }
+    port.idleTick();
+    if (!host.received.empty()) {
+        std::cerr << "  ✗ FAIL: Flushed while bytes were still arriving" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ No flush on the tick that saw new bytes" << std::endl;
+
+    port.idleTick();
+    if (std::string(host.received.begin(), host.received.end()) != "DIR > LPT1\r\n" ||
+        port.stats().idleFlushes != 1) {
+        std::cerr << "  ✗ FAIL: Quiet port not flushed on the next tick" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Flushed on the next quiet tick" << std::endl;
+
+    port.idleTick();
+    if (port.stats().idleFlushes != 1 || port.stats().chunks != 1) {
+        std::cerr << "  ✗ FAIL: Empty ring flushed again" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Empty ring left alone" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testControlBehindPartialDelivery() {
+    std::cout << "\n[TEST 7] Control Changes Wait Behind Unaccepted Bytes" << std::endl;
+
+    HostPrinter host;
+    BoxerPrinterStream port(host.dataSink(), host.controlSink(), 16);
+    host.acceptLimit = 0;
+    for (const char c : std::string("ABCD")) {
+        strobeByte(port, static_cast<uint8_t>(c));
+    }
+    // Reset pulse while the host holds off, then a byte from a driver that
+    // ignores BUSY
+    port.writeControl(0xD0);
+    port.writeControl(0xD4);
+    strobeByte(port, 'E');
+    if (host.events != std::vector<std::string>{"control:212"} || !port.busy()) {
+        std::cerr << "  ✗ FAIL: Reset forwarded ahead of unaccepted bytes, or port not busy" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Reset held back and port BUSY while the host refuses" << std::endl;
+
+    // Two bytes per host call: the tick gets AB out, the next status poll
+    // the rest
+    host.acceptLimit = 2;
+    port.idleTick();
+    if (host.events != std::vector<std::string>{"control:212", "data:AB"}) {
+        std::cerr << "  ✗ FAIL: Reset forwarded after a partial delivery" << std::endl;
+        return false;
+    }
+    if (port.busy()) {
+        std::cerr << "  ✗ FAIL: Port still busy once the host accepted everything" << std::endl;
+        return false;
+    }
+    const std::vector<std::string> expected = {"control:212", "data:AB", "data:CD", "control:208",
+                                               "control:212", "data:E"};
+    if (host.events != expected) {
+        std::cerr << "  ✗ FAIL: Events out of order:";
+        for (const auto& event : host.events) {
+            std::cerr << " " << event;
+        }
+        std::cerr << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Partial deliveries keep bytes and line changes in port order" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testHookCost() {
+    std::cout << "\n[TEST 6] Hook Cost for a Page of ESC/P Graphics" << std::endl;
+
+    const auto page = graphicsPage(64 * 1024);
+    const int rounds = 50;
+
+    LegacyHostPrinter legacyHost;
+    // Opaque, like a delegate set at runtime, so the calls stay virtual
+    LegacyPrinterDelegate* volatile delegateSlot = &legacyHost;
+    LegacyPrinterDelegate* delegate = delegateSlot;
+    LegacyPort legacy{delegate};
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        legacyHost.received.clear();
+        for (const uint8_t byte : page) {
+            strobeByte(legacy, byte);
+            delegate->PRINTER_readstatus(0, 1);
+        }
+    }
+    const double legacyNs =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+        (double(rounds) * page.size());
+
+    HostPrinter host;
+    BoxerPrinterStream port(host.dataSink(), host.controlSink());
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        host.received.clear();
+        for (const uint8_t byte : page) {
+            strobeByte(port, byte);
+            port.busy();
+        }
+        port.flush();
+    }
+    const double streamNs =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+        (double(rounds) * page.size());
+
+    if (legacyHost.received != page || host.received != page) {
+        std::cerr << "  ✗ FAIL: Paths printed different bytes" << std::endl;
+        return false;
+    }
+    std::cout << "  Per-byte hooks:  " << legacyHost.calls / rounds << " calls per page, " << legacyNs
+              << " ns per byte" << std::endl;
+    std::cout << "  Buffered stream: " << port.stats().chunks / rounds << " chunks per page, " << streamNs
+              << " ns per byte" << std::endl;
+    std::cout << "  ✓ Both paths printed the same page" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Printer Stream Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-075, INT-076, INT-078 buffered data path" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testStrobedBytes()) passed++; else failed++;
+    if (testControlFlush()) passed++; else failed++;
+    if (testFullRing()) passed++; else failed++;
+    if (testBackpressure()) passed++; else failed++;
+    if (testIdleFlush()) passed++; else failed++;
+    if (testHookCost()) passed++; else failed++;
+    if (testControlBehindPartialDelivery()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
@@ -0,0 +1,366 @@
+/*
+ * batch-driver-test.cpp - Headless batch driver test suite
+ *
+ * Validates BoxerBatchDriver, which answers these hooks without a delegate:
+ * - INT-026: didReturnToShell
+ * - INT-036: shellWillBeginBatchFile
+ * - INT-037: shellDidEndBatchFile
+ * - INT-038: shellShouldContinue
+ * - INT-059: runLoopShouldContinue (job timeouts)
+ *
+ * Test cases:
+ * 1. Job list parsing
+ * 2. Jobs run back to back with exit status and timing
+ * 3. CALLed batch files belong to their job
+ * 4. A hung job times out and the next job runs after a restart
+ * 5. A missing batch file is recorded and skipped
+ * 6. JSON report and per-job driver overhead
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_batch_driver.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// Simulated shell
+// ============================================================================
+// Pops queued lines like DOS_Shell::Run and "executes" scripted batch
+// files, advancing a manual clock and polling the run loop hook as it goes.
+
+struct BatchScript {
+    uint64_t runMs = 10;
+    uint8_t errorLevel = 0;
+    std::vector<std::string> calls;   ///< Batch files CALLed from this one
+    bool hangs = false;               ///< Never returns to the shell
+};
+
+BatchScript batch(uint64_t runMs, uint8_t errorLevel, std::vector<std::string> calls = {}, bool hangs = false) {
+    return BatchScript{runMs, errorLevel, std::move(calls), hangs};
+}
+
+class SimulatedShell {
+public:
+    uint64_t nowNs = 0;
+    uint8_t returnCode = 0;
+    int restarts = 0;
+    std::map<std::string, BatchScript> files;
+
+    BoxerBatchDriver::Clock clock() {
+        return [this]() { return nowNs; };
+    }
+    BoxerBatchDriver::ErrorLevel errorLevel() {
+        return [this]() { return returnCode; };
+    }
+
+    // The shell loop until INT-038 says stop; false if it stalls
+    bool run(BoxerBatchDriver& driver, BoxerCommandQueue& queue) {
+        int idleWithoutWork = 0;
+        while (driver.shellShouldContinue()) {
+            std::string line;
+            if (queue.pop(line)) {
+                idleWithoutWork = 0;
+                if (!execute(driver, line)) {
+                    // Timed out: the integration restarts the machine
+                    driver.machineWillRestart();
+                    ++restarts;
+                }
+                continue;
+            }
+            driver.shellDidBecomeIdle();
+            if (++idleWithoutWork > 2) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    // Run a command line; false if the run loop was told to stop
+    bool execute(BoxerBatchDriver& driver, const std::string& line) {
+        const std::string path = line.substr(0, line.find(' '));
+        const auto found = files.find(path);
+        if (found == files.end()) {
+            nowNs += 100000;   // "Illegal command"
+            return true;
+        }
+        return runBatch(driver, path, found->second);
+    }
+
+    bool runBatch(BoxerBatchDriver& driver, const std::string& path, const BatchScript& script) {
+        driver.shellWillBeginBatchFile(path.c_str());
+        const uint64_t steps = script.hangs ? UINT64_MAX : script.runMs;
+        for (uint64_t ms = 0; ms < steps; ++ms) {
+            nowNs += 1000000;
+            if (!driver.runLoopShouldContinue()) {
+                return false;
+            }
+        }
+        for (const auto& call : script.calls) {
+            if (!runBatch(driver, call, files.at(call))) {
+                return false;
+            }
+        }
+        returnCode = script.errorLevel;
+        driver.shellDidEndBatchFile(path.c_str());
+        return true;
+    }
+};
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+bool testJobListParsing() {
+    std::cout << "\n[TEST 1] Job List Parsing" << std::endl;
+
+    std::istringstream list(
+        "# nightly compile jobs\r\n"
+        "C:\\JOBS\\BUILD.BAT release\r\n"
+        "\r\n"
+        "timeout 2.5\n"
+        "  C:\\JOBS\\TEST.BAT   \n"
+        "; disabled: C:\\JOBS\\SLOW.BAT\n"
+        "timeout 0\n"
+        "C:\\JOBS\\SOAK.BAT 1000\n");
+    std::vector<BoxerBatchDriver::Job> jobs;
+    std::string error;
+    if (!BoxerBatchDriver::parseJobList(list, jobs, error) || jobs.size() != 3) {
+        std::cerr << "  ✗ FAIL: Expected 3 jobs (" << error << ")" << std::endl;
+        return false;
+    }
+    if (jobs[0].command != "C:\\JOBS\\BUILD.BAT release" || jobs[0].timeoutMs != BoxerBatchDriver::kDefaultTimeoutMs ||
+        jobs[1].command != "C:\\JOBS\\TEST.BAT" || jobs[1].timeoutMs != 2500 ||
+        jobs[2].command != "C:\\JOBS\\SOAK.BAT 1000" || jobs[2].timeoutMs != 0) {
+        std::cerr << "  ✗ FAIL: Jobs parsed wrongly" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Comments, blank lines and CRLF skipped; timeouts apply to later jobs" << std::endl;
+
+    std::istringstream bad("C:\\A.BAT\ntimeout soon\n");
+    jobs.clear();
+    if (BoxerBatchDriver::parseJobList(bad, jobs, error) || error != "line 2: bad timeout 'soon'") {
+        std::cerr << "  ✗ FAIL: Bad timeout accepted or wrong error: " << error << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Bad timeout rejected: " << error << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testBackToBack() {
+    std::cout << "\n[TEST 2] Jobs Run Back to Back" << std::endl;
+
+    SimulatedShell shell;
+    shell.files["C:\\A.BAT"] = batch(30, 0);
+    shell.files["C:\\B.BAT"] = batch(50, 4);
+    shell.files["C:\\C.BAT"] = batch(20, 1);
+    BoxerCommandQueue queue;
+    BoxerBatchDriver driver({{"C:\\A.BAT", 1000}, {"C:\\B.BAT x y", 1000}, {"C:\\C.BAT", 1000}},
+                            shell.errorLevel(), queue, shell.clock());
+
+    if (!shell.run(driver, queue) || !driver.finished()) {
+        std::cerr << "  ✗ FAIL: Shell stalled before the jobs finished" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ All jobs ran in one machine; shellShouldContinue ended the shell" << std::endl;
+
+    const auto& results = driver.results();
+    const uint8_t expectedLevels[] = {0, 4, 1};
+    const uint64_t expectedMs[] = {30, 50, 20};
+    for (size_t i = 0; i < 3; ++i) {
+        if (results[i].outcome != BoxerBatchDriver::Outcome::Completed ||
+            results[i].errorLevel != expectedLevels[i] || results[i].wallNs != expectedMs[i] * 1000000) {
+            std::cerr << "  ✗ FAIL: Job " << i << " result wrong (errorlevel "
+                      << unsigned(results[i].errorLevel) << ", " << results[i].wallNs << " ns)" << std::endl;
+            return false;
+        }
+    }
+    std::cout << "  ✓ ERRORLEVEL 0, 4, 1 and wall times 30, 50, 20 ms recorded" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testNestedCalls() {
+    std::cout << "\n[TEST 3] CALLed Batch Files Belong to Their Job" << std::endl;
+
+    SimulatedShell shell;
+    shell.files["C:\\ALL.BAT"] = batch(5, 0, {"C:\\STEP1.BAT", "C:\\STEP2.BAT"});
+    shell.files["C:\\STEP1.BAT"] = batch(10, 0, {"C:\\INNER.BAT"});
+    shell.files["C:\\STEP2.BAT"] = batch(10, 0);
+    shell.files["C:\\INNER.BAT"] = batch(10, 0);
+    shell.files["C:\\AFTER.BAT"] = batch(10, 7);
+    BoxerCommandQueue queue;
+    BoxerBatchDriver driver({{"C:\\ALL.BAT", 0}, {"C:\\AFTER.BAT", 0}}, shell.errorLevel(), queue, shell.clock());
+
+    if (!shell.run(driver, queue)) {
+        std::cerr << "  ✗ FAIL: Shell stalled" << std::endl;
+        return false;
+    }
+    const auto& all = driver.results()[0];
+    const auto& after = driver.results()[1];
+    if (all.outcome != BoxerBatchDriver::Outcome::Completed || all.nestedBatchFiles != 3 ||
+        all.wallNs != 35000000) {
+        std::cerr << "  ✗ FAIL: Nested job: " << all.nestedBatchFiles << " nested, " << all.wallNs << " ns"
+                  << std::endl;
+        return false;
+    }
+    if (after.outcome != BoxerBatchDriver::Outcome::Completed || after.errorLevel != 7) {
+        std::cerr << "  ✗ FAIL: Job after the nested one did not run" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ 3 CALLs counted inside one 35 ms job; next job ran after it" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testTimeout() {
+    std::cout << "\n[TEST 4] Hung Job Times Out" << std::endl;
+
+    SimulatedShell shell;
+    shell.files["C:\\OK.BAT"] = batch(10, 0);
+    shell.files["C:\\HANG.BAT"] = batch(0, 0, {}, true);
+    BoxerCommandQueue queue;
+    BoxerBatchDriver driver({{"C:\\OK.BAT", 500}, {"C:\\HANG.BAT", 500}, {"C:\\OK.BAT again", 500}},
+                            shell.errorLevel(), queue, shell.clock());
+
+    if (!shell.run(driver, queue) || shell.restarts != 1) {
+        std::cerr << "  ✗ FAIL: Expected one restart and all jobs finished" << std::endl;
+        return false;
+    }
+    const auto& hung = driver.results()[1];
+    if (hung.outcome != BoxerBatchDriver::Outcome::TimedOut || hung.wallNs != 500000000) {
+        std::cerr << "  ✗ FAIL: Hung job not timed out at 500 ms (" << hung.wallNs << " ns)" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Hung job stopped at its 500 ms timeout" << std::endl;
+
+    if (driver.results()[2].outcome != BoxerBatchDriver::Outcome::Completed) {
+        std::cerr << "  ✗ FAIL: Job after the timeout did not run" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Machine restarted once; next job completed" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testMissingBatchFile() {
+    std::cout << "\n[TEST 5] Missing Batch File" << std::endl;
+
+    SimulatedShell shell;
+    shell.files["C:\\REAL.BAT"] = batch(10, 2);
+    BoxerCommandQueue queue;
+    BoxerBatchDriver driver({{"C:\\TYPO.BAT", 1000}, {"C:\\REAL.BAT", 1000}}, shell.errorLevel(), queue,
+                            shell.clock());
+
+    if (!shell.run(driver, queue)) {
+        std::cerr << "  ✗ FAIL: Shell stalled on the missing file" << std::endl;
+        return false;
+    }
+    if (driver.results()[0].outcome != BoxerBatchDriver::Outcome::NotStarted ||
+        driver.results()[1].outcome != BoxerBatchDriver::Outcome::Completed ||
+        driver.results()[1].errorLevel != 2) {
+        std::cerr << "  ✗ FAIL: Missing file not recorded or next job skipped" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Missing file recorded as not started; next job ran" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testReportAndOverhead() {
+    std::cout << "\n[TEST 6] JSON Report and Driver Overhead" << std::endl;
+
+    SimulatedShell shell;
+    shell.files["C:\\JOBS\\RUN.BAT"] = batch(1, 0);
+    shell.files["C:\\JOBS\\HANG.BAT"] = batch(0, 0, {}, true);
+    BoxerCommandQueue queue;
+    BoxerBatchDriver driver({{"C:\\JOBS\\RUN.BAT \"quoted arg\"", 100}, {"C:\\JOBS\\HANG.BAT", 100},
+                             {"C:\\JOBS\\NOPE.BAT", 100}},
+                            shell.errorLevel(), queue, shell.clock());
+    shell.run(driver, queue);
+
+    std::ostringstream json;
+    driver.writeJson(json);
+    const std::string text = json.str();
+    const char* expected[] = {
+        "\"command\": \"C:\\\\JOBS\\\\RUN.BAT \\\"quoted arg\\\"\", \"outcome\": \"completed\"",
+        "\"outcome\": \"timed_out\", \"errorlevel\": 0, \"nested_batch_files\": 0, \"wall_ms\": 100.000",
+        "\"outcome\": \"not_started\"",
+    };
+    for (const char* fragment : expected) {
+        if (text.find(fragment) == std::string::npos) {
+            std::cerr << "  ✗ FAIL: Missing '" << fragment << "' in:\n" << text << std::endl;
+            return false;
+        }
+    }
+    std::cout << "  ✓ Report lists command, outcome, errorlevel and timing per job" << std::endl;
+
+    // Many short jobs: what the driver itself adds per job
+    const size_t jobCount = 20000;
+    SimulatedShell fast;
+    fast.files["C:\\T.BAT"] = batch(0, 0);
+    std::vector<BoxerBatchDriver::Job> jobs(jobCount, BoxerBatchDriver::Job{"C:\\T.BAT", 1000});
+    BoxerCommandQueue fastQueue;
+    BoxerBatchDriver many(std::move(jobs), fast.errorLevel(), fastQueue);
+    const auto start = std::chrono::steady_clock::now();
+    fast.run(many, fastQueue);
+    const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  Driver + simulated shell: " << us / jobCount << " µs per job" << std::endl;
+
+    for (const auto& result : many.results()) {
+        if (result.outcome != BoxerBatchDriver::Outcome::Completed) {
+            std::cerr << "  ✗ FAIL: A short job did not complete" << std::endl;
+            return false;
+        }
+    }
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Batch Driver Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-026, INT-036, INT-037, INT-038 headless driver" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testJobListParsing()) passed++; else failed++;
+    if (testBackToBack()) passed++; else failed++;
+    if (testNestedCalls()) passed++; else failed++;
+    if (testTimeout()) passed++; else failed++;
+    if (testMissingBatchFile()) passed++; else failed++;
+    if (testReportAndOverhead()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
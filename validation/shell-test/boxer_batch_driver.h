@@ -0,0 +1,257 @@
+/*
+ * boxer_batch_driver.h - Headless batch-job driver for the DOS shell
+ *
+ * Runs a list of DOS batch files unattended, one after another in the same
+ * machine, and records how each one ended. It answers the shell's
+ * questions itself, so throughput runs need no GUI-style delegate:
+ *
+ *   - INT-026 didReturnToShell       -> shellDidBecomeIdle(): queue the next job
+ *   - INT-036 shellWillBeginBatchFile -> track the job's batch nesting
+ *   - INT-037 shellDidEndBatchFile    -> the outermost end completes the job
+ *   - INT-038 shellShouldContinue     -> false once every job has run
+ *   - INT-059 runLoopShouldContinue   -> false when a job exceeds its timeout
+ *
+ * ARCHITECTURE:
+ *   - Jobs are started by pushing their command line into the shell's
+ *     BoxerCommandQueue, exactly as if typed at the prompt
+ *   - The first batch file that begins after the push is the job; CALLs
+ *     inside it nest and are counted, and the job ends when the outermost
+ *     batch file ends. The ERRORLEVEL at that point is the job's exit status
+ *   - A job whose command returns to the prompt without starting a batch
+ *     file (missing file, bad path) is recorded as NotStarted
+ *   - A job that runs past its timeout is recorded as TimedOut and the
+ *     emulation loop is stopped. A hung DOS program cannot be unwound from
+ *     outside, so the integration restarts the machine and calls
+ *     machineWillRestart(); the driver carries on with the next job after
+ *     the new AUTOEXEC
+ *
+ * THREAD SAFETY:
+ *   None. All calls happen on the emulation thread.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_BATCH_DRIVER_H
+#define BOXER_BATCH_DRIVER_H
+
+#ifdef BOXER_INTEGRATED
+
+#include "boxer_command_queue.h"
+#include "boxer_shell_report.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// BoxerBatchDriver
+// ============================================================================
+
+class BoxerBatchDriver {
+public:
+    struct Job {
+        std::string command;     ///< Batch file path and arguments, as typed
+        uint32_t timeoutMs;      ///< 0: no timeout
+    };
+
+    enum class Outcome : uint8_t {
+        Pending,
+        Completed,
+        TimedOut,
+        NotStarted,   ///< The command returned without starting a batch file
+    };
+
+    struct Result {
+        Job job;
+        Outcome outcome = Outcome::Pending;
+        uint8_t errorLevel = 0;
+        uint32_t nestedBatchFiles = 0;   ///< Batch files CALLed inside the job
+        uint64_t wallNs = 0;
+    };
+
+    /// Nanoseconds from an arbitrary epoch
+    using Clock = std::function<uint64_t()>;
+    /// The DOS ERRORLEVEL (dos.return_code)
+    using ErrorLevel = std::function<uint8_t()>;
+
+    static constexpr uint32_t kDefaultTimeoutMs = 60000;
+
+    BoxerBatchDriver(std::vector<Job> jobs, ErrorLevel errorLevel,
+                     BoxerCommandQueue& queue = BoxerCommandQueue::shared(),
+                     Clock clock = BoxerShellReport::steadyClock)
+        : m_errorLevel(std::move(errorLevel)), m_queue(queue), m_clock(std::move(clock)) {
+        m_results.reserve(jobs.size());
+        for (auto& job : jobs) {
+            m_results.push_back(Result{std::move(job)});
+        }
+    }
+
+    BoxerBatchDriver(const BoxerBatchDriver&) = delete;
+    BoxerBatchDriver& operator=(const BoxerBatchDriver&) = delete;
+
+    /**
+     * @brief Read a job list: one batch command per line
+     * @param[out] error Line number and reason on failure
+     *
+     * Blank lines and lines starting with '#' or ';' are ignored. A line
+     * "timeout SECONDS" sets the timeout of the jobs after it (0 disables).
+     */
+    static bool parseJobList(std::istream& in, std::vector<Job>& jobs, std::string& error) {
+        uint32_t timeoutMs = kDefaultTimeoutMs;
+        std::string line;
+        for (int number = 1; std::getline(in, line); ++number) {
+            const size_t begin = line.find_first_not_of(" \t\r");
+            const size_t end = line.find_last_not_of(" \t\r");
+            if (begin == std::string::npos || line[begin] == '#' || line[begin] == ';') {
+                continue;
+            }
+            line = line.substr(begin, end - begin + 1);
+            if (line.compare(0, 8, "timeout ") == 0) {
+                char* tail = nullptr;
+                const double seconds = std::strtod(line.c_str() + 8, &tail);
+                if (tail == line.c_str() + 8 || *tail != '\0' || seconds < 0 || seconds > 86400) {
+                    error = "line " + std::to_string(number) + ": bad timeout '" + line.substr(8) + "'";
+                    return false;
+                }
+                timeoutMs = static_cast<uint32_t>(seconds * 1000);
+                continue;
+            }
+            jobs.push_back(Job{line, timeoutMs});
+        }
+        return true;
+    }
+
+    // ========================================================================
+    // Shell hooks
+    // ========================================================================
+
+    /// INT-026: the shell is at the prompt with nothing queued
+    void shellDidBecomeIdle() {
+        if (m_queue.hasPending()) {
+            return;
+        }
+        if (m_dispatched && m_depth == 0) {
+            // Back at the prompt and the command never began a batch file
+            finish(Outcome::NotStarted);
+        }
+        if (!m_dispatched && m_next < m_results.size()) {
+            m_dispatched = true;
+            m_startNs = m_clock();
+            m_queue.push(m_results[m_next].job.command);
+        }
+    }
+
+    /// INT-036
+    void shellWillBeginBatchFile(const char* /*canonicalPath*/) {
+        if (!m_dispatched) {
+            return;
+        }
+        if (m_depth++ > 0) {
+            ++m_results[m_next].nestedBatchFiles;
+        }
+    }
+
+    /// INT-037
+    void shellDidEndBatchFile(const char* /*canonicalPath*/) {
+        if (!m_dispatched || m_depth == 0) {
+            return;
+        }
+        if (--m_depth == 0) {
+            m_results[m_next].errorLevel = m_errorLevel ? m_errorLevel() : 0;
+            finish(Outcome::Completed);
+        }
+    }
+
+    /// INT-038: false once every job has run, so the shell exits
+    bool shellShouldContinue() const {
+        return !finished();
+    }
+
+    /**
+     * @brief INT-059: false if the running job has used up its timeout
+     *
+     * The job is recorded as TimedOut; the integration then restarts the
+     * machine and calls machineWillRestart().
+     */
+    bool runLoopShouldContinue() {
+        if (!m_dispatched) {
+            return true;
+        }
+        const uint32_t timeoutMs = m_results[m_next].job.timeoutMs;
+        if (timeoutMs == 0 || m_clock() - m_startNs < uint64_t(timeoutMs) * 1000000) {
+            return true;
+        }
+        finish(Outcome::TimedOut);
+        return false;
+    }
+
+    /// The machine is being restarted after a timeout: forget shell state
+    void machineWillRestart() {
+        m_queue.clear();
+        m_depth = 0;
+    }
+
+    // ========================================================================
+    // Results
+    // ========================================================================
+
+    bool finished() const { return m_next >= m_results.size(); }
+    const std::vector<Result>& results() const { return m_results; }
+
+    static const char* outcomeName(Outcome outcome) {
+        switch (outcome) {
+            case Outcome::Pending: return "pending";
+            case Outcome::Completed: return "completed";
+            case Outcome::TimedOut: return "timed_out";
+            case Outcome::NotStarted: return "not_started";
+        }
+        return "unknown";
+    }
+
+    void writeJson(std::ostream& out) const {
+        out << "{\n  \"jobs\": [";
+        for (size_t i = 0; i < m_results.size(); ++i) {
+            const Result& result = m_results[i];
+            char wall[32];
+            std::snprintf(wall, sizeof(wall), "%.3f", static_cast<double>(result.wallNs) / 1e6);
+            out << (i ? ",\n" : "\n")
+                << "    {\"command\": " << BoxerShellReport::jsonString(result.job.command)
+                << ", \"outcome\": \"" << outcomeName(result.outcome) << "\""
+                << ", \"errorlevel\": " << unsigned(result.errorLevel)
+                << ", \"nested_batch_files\": " << result.nestedBatchFiles
+                << ", \"wall_ms\": " << wall
+                << ", \"timeout_ms\": " << result.job.timeoutMs << "}";
+        }
+        out << (m_results.empty() ? "]\n" : "\n  ]\n") << "}\n";
+    }
+
+private:
+    void finish(Outcome outcome) {
+        Result& result = m_results[m_next];
+        result.outcome = outcome;
+        result.wallNs = m_clock() - m_startNs;
+        ++m_next;
+        m_dispatched = false;
+        m_depth = 0;
+    }
+
+    const ErrorLevel m_errorLevel;
+    BoxerCommandQueue& m_queue;
+    const Clock m_clock;
+    std::vector<Result> m_results;
+    size_t m_next = 0;          ///< Index of the running or next job
+    bool m_dispatched = false;  ///< m_next's command has been queued
+    uint32_t m_depth = 0;
+    uint64_t m_startNs = 0;
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_BATCH_DRIVER_H
@@ -0,0 +1,245 @@
+/*
+ * boxer_command_queue.h - Lock-free shell command queue for Boxer integration
+ *
+ * Replaces the per-command shell hooks (INT-031 hasPendingCommandsForShell,
+ * INT-032 executeNextPendingCommandForShell) with a multi-producer/
+ * single-consumer queue of command lines owned by the shell.
+ *
+ * ARCHITECTURE:
+ *   - Boxer and host automation (producers) push single commands or whole
+ *     scripts from any thread
+ *   - DOS_Shell::Run (consumer) pops the next line on each prompt iteration
+ *     and parses it directly, with no delegate round trip
+ *   - A script is linked privately and published with one atomic exchange,
+ *     so its lines run back to back and never interleave with another
+ *     producer's commands
+ *
+ * The queue is Vyukov's intrusive MPSC list with a stub node: a push is one
+ * exchange and one store, a pop touches no shared counter. A producer
+ * between its exchange and its store briefly hides everything behind it;
+ * pop() then returns false while hasPending() stays true, and the shell
+ * simply picks the line up on its next iteration.
+ *
+ * THREAD SAFETY:
+ *   push(), pushBatch(), pushScript() and pendingCount() are safe from any
+ *   thread. pop(), hasPending() and clear() belong to the shell thread.
+ *   The destructor must run with no producer active.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_COMMAND_QUEUE_H
+#define BOXER_COMMAND_QUEUE_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// ============================================================================
+// BoxerCommandQueue - MPSC queue of shell command lines
+// ============================================================================
+
+class BoxerCommandQueue {
+public:
+    BoxerCommandQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+    ~BoxerCommandQueue() {
+        clear();
+    }
+
+    BoxerCommandQueue(const BoxerCommandQueue&) = delete;
+    BoxerCommandQueue& operator=(const BoxerCommandQueue&) = delete;
+
+    /**
+     * @brief Process-wide queue shared by Boxer and the DOS shell
+     *
+     * Boxer pushes into this instance; shell.cpp drains it.
+     */
+    static BoxerCommandQueue& shared() {
+        static BoxerCommandQueue queue;
+        return queue;
+    }
+
+    // ========================================================================
+    // Producer side (any thread)
+    // ========================================================================
+
+    /// Queue one command line
+    void push(std::string command) {
+        Node* node = new Node(std::move(command));
+        publish(node, node, 1);
+    }
+
+    /**
+     * @brief Queue a sequence of command lines as one unit
+     * @return Number of lines queued
+     *
+     * The lines become visible to the shell together and stay contiguous.
+     */
+    template <typename Iterator>
+    size_t pushBatch(Iterator begin, Iterator end) {
+        Node* first = nullptr;
+        Node* last = nullptr;
+        size_t count = 0;
+        for (; begin != end; ++begin) {
+            append(first, last, std::string(*begin));
+            ++count;
+        }
+        if (count > 0) {
+            publish(first, last, count);
+        }
+        return count;
+    }
+
+    /**
+     * @brief Queue a script as one unit, one command per line
+     * @param script Text with LF or CRLF line endings
+     * @return Number of lines queued
+     *
+     * Blank lines are skipped, as the shell would ignore them anyway.
+     */
+    size_t pushScript(std::string_view script) {
+        Node* first = nullptr;
+        Node* last = nullptr;
+        size_t count = 0;
+        while (!script.empty()) {
+            const size_t end = script.find('\n');
+            std::string_view line = script.substr(0, end);
+            script.remove_prefix(end == std::string_view::npos ? script.size() : end + 1);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            if (line.find_first_not_of(" \t") == std::string_view::npos) {
+                continue;
+            }
+            append(first, last, std::string(line));
+            ++count;
+        }
+        if (count > 0) {
+            publish(first, last, count);
+        }
+        return count;
+    }
+
+    /// Lines queued and not yet popped; approximate while producers run
+    size_t pendingCount() const {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    // ========================================================================
+    // Consumer side (shell thread)
+    // ========================================================================
+
+    /**
+     * @brief True if a line is queued or being published
+     *
+     * A true result can be followed by a false pop() while a producer is
+     * mid-push; the line is visible on a later iteration.
+     */
+    bool hasPending() const {
+        return m_tail != &m_stub || m_head.load(std::memory_order_acquire) != &m_stub;
+    }
+
+    /**
+     * @brief Take the next command line
+     * @param[out] command Receives the line
+     * @return false if nothing is ready yet
+     */
+    bool pop(std::string& command) {
+        Node* node = popNode();
+        if (!node) {
+            return false;
+        }
+        command = std::move(node->command);
+        delete node;
+        m_count.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Discard everything that can be popped
+     * @return Number of lines discarded
+     *
+     * Called when the shell exits or Boxer cancels a launch.
+     */
+    size_t clear() {
+        size_t discarded = 0;
+        while (Node* node = popNode()) {
+            delete node;
+            ++discarded;
+        }
+        m_count.fetch_sub(discarded, std::memory_order_relaxed);
+        return discarded;
+    }
+
+private:
+    struct Node {
+        Node() = default;
+        explicit Node(std::string line) : command(std::move(line)) {}
+
+        std::atomic<Node*> next{nullptr};
+        std::string command;
+    };
+
+    static void append(Node*& first, Node*& last, std::string line) {
+        Node* node = new Node(std::move(line));
+        if (last) {
+            last->next.store(node, std::memory_order_relaxed);
+        } else {
+            first = node;
+        }
+        last = node;
+    }
+
+    // Link a private chain first..last onto the queue
+    void publish(Node* first, Node* last, size_t count) {
+        m_count.fetch_add(count, std::memory_order_relaxed);
+        last->next.store(nullptr, std::memory_order_relaxed);
+        Node* previous = m_head.exchange(last, std::memory_order_acq_rel);
+        previous->next.store(first, std::memory_order_release);
+    }
+
+    Node* popNode() {
+        Node* tail = m_tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &m_stub) {
+            if (!next) {
+                return nullptr;
+            }
+            m_tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            m_tail = next;
+            return tail;
+        }
+        // tail is the last linked node; if a producer has already moved
+        // m_head past it, its link is not stored yet
+        if (tail != m_head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        // Re-insert the stub behind tail so tail can be handed out
+        publish(&m_stub, &m_stub, 0);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            m_tail = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    Node m_stub;
+    alignas(64) std::atomic<Node*> m_head;   ///< Last node pushed (producers)
+    alignas(64) Node* m_tail;                ///< Next node to pop (consumer)
+    std::atomic<size_t> m_count{0};
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_COMMAND_QUEUE_H
@@ -0,0 +1,241 @@
+/*
+ * boxer_message_table.h - Interned, perfect-hashed localized message table
+ *
+ * Replaces per-message INT-081 localizedStringForKey calls. messages.cpp
+ * asks the delegate once at startup for every registered message key,
+ * builds this table, and from then on MSG_Get is an inline hash probe with
+ * no hook call, including inside DIR listings and batch ECHO loops.
+ *
+ * ARCHITECTURE:
+ *   - Keys and values are copied once into a single arena; identical
+ *     values share one copy. Returned pointers stay valid for the table's
+ *     lifetime, so MSG_Get can keep returning const char* without a copy
+ *   - The hash is minimal and perfect (hash-and-displace): one 64-bit
+ *     hash of the key picks a bucket, the bucket's displacement picks the
+ *     slot, and every key has a slot of its own. A lookup is one pass over
+ *     the key, two array reads and one string compare to reject unknown
+ *     keys
+ *   - Tables are immutable. A language change builds a new table; the old
+ *     one must be kept alive as long as its strings may be referenced
+ *
+ * THREAD SAFETY:
+ *   A built table is read-only and safe to read from any thread.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_MESSAGE_TABLE_H
+#define BOXER_MESSAGE_TABLE_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// BoxerMessageTable
+// ============================================================================
+
+class BoxerMessageTable {
+public:
+    using Entry = std::pair<std::string, std::string>;   ///< key, localized text
+
+    struct Stats {
+        size_t keys = 0;
+        size_t buckets = 0;
+        size_t arenaBytes = 0;
+        uint32_t maxDisplacement = 0;   ///< Largest seed a bucket needed
+    };
+
+    /**
+     * @brief Build a table; a key given twice keeps its last value
+     */
+    explicit BoxerMessageTable(const std::vector<Entry>& entries) {
+        // Deduplicate keys (last wins) and intern values
+        std::unordered_map<std::string_view, size_t> keyIndex;
+        std::vector<std::pair<std::string_view, std::string_view>> unique;
+        unique.reserve(entries.size());
+        for (const auto& entry : entries) {
+            const auto inserted = keyIndex.emplace(entry.first, unique.size());
+            if (inserted.second) {
+                unique.emplace_back(entry.first, entry.second);
+            } else {
+                unique[inserted.first->second].second = entry.second;
+            }
+        }
+        layOutArena(unique);
+        buildHash(unique);
+    }
+
+    BoxerMessageTable(const BoxerMessageTable&) = delete;
+    BoxerMessageTable& operator=(const BoxerMessageTable&) = delete;
+
+    /**
+     * @brief Ask the delegate once for every registered key
+     * @param localized INT-081 localizedStringForKey; nullptr or "" means
+     *        the delegate has no translation and the key is left out
+     */
+    template <typename Keys, typename Localize>
+    static std::vector<Entry> collect(const Keys& keys, Localize&& localized) {
+        std::vector<Entry> entries;
+        for (const auto& key : keys) {
+            const std::string keyString(key);
+            const char* text = localized(keyString.c_str());
+            if (text && *text) {
+                entries.emplace_back(keyString, text);
+            }
+        }
+        return entries;
+    }
+
+    /**
+     * @brief Localized text for a key
+     * @return Interned text, or nullptr if the delegate had none (use the
+     *         built-in English text)
+     */
+    const char* lookup(const char* key) const {
+        if (m_slots.empty()) {
+            return nullptr;
+        }
+        const uint64_t hash = hashKey(key);
+        const uint32_t displacement = m_displacements[bucketOf(hash)];
+        const Slot& slot = m_slots[slotOf(hash, displacement)];
+        const char* candidate = m_arena.data() + slot.key;
+        return std::strcmp(candidate, key) == 0 ? m_arena.data() + slot.value : nullptr;
+    }
+
+    size_t size() const { return m_slots.size(); }
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct Slot {
+        uint32_t key;     ///< Arena offset of the NUL-terminated key
+        uint32_t value;   ///< Arena offset of the NUL-terminated text
+    };
+
+    // FNV-1a, one pass, stops at the NUL so lookup needs no strlen
+    static uint64_t hashKey(const char* key) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (; *key; ++key) {
+            hash = (hash ^ static_cast<unsigned char>(*key)) * 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    size_t bucketOf(uint64_t hash) const {
+        return static_cast<size_t>((hash >> 32) % m_displacements.size());
+    }
+
+    // Remix the key hash with the bucket's displacement
+    size_t slotOf(uint64_t hash, uint32_t displacement) const {
+        uint64_t x = hash ^ (uint64_t(displacement) * 0x9e3779b97f4a7c15ULL);
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        return static_cast<size_t>(x % m_slots.size());
+    }
+
+    void layOutArena(const std::vector<std::pair<std::string_view, std::string_view>>& unique) {
+        std::unordered_map<std::string_view, uint32_t> interned;
+        m_keyOffsets.reserve(unique.size());
+        m_valueOffsets.reserve(unique.size());
+        auto append = [this](std::string_view text) {
+            const auto offset = static_cast<uint32_t>(m_arena.size());
+            m_arena.insert(m_arena.end(), text.begin(), text.end());
+            m_arena.push_back('\0');
+            return offset;
+        };
+        for (const auto& entry : unique) {
+            m_keyOffsets.push_back(append(entry.first));
+            const auto found = interned.find(entry.second);
+            if (found != interned.end()) {
+                m_valueOffsets.push_back(found->second);
+            } else {
+                const uint32_t offset = append(entry.second);
+                interned.emplace(entry.second, offset);
+                m_valueOffsets.push_back(offset);
+            }
+        }
+        m_stats.arenaBytes = m_arena.size();
+    }
+
+    // Hash and displace: place the largest buckets first, each with the
+    // first displacement that puts all of its keys in free slots
+    void buildHash(const std::vector<std::pair<std::string_view, std::string_view>>& unique) {
+        const size_t count = unique.size();
+        m_stats.keys = count;
+        if (count == 0) {
+            return;
+        }
+        m_slots.resize(count);
+        m_displacements.assign(std::max<size_t>(1, count / 4), 0);
+        m_stats.buckets = m_displacements.size();
+
+        std::vector<uint64_t> hashes(count);
+        std::vector<std::vector<uint32_t>> buckets(m_displacements.size());
+        for (size_t i = 0; i < count; ++i) {
+            hashes[i] = hashKey(m_arena.data() + m_keyOffsets[i]);
+            buckets[bucketOf(hashes[i])].push_back(static_cast<uint32_t>(i));
+        }
+        std::vector<uint32_t> order(buckets.size());
+        for (size_t b = 0; b < order.size(); ++b) {
+            order[b] = static_cast<uint32_t>(b);
+        }
+        std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        std::vector<bool> taken(count, false);
+        std::vector<size_t> slots;
+        for (const uint32_t b : order) {
+            const auto& members = buckets[b];
+            if (members.empty()) {
+                break;
+            }
+            for (uint32_t displacement = 0;; ++displacement) {
+                slots.clear();
+                bool fits = true;
+                for (const uint32_t i : members) {
+                    const size_t slot = slotOf(hashes[i], displacement);
+                    if (taken[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                        fits = false;
+                        break;
+                    }
+                    slots.push_back(slot);
+                }
+                if (!fits) {
+                    continue;
+                }
+                for (size_t k = 0; k < members.size(); ++k) {
+                    taken[slots[k]] = true;
+                    m_slots[slots[k]] = Slot{m_keyOffsets[members[k]], m_valueOffsets[members[k]]};
+                }
+                m_displacements[b] = displacement;
+                m_stats.maxDisplacement = std::max(m_stats.maxDisplacement, displacement);
+                break;
+            }
+        }
+        m_keyOffsets.clear();
+        m_keyOffsets.shrink_to_fit();
+        m_valueOffsets.clear();
+        m_valueOffsets.shrink_to_fit();
+    }
+
+    std::vector<char> m_arena;
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_displacements;   ///< One per bucket
+    std::vector<uint32_t> m_keyOffsets;      ///< Build only
+    std::vector<uint32_t> m_valueOffsets;    ///< Build only
+    Stats m_stats;
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_MESSAGE_TABLE_H
@@ -0,0 +1,267 @@
+/*
+ * boxer_program_profiler.h - Per-program execution profiling
+ *
+ * Attributes emulator work to the DOS programs that caused it. A program
+ * run opens at INT-034 shellWillExecuteFileAtDOSPath and closes at INT-035
+ * shellDidExecuteFileAtDOSPath; those fire only for .COM and .EXE files, so
+ * a batch file run opens at INT-036 shellWillBeginBatchFile and closes at
+ * INT-037 shellDidEndBatchFile. Everything counted in between is charged to
+ * the canonical DOS path and summed over all of its runs. The
+ * aggregates are written as JSON when the emulator shuts down.
+ *
+ * ARCHITECTURE:
+ *   - The emulator bumps plain running counters: emulated cycles from the
+ *     CPU loop, frames from the renderer, bytes from DOS file reads and
+ *     writes, and delegate hook calls. A count is one add on the
+ *     emulation thread
+ *   - Each run snapshots the counters when it opens and charges the
+ *     difference when it closes, so counting never looks up a program
+ *   - Runs nest (a launcher EXECs the game, COMMAND /C runs a tool).
+ *     Totals are inclusive of child runs; "self" wall time and cycles
+ *     exclude them
+ *   - A run whose program never reports back (the shell exits, the parent
+ *     returns first) is closed when its parent closes or at shutdown and
+ *     counted as unfinished
+ *
+ * Profiling is off until enable() is called. Disabled, beginRun() and
+ * endRun() return immediately; the counters still advance.
+ *
+ * THREAD SAFETY:
+ *   None. Everything runs on the emulation thread, including the final
+ *   writeJson().
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_PROGRAM_PROFILER_H
+#define BOXER_PROGRAM_PROFILER_H
+
+#ifdef BOXER_INTEGRATED
+
+#include "boxer_shell_report.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// BoxerProgramProfiler
+// ============================================================================
+
+class BoxerProgramProfiler {
+public:
+    /// Running totals; the profiler charges differences of these
+    struct Counters {
+        uint64_t cycles = 0;
+        uint64_t frames = 0;
+        uint64_t bytesRead = 0;
+        uint64_t bytesWritten = 0;
+        uint64_t hookCalls = 0;
+    };
+
+    /// Everything recorded for one canonical DOS path
+    struct Program {
+        std::string path;
+        uint64_t runs = 0;
+        uint64_t unfinishedRuns = 0;   ///< Closed without shellDidExecuteFileAtDOSPath
+        uint64_t wallNs = 0;           ///< Inclusive of child runs
+        uint64_t selfWallNs = 0;
+        uint64_t minWallNs = UINT64_MAX;
+        uint64_t maxWallNs = 0;
+        uint64_t selfCycles = 0;
+        Counters totals;               ///< Inclusive of child runs
+    };
+
+    /// Nanoseconds from an arbitrary epoch
+    using Clock = std::function<uint64_t()>;
+
+    explicit BoxerProgramProfiler(Clock clock = BoxerShellReport::steadyClock) : m_clock(std::move(clock)) {}
+
+    BoxerProgramProfiler(const BoxerProgramProfiler&) = delete;
+    BoxerProgramProfiler& operator=(const BoxerProgramProfiler&) = delete;
+
+    /// Process-wide profiler used by the emulator call sites
+    static BoxerProgramProfiler& shared() {
+        static BoxerProgramProfiler profiler;
+        return profiler;
+    }
+
+    void enable() { m_enabled = true; }
+    bool enabled() const { return m_enabled; }
+
+    // ========================================================================
+    // Counting (emulation thread, hot paths)
+    // ========================================================================
+
+    /// Cycles a CPU loop slice actually executed (not the slice budget)
+    void addCycles(uint64_t cycles) { m_counters.cycles += cycles; }
+    void frameRendered() { ++m_counters.frames; }
+    void didReadBytes(uint64_t bytes) { m_counters.bytesRead += bytes; }
+    void didWriteBytes(uint64_t bytes) { m_counters.bytesWritten += bytes; }
+    void hookCalled() { ++m_counters.hookCalls; }
+
+    const Counters& counters() const { return m_counters; }
+
+    // ========================================================================
+    // Runs (shell hooks)
+    // ========================================================================
+
+    /// INT-034 (or INT-036 for a batch file): this canonical DOS path is about to start
+    void beginRun(const char* canonicalPath) {
+        if (!m_enabled) {
+            return;
+        }
+        m_stack.push_back(Run{canonicalPath, m_clock(), m_counters, 0, 0});
+    }
+
+    /**
+     * @brief INT-035 (or INT-037): the program or batch file at this path has
+     *        returned
+     *
+     * Runs opened after it that never reported back are closed first and
+     * counted as unfinished. A path with no open run is ignored.
+     */
+    void endRun(const char* canonicalPath) {
+        if (!m_enabled) {
+            return;
+        }
+        auto open = std::find_if(m_stack.rbegin(), m_stack.rend(),
+                                 [canonicalPath](const Run& run) { return run.path == canonicalPath; });
+        if (open == m_stack.rend()) {
+            return;
+        }
+        const size_t depth = static_cast<size_t>(m_stack.rend() - open) - 1;
+        while (m_stack.size() > depth + 1) {
+            closeTop(false);
+        }
+        closeTop(true);
+    }
+
+    /// Close every open run as unfinished (shutdown)
+    void endAllRuns() {
+        while (!m_stack.empty()) {
+            closeTop(false);
+        }
+    }
+
+    size_t openRuns() const { return m_stack.size(); }
+
+    /// A copy of the aggregates, most total wall time first
+    std::vector<Program> programs() const {
+        std::vector<Program> sorted;
+        sorted.reserve(m_programs.size());
+        for (const auto& entry : m_programs) {
+            sorted.push_back(entry.second);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const Program& a, const Program& b) {
+            return a.wallNs != b.wallNs ? a.wallNs > b.wallNs : a.path < b.path;
+        });
+        return sorted;
+    }
+
+    const Program* program(const std::string& canonicalPath) const {
+        const auto found = m_programs.find(canonicalPath);
+        return found == m_programs.end() ? nullptr : &found->second;
+    }
+
+    // ========================================================================
+    // Output
+    // ========================================================================
+
+    void writeJson(std::ostream& out) const {
+        out << "{\n  \"programs\": [";
+        bool first = true;
+        for (const auto& program : programs()) {
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "    {\"path\": " << BoxerShellReport::jsonString(program.path)
+                << ", \"runs\": " << program.runs
+                << ", \"unfinished_runs\": " << program.unfinishedRuns
+                << ", \"wall_ms\": " << milliseconds(program.wallNs)
+                << ", \"self_wall_ms\": " << milliseconds(program.selfWallNs)
+                << ", \"min_wall_ms\": " << milliseconds(program.minWallNs)
+                << ", \"max_wall_ms\": " << milliseconds(program.maxWallNs)
+                << ", \"cycles\": " << program.totals.cycles
+                << ", \"self_cycles\": " << program.selfCycles
+                << ", \"frames\": " << program.totals.frames
+                << ", \"bytes_read\": " << program.totals.bytesRead
+                << ", \"bytes_written\": " << program.totals.bytesWritten
+                << ", \"hook_calls\": " << program.totals.hookCalls << "}";
+        }
+        out << (first ? "]\n" : "\n  ]\n") << "}\n";
+    }
+
+    /// Close open runs and write the JSON to a file; false if it can't be written
+    bool writeJsonFile(const std::string& path) {
+        endAllRuns();
+        std::ofstream out(path);
+        writeJson(out);
+        return static_cast<bool>(out);
+    }
+
+private:
+    struct Run {
+        std::string path;
+        uint64_t startNs;
+        Counters start;
+        uint64_t childWallNs;
+        uint64_t childCycles;
+    };
+
+    void closeTop(bool finished) {
+        Run run = std::move(m_stack.back());
+        m_stack.pop_back();
+
+        const uint64_t wallNs = m_clock() - run.startNs;
+        const uint64_t cycles = m_counters.cycles - run.start.cycles;
+
+        Program& program = m_programs[run.path];
+        if (program.path.empty()) {
+            program.path = run.path;
+        }
+        ++program.runs;
+        program.unfinishedRuns += finished ? 0 : 1;
+        program.wallNs += wallNs;
+        program.selfWallNs += wallNs - std::min(wallNs, run.childWallNs);
+        program.minWallNs = std::min(program.minWallNs, wallNs);
+        program.maxWallNs = std::max(program.maxWallNs, wallNs);
+        program.selfCycles += cycles - std::min(cycles, run.childCycles);
+        program.totals.cycles += cycles;
+        program.totals.frames += m_counters.frames - run.start.frames;
+        program.totals.bytesRead += m_counters.bytesRead - run.start.bytesRead;
+        program.totals.bytesWritten += m_counters.bytesWritten - run.start.bytesWritten;
+        program.totals.hookCalls += m_counters.hookCalls - run.start.hookCalls;
+
+        if (!m_stack.empty()) {
+            m_stack.back().childWallNs += wallNs;
+            m_stack.back().childCycles += cycles;
+        }
+    }
+
+    static std::string milliseconds(uint64_t ns) {
+        if (ns == UINT64_MAX) {
+            ns = 0;
+        }
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.3f", static_cast<double>(ns) / 1e6);
+        return text;
+    }
+
+    const Clock m_clock;
+    bool m_enabled = false;
+    Counters m_counters;
+    std::vector<Run> m_stack;
+    std::unordered_map<std::string, Program> m_programs;
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_PROGRAM_PROFILER_H
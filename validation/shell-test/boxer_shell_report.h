@@ -0,0 +1,56 @@
+/*
+ * boxer_shell_report.h - Helpers shared by the shell's timing reports
+ *
+ * Internal to BoxerProgramProfiler and BoxerBatchDriver, which both time
+ * DOS runs on the host clock and write their results as JSON.
+ *
+ * THREAD SAFETY:
+ *   Stateless; callable from any thread.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_SHELL_REPORT_H
+#define BOXER_SHELL_REPORT_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace BoxerShellReport {
+
+/// Host monotonic time in nanoseconds; the reports' default clock
+inline uint64_t steadyClock() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+/// Quoted JSON string. DOS paths carry backslashes; names can carry any
+/// code page byte, which is escaped as \u00XX rather than guessed at
+inline std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (const unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += static_cast<char>(c);
+        } else if (c < 0x20 || c >= 0x80) {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+            quoted += escape;
+        } else {
+            quoted += static_cast<char>(c);
+        }
+    }
+    return quoted + "\"";
+}
+
+} // namespace BoxerShellReport
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_SHELL_REPORT_H
@@ -0,0 +1,443 @@
+/*
+ * boxer_warm_boot.h - Post-AUTOEXEC machine snapshot for warm boot
+ *
+ * Every session boots DOS and runs AUTOEXEC before the real program starts.
+ * For a given configuration that work always ends in the same machine
+ * state, so it only needs doing once: the first session captures the
+ * machine when the shell goes idle after AUTOEXEC, and later sessions with
+ * the same configuration load that state and start at the prompt.
+ *
+ * ARCHITECTURE:
+ *   - Subsystems register sections: a name, a layout version and save/load
+ *     callbacks (RAM, CPU, PIC/PIT, VGA, DOS kernel tables, ...)
+ *   - autoexecWillStart() (INT-025) arms a capture; shellDidBecomeIdle()
+ *     (first INT-026 didReturnToShell) takes it and writes the snapshot
+ *     file, named by the configuration key
+ *   - restore() runs before the shell starts. It reads the whole file and
+ *     validates every section (presence, version, size, checksum) before
+ *     loading any, so a stale or damaged snapshot falls back to a cold boot
+ *     with the machine untouched
+ *   - The snapshot is taken at the prompt with no batch file running, which
+ *     is the one point where the shell object itself holds no state that
+ *     the DOS kernel sections do not already cover
+ *   - After a restore, restore hooks bring back what must follow the host
+ *     rather than the snapshot: the BIOS tick count, CMOS clock and DOS
+ *     date and time, which a cold boot would have read from the host clock
+ *
+ * The configuration key must cover everything that changes the post-
+ * AUTOEXEC state: the canonical configuration text, AUTOEXEC contents,
+ * mounted paths and the emulator build. It does not cover the files
+ * AUTOEXEC runs from mounted drives (TSRs, CALLed batch files): those are
+ * reported with autoexecRanFile(), checksummed into the snapshot, and a
+ * restore whose files changed is stale. Files those programs only open are
+ * not checked. Snapshots use host byte order and are only valid for the
+ * build that wrote them.
+ *
+ * THREAD SAFETY:
+ *   None. All calls happen on the emulation thread.
+ *
+ * Copyright (c) 2013 Alun Bestor and contributors. All rights reserved.
+ * This source file is released under the GNU General Public License 2.0.
+ */
+
+#ifndef BOXER_WARM_BOOT_H
+#define BOXER_WARM_BOOT_H
+
+#ifdef BOXER_INTEGRATED
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// BoxerWarmBoot
+// ============================================================================
+
+class BoxerWarmBoot {
+public:
+    /// Appends the section's state to the buffer
+    using Save = std::function<void(std::vector<uint8_t>&)>;
+    /// Replaces the subsystem's state; false if the data is unusable
+    using Load = std::function<bool(const uint8_t* data, size_t size)>;
+    /// False (with a reason) if the state cannot be captured right now
+    using CanCapture = std::function<bool(std::string& reason)>;
+    /// Runs after every section has loaded
+    using RestoreHook = std::function<void()>;
+
+    enum class RestoreResult {
+        Restored,
+        NoSnapshot,    ///< No snapshot for this key: cold boot and capture
+        Stale,         ///< Sections, versions or AUTOEXEC's files differ
+        Corrupt,       ///< Truncated or checksum mismatch
+        LoadFailed,    ///< A section rejected its data after validation
+    };
+
+    enum class CaptureResult {
+        Captured,
+        NotArmed,      ///< No AUTOEXEC since start, or already captured/restored
+        Vetoed,        ///< A section's CanCapture said no
+        WriteFailed,
+    };
+
+    struct Stats {
+        uint64_t bytes = 0;           ///< Section payload of the last capture/restore
+        size_t files = 0;             ///< Files AUTOEXEC ran, checked on restore
+        double captureMs = 0;
+        double restoreMs = 0;
+        std::string vetoReason;
+    };
+
+    static constexpr uint32_t kFormatVersion = 2;
+
+    /**
+     * @param snapshotDirectory Where snapshot files live (Boxer's caches folder)
+     * @param key Configuration key from configurationKey()
+     */
+    BoxerWarmBoot(std::string snapshotDirectory, uint64_t key)
+        : m_directory(std::move(snapshotDirectory)), m_key(key) {}
+
+    BoxerWarmBoot(const BoxerWarmBoot&) = delete;
+    BoxerWarmBoot& operator=(const BoxerWarmBoot&) = delete;
+
+    /**
+     * @brief Key for a configuration
+     * @param canonicalConfig Configuration, AUTOEXEC and mount list as text
+     * @param buildId Emulator build identifier (version and commit)
+     */
+    static uint64_t configurationKey(std::string_view canonicalConfig, std::string_view buildId) {
+        const uint64_t build = checksum(reinterpret_cast<const uint8_t*>(buildId.data()), buildId.size());
+        return checksum(reinterpret_cast<const uint8_t*>(canonicalConfig.data()), canonicalConfig.size(), build);
+    }
+
+    std::string snapshotPath() const {
+        char name[40];
+        std::snprintf(name, sizeof(name), "warmboot-%016llx.bxwb", static_cast<unsigned long long>(m_key));
+        return m_directory + "/" + name;
+    }
+
+    /// Register a section; registration order is the save and load order
+    void registerSection(std::string name, uint32_t version, Save save, Load load,
+                         CanCapture canCapture = nullptr) {
+        m_sections.push_back(Section{std::move(name), version, std::move(save), std::move(load),
+                                     std::move(canCapture)});
+    }
+
+    /**
+     * @brief Run after each successful restore, in registration order
+     *
+     * For state that must come from the host, not the snapshot. Boxer
+     * registers one that sets the BIOS tick count at 0040:006C, the CMOS
+     * clock and the DOS date and time from the host clock, as a cold boot
+     * does; without it a warm-booted session starts at capture time.
+     */
+    void addRestoreHook(RestoreHook hook) { m_restoreHooks.push_back(std::move(hook)); }
+
+    // ========================================================================
+    // Restore (before the shell starts)
+    // ========================================================================
+
+    RestoreResult restore() {
+        const auto start = std::chrono::steady_clock::now();
+        std::ifstream in(snapshotPath(), std::ios::binary | std::ios::ate);
+        if (!in) {
+            return RestoreResult::NoSnapshot;
+        }
+        std::vector<uint8_t> file(static_cast<size_t>(in.tellg()));
+        in.seekg(0);
+        if (!in.read(reinterpret_cast<char*>(file.data()), static_cast<std::streamsize>(file.size()))) {
+            return RestoreResult::Corrupt;
+        }
+
+        std::vector<Span> spans;
+        std::vector<std::string> files;
+        const RestoreResult validated = validate(file, spans, files);
+        if (validated != RestoreResult::Restored) {
+            return validated;
+        }
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < m_sections.size(); ++i) {
+            if (!m_sections[i].load(file.data() + spans[i].offset, spans[i].size)) {
+                return RestoreResult::LoadFailed;
+            }
+            bytes += spans[i].size;
+        }
+        for (const auto& hook : m_restoreHooks) {
+            hook();
+        }
+        m_restored = true;
+        m_armed = false;
+        m_stats.bytes = bytes;
+        m_stats.files = files.size();
+        m_stats.restoreMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        return RestoreResult::Restored;
+    }
+
+    /// True once restore() succeeded: skip AUTOEXEC and go to the prompt
+    bool restored() const { return m_restored; }
+
+    // ========================================================================
+    // Capture (shell hooks)
+    // ========================================================================
+
+    /// INT-025: AUTOEXEC is about to run on a cold boot
+    void autoexecWillStart() {
+        m_armed = !m_restored;
+        m_autoexecFiles.clear();
+    }
+
+    /**
+     * @brief INT-034/INT-036 during AUTOEXEC: a program or batch file it ran
+     * @param hostPath The file on the host, resolved through its mounted drive
+     */
+    void autoexecRanFile(const std::string& hostPath) {
+        if (m_armed && std::find(m_autoexecFiles.begin(), m_autoexecFiles.end(), hostPath) ==
+                           m_autoexecFiles.end()) {
+            m_autoexecFiles.push_back(hostPath);
+        }
+    }
+
+    /// First INT-026 after AUTOEXEC: the shell is idle at the prompt
+    CaptureResult shellDidBecomeIdle() {
+        if (!m_armed) {
+            return CaptureResult::NotArmed;
+        }
+        m_armed = false;
+        return capture();
+    }
+
+    /// Capture now, regardless of arming; used by tests and tooling
+    CaptureResult capture() {
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& section : m_sections) {
+            std::string reason;
+            if (section.canCapture && !section.canCapture(reason)) {
+                m_stats.vetoReason = section.name + ": " + reason;
+                return CaptureResult::Vetoed;
+            }
+        }
+
+        std::vector<uint8_t> file;
+        appendHeader(file);
+        uint64_t bytes = 0;
+        std::vector<uint8_t> data;
+        for (const auto& section : m_sections) {
+            data.clear();
+            section.save(data);
+            appendSection(file, section, data);
+            bytes += data.size();
+        }
+
+        // Write beside the snapshot and rename, so readers never see half a file
+        const std::string path = snapshotPath();
+        const std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+            if (!out) {
+                std::remove(temporary.c_str());
+                return CaptureResult::WriteFailed;
+            }
+        }
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            return CaptureResult::WriteFailed;
+        }
+        m_stats.bytes = bytes;
+        m_stats.files = m_autoexecFiles.size();
+        m_stats.captureMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        return CaptureResult::Captured;
+    }
+
+    /// Delete this configuration's snapshot (user reset, failed restore)
+    void discardSnapshot() {
+        std::remove(snapshotPath().c_str());
+    }
+
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct Section {
+        std::string name;
+        uint32_t version;
+        Save save;
+        Load load;
+        CanCapture canCapture;
+    };
+
+    struct Span {
+        size_t offset;
+        size_t size;
+    };
+
+    // What a file AUTOEXEC ran looked like; a missing file has size UINT64_MAX
+    struct FileStamp {
+        uint64_t size = UINT64_MAX;
+        uint64_t sum = 0;
+    };
+
+    static constexpr char kMagic[4] = {'B', 'X', 'W', 'B'};
+    static constexpr uint64_t kOffsetBasis = 0xcbf29ce484222325ULL;
+    static constexpr uint64_t kPrime = 0x100000001b3ULL;
+
+    // FNV-1a over 64-bit words, then the tail bytes: several GB/s, which
+    // keeps a RAM-sized section well under the cost of copying it
+    static uint64_t checksum(const uint8_t* data, size_t size, uint64_t hash = kOffsetBasis) {
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            hash = (hash ^ word) * kPrime;
+        }
+        for (; i < size; ++i) {
+            hash = (hash ^ data[i]) * kPrime;
+        }
+        return hash;
+    }
+
+    // TSRs and batch files are a few KB, so the whole file is checksummed
+    static FileStamp stampFile(const std::string& path) {
+        FileStamp stamp;
+        std::ifstream in(path, std::ios::binary);
+        if (in) {
+            std::vector<uint8_t> contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            stamp.size = contents.size();
+            stamp.sum = checksum(contents.data(), contents.size());
+        }
+        return stamp;
+    }
+
+    template <typename T>
+    static void put(std::vector<uint8_t>& out, T value) {
+        const size_t at = out.size();
+        out.resize(at + sizeof(T));
+        std::memcpy(out.data() + at, &value, sizeof(T));
+    }
+
+    template <typename T>
+    static bool get(const std::vector<uint8_t>& in, size_t& offset, T& value) {
+        if (in.size() - offset < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, in.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    void appendHeader(std::vector<uint8_t>& out) const {
+        out.insert(out.end(), kMagic, kMagic + 4);
+        put<uint32_t>(out, kFormatVersion);
+        put<uint64_t>(out, m_key);
+        put<uint32_t>(out, static_cast<uint32_t>(m_sections.size()));
+        put<uint32_t>(out, static_cast<uint32_t>(m_autoexecFiles.size()));
+        for (const auto& path : m_autoexecFiles) {
+            const FileStamp stamp = stampFile(path);
+            put<uint16_t>(out, static_cast<uint16_t>(path.size()));
+            out.insert(out.end(), path.begin(), path.end());
+            put<uint64_t>(out, stamp.size);
+            put<uint64_t>(out, stamp.sum);
+        }
+    }
+
+    static void appendSection(std::vector<uint8_t>& out, const Section& section,
+                              const std::vector<uint8_t>& data) {
+        put<uint16_t>(out, static_cast<uint16_t>(section.name.size()));
+        out.insert(out.end(), section.name.begin(), section.name.end());
+        put<uint32_t>(out, section.version);
+        put<uint64_t>(out, data.size());
+        put<uint64_t>(out, checksum(data.data(), data.size()));
+        out.insert(out.end(), data.begin(), data.end());
+    }
+
+    // Checks the whole file against the registered sections and the files
+    // AUTOEXEC ran; spans[i] locates the data for m_sections[i]
+    RestoreResult validate(const std::vector<uint8_t>& file, std::vector<Span>& spans,
+                           std::vector<std::string>& files) const {
+        size_t offset = 0;
+        uint32_t format = 0;
+        uint64_t key = 0;
+        uint32_t count = 0;
+        if (file.size() < 4 || std::memcmp(file.data(), kMagic, 4) != 0) {
+            return RestoreResult::Corrupt;
+        }
+        offset = 4;
+        if (!get(file, offset, format) || !get(file, offset, key) || !get(file, offset, count)) {
+            return RestoreResult::Corrupt;
+        }
+        if (format != kFormatVersion || key != m_key || count != m_sections.size()) {
+            return RestoreResult::Stale;
+        }
+
+        // Files AUTOEXEC ran must still be what it ran
+        uint32_t fileCount = 0;
+        if (!get(file, offset, fileCount)) {
+            return RestoreResult::Corrupt;
+        }
+        for (uint32_t i = 0; i < fileCount; ++i) {
+            uint16_t pathLength = 0;
+            FileStamp stamp;
+            if (!get(file, offset, pathLength) || file.size() - offset < pathLength) {
+                return RestoreResult::Corrupt;
+            }
+            std::string path(reinterpret_cast<const char*>(file.data() + offset), pathLength);
+            offset += pathLength;
+            if (!get(file, offset, stamp.size) || !get(file, offset, stamp.sum)) {
+                return RestoreResult::Corrupt;
+            }
+            const FileStamp current = stampFile(path);
+            if (current.size != stamp.size || current.sum != stamp.sum) {
+                return RestoreResult::Stale;
+            }
+            files.push_back(std::move(path));
+        }
+
+        spans.assign(m_sections.size(), Span{0, 0});
+        for (const auto& section : m_sections) {
+            uint16_t nameLength = 0;
+            uint32_t version = 0;
+            uint64_t size = 0;
+            uint64_t expected = 0;
+            if (!get(file, offset, nameLength) || file.size() - offset < nameLength) {
+                return RestoreResult::Corrupt;
+            }
+            const std::string name(reinterpret_cast<const char*>(file.data() + offset), nameLength);
+            offset += nameLength;
+            if (!get(file, offset, version) || !get(file, offset, size) || !get(file, offset, expected) ||
+                file.size() - offset < size) {
+                return RestoreResult::Corrupt;
+            }
+            if (name != section.name || version != section.version) {
+                return RestoreResult::Stale;
+            }
+            if (checksum(file.data() + offset, static_cast<size_t>(size)) != expected) {
+                return RestoreResult::Corrupt;
+            }
+            spans[static_cast<size_t>(&section - m_sections.data())] = Span{offset, static_cast<size_t>(size)};
+            offset += static_cast<size_t>(size);
+        }
+        return offset == file.size() ? RestoreResult::Restored : RestoreResult::Corrupt;
+    }
+
+    const std::string m_directory;
+    const uint64_t m_key;
+    std::vector<Section> m_sections;
+    std::vector<RestoreHook> m_restoreHooks;
+    std::vector<std::string> m_autoexecFiles;
+    bool m_armed = false;
+    bool m_restored = false;
+    Stats m_stats;
+};
+
+#endif // BOXER_INTEGRATED
+
+#endif // BOXER_WARM_BOOT_H
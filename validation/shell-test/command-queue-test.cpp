@@ -0,0 +1,415 @@
+/*
+ * command-queue-test.cpp - Shell command queue test suite
+ *
+ * Validates BoxerCommandQueue, the replacement for the per-command hooks:
+ * - INT-031: hasPendingCommandsForShell
+ * - INT-032: executeNextPendingCommandForShell
+ *
+ * Test cases:
+ * 1. FIFO order and pending state
+ * 2. Script splitting (CRLF, blank lines)
+ * 3. Batches from concurrent producers stay contiguous
+ * 4. Multi-producer ordering without loss
+ * 5. Clear discards queued lines
+ * 6. Throughput versus per-command hook round trips
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_command_queue.h"
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// Legacy delegate: what Boxer does behind INT-031/INT-032 today
+// ============================================================================
+
+class LegacyCommandDelegate {
+public:
+    virtual ~LegacyCommandDelegate() = default;
+    virtual bool hasPendingCommandsForShell() = 0;
+    virtual bool executeNextPendingCommandForShell(std::string& command) = 0;
+};
+
+class DequeCommandDelegate : public LegacyCommandDelegate {
+public:
+    std::mutex mutex;
+    std::deque<std::string> commands;
+
+    bool hasPendingCommandsForShell() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !commands.empty();
+    }
+
+    bool executeNextPendingCommandForShell(std::string& command) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (commands.empty()) {
+            return false;
+        }
+        command = std::move(commands.front());
+        commands.pop_front();
+        return true;
+    }
+};
+
+// Stand-in for DOS_Shell::ParseLine
+struct SimulatedShell {
+    size_t executed = 0;
+    size_t characters = 0;
+
+    void parseLine(const std::string& line) {
+        ++executed;
+        characters += line.size();
+    }
+};
+
+// "P<producer>:<batch>:<line>"
+std::string tagged(int producer, int batch, int line) {
+    return "P" + std::to_string(producer) + ":" + std::to_string(batch) + ":" + std::to_string(line);
+}
+
+bool parseTag(const std::string& text, int& producer, int& batch, int& line) {
+    return std::sscanf(text.c_str(), "P%d:%d:%d", &producer, &batch, &line) == 3;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+bool testFifoOrder() {
+    std::cout << "\n[TEST 1] FIFO Order and Pending State" << std::endl;
+
+    BoxerCommandQueue queue;
+    std::string command;
+    if (queue.hasPending() || queue.pop(command)) {
+        std::cerr << "  ✗ FAIL: New queue is not empty" << std::endl;
+        return false;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        queue.push("C:");
+        queue.push("CD \\GAMES\\KEEN" + std::to_string(i));
+        queue.push("KEEN" + std::to_string(i) + ".EXE");
+    }
+    if (!queue.hasPending() || queue.pendingCount() != 9) {
+        std::cerr << "  ✗ FAIL: Expected 9 pending, got " << queue.pendingCount() << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ 9 commands pending" << std::endl;
+
+    for (int i = 0; i < 3; ++i) {
+        const std::string expected[] = {"C:", "CD \\GAMES\\KEEN" + std::to_string(i),
+                                        "KEEN" + std::to_string(i) + ".EXE"};
+        for (const auto& line : expected) {
+            if (!queue.pop(command) || command != line) {
+                std::cerr << "  ✗ FAIL: Expected '" << line << "', got '" << command << "'" << std::endl;
+                return false;
+            }
+        }
+    }
+    std::cout << "  ✓ Commands popped in push order" << std::endl;
+
+    if (queue.hasPending() || queue.pop(command) || queue.pendingCount() != 0) {
+        std::cerr << "  ✗ FAIL: Queue not empty after draining" << std::endl;
+        return false;
+    }
+
+    // The stub is re-inserted on each drain; the queue must stay usable
+    for (int round = 0; round < 100; ++round) {
+        queue.push("VER");
+        if (!queue.pop(command) || command != "VER" || queue.hasPending()) {
+            std::cerr << "  ✗ FAIL: Push/pop round " << round << " failed" << std::endl;
+            return false;
+        }
+    }
+    std::cout << "  ✓ Empty after draining, reusable afterwards" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testScriptSplitting() {
+    std::cout << "\n[TEST 2] Script Splitting" << std::endl;
+
+    BoxerCommandQueue queue;
+    const size_t queued = queue.pushScript("@ECHO OFF\r\nMOUNT D /cdrom -t cdrom\r\n\r\n   \nD:\nINSTALL.EXE /S");
+    const std::vector<std::string> expected = {"@ECHO OFF", "MOUNT D /cdrom -t cdrom", "D:", "INSTALL.EXE /S"};
+    if (queued != expected.size()) {
+        std::cerr << "  ✗ FAIL: Expected 4 lines, queued " << queued << std::endl;
+        return false;
+    }
+
+    std::string command;
+    for (const auto& line : expected) {
+        if (!queue.pop(command) || command != line) {
+            std::cerr << "  ✗ FAIL: Expected '" << line << "', got '" << command << "'" << std::endl;
+            return false;
+        }
+    }
+    std::cout << "  ✓ CRLF stripped, blank lines skipped, last line without newline kept" << std::endl;
+
+    if (queue.pushScript("\r\n\n") != 0 || queue.hasPending()) {
+        std::cerr << "  ✗ FAIL: Blank script queued something" << std::endl;
+        return false;
+    }
+    const std::vector<std::string> lines = {"A:", "DIR", "B:"};
+    if (queue.pushBatch(lines.begin(), lines.end()) != 3 || queue.pendingCount() != 3) {
+        std::cerr << "  ✗ FAIL: pushBatch did not queue 3 lines" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Blank script queues nothing, pushBatch queues each element" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testBatchesStayContiguous() {
+    std::cout << "\n[TEST 3] Concurrent Batches Stay Contiguous" << std::endl;
+
+    const int producers = 4;
+    const int batches = 500;
+    const int lines = 20;
+    BoxerCommandQueue queue;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p]() {
+            std::vector<std::string> script;
+            for (int b = 0; b < batches; ++b) {
+                script.clear();
+                for (int l = 0; l < lines; ++l) {
+                    script.push_back(tagged(p, b, l));
+                }
+                queue.pushBatch(script.begin(), script.end());
+                if (b % 16 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> nextBatch(producers, 0);
+    int expectedLine = 0;
+    int currentProducer = -1;
+    size_t received = 0;
+    const size_t total = static_cast<size_t>(producers) * batches * lines;
+    std::string command;
+    bool ok = true;
+    while (received < total && ok) {
+        if (!queue.pop(command)) {
+            std::this_thread::yield();
+            continue;
+        }
+        int p = 0;
+        int b = 0;
+        int l = 0;
+        ok = parseTag(command, p, b, l);
+        if (expectedLine == 0) {
+            ok = ok && l == 0 && b == nextBatch[p];
+            currentProducer = p;
+        } else {
+            ok = ok && p == currentProducer && b == nextBatch[p] && l == expectedLine;
+        }
+        if (!ok) {
+            std::cerr << "  ✗ FAIL: Line '" << command << "' broke into a batch of producer "
+                      << currentProducer << std::endl;
+            break;
+        }
+        if (++expectedLine == lines) {
+            expectedLine = 0;
+            ++nextBatch[p];
+        }
+        ++received;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (!ok) {
+        return false;
+    }
+    std::cout << "  ✓ " << producers * batches << " batches of " << lines
+              << " lines, none interleaved" << std::endl;
+
+    if (queue.hasPending()) {
+        std::cerr << "  ✗ FAIL: Lines left after all batches were received" << std::endl;
+        return false;
+    }
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testMultiProducerOrdering() {
+    std::cout << "\n[TEST 4] Multi-Producer Ordering Without Loss" << std::endl;
+
+    const int producers = 4;
+    const int perProducer = 50000;
+    BoxerCommandQueue queue;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p]() {
+            for (int i = 0; i < perProducer; ++i) {
+                queue.push(tagged(p, i, 0));
+                if (i % 256 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> next(producers, 0);
+    size_t received = 0;
+    size_t emptyPolls = 0;
+    std::string command;
+    while (received < static_cast<size_t>(producers) * perProducer) {
+        if (!queue.pop(command)) {
+            ++emptyPolls;
+            std::this_thread::yield();
+            continue;
+        }
+        int p = 0;
+        int i = 0;
+        int unused = 0;
+        if (!parseTag(command, p, i, unused) || p < 0 || p >= producers || i != next[p]) {
+            std::cerr << "  ✗ FAIL: Out of order: '" << command << "'" << std::endl;
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            return false;
+        }
+        ++next[p];
+        ++received;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::cout << "  ✓ " << received << " commands, each producer's order preserved" << std::endl;
+    std::cout << "  ✓ " << emptyPolls << " polls found nothing ready" << std::endl;
+
+    if (queue.pendingCount() != 0 || queue.hasPending()) {
+        std::cerr << "  ✗ FAIL: Queue not empty at the end" << std::endl;
+        return false;
+    }
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testClear() {
+    std::cout << "\n[TEST 5] Clear Discards Queued Lines" << std::endl;
+
+    BoxerCommandQueue queue;
+    queue.pushScript("C:\nCD GAME\nGAME.EXE\n");
+    queue.push("EXIT");
+    const size_t discarded = queue.clear();
+    if (discarded != 4 || queue.hasPending() || queue.pendingCount() != 0) {
+        std::cerr << "  ✗ FAIL: Expected 4 discarded and an empty queue, discarded " << discarded
+                  << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Cancelled launch discarded 4 lines" << std::endl;
+
+    queue.push("DIR");
+    std::string command;
+    if (!queue.pop(command) || command != "DIR") {
+        std::cerr << "  ✗ FAIL: Queue unusable after clear" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Later commands run normally" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testThroughput() {
+    std::cout << "\n[TEST 6] Throughput: Queue vs Per-Command Hooks" << std::endl;
+
+    const size_t total = 500000;
+    std::vector<std::string> script;
+    script.reserve(total);
+    for (size_t i = 0; i < total; ++i) {
+        script.push_back("ECHO LINE " + std::to_string(i));
+    }
+
+    // Legacy: two virtual calls and two lock round trips per command
+    DequeCommandDelegate legacyImpl;
+    legacyImpl.commands.assign(script.begin(), script.end());
+    LegacyCommandDelegate* legacy = &legacyImpl;
+    SimulatedShell legacyShell;
+    std::string command;
+
+    auto start = std::chrono::steady_clock::now();
+    while (legacy->hasPendingCommandsForShell()) {
+        if (legacy->executeNextPendingCommandForShell(command)) {
+            legacyShell.parseLine(command);
+        }
+    }
+    const double legacyMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    // Queue: the script is pushed once and drained in the shell
+    BoxerCommandQueue queue;
+    queue.pushBatch(script.begin(), script.end());
+    SimulatedShell shell;
+    start = std::chrono::steady_clock::now();
+    while (queue.pop(command)) {
+        shell.parseLine(command);
+    }
+    const double queueMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "  Per-command hooks: " << legacyShell.executed << " commands in " << legacyMs << " ms"
+              << std::endl;
+    std::cout << "  Command queue:     " << shell.executed << " commands in " << queueMs
+              << " ms" << std::endl;
+
+    if (legacyShell.executed != total || shell.executed != total ||
+        legacyShell.characters != shell.characters) {
+        std::cerr << "  ✗ FAIL: Not every command was executed" << std::endl;
+        return false;
+    }
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Command Queue Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-031, INT-032 replacement" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testFifoOrder()) passed++; else failed++;
+    if (testScriptSplitting()) passed++; else failed++;
+    if (testBatchesStayContiguous()) passed++; else failed++;
+    if (testMultiProducerOrdering()) passed++; else failed++;
+    if (testClear()) passed++; else failed++;
+    if (testThroughput()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
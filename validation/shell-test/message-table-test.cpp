@@ -0,0 +1,312 @@
+/*
+ * message-table-test.cpp - Localized message table test suite
+ *
+ * Validates BoxerMessageTable, which replaces per-message calls to:
+ * - INT-081: localizedStringForKey
+ *
+ * Test cases:
+ * 1. Bulk collection from the delegate and lookup of every key
+ * 2. Unknown keys miss and fall back to the built-in text
+ * 3. Minimal perfect hash over a large key set
+ * 4. Duplicate keys and interned values
+ * 5. Build time at DOSBox and stress sizes
+ * 6. Lookup cost versus the per-message hook
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_message_table.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// Test fixtures
+// ============================================================================
+
+// Keys shaped like the ones DOSBox registers with MSG_Add
+std::vector<std::string> messageKeys(size_t count) {
+    static const char* prefixes[] = {"SHELL_CMD_", "SHELL_", "PROGRAM_MOUNT_", "PROGRAM_CONFIG_", "CONFIG_", "MIXER_"};
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys.push_back(std::string(prefixes[i % 6]) + "MSG_" + std::to_string(i));
+    }
+    return keys;
+}
+
+// Host-side localization as the legacy hook sees it: a virtual call that
+// builds a key string and looks it up in a dictionary
+class LegacyLocalizer {
+public:
+    virtual ~LegacyLocalizer() = default;
+    virtual const char* localizedStringForKey(const char* key) = 0;
+};
+
+class DictionaryLocalizer : public LegacyLocalizer {
+public:
+    std::unordered_map<std::string, std::string> strings;
+    size_t calls = 0;
+
+    const char* localizedStringForKey(const char* key) override {
+        ++calls;
+        const auto found = strings.find(key);
+        return found == strings.end() ? nullptr : found->second.c_str();
+    }
+};
+
+DictionaryLocalizer translatedLocalizer(const std::vector<std::string>& keys) {
+    DictionaryLocalizer localizer;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        // Every fifth message is untranslated
+        if (i % 5 != 4) {
+            localizer.strings[keys[i]] = "Übersetzt " + std::to_string(i) + "\n";
+        }
+    }
+    return localizer;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+bool testCollectAndLookup() {
+    std::cout << "\n[TEST 1] Bulk Collection and Lookup" << std::endl;
+
+    const auto keys = messageKeys(1500);
+    DictionaryLocalizer delegate = translatedLocalizer(keys);
+    const BoxerMessageTable table(BoxerMessageTable::collect(
+        keys, [&delegate](const char* key) { return delegate.localizedStringForKey(key); }));
+
+    if (delegate.calls != keys.size() || table.size() != 1200) {
+        std::cerr << "  ✗ FAIL: Expected 1500 hook calls and 1200 entries, got "
+                  << delegate.calls << " and " << table.size() << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ One hook call per registered key; 300 untranslated keys left out" << std::endl;
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const char* text = table.lookup(keys[i].c_str());
+        const char* expected = delegate.localizedStringForKey(keys[i].c_str());
+        if ((expected == nullptr) != (text == nullptr) || (expected && std::strcmp(text, expected) != 0)) {
+            std::cerr << "  ✗ FAIL: Wrong text for " << keys[i] << std::endl;
+            return false;
+        }
+        if (text && table.lookup(keys[i].c_str()) != text) {
+            std::cerr << "  ✗ FAIL: Pointer for " << keys[i] << " not stable" << std::endl;
+            return false;
+        }
+    }
+    std::cout << "  ✓ Every key returns the delegate's text, at a stable address" << std::endl;
+
+    const size_t callsBefore = delegate.calls;
+    for (int repeat = 0; repeat < 100; ++repeat) {
+        table.lookup("SHELL_CMD_MSG_0");
+    }
+    if (delegate.calls != callsBefore) {
+        std::cerr << "  ✗ FAIL: Lookups reached the delegate" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Lookups never reach the delegate" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testMisses() {
+    std::cout << "\n[TEST 2] Unknown Keys Fall Back" << std::endl;
+
+    const BoxerMessageTable table({{"SHELL_CMD_DIR_INTRO", "Verzeichnis von %s\n"},
+                                   {"SHELL_CMD_DIR_BYTES_USED", "%5d Datei(en) %17s Bytes\n"},
+                                   {"SHELL_ILLEGAL_PATH", "Ungültiger Pfad\n"}});
+    const char* misses[] = {"SHELL_CMD_DIR", "SHELL_CMD_DIR_INTRO_", "shell_cmd_dir_intro", "", "SHELL_CMD_ECHO_ON"};
+    for (const char* key : misses) {
+        if (table.lookup(key) != nullptr) {
+            std::cerr << "  ✗ FAIL: '" << key << "' should miss" << std::endl;
+            return false;
+        }
+    }
+    std::cout << "  ✓ Prefixes, extensions, other case and empty key all miss" << std::endl;
+
+    const BoxerMessageTable empty({});
+    if (empty.size() != 0 || empty.lookup("SHELL_CMD_DIR_INTRO") != nullptr) {
+        std::cerr << "  ✗ FAIL: Empty table returned a string" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Empty table (English build) misses everything" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testPerfectHash() {
+    std::cout << "\n[TEST 3] Minimal Perfect Hash" << std::endl;
+
+    const auto keys = messageKeys(50000);
+    std::vector<BoxerMessageTable::Entry> entries;
+    for (const auto& key : keys) {
+        entries.emplace_back(key, key + "=");
+    }
+    const BoxerMessageTable table(entries);
+
+    // One slot per key: any collision would leave some key unreachable
+    for (const auto& key : keys) {
+        const char* text = table.lookup(key.c_str());
+        if (!text || key + "=" != text) {
+            std::cerr << "  ✗ FAIL: " << key << " unreachable" << std::endl;
+            return false;
+        }
+    }
+    const auto& stats = table.stats();
+    if (table.size() != keys.size() || stats.buckets != keys.size() / 4) {
+        std::cerr << "  ✗ FAIL: Expected " << keys.size() << " slots, got " << table.size() << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ 50000 keys in 50000 slots, all reachable (largest displacement "
+              << stats.maxDisplacement << ")" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testDuplicatesAndInterning() {
+    std::cout << "\n[TEST 4] Duplicate Keys and Interned Values" << std::endl;
+
+    const BoxerMessageTable table({{"SHELL_CMD_PAUSE", "Taste drücken . . ."},
+                                   {"SHELL_CMD_PAUSE_HELP", "Wartet auf Tastendruck.\n"},
+                                   {"PROGRAM_MOUNT_OK", "OK\n"},
+                                   {"PROGRAM_CONFIG_OK", "OK\n"},
+                                   {"SHELL_CMD_PAUSE", "Eine Taste drücken . . ."}});
+    if (table.size() != 4 || std::strcmp(table.lookup("SHELL_CMD_PAUSE"), "Eine Taste drücken . . .") != 0) {
+        std::cerr << "  ✗ FAIL: Later duplicate did not replace the earlier one" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ A key given twice keeps its last text" << std::endl;
+
+    if (table.lookup("PROGRAM_MOUNT_OK") != table.lookup("PROGRAM_CONFIG_OK")) {
+        std::cerr << "  ✗ FAIL: Identical texts not interned" << std::endl;
+        return false;
+    }
+    const size_t expectedArena = sizeof("SHELL_CMD_PAUSE") + sizeof("Eine Taste drücken . . .") +
+                                 sizeof("SHELL_CMD_PAUSE_HELP") + sizeof("Wartet auf Tastendruck.\n") +
+                                 sizeof("PROGRAM_MOUNT_OK") + sizeof("OK\n") + sizeof("PROGRAM_CONFIG_OK");
+    if (table.stats().arenaBytes != expectedArena) {
+        std::cerr << "  ✗ FAIL: Arena holds " << table.stats().arenaBytes << " bytes, expected "
+                  << expectedArena << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Identical texts share one copy; arena is " << expectedArena << " bytes" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testBuildTime() {
+    std::cout << "\n[TEST 5] Build Time" << std::endl;
+
+    for (const size_t count : {size_t(1500), size_t(50000)}) {
+        std::vector<BoxerMessageTable::Entry> entries;
+        for (const auto& key : messageKeys(count)) {
+            entries.emplace_back(key, "Localized text for " + key + "\n");
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const BoxerMessageTable table(entries);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << count << " messages: " << ms << " ms, " << table.stats().arenaBytes / 1024
+                  << " KiB arena" << std::endl;
+        if (table.size() != count) {
+            std::cerr << "  ✗ FAIL: Table lost messages" << std::endl;
+            return false;
+        }
+    }
+    std::cout << "  ✓ Tables built at startup and on language change" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testLookupCost() {
+    std::cout << "\n[TEST 6] Lookup Cost versus Per-Message Hook" << std::endl;
+
+    const auto keys = messageKeys(1500);
+    DictionaryLocalizer dictionary = translatedLocalizer(keys);
+    LegacyLocalizer* delegate = &dictionary;
+    const BoxerMessageTable table(BoxerMessageTable::collect(
+        keys, [delegate](const char* key) { return delegate->localizedStringForKey(key); }));
+
+    // A DIR listing prints a handful of messages per entry; cycle through
+    // a small working set the way a listing does
+    std::vector<const char*> workingSet;
+    for (size_t i = 0; i < 16; ++i) {
+        workingSet.push_back(keys[i * 37].c_str());
+    }
+    const size_t iterations = 2000000;
+
+    size_t legacyBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        const char* text = delegate->localizedStringForKey(workingSet[i & 15]);
+        legacyBytes += text ? static_cast<unsigned char>(text[0]) : 0;
+    }
+    const double legacyNs =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    size_t tableBytes = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        const char* text = table.lookup(workingSet[i & 15]);
+        tableBytes += text ? static_cast<unsigned char>(text[0]) : 0;
+    }
+    const double tableNs =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    if (legacyBytes != tableBytes) {
+        std::cerr << "  ✗ FAIL: Table and hook returned different texts" << std::endl;
+        return false;
+    }
+    std::cout << "  Per-message hook: " << legacyNs << " ns per message" << std::endl;
+    std::cout << "  Message table:    " << tableNs << " ns per message" << std::endl;
+    std::cout << "  ✓ Same texts returned by both paths" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Message Table Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-081 localized message table" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testCollectAndLookup()) passed++; else failed++;
+    if (testMisses()) passed++; else failed++;
+    if (testPerfectHash()) passed++; else failed++;
+    if (testDuplicatesAndInterning()) passed++; else failed++;
+    if (testBuildTime()) passed++; else failed++;
+    if (testLookupCost()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
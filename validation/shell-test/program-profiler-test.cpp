@@ -0,0 +1,353 @@
+/*
+ * program-profiler-test.cpp - Per-program profiler test suite
+ *
+ * Validates BoxerProgramProfiler, driven from:
+ * - INT-034: shellWillExecuteFileAtDOSPath
+ * - INT-035: shellDidExecuteFileAtDOSPath
+ *
+ * Test cases:
+ * 1. One run charges every counter to its program
+ * 2. Repeated runs aggregate (runs, min, max, total)
+ * 3. Nested runs: inclusive totals and self time
+ * 4. Runs that never report back are closed as unfinished
+ * 5. JSON output (ordering, escaping)
+ * 6. Disabled profiler records nothing; counting cost
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_program_profiler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// ============================================================================
+// Manual clock
+// ============================================================================
+
+struct ManualClock {
+    uint64_t ns = 1000;
+
+    BoxerProgramProfiler::Clock function() {
+        return [this]() { return ns; };
+    }
+    void advanceMs(uint64_t ms) { ns += ms * 1000000; }
+};
+
+// One program's slice of emulation: cycles, frames, file I/O and hook calls
+void emulate(BoxerProgramProfiler& profiler, ManualClock& clock, uint64_t ms) {
+    clock.advanceMs(ms);
+    profiler.addCycles(3000 * ms);
+    for (uint64_t frame = 0; frame < ms / 14; ++frame) {
+        profiler.frameRendered();
+    }
+    profiler.didReadBytes(512 * ms);
+    profiler.didWriteBytes(16 * ms);
+    profiler.hookCalled();
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+bool testSingleRun() {
+    std::cout << "\n[TEST 1] One Run Charges Every Counter" << std::endl;
+
+    ManualClock clock;
+    BoxerProgramProfiler profiler(clock.function());
+    profiler.enable();
+
+    emulate(profiler, clock, 100);   // before the program: not charged
+    profiler.beginRun("C:\\GAMES\\DOOM\\DOOM.EXE");
+    emulate(profiler, clock, 700);
+    profiler.endRun("C:\\GAMES\\DOOM\\DOOM.EXE");
+    emulate(profiler, clock, 100);   // after: not charged
+
+    const auto* doom = profiler.program("C:\\GAMES\\DOOM\\DOOM.EXE");
+    if (!doom || doom->runs != 1 || doom->unfinishedRuns != 0) {
+        std::cerr << "  ✗ FAIL: Expected one finished run" << std::endl;
+        return false;
+    }
+    if (doom->wallNs != 700000000 || doom->selfWallNs != doom->wallNs) {
+        std::cerr << "  ✗ FAIL: Wall time " << doom->wallNs << " ns, expected 700 ms" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ 700 ms wall time, all of it self time" << std::endl;
+
+    const auto& totals = doom->totals;
+    if (totals.cycles != 2100000 || doom->selfCycles != 2100000 || totals.frames != 50 ||
+        totals.bytesRead != 358400 || totals.bytesWritten != 11200 || totals.hookCalls != 1) {
+        std::cerr << "  ✗ FAIL: Counters not charged exactly (cycles " << totals.cycles
+                  << ", frames " << totals.frames << ", read " << totals.bytesRead << ")" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Cycles, frames, bytes and hook calls charged for the run only" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testRepeatedRuns() {
+    std::cout << "\n[TEST 2] Repeated Runs Aggregate" << std::endl;
+
+    ManualClock clock;
+    BoxerProgramProfiler profiler(clock.function());
+    profiler.enable();
+
+    for (uint64_t ms : {30, 10, 20}) {
+        profiler.beginRun("C:\\UTIL\\PKUNZIP.EXE");
+        emulate(profiler, clock, ms);
+        profiler.endRun("C:\\UTIL\\PKUNZIP.EXE");
+    }
+
+    const auto* unzip = profiler.program("C:\\UTIL\\PKUNZIP.EXE");
+    if (!unzip || unzip->runs != 3) {
+        std::cerr << "  ✗ FAIL: Expected 3 runs" << std::endl;
+        return false;
+    }
+    if (unzip->wallNs != 60000000 || unzip->minWallNs != 10000000 || unzip->maxWallNs != 30000000) {
+        std::cerr << "  ✗ FAIL: Total/min/max wrong (" << unzip->wallNs << ", " << unzip->minWallNs
+                  << ", " << unzip->maxWallNs << ")" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ 3 runs: 60 ms total, 10 ms min, 30 ms max" << std::endl;
+
+    if (unzip->totals.hookCalls != 3 || unzip->totals.cycles != 180000) {
+        std::cerr << "  ✗ FAIL: Counters not summed over runs" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Counters summed over runs" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testNestedRuns() {
+    std::cout << "\n[TEST 3] Nested Runs: Inclusive and Self" << std::endl;
+
+    ManualClock clock;
+    BoxerProgramProfiler profiler(clock.function());
+    profiler.enable();
+
+    // A launcher menu runs the game twice, then a setup tool
+    profiler.beginRun("C:\\MENU.EXE");
+    emulate(profiler, clock, 50);
+    for (int i = 0; i < 2; ++i) {
+        profiler.beginRun("C:\\GAME\\GAME.EXE");
+        emulate(profiler, clock, 400);
+        profiler.endRun("C:\\GAME\\GAME.EXE");
+        emulate(profiler, clock, 20);
+    }
+    profiler.beginRun("C:\\GAME\\SETUP.EXE");
+    emulate(profiler, clock, 100);
+    profiler.endRun("C:\\GAME\\SETUP.EXE");
+    profiler.endRun("C:\\MENU.EXE");
+
+    const auto* menu = profiler.program("C:\\MENU.EXE");
+    const auto* game = profiler.program("C:\\GAME\\GAME.EXE");
+    if (!menu || !game || profiler.openRuns() != 0) {
+        std::cerr << "  ✗ FAIL: Programs missing or runs left open" << std::endl;
+        return false;
+    }
+    if (menu->wallNs != 990000000 || menu->selfWallNs != 90000000) {
+        std::cerr << "  ✗ FAIL: Menu wall " << menu->wallNs << " self " << menu->selfWallNs << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Menu: 990 ms inclusive, 90 ms self" << std::endl;
+
+    if (menu->totals.cycles != 2970000 || menu->selfCycles != 270000 || game->selfCycles != 2400000) {
+        std::cerr << "  ✗ FAIL: Cycles not split between parent and children" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Cycles: children's excluded from the menu's self count" << std::endl;
+
+    const auto sorted = profiler.programs();
+    if (sorted.size() != 3 || sorted[0].path != "C:\\MENU.EXE" || sorted[1].path != "C:\\GAME\\GAME.EXE") {
+        std::cerr << "  ✗ FAIL: programs() not ordered by total wall time" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ programs() ordered by total wall time" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testUnfinishedRuns() {
+    std::cout << "\n[TEST 4] Runs That Never Report Back" << std::endl;
+
+    ManualClock clock;
+    BoxerProgramProfiler profiler(clock.function());
+    profiler.enable();
+
+    // The TSR never returns through the shell; its parent does
+    profiler.beginRun("C:\\INSTALL.BAT");
+    profiler.beginRun("C:\\DRIVERS\\MOUSE.COM");
+    emulate(profiler, clock, 5);
+    profiler.endRun("C:\\INSTALL.BAT");
+
+    const auto* mouse = profiler.program("C:\\DRIVERS\\MOUSE.COM");
+    const auto* install = profiler.program("C:\\INSTALL.BAT");
+    if (!mouse || !install || mouse->unfinishedRuns != 1 || install->unfinishedRuns != 0 ||
+        profiler.openRuns() != 0) {
+        std::cerr << "  ✗ FAIL: Child not closed as unfinished with its parent" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Child closed as unfinished when its parent returned" << std::endl;
+
+    profiler.endRun("C:\\NEVER.EXE");
+    if (profiler.program("C:\\NEVER.EXE")) {
+        std::cerr << "  ✗ FAIL: End without begin created a program" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ End without a matching begin ignored" << std::endl;
+
+    // Still running when the emulator shuts down
+    profiler.beginRun("C:\\GAME.EXE");
+    emulate(profiler, clock, 250);
+    profiler.endAllRuns();
+    const auto* game = profiler.program("C:\\GAME.EXE");
+    if (!game || game->unfinishedRuns != 1 || game->wallNs != 250000000) {
+        std::cerr << "  ✗ FAIL: Shutdown did not close the running program" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Shutdown closes the running program with its time so far" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testJsonOutput() {
+    std::cout << "\n[TEST 5] JSON Output" << std::endl;
+
+    ManualClock clock;
+    BoxerProgramProfiler profiler(clock.function());
+    std::ostringstream empty;
+    profiler.writeJson(empty);
+    if (empty.str() != "{\n  \"programs\": []\n}\n") {
+        std::cerr << "  ✗ FAIL: Empty profile: " << empty.str() << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Empty profile is valid JSON" << std::endl;
+
+    profiler.enable();
+    profiler.beginRun("C:\\FAST.COM");
+    emulate(profiler, clock, 1);
+    profiler.endRun("C:\\FAST.COM");
+    profiler.beginRun("C:\\\"ODD\"\\N\x82W.EXE");
+    emulate(profiler, clock, 42);
+    profiler.endRun("C:\\\"ODD\"\\N\x82W.EXE");
+
+    std::ostringstream json;
+    profiler.writeJson(json);
+    const std::string text = json.str();
+    const size_t odd = text.find("\"path\": \"C:\\\\\\\"ODD\\\"\\\\N\\u0082W.EXE\"");
+    const size_t fast = text.find("\"path\": \"C:\\\\FAST.COM\"");
+    if (odd == std::string::npos || fast == std::string::npos) {
+        std::cerr << "  ✗ FAIL: Paths not escaped:\n" << text << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Backslashes, quotes and code page bytes escaped" << std::endl;
+
+    if (odd > fast) {
+        std::cerr << "  ✗ FAIL: Slowest program not listed first" << std::endl;
+        return false;
+    }
+    if (text.find("\"wall_ms\": 42.000") == std::string::npos ||
+        text.find("\"cycles\": 126000") == std::string::npos) {
+        std::cerr << "  ✗ FAIL: Values missing:\n" << text << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Slowest first, values in ms and raw counts" << std::endl;
+
+    const std::string path = "program-profiler-test.json";
+    profiler.beginRun("C:\\OPEN.EXE");
+    if (!profiler.writeJsonFile(path) || profiler.openRuns() != 0) {
+        std::cerr << "  ✗ FAIL: writeJsonFile failed or left runs open" << std::endl;
+        return false;
+    }
+    std::ifstream written(path);
+    const std::string contents((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>());
+    std::remove(path.c_str());
+    if (contents.find("\"unfinished_runs\": 1") == std::string::npos) {
+        std::cerr << "  ✗ FAIL: Open run missing from file" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ writeJsonFile closes open runs and writes the file" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testDisabledAndCost() {
+    std::cout << "\n[TEST 6] Disabled Profiler and Counting Cost" << std::endl;
+
+    ManualClock clock;
+    BoxerProgramProfiler profiler(clock.function());
+    profiler.beginRun("C:\\GAME.EXE");
+    emulate(profiler, clock, 100);
+    profiler.endRun("C:\\GAME.EXE");
+    if (!profiler.programs().empty() || profiler.openRuns() != 0) {
+        std::cerr << "  ✗ FAIL: Disabled profiler recorded a run" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Disabled profiler records no runs" << std::endl;
+
+    BoxerProgramProfiler timed;
+    timed.enable();
+    timed.beginRun("C:\\GAME.EXE");
+    const uint64_t counts = 10000000;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < counts; ++i) {
+        timed.addCycles(1);
+        timed.didReadBytes(i & 0xff);
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    timed.endRun("C:\\GAME.EXE");
+    std::cout << "  Counting: " << ns / (2.0 * counts) << " ns per count" << std::endl;
+
+    if (timed.program("C:\\GAME.EXE")->totals.cycles != counts) {
+        std::cerr << "  ✗ FAIL: Counts lost" << std::endl;
+        return false;
+    }
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Program Profiler Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-034, INT-035 profiling" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testSingleRun()) passed++; else failed++;
+    if (testRepeatedRuns()) passed++; else failed++;
+    if (testNestedRuns()) passed++; else failed++;
+    if (testUnfinishedRuns()) passed++; else failed++;
+    if (testJsonOutput()) passed++; else failed++;
+    if (testDisabledAndCost()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}
@@ -0,0 +1,481 @@
+/*
+ * warm-boot-test.cpp - Post-AUTOEXEC warm boot snapshot test suite
+ *
+ * Validates BoxerWarmBoot, driven from:
+ * - INT-025: shellWillStartAutoexec
+ * - INT-026: didReturnToShell
+ *
+ * Test cases:
+ * 1. Capture after AUTOEXEC and restore into a fresh machine
+ * 2. Capture happens once, and never after a warm boot
+ * 3. Another configuration or section layout is not restored
+ * 4. Damaged snapshots are rejected before anything is loaded
+ * 5. A section can veto the capture
+ * 6. Capture and restore cost for 16 MB of RAM
+ * 7. Restore hooks resync the clock; changed AUTOEXEC files make it stale
+ *
+ * Copyright (c) 2025 Boxer DOSBox Integration Project
+ * Released under GNU General Public License 2.0
+ */
+
+#include "boxer_warm_boot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// ============================================================================
+// Simulated machine
+// ============================================================================
+
+struct CpuState {
+    uint32_t eax, ebx, ecx, edx, esi, edi, ebp, esp, eip, flags;
+    uint16_t cs, ds, es, ss;
+};
+
+struct SimulatedMachine {
+    std::vector<uint8_t> ram;
+    CpuState cpu{};
+    std::string currentDirectory;
+    int loads = 0;
+    int openFiles = 0;
+
+    explicit SimulatedMachine(size_t ramBytes) : ram(ramBytes, 0) {}
+
+    // What BIOS POST, DOS init and AUTOEXEC leave behind
+    void coldBoot() {
+        for (size_t i = 0; i < ram.size(); ++i) {
+            ram[i] = static_cast<uint8_t>((i * 2654435761u) >> 13);
+        }
+        cpu = CpuState{0x1234, 0, 0x80, 0, 0, 0, 0, 0xfffe, 0x0100, 0x0202, 0x0814, 0x0814, 0x0814, 0x0814};
+        currentDirectory = "C:\\GAMES";
+    }
+
+    void registerWith(BoxerWarmBoot& warmBoot, uint32_t cpuVersion = 1) {
+        warmBoot.registerSection("ram", 1,
+            [this](std::vector<uint8_t>& out) { out.insert(out.end(), ram.begin(), ram.end()); },
+            [this](const uint8_t* data, size_t size) {
+                if (size != ram.size()) {
+                    return false;
+                }
+                std::copy(data, data + size, ram.begin());
+                ++loads;
+                return true;
+            });
+        warmBoot.registerSection("cpu", cpuVersion,
+            [this](std::vector<uint8_t>& out) {
+                const auto* bytes = reinterpret_cast<const uint8_t*>(&cpu);
+                out.insert(out.end(), bytes, bytes + sizeof(cpu));
+            },
+            [this](const uint8_t* data, size_t size) {
+                if (size != sizeof(cpu)) {
+                    return false;
+                }
+                std::memcpy(&cpu, data, size);
+                ++loads;
+                return true;
+            });
+        warmBoot.registerSection("dos", 1,
+            [this](std::vector<uint8_t>& out) {
+                out.insert(out.end(), currentDirectory.begin(), currentDirectory.end());
+            },
+            [this](const uint8_t* data, size_t size) {
+                currentDirectory.assign(reinterpret_cast<const char*>(data), size);
+                ++loads;
+                return true;
+            },
+            [this](std::string& reason) {
+                if (openFiles > 0) {
+                    reason = std::to_string(openFiles) + " DOS file handles open";
+                    return false;
+                }
+                return true;
+            });
+    }
+
+    bool sameStateAs(const SimulatedMachine& other) const {
+        return ram == other.ram && std::memcmp(&cpu, &other.cpu, sizeof(cpu)) == 0 &&
+               currentDirectory == other.currentDirectory;
+    }
+};
+
+struct TempDir {
+    fs::path path;
+    TempDir() {
+        path = fs::temp_directory_path() /
+               ("boxer-warmboot-test-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+        fs::create_directories(path);
+    }
+    ~TempDir() {
+        std::error_code error;
+        fs::remove_all(path, error);
+    }
+};
+
+const size_t kRamBytes = 16 * 1024 * 1024;
+
+uint64_t keyFor(const std::string& config) {
+    return BoxerWarmBoot::configurationKey(config, "dosbox-staging 0.82.0 boxer");
+}
+
+// Cold boot a machine with this configuration and capture its snapshot
+bool captureSnapshot(const TempDir& dir, const std::string& config, SimulatedMachine& machine) {
+    BoxerWarmBoot warmBoot(dir.path.string(), keyFor(config));
+    machine.registerWith(warmBoot);
+    if (warmBoot.restore() != BoxerWarmBoot::RestoreResult::NoSnapshot) {
+        return false;
+    }
+    warmBoot.autoexecWillStart();
+    machine.coldBoot();
+    return warmBoot.shellDidBecomeIdle() == BoxerWarmBoot::CaptureResult::Captured;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+bool testCaptureAndRestore() {
+    std::cout << "\n[TEST 1] Capture After AUTOEXEC and Restore" << std::endl;
+
+    TempDir dir;
+    SimulatedMachine first(kRamBytes);
+    if (!captureSnapshot(dir, "[cpu]\ncycles=max\n", first)) {
+        std::cerr << "  ✗ FAIL: Cold boot did not capture" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Snapshot captured when the shell went idle after AUTOEXEC" << std::endl;
+
+    SimulatedMachine second(kRamBytes);
+    BoxerWarmBoot warmBoot(dir.path.string(), keyFor("[cpu]\ncycles=max\n"));
+    second.registerWith(warmBoot);
+    if (warmBoot.restore() != BoxerWarmBoot::RestoreResult::Restored || !warmBoot.restored()) {
+        std::cerr << "  ✗ FAIL: Restore failed" << std::endl;
+        return false;
+    }
+    if (!second.sameStateAs(first) || second.loads != 3) {
+        std::cerr << "  ✗ FAIL: Restored machine differs from the captured one" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Fresh machine restored to the captured state ("
+              << warmBoot.stats().bytes / 1024 << " KB)" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testCaptureOnce() {
+    std::cout << "\n[TEST 2] Capture Once, Never After a Warm Boot" << std::endl;
+
+    TempDir dir;
+    const std::string config = "[dos]\nems=true\n";
+    SimulatedMachine machine(4096);
+    BoxerWarmBoot warmBoot(dir.path.string(), keyFor(config));
+    machine.registerWith(warmBoot);
+
+    if (warmBoot.shellDidBecomeIdle() != BoxerWarmBoot::CaptureResult::NotArmed) {
+        std::cerr << "  ✗ FAIL: Captured without AUTOEXEC" << std::endl;
+        return false;
+    }
+    warmBoot.autoexecWillStart();
+    machine.coldBoot();
+    if (warmBoot.shellDidBecomeIdle() != BoxerWarmBoot::CaptureResult::Captured ||
+        warmBoot.shellDidBecomeIdle() != BoxerWarmBoot::CaptureResult::NotArmed) {
+        std::cerr << "  ✗ FAIL: Expected one capture at the first idle prompt" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Captured at the first idle prompt only" << std::endl;
+
+    SimulatedMachine warm(4096);
+    BoxerWarmBoot next(dir.path.string(), keyFor(config));
+    warm.registerWith(next);
+    next.restore();
+    next.autoexecWillStart();
+    if (next.shellDidBecomeIdle() != BoxerWarmBoot::CaptureResult::NotArmed) {
+        std::cerr << "  ✗ FAIL: Warm-booted session captured again" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Warm-booted session does not recapture" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testStaleSnapshots() {
+    std::cout << "\n[TEST 3] Other Configurations and Layouts Not Restored" << std::endl;
+
+    TempDir dir;
+    SimulatedMachine original(4096);
+    captureSnapshot(dir, "[sblaster]\nirq=7\n", original);
+
+    SimulatedMachine other(4096);
+    BoxerWarmBoot otherConfig(dir.path.string(), keyFor("[sblaster]\nirq=5\n"));
+    other.registerWith(otherConfig);
+    if (otherConfig.restore() != BoxerWarmBoot::RestoreResult::NoSnapshot || other.loads != 0) {
+        std::cerr << "  ✗ FAIL: Snapshot used for a different configuration" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Different configuration: no snapshot" << std::endl;
+
+    if (BoxerWarmBoot::configurationKey("a", "build-1") == BoxerWarmBoot::configurationKey("a", "build-2")) {
+        std::cerr << "  ✗ FAIL: Build id not part of the key" << std::endl;
+        return false;
+    }
+
+    SimulatedMachine newer(4096);
+    BoxerWarmBoot newLayout(dir.path.string(), keyFor("[sblaster]\nirq=7\n"));
+    newer.registerWith(newLayout, 2);
+    if (newLayout.restore() != BoxerWarmBoot::RestoreResult::Stale || newer.loads != 0) {
+        std::cerr << "  ✗ FAIL: Snapshot with an old CPU layout was loaded" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Section version changed: stale, nothing loaded" << std::endl;
+
+    SimulatedMachine extra(4096);
+    BoxerWarmBoot extraSection(dir.path.string(), keyFor("[sblaster]\nirq=7\n"));
+    extra.registerWith(extraSection);
+    extraSection.registerSection("vga", 1, [](std::vector<uint8_t>&) {},
+                                 [](const uint8_t*, size_t) { return true; });
+    if (extraSection.restore() != BoxerWarmBoot::RestoreResult::Stale || extra.loads != 0) {
+        std::cerr << "  ✗ FAIL: Snapshot missing a section was loaded" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ New section registered: stale, nothing loaded" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testDamagedSnapshots() {
+    std::cout << "\n[TEST 4] Damaged Snapshots Rejected Before Loading" << std::endl;
+
+    TempDir dir;
+    const std::string config = "[render]\naspect=true\n";
+    SimulatedMachine original(65536);
+    captureSnapshot(dir, config, original);
+
+    BoxerWarmBoot probe(dir.path.string(), keyFor(config));
+    const std::string path = probe.snapshotPath();
+    const auto size = fs::file_size(path);
+
+    // Flip one byte near the end: the last section's data, after the RAM
+    // section has passed its own check
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(static_cast<std::streamoff>(size - 3));
+        char byte = 0;
+        file.read(&byte, 1);
+        byte ^= 0x20;
+        file.seekp(static_cast<std::streamoff>(size - 3));
+        file.write(&byte, 1);
+    }
+    SimulatedMachine flipped(65536);
+    BoxerWarmBoot flippedBoot(dir.path.string(), keyFor(config));
+    flipped.registerWith(flippedBoot);
+    if (flippedBoot.restore() != BoxerWarmBoot::RestoreResult::Corrupt || flipped.loads != 0) {
+        std::cerr << "  ✗ FAIL: Flipped byte not detected before loading" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Flipped byte: corrupt, no section loaded" << std::endl;
+
+    fs::resize_file(path, size / 2);
+    SimulatedMachine truncated(65536);
+    BoxerWarmBoot truncatedBoot(dir.path.string(), keyFor(config));
+    truncated.registerWith(truncatedBoot);
+    if (truncatedBoot.restore() != BoxerWarmBoot::RestoreResult::Corrupt || truncated.loads != 0) {
+        std::cerr << "  ✗ FAIL: Truncated file not detected" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Truncated file: corrupt, no section loaded" << std::endl;
+
+    // The cold boot that follows overwrites it
+    SimulatedMachine recovered(65536);
+    BoxerWarmBoot recovery(dir.path.string(), keyFor(config));
+    recovered.registerWith(recovery);
+    recovery.autoexecWillStart();
+    recovered.coldBoot();
+    if (recovery.shellDidBecomeIdle() != BoxerWarmBoot::CaptureResult::Captured ||
+        fs::file_size(path) != size) {
+        std::cerr << "  ✗ FAIL: Cold boot did not replace the damaged snapshot" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Next cold boot replaces the damaged snapshot" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testVeto() {
+    std::cout << "\n[TEST 5] Section Vetoes the Capture" << std::endl;
+
+    TempDir dir;
+    SimulatedMachine machine(4096);
+    BoxerWarmBoot warmBoot(dir.path.string(), keyFor("[autoexec]\nLOADHIGH TSR.COM\n"));
+    machine.registerWith(warmBoot);
+    warmBoot.autoexecWillStart();
+    machine.coldBoot();
+    machine.openFiles = 2;
+
+    if (warmBoot.shellDidBecomeIdle() != BoxerWarmBoot::CaptureResult::Vetoed) {
+        std::cerr << "  ✗ FAIL: Capture not vetoed" << std::endl;
+        return false;
+    }
+    if (fs::exists(warmBoot.snapshotPath()) || warmBoot.stats().vetoReason != "dos: 2 DOS file handles open") {
+        std::cerr << "  ✗ FAIL: Snapshot written or reason missing: " << warmBoot.stats().vetoReason << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Vetoed with reason '" << warmBoot.stats().vetoReason << "', nothing written" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testWarmBootCost() {
+    std::cout << "\n[TEST 6] Warm Boot Cost" << std::endl;
+
+    TempDir dir;
+    const std::string config = "[dosbox]\nmemsize=16\n";
+    SimulatedMachine first(kRamBytes);
+    BoxerWarmBoot capture(dir.path.string(), keyFor(config));
+    first.registerWith(capture);
+    capture.autoexecWillStart();
+    first.coldBoot();
+    capture.shellDidBecomeIdle();
+
+    SimulatedMachine second(kRamBytes);
+    BoxerWarmBoot warmBoot(dir.path.string(), keyFor(config));
+    second.registerWith(warmBoot);
+    if (warmBoot.restore() != BoxerWarmBoot::RestoreResult::Restored || !second.sameStateAs(first)) {
+        std::cerr << "  ✗ FAIL: Restore failed" << std::endl;
+        return false;
+    }
+
+    const double mb = static_cast<double>(warmBoot.stats().bytes) / (1024 * 1024);
+    std::cout << "  Capture: " << capture.stats().captureMs << " ms for " << mb << " MB" << std::endl;
+    std::cout << "  Restore: " << warmBoot.stats().restoreMs << " ms ("
+              << mb / (warmBoot.stats().restoreMs / 1000.0) << " MB/s)" << std::endl;
+    std::cout << "  (A real AUTOEXEC runs for seconds of emulated time; restore replaces all of it)" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+bool testHostStateAfterRestore() {
+    std::cout << "\n[TEST 7] Clock Resynced and AUTOEXEC's Files Checked" << std::endl;
+
+    TempDir dir;
+    const std::string config = "[autoexec]\nmount c games\nc:\\mouse\\mouse.com\n";
+    const std::string tsr = (dir.path / "MOUSE.COM").string();
+    {
+        std::ofstream out(tsr, std::ios::binary);
+        out << "mouse driver v8.20";
+    }
+
+    SimulatedMachine first(4096);
+    BoxerWarmBoot capture(dir.path.string(), keyFor(config));
+    first.registerWith(capture);
+    capture.autoexecWillStart();
+    first.coldBoot();
+    capture.autoexecRanFile(tsr);
+    capture.autoexecRanFile(tsr);
+    if (capture.shellDidBecomeIdle() != BoxerWarmBoot::CaptureResult::Captured || capture.stats().files != 1) {
+        std::cerr << "  ✗ FAIL: Expected one file recorded with the snapshot" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ File AUTOEXEC ran recorded once with the snapshot" << std::endl;
+
+    // The BIOS tick count at 0040:006C stands in for the clocks
+    const size_t tickOffset = 0x046c;
+    int resyncs = 0;
+    auto resyncClock = [&resyncs](SimulatedMachine& machine) {
+        ++resyncs;
+        const uint32_t hostTicks = 0x000f1234;
+        std::memcpy(machine.ram.data() + tickOffset, &hostTicks, sizeof(hostTicks));
+    };
+
+    SimulatedMachine warm(4096);
+    BoxerWarmBoot warmBoot(dir.path.string(), keyFor(config));
+    warm.registerWith(warmBoot);
+    warmBoot.addRestoreHook([&] { resyncClock(warm); });
+    if (warmBoot.restore() != BoxerWarmBoot::RestoreResult::Restored || resyncs != 1) {
+        std::cerr << "  ✗ FAIL: Restore hook did not run once after the restore" << std::endl;
+        return false;
+    }
+    uint32_t ticks = 0;
+    std::memcpy(&ticks, warm.ram.data() + tickOffset, sizeof(ticks));
+    if (ticks != 0x000f1234 || warm.sameStateAs(first)) {
+        std::cerr << "  ✗ FAIL: Tick count still holds the captured value" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ Restore hook set the tick count from the host after loading" << std::endl;
+
+    // Same length, different contents: the key alone would not notice
+    {
+        std::ofstream out(tsr, std::ios::binary | std::ios::trunc);
+        out << "mouse driver v9.01";
+    }
+    SimulatedMachine changed(4096);
+    BoxerWarmBoot changedBoot(dir.path.string(), keyFor(config));
+    changed.registerWith(changedBoot);
+    changedBoot.addRestoreHook([&] { resyncClock(changed); });
+    if (changedBoot.restore() != BoxerWarmBoot::RestoreResult::Stale || changed.loads != 0 || resyncs != 1) {
+        std::cerr << "  ✗ FAIL: Snapshot restored after the TSR changed" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ TSR changed: stale, nothing loaded, no hook run" << std::endl;
+
+    fs::remove(tsr);
+    SimulatedMachine missing(4096);
+    BoxerWarmBoot missingBoot(dir.path.string(), keyFor(config));
+    missing.registerWith(missingBoot);
+    if (missingBoot.restore() != BoxerWarmBoot::RestoreResult::Stale || missing.loads != 0) {
+        std::cerr << "  ✗ FAIL: Snapshot restored after the TSR was deleted" << std::endl;
+        return false;
+    }
+    std::cout << "  ✓ TSR deleted: stale, nothing loaded" << std::endl;
+
+    std::cout << "  ✅ TEST PASSED" << std::endl;
+    return true;
+}
+
+// ============================================================================
+// Main Test Runner
+// ============================================================================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "Boxer Warm Boot Test Suite" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "\nTesting INT-025, INT-026 warm boot snapshots" << std::endl;
+
+    int passed = 0;
+    int failed = 0;
+
+    if (testCaptureAndRestore()) passed++; else failed++;
+    if (testCaptureOnce()) passed++; else failed++;
+    if (testStaleSnapshots()) passed++; else failed++;
+    if (testDamagedSnapshots()) passed++; else failed++;
+    if (testVeto()) passed++; else failed++;
+    if (testWarmBootCost()) passed++; else failed++;
+    if (testHostStateAfterRestore()) passed++; else failed++;
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Passed: " << passed << "/" << (passed + failed) << std::endl;
+    std::cout << "  Failed: " << failed << "/" << (passed + failed) << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (failed == 0) {
+        std::cout << "\n✅ ALL TESTS PASSED" << std::endl;
+        return 0;
+    }
+    std::cerr << "\n❌ SOME TESTS FAILED - Review failures above" << std::endl;
+    return 1;
+}